@@ -179,6 +179,11 @@ static vector<filesystem::path> embedded_runtime_sources(const filesystem::path
       root / "src" / "runtime" / "seq.c",
       root / "src" / "runtime" / "hamt.c",
       root / "src" / "runtime" / "exceptions.c",
+      root / "src" / "runtime" / "string_simd.c",
+      root / "src" / "runtime" / "numconv.c",
+      root / "src" / "runtime" / "intern.c",
+      root / "src" / "runtime" / "json.c",
+      root / "src" / "runtime" / "binary.c",
       root / "src" / "runtime" / "closures.c",
       root / "src" / "runtime" / "gpu_vulkan.c",
       root / "src" / "runtime" / "gpu_vulkan_device.c",
@@ -509,6 +509,9 @@ private:
         // Strings
         llvm::Function* string_concat_ = nullptr;
         llvm::Function* string_eq_ = nullptr;
+        llvm::Function *string_length_ = nullptr, *string_alloc_len_ = nullptr,
+            *format_int_ = nullptr, *format_float_ = nullptr, *format_seq_ = nullptr,
+            *intern_register_ = nullptr;
         // Sequences
         llvm::Function *seq_alloc_ = nullptr, *seq_set_ = nullptr, *seq_get_ = nullptr,
             *seq_set_heap_ = nullptr,
@@ -533,12 +536,14 @@ private:
         llvm::Function *async_call_ = nullptr, *async_call_thunk_ = nullptr,
             *async_await_ = nullptr, *async_await_keep_ = nullptr, *io_await_ = nullptr;
         // Task groups (structured concurrency)
-        llvm::Function *group_begin_ = nullptr, *group_register_ = nullptr,
+        llvm::Function *group_begin_ = nullptr, *group_begin_in_ = nullptr,
+            *group_register_ = nullptr,
             *group_register_io_ = nullptr, *group_await_all_ = nullptr,
             *group_end_ = nullptr, *group_cancel_ = nullptr, *group_is_cancelled_ = nullptr,
             *async_call_grouped_ = nullptr, *async_call_thunk_grouped_ = nullptr,
             *group_attach_arena_ = nullptr,
-            *group_arena_bind_push_ = nullptr, *group_arena_bind_pop_ = nullptr;
+            *group_arena_bind_push_ = nullptr, *group_arena_bind_pop_ = nullptr,
+            *par_map_ = nullptr;
         // Exceptions
         llvm::Function *try_begin_ = nullptr, *try_end_ = nullptr, *raise_ = nullptr,
             *get_exc_sym_ = nullptr, *get_exc_msg_ = nullptr;
@@ -576,11 +581,15 @@ private:
         // Misc
         llvm::Function *box_ = nullptr, *close_ = nullptr;
         // Arena
-        llvm::Function *arena_create_ = nullptr, *arena_alloc_ = nullptr,
-            *arena_destroy_ = nullptr;
+        llvm::Function *let_arena_begin_ = nullptr, *arena_alloc_ = nullptr,
+            *let_arena_end_ = nullptr;
     } rt_;
 
     int64_t intern_symbol(const std::string& name);
+    // Short string literals are emitted pre-interned (see codegen_string);
+    // emit_intern_ctor registers them with the runtime from a module ctor.
+    std::vector<llvm::Constant*> interned_literals_;
+    void emit_intern_ctor();
     int opt_level_ = 2;
 
     // Debug info helpers
@@ -720,6 +729,8 @@ private:
     TypedValue codegen_higher_order_call(const std::string& fn_name, const std::vector<TypedValue>& all_args);
     TypedValue codegen_extern_call(ApplyExpr* node, const std::string& fn_name,
                                     const std::vector<TypedValue>& all_args);
+    std::optional<TypedValue> codegen_literal_format(const std::string& fn_name,
+                                                     const std::vector<ApplyExpr*>& chain);
     TypedValue codegen_partial_apply(const std::string& fn_name, CompiledFunction& cf,
                                       const std::vector<TypedValue>& all_args);
     TypedValue codegen_curry_apply(const std::string& fn_name, CompiledFunction& cf,
@@ -787,6 +798,7 @@ private:
 
     // Generators / comprehensions
     TypedValue codegen_seq_generator(SeqGeneratorExpr* node);
+    TypedValue parallel_map_closure(SeqGeneratorExpr* node, CType elem_type);
     TypedValue codegen_fused_seq_generator(SeqGeneratorExpr* outer, SeqGeneratorExpr* inner);
     static int count_identifier_refs(ast::AstNode* node, const std::string& name);
     TypedValue codegen_set_generator(SetGeneratorExpr* node);
@@ -39,8 +39,9 @@ struct DeriveAdtInfo {
     bool is_recursive = false;
 };
 
-/// Generator function: takes ADT metadata, returns method source text.
-using DeriveGeneratorFn = std::function<std::string(const DeriveAdtInfo&)>;
+/// Generator function: takes ADT metadata and the method being derived,
+/// returns that method's source text.
+using DeriveGeneratorFn = std::function<std::string(const DeriveAdtInfo&, const std::string& method)>;
 
 /// A registered derivable trait strategy.
 struct DeriveStrategyInfo {
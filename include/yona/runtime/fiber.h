@@ -0,0 +1,31 @@
+/*
+ * Green-thread hooks for blocking runtime code outside the async TU.
+ *
+ * On POSIX every pool task runs on its own fiber (see async_posix.c). Code
+ * that would otherwise block a worker thread — io_uring completion waits in
+ * uring_linux.c — parks the fiber instead and lets the worker run other
+ * tasks. Fibers resume on the worker that started them.
+ *
+ * Protocol: publish the fiber handle where the waker will find it, release
+ * any locks, then call yona_rt_fiber_suspend(). The waker calls
+ * yona_rt_fiber_ready() exactly once. Waking before the fiber has finished
+ * suspending is fine: its worker cannot resume it until it has switched out.
+ *
+ * Not implemented by the Windows thread pool; callers only use it from
+ * POSIX platform TUs.
+ */
+
+#ifndef YONA_FIBER_H
+#define YONA_FIBER_H
+
+/* The calling task's fiber, or NULL on a plain thread (main, or a worker
+ * running a task that could not get a fiber stack). */
+void* yona_rt_fiber_current(void);
+
+/* Switch away from the current fiber until yona_rt_fiber_ready(). */
+void yona_rt_fiber_suspend(void);
+
+/* Make a suspended fiber runnable on its worker. Any thread. */
+void yona_rt_fiber_ready(void* fiber);
+
+#endif /* YONA_FIBER_H */
@@ -26,6 +26,10 @@
 /* ===== I/O await (io_uring user_data on Linux; IOCP / direct-result on Windows) ===== */
 
 int64_t yona_rt_io_await(int64_t uring_id);
+/* Hand I/O the calling thread has queued but not yet submitted to the
+ * kernel. The scheduler calls this before a thread blocks or after a task
+ * finishes; a no-op where submission is immediate. */
+void yona_platform_io_flush(void);
 
 /* ===== Async File I/O (submit-and-return) ===== */
 
@@ -46,6 +50,7 @@ int yona_platform_append_file(const char* path, const char* content);
 int yona_platform_file_exists(const char* path);
 int yona_platform_remove_file(const char* path);
 int64_t yona_platform_file_size(const char* path);
+void* yona_platform_map_file_bytes(const char* path);
 int64_t* yona_platform_list_dir(const char* path);
 int64_t yona_platform_open_file_handle(const char* path, int64_t mode_tag);
 int64_t yona_platform_close_file_handle(int fd);
@@ -55,6 +60,18 @@ int64_t yona_platform_advance_file_handle(int fd, int64_t delta);
 int64_t yona_platform_flush_file_handle(int fd);
 int64_t yona_platform_truncate_file_handle(int fd, int64_t length);
 
+/* ===== CPU topology (worker pool sizing and pinning) ===== */
+
+int64_t yona_platform_cpu_count(void);
+/* CPUs this process may actually use: online CPUs narrowed by the affinity
+ * mask and, on Linux, the cgroup CPU quota (rounded up). Always >= 1. */
+int64_t yona_platform_available_cpus(void);
+/* Fill cpus[]/nodes[] with the CPU ids in the affinity mask and their NUMA
+ * node, grouped by node. Returns the count (0 if unknown). */
+int yona_platform_usable_cpus(int* cpus, int* nodes, int max);
+/* Pin the calling thread to one CPU. Returns 0 on success, -1 otherwise. */
+int yona_platform_pin_thread(int cpu);
+
 /* ===== Console I/O ===== */
 
 char* yona_platform_read_line(void);
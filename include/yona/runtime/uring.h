@@ -1,12 +1,14 @@
 /*
  * io_uring shared infrastructure — used by file_linux.c, net_linux.c, etc.
  *
- * Raw syscall interface (no liburing dependency). Lazily initialized,
- * thread-safe via mutex. Supports submit-and-wait pattern via user_data IDs.
+ * Raw syscall interface (no liburing dependency). Each submitting thread
+ * gets its own ring on first use. Supports submit-and-wait pattern via
+ * user_data IDs, which name their ring, so any thread may await or cancel
+ * an ID.
  *
  * Ring state and the io_ctx table live in src/runtime/platform/uring_linux.c
- * so every platform TU shares one ring. (A header-static singleton used to
- * give file/net/os each their own ring — net submit + file await SIGSEGV.)
+ * so every platform TU sees the same rings. (A header-static singleton used
+ * to give file/net/os each their own ring — net submit + file await SIGSEGV.)
  *
  * Header lives under include/yona/runtime/; implementations consume it from
  * src/runtime/platform/ (Linux .c files only).
@@ -41,13 +43,58 @@ typedef struct {
     int close_fd;
 } io_context_t;
 
+/* Contexts for IDs that are not ring IDs (direct results) */
 #define IO_CTX_TABLE_SIZE 1024
 
+/* Queue an SQE on the calling thread's ring. It reaches the kernel in a
+ * batch: see ring_flush. */
 uint64_t ring_submit_sqe(struct io_uring_sqe *sqe_template);
+/* Submit whatever the calling thread has queued. */
+void ring_flush(void);
 int32_t ring_await(uint64_t id);
+/* ring_await, also returning the CQE flags (IORING_CQE_F_BUFFER etc.) */
+int32_t ring_await_flags(uint64_t id, uint32_t* cqe_flags);
 void ring_cancel(uint64_t target_id);
 void ring_cancel_group_ios(uint64_t* io_ids, int count);
 
+/* Registered resources; every call falls back quietly (0 / NULL) when the
+ * kernel or limits refuse them.
+ *
+ * ring_file_track marks a long-lived fd (socket, file handle) so SQEs on
+ * it use the ring's fixed-file table; ring_file_forget (which also ends
+ * streams on the fd) must precede its close(). */
+void ring_file_track(int fd);
+void ring_file_forget(int fd);
+/* A registered staging buffer of at least len bytes on the calling
+ * thread's ring, for an IORING_OP_WRITE_FIXED with buf_index = *index
+ * submitted from the same thread. ring_buf_put returns it from any thread
+ * and returns 0 if data is not a staging buffer. */
+void* ring_buf_get(size_t len, unsigned* index);
+int ring_buf_put(const void* data);
+/* Let the kernel pick a recv buffer of up to len bytes from the calling
+ * thread's provided-buffer ring. On completion, read the bytes from
+ * ring_pbuf_data(id, cqe_flags), then ring_pbuf_recycle. A recv that
+ * finds the pool empty fails with -ENOBUFS. */
+int ring_sqe_select_buffer(struct io_uring_sqe* sqe, size_t len);
+const char* ring_pbuf_data(uint64_t id, uint32_t cqe_flags);
+void ring_pbuf_recycle(uint64_t id, uint32_t cqe_flags);
+
+/* Multishot operations (IORING_ACCEPT_MULTISHOT, IORING_RECV_MULTISHOT):
+ * one SQE, armed on the calling thread's ring, yielding results until a
+ * CQE without IORING_CQE_F_MORE. ring_stream_next blocks (parking a
+ * fiber) for the next result and returns 1, or 0 once the stream has
+ * ended, or -1 if it ended because its fd was closed.
+ * ring_stream_close cancels a live stream, drops what it still holds
+ * (provided buffers, accepted fds) and frees it. Closing the fd through
+ * ring_file_forget ends its streams too. One consumer per stream. */
+typedef struct ring_stream ring_stream_t;
+ring_stream_t* ring_stream_open(const struct io_uring_sqe* sqe);
+int ring_stream_next(ring_stream_t* st, int32_t* res, uint32_t* cqe_flags);
+uint64_t ring_stream_id(const ring_stream_t* st);
+void ring_stream_close(ring_stream_t* st);
+
+/* Attach a context to an ID. For a ring ID, take it back before
+ * ring_await: awaiting recycles the ID's completion slot. */
 void io_ctx_put(uint64_t id, io_context_t* ctx);
 io_context_t* io_ctx_take(uint64_t id);
 
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""
+Regenerate include/runtime/pow10_table.inl.
+
+128-bit truncated significands of 10^e for e in [-348, 347], normalized so
+the top bit is set: m = floor(10^e * 2^s) with 2^127 <= m < 2^128. Used by
+src/runtime/numconv.c for Eisel-Lemire parsing (as is) and for Schubfach
+shortest printing (g = (m >> 2) + 1, a 126-bit upper bound).
+
+Usage:
+    python3 scripts/gen_pow10_table.py
+"""
+
+from __future__ import annotations
+
+from fractions import Fraction
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+OUT = ROOT / "include" / "runtime" / "pow10_table.inl"
+
+MIN_E10 = -348
+MAX_E10 = 347
+
+
+def significand(e: int) -> int:
+    x = Fraction(10) ** e
+    # Smallest s with x * 2^s >= 2^127.
+    s = 127 - (x.numerator.bit_length() - x.denominator.bit_length())
+    while x * Fraction(2) ** s >= 2**128:
+        s -= 1
+    while x * Fraction(2) ** s < 2**127:
+        s += 1
+    v = x * Fraction(2) ** s
+    m = v.numerator // v.denominator
+    assert 2**127 <= m < 2**128
+    return m
+
+
+def main() -> None:
+    lines = [
+        "/* 128-bit powers of ten — generated by scripts/gen_pow10_table.py; do not edit by hand. */",
+        "#ifndef YONA_RUNTIME_POW10_TABLE_INL",
+        "#define YONA_RUNTIME_POW10_TABLE_INL",
+        "",
+        f"#define YONA_POW10_MIN_E10 ({MIN_E10})",
+        f"#define YONA_POW10_MAX_E10 {MAX_E10}",
+        "",
+        "/* { high 64 bits, low 64 bits } of floor(10^e * 2^s), top bit set */",
+        "static const uint64_t yona_pow10_table[][2] = {",
+    ]
+    for e in range(MIN_E10, MAX_E10 + 1):
+        m = significand(e)
+        lines.append(f"    {{0x{m >> 64:016x}, 0x{m & (2**64 - 1):016x}}}, /* 1e{e} */")
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif")
+    OUT.write_text("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -33,6 +33,7 @@
 #include <llvm/Transforms/Scalar.h>
 #include <llvm/Transforms/Scalar/GVN.h>
 #include <llvm/Transforms/Utils.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
 #include <llvm/Transforms/IPO.h>
 #include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <llvm/Passes/PassBuilder.h>
@@ -363,6 +364,12 @@ void Codegen::declare_runtime() {
     rt_.print_seq_     = decl("yona_rt_print_seq", vd, {i64p});
     rt_.string_concat_ = decl("yona_rt_string_concat", ptr, {ptr, ptr});
     rt_.string_eq_     = decl("yona_Prelude__Eq_String__eq", i64, {ptr, ptr});
+    rt_.string_length_ = decl("yona_rt_string_length_fast", i64, {ptr});
+    rt_.string_alloc_len_ = decl("yona_rt_rc_alloc_string_len", ptr, {i64, i64});
+    rt_.format_int_    = decl("yona_rt_format_int", i64, {ptr, i64});
+    rt_.format_float_  = decl("yona_rt_format_float", i64, {ptr, f64});
+    rt_.format_seq_    = decl("yona_rt_format_seq", ptr, {ptr, i64p, i64});
+    rt_.intern_register_ = decl("yona_rt_intern_register", vd, {ptr, i64});
     rt_.seq_alloc_     = decl("yona_rt_seq_alloc", i64p, {i64});
     rt_.seq_set_       = decl("yona_rt_seq_set", vd, {i64p, i64, i64});
     rt_.seq_set_heap_  = decl("yona_rt_seq_set_heap", vd, {i64p, i64});
@@ -416,6 +423,7 @@ void Codegen::declare_runtime() {
     // Task groups (structured concurrency)
     auto group_ptr = ptr; // opaque pointer to yona_task_group_t
     rt_.group_begin_   = decl("yona_rt_group_begin", group_ptr, {});
+    rt_.group_begin_in_ = decl("yona_rt_group_begin_in", group_ptr, {ptr, i64});
     rt_.group_register_ = decl("yona_rt_group_register", vd, {group_ptr, promise_ptr});
     rt_.group_register_io_ = decl("yona_rt_group_register_io", vd, {group_ptr, i64});
     rt_.group_await_all_ = decl("yona_rt_group_await_all", i64, {group_ptr});
@@ -428,6 +436,9 @@ void Codegen::declare_runtime() {
     rt_.group_arena_bind_push_ = decl("yona_rt_group_arena_bind_push", vd, {group_ptr});
     rt_.group_arena_bind_pop_ = decl("yona_rt_group_arena_bind_pop", vd, {});
 
+    // Chunked parallel loops: [| f x for x = xs ] with a closure f
+    rt_.par_map_ = decl("yona_rt_par_map", i64p, {ptr, i64p, i64});
+
     // ADT runtime (recursive types)
     auto i8 = LType::getInt8Ty(*context_);
     rt_.adt_alloc_     = decl("yona_rt_adt_alloc", ptr, {i64, i64});
@@ -452,9 +463,9 @@ void Codegen::declare_runtime() {
     rt_.rc_dec_ = decl("yona_rt_rc_dec", vd, {ptr});
 
     // Arena allocator
-    rt_.arena_create_  = decl("yona_rt_arena_create", ptr, {i64});
-    rt_.arena_alloc_   = decl("yona_rt_arena_alloc", ptr, {ptr, i64, i64});
-    rt_.arena_destroy_ = decl("yona_rt_arena_destroy", vd, {ptr});
+    rt_.let_arena_begin_ = decl("yona_rt_let_arena_begin", ptr, {});
+    rt_.arena_alloc_     = decl("yona_rt_arena_alloc", ptr, {ptr, i64, i64});
+    rt_.let_arena_end_   = decl("yona_rt_let_arena_end", vd, {ptr});
 
     // io_uring await
     rt_.io_await_ = decl("yona_rt_io_await", i64, {i64});
@@ -588,6 +599,7 @@ std::string Codegen::mangle_name(const std::string& module_fqn, const std::strin
 Module* Codegen::compile(AstNode* node) {
     auto fn = codegen_main(node);
     if (!fn) return nullptr;
+    emit_intern_ctor();
     finalize_debug_info();
     std::string err;
     raw_string_ostream os(err);
@@ -803,7 +815,7 @@ Module* Codegen::compile_module(ModuleDecl* mod) {
 
             // Generate and compile each method from the strategy
             for (auto& method_name : strategy->method_names) {
-                std::string method_source = strategy->generator(dai);
+                std::string method_source = strategy->generator(dai, method_name);
                 if (method_source.empty()) continue;
 
                 std::string mangled = trait_name + "_" + adt->name + "__" + method_name;
@@ -1339,6 +1351,7 @@ Module* Codegen::compile_module(ModuleDecl* mod) {
     // Clear builder insert point after module compilation
     builder_->ClearInsertionPoint();
 
+    emit_intern_ctor();
     finalize_debug_info();
 
     // Verify
@@ -1983,6 +1996,29 @@ int64_t Codegen::intern_symbol(const std::string& name) {
     return id;
 }
 
+void Codegen::emit_intern_ctor() {
+    if (interned_literals_.empty()) return;
+    auto* ptr_ty = PointerType::get(*context_, 0);
+    auto* i64_ty = LType::getInt64Ty(*context_);
+    auto* arr_ty = ArrayType::get(ptr_ty, interned_literals_.size());
+    auto* arr = new GlobalVariable(*module_, arr_ty, /*isConstant=*/true,
+                                   GlobalValue::PrivateLinkage,
+                                   ConstantArray::get(arr_ty, interned_literals_), ".strlit.interned");
+    auto* fn = Function::Create(llvm::FunctionType::get(LType::getVoidTy(*context_), {}, false),
+                                Function::InternalLinkage, "yona.intern.init", module_.get());
+    auto saved = builder_->saveIP();
+    auto saved_loc = builder_->getCurrentDebugLocation();
+    builder_->SetInsertPoint(BasicBlock::Create(*context_, "entry", fn));
+    builder_->SetCurrentDebugLocation(DebugLoc());
+    builder_->CreateCall(rt_.intern_register_,
+        {arr, ConstantInt::get(i64_ty, (int64_t)interned_literals_.size())});
+    builder_->CreateRetVoid();
+    builder_->restoreIP(saved);
+    builder_->SetCurrentDebugLocation(saved_loc);
+    appendToGlobalCtors(*module_, fn, 0);
+    interned_literals_.clear();
+}
+
 // ===== CFFI =====
 
 void Codegen::register_cffi_signatures() {
@@ -440,6 +440,8 @@ std::expected<char32_t, LexError> Lexer::parse_escape_sequence() {
         case '\\': return '\\';
         case '"': return '"';
         case '\'': return '\'';
+        case '{': return '{';
+        case '}': return '}';
         case '0': return '\0';
         case 'u': return parse_unicode_escape(4);
         case 'U': return parse_unicode_escape(8);
@@ -501,6 +503,13 @@ std::expected<Token, LexError> Lexer::scan_string_body() {
             return make_token(in_string_interp_ > 0 ? TokenType::YSTRING_PART : TokenType::YSTRING, std::move(value));
         } else if (ch == '{') {
             skip_char(); // consume '{'
+            // "{}" has nothing to interpolate: keep it as text, which is
+            // what Std\Format placeholders need.
+            if (current_ < source_.length() && source_[current_] == '}') {
+                skip_char();
+                value += "{}";
+                continue;
+            }
             in_string_interp_++;
             // Emit the string part before the interpolation
             return make_token(TokenType::YSTRING_PART, std::move(value));
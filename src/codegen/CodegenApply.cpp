@@ -771,9 +771,31 @@ TypedValue Codegen::codegen_extern_call(ApplyExpr* node, const std::string& fn_n
         }
         vals.push_back(arg_val);
     }
-    Value* ext_result = ext_fn->getReturnType()->isVoidTy()
-        ? builder_->CreateCall(ext_fn, vals)
-        : builder_->CreateCall(ext_fn, vals, "extern_call");
+    // Std\Format.format over a Seq of numbers or booleans: the exported
+    // entry reads every element as a string, so pass the element kind to
+    // the runtime formatter instead (same rule as codegen_literal_format).
+    Function* call_fn = ext_fn;
+    if (mangled == "yona_Std_Format__format" && all_args.size() == 2 &&
+        all_args[1].type == CType::SEQ && !all_args[1].subtypes.empty()) {
+        int64_t kind = -1;
+        switch (all_args[1].subtypes[0]) {
+            case CType::STRING: break;
+            case CType::INT:   kind = 1; break;
+            case CType::FLOAT: kind = 2; break;
+            case CType::BOOL:  kind = 3; break;
+            default:
+                report_error(node ? node->source_context : SourceLocation::unknown(),
+                             "type error: Std\\Format.format arguments must be String, Int, Float or Bool");
+                return {};
+        }
+        if (kind > 0) {
+            call_fn = rt_.format_seq_;
+            vals.push_back(ConstantInt::get(i64_ty_local, kind));
+        }
+    }
+    Value* ext_result = call_fn->getReturnType()->isVoidTy()
+        ? builder_->CreateCall(call_fn, vals)
+        : builder_->CreateCall(call_fn, vals, "extern_call");
     if (ext_cf)
         cleanup_borrowed_temporary_args(*ext_cf, all_args);
     if (ext_fn->getReturnType()->isVoidTy())
@@ -1329,6 +1351,132 @@ TypedValue Codegen::emit_direct_call(const std::string& fn_name, CompiledFunctio
     return result;
 }
 
+// ===== Std\Format.format with a literal template =====
+//
+// `format "{}: {}" [a, b]` with a literal template and a literal argument
+// list never reaches yona_Std_Format__format. The template is split into
+// constant segments here, so the emitted code is: one length per argument,
+// one yona_rt_rc_alloc_string_len, then a memcpy per piece. Placeholder
+// semantics match the runtime: `{}` takes the next argument while any
+// remain, surplus `{}` stay literal, surplus arguments are evaluated and
+// ignored. Int/Float/Bool arguments are written directly (Show text)
+// instead of going through toString temporaries.
+
+std::optional<TypedValue> Codegen::codegen_literal_format(const std::string& fn_name,
+                                                          const std::vector<ApplyExpr*>& chain) {
+    auto ext_it = imports_.extern_functions.find(fn_name);
+    if (ext_it == imports_.extern_functions.end() || ext_it->second != "yona_Std_Format__format")
+        return std::nullopt;
+    if (compiled_functions_.count(fn_name) || deferred_functions_.count(fn_name) ||
+        named_values_.count(fn_name))
+        return std::nullopt;
+
+    std::vector<AstNode*> args;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+        for (auto& a : (*it)->args)
+            args.push_back(std::holds_alternative<ExprNode*>(a)
+                ? static_cast<AstNode*>(std::get<ExprNode*>(a))
+                : static_cast<AstNode*>(std::get<ValueExpr*>(a)));
+    if (args.size() != 2) return std::nullopt;
+    auto* tmpl = dynamic_cast<StringExpr*>(args[0]);
+    auto* list = dynamic_cast<ValuesSequenceExpr*>(args[1]);
+    if (!tmpl || !list) return std::nullopt;
+
+    // segments[k] is the literal text before argument k; the last segment
+    // is the tail after the final substituted placeholder.
+    const std::string& fmt = tmpl->value;
+    const size_t argc = list->values.size();
+    std::vector<std::string> segments(1);
+    for (size_t i = 0; i < fmt.size(); i++) {
+        if (fmt[i] == '{' && i + 1 < fmt.size() && fmt[i + 1] == '}' && segments.size() <= argc) {
+            segments.emplace_back();
+            i++;
+        } else {
+            segments.back() += fmt[i];
+        }
+    }
+    const size_t used = segments.size() - 1;
+
+    set_debug_loc(list->source_context);
+    auto* i64_ty = LType::getInt64Ty(*context_);
+    auto* ptr_ty = PointerType::get(*context_, 0);
+    auto* fn_parent = builder_->GetInsertBlock()->getParent();
+    IRBuilder<> entry_ir(&fn_parent->getEntryBlock(), fn_parent->getEntryBlock().begin());
+
+    // Evaluate every argument (in order) and compute its byte length.
+    struct Piece { Value* src; Value* len; };
+    std::vector<Piece> pieces;
+    std::vector<TypedValue> owned;
+    uint64_t const_len = 0;
+    for (auto& seg : segments) const_len += seg.size();
+    Value* total = ConstantInt::get(i64_ty, const_len);
+    for (size_t k = 0; k < argc; k++) {
+        auto tv = codegen(list->values[k]);
+        if (!tv) return TypedValue{};
+        if (tv.type == CType::PROMISE) tv = auto_await(tv);
+        if (tv.type == CType::STRING) owned.push_back(tv);
+        if (k >= used) continue;
+        Piece pc{};
+        switch (tv.type) {
+            case CType::STRING:
+                pc.src = coerce_to_type(*builder_, tv.val, ptr_ty);
+                pc.len = builder_->CreateCall(rt_.string_length_, {pc.src}, "fmt_len");
+                break;
+            case CType::INT:
+            case CType::FLOAT: {
+                auto* buf = entry_ir.CreateAlloca(ArrayType::get(LType::getInt8Ty(*context_), 32),
+                                                  nullptr, "fmt_num");
+                pc.src = buf;
+                pc.len = tv.type == CType::INT
+                    ? builder_->CreateCall(rt_.format_int_, {buf, coerce_to_type(*builder_, tv.val, i64_ty)}, "fmt_len")
+                    : builder_->CreateCall(rt_.format_float_,
+                          {buf, coerce_to_type(*builder_, tv.val, LType::getDoubleTy(*context_))}, "fmt_len");
+                break;
+            }
+            case CType::BOOL: {
+                auto* b = builder_->CreateICmpNE(tv.val, ConstantInt::get(tv.val->getType(), 0));
+                pc.src = builder_->CreateSelect(b, builder_->CreateGlobalStringPtr("true", "fmt_true"),
+                                                builder_->CreateGlobalStringPtr("false", "fmt_false"));
+                pc.len = builder_->CreateSelect(b, ConstantInt::get(i64_ty, 4), ConstantInt::get(i64_ty, 5));
+                break;
+            }
+            default:
+                report_error(list->values[k]->source_context,
+                             "type error: Std\\Format.format arguments must be String, Int, Float or Bool");
+                return TypedValue{};
+        }
+        total = builder_->CreateAdd(total, pc.len, "fmt_total");
+        pieces.push_back(pc);
+    }
+
+    auto* bytes = builder_->CreateAdd(total, ConstantInt::get(i64_ty, 1));
+    Value* result = builder_->CreateCall(rt_.string_alloc_len_, {bytes, total}, "fmt_str");
+    Value* cursor = result;
+    auto* i8_ty = LType::getInt8Ty(*context_);
+    auto copy = [&](Value* src, Value* len) {
+        builder_->CreateMemCpy(cursor, MaybeAlign(1), src, MaybeAlign(1), len);
+        cursor = builder_->CreateInBoundsGEP(i8_ty, cursor, len, "fmt_cur");
+    };
+    for (size_t k = 0; k < segments.size(); k++) {
+        if (!segments[k].empty())
+            copy(builder_->CreateGlobalStringPtr(segments[k], "fmt_seg"),
+                 ConstantInt::get(i64_ty, segments[k].size()));
+        if (k < pieces.size()) copy(pieces[k].src, pieces[k].len);
+    }
+    builder_->CreateStore(ConstantInt::get(i8_ty, 0), cursor);
+
+    // String arguments were only read; release anonymous temporaries the
+    // same way borrowed extern params are released.
+    for (auto& tv : owned) {
+        if (!tv.val || isa<Constant>(tv.val)) continue;
+        bool is_named = false;
+        for (auto& [k, v] : named_values_)
+            if (v.val == tv.val) { is_named = true; break; }
+        if (!is_named) emit_rc_dec(tv.val, CType::STRING);
+    }
+    return TypedValue{result, CType::STRING};
+}
+
 // ===== codegen_apply — main dispatcher =====
 
 TypedValue Codegen::codegen_apply(ApplyExpr* node) {
@@ -1350,6 +1498,10 @@ TypedValue Codegen::codegen_apply(ApplyExpr* node) {
         }
     }
 
+    // 1b. Std\Format.format with a literal template: expand at compile time
+    if (auto fmt = codegen_literal_format(fn_name, chain))
+        return *fmt;
+
     // 2. Evaluate all arguments
     auto eval = evaluate_apply_args(chain);
     auto& all_args = eval.all_args;
@@ -32,6 +32,21 @@ bool Codegen::codegen_pattern_value(PatternValue* pv, const TypedValue& scrutine
             auto mv = ConstantInt::get(LType::getInt64Ty(*context_), ie->value);
             auto cmp = builder_->CreateICmpEQ(scrutinee.val, mv);
             builder_->CreateCondBr(cmp, body_bb, next_bb);
+        } else if (an->get_type() == AST_STRING_EXPR) {
+            // Literal is pre-interned: an interned (or the same) scrutinee
+            // matches on pointer identity; anything else falls back to Eq.
+            auto lit_tv = codegen_string(static_cast<StringExpr*>(an));
+            Value* sv = scrutinee.val;
+            if (!sv->getType()->isPointerTy())
+                sv = builder_->CreateIntToPtr(sv, PointerType::get(*context_, 0));
+            auto* fn = builder_->GetInsertBlock()->getParent();
+            auto* cmp_bb = BasicBlock::Create(*context_, "case.streq", fn);
+            builder_->CreateCondBr(builder_->CreateICmpEQ(sv, lit_tv.val), body_bb, cmp_bb);
+            builder_->SetInsertPoint(cmp_bb);
+            auto* eq = builder_->CreateCall(rt_.string_eq_, {sv, lit_tv.val});
+            builder_->CreateCondBr(
+                builder_->CreateICmpNE(eq, ConstantInt::get(LType::getInt64Ty(*context_), 0)),
+                body_bb, next_bb);
         } else builder_->CreateBr(body_bb);
     } else builder_->CreateBr(body_bb);
     return false;
@@ -418,6 +418,51 @@ static std::string extractor_var_name(CollectionExtractorExpr* ext) {
     return "_";
 }
 
+// `[| f x for x = xs ]` where f is a closure the runtime can call as
+// fn(env, i64) -> i64: returns that closure (subtypes = {element result}) so
+// the comprehension can hand the whole loop to yona_rt_par_map. Floats and
+// unboxed ADT structs change the call ABI, so those keep the inline loop.
+TypedValue Codegen::parallel_map_closure(SeqGeneratorExpr* node, CType elem_type) {
+    auto* app = dynamic_cast<ApplyExpr*>(node->reducerExpr);
+    if (!app || app->args.size() != 1 || app->named_args) return {};
+    auto* nc = dynamic_cast<NameCall*>(app->call);
+    if (!nc) return {};
+    auto& arg = app->args[0];
+    AstNode* arg_node = std::holds_alternative<ExprNode*>(arg)
+        ? static_cast<AstNode*>(std::get<ExprNode*>(arg))
+        : static_cast<AstNode*>(std::get<ValueExpr*>(arg));
+    if (!arg_node || arg_node->get_type() != AST_IDENTIFIER_EXPR) return {};
+    std::string var_name = extractor_var_name(node->collectionExtractor);
+    const std::string& fn_name = nc->name->value;
+    if (static_cast<IdentifierExpr*>(arg_node)->name->value != var_name || fn_name == var_name)
+        return {};
+    if (effect_resume_names_.count(fn_name)) return {};
+    auto nv_it = named_values_.find(fn_name);
+    if (nv_it == named_values_.end() || nv_it->second.type != CType::FUNCTION ||
+        !nv_it->second.val || nv_it->second.subtypes.empty())
+        return {};
+
+    auto word_sized = [](CType t) {
+        return t == CType::INT || t == CType::STRING || t == CType::SYMBOL ||
+               t == CType::SEQ || t == CType::SET || t == CType::DICT;
+    };
+    CType ret = nv_it->second.subtypes[0];
+    if (!word_sized(elem_type) || !word_sized(ret)) return {};
+
+    Value* closure = nv_it->second.val;
+    if (auto* fn = dyn_cast<Function>(closure)) {
+        // Direct function pointer: needs an env-taking wrapper, and only
+        // when every parameter already travels as an i64 or pointer.
+        if (fn->arg_size() != 1) return {};
+        auto* param_ty = fn->getArg(0)->getType();
+        if (!param_ty->isPointerTy() && param_ty != LType::getInt64Ty(*context_)) return {};
+        closure = wrap_in_closure(fn, ret);
+    } else if (!closure->getType()->isPointerTy()) {
+        closure = builder_->CreateIntToPtr(closure, PointerType::get(*context_, 0));
+    }
+    return {closure, CType::FUNCTION, {ret}};
+}
+
 TypedValue Codegen::codegen_seq_generator(SeqGeneratorExpr* node) {
     set_debug_loc(node->source_context);
     auto* ext = static_cast<ValueCollectionExtractorExpr*>(node->collectionExtractor);
@@ -427,7 +472,8 @@ TypedValue Codegen::codegen_seq_generator(SeqGeneratorExpr* node) {
     }
 
     // Parallel comprehension: [| expr for var <- source |]
-    // Spawns each iteration as a task in a group, collects promises, awaits all.
+    // `f x` over a closure f runs as a chunked loop on the pool; any other
+    // body spawns its async calls as tasks in a group and awaits them all.
     if (node->is_parallel) {
         auto src = codegen(ext->collection);
         if (!src) return {};
@@ -437,6 +483,13 @@ TypedValue Codegen::codegen_seq_generator(SeqGeneratorExpr* node) {
         if (!src_ptr->getType()->isPointerTy())
             src_ptr = builder_->CreateIntToPtr(src_ptr, ptr_ty);
 
+        CType src_elem = (!src.subtypes.empty()) ? src.subtypes[0] : CType::INT;
+        if (auto closure = parallel_map_closure(node, src_elem)) {
+            auto* result = builder_->CreateCall(rt_.par_map_,
+                {closure.val, src_ptr, ConstantInt::get(i64_ty, 0)}, "par_result");
+            return {builder_->CreateBitCast(result, ptr_ty), CType::SEQ, closure.subtypes};
+        }
+
         auto* src_len = builder_->CreateCall(rt_.seq_length_, {src_ptr}, "par_src_len");
         auto* result = builder_->CreateCall(rt_.seq_alloc_, {src_len}, "par_result");
         auto* group = builder_->CreateCall(rt_.group_begin_, {}, "par_group");
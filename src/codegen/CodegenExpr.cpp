@@ -12,13 +12,16 @@
 #include <llvm/IR/InlineAsm.h>
 #include <llvm/IR/Intrinsics.h>
 #include <llvm/IR/Type.h>
+#include <llvm/TargetParser/Triple.h>
 #include <llvm/BinaryFormat/Dwarf.h>
 #include <iostream>
 
 namespace yona::compiler::codegen {
 
 // Constants — match runtime defines
-static constexpr int64_t ARENA_DEFAULT_SIZE = 4096;
+static constexpr int64_t GROUP_FRAME_HEADER = 256;
+// Grouped lets with at most this many aliases keep their group on the stack
+static constexpr size_t GROUP_FRAME_MAX_CHILDREN = 32;
 using namespace llvm;
 using LType = llvm::Type;
 
@@ -125,21 +128,73 @@ TypedValue Codegen::codegen_string(StringExpr* node) {
     //     i64 encoded_tag = RC_TYPE_STRING(6) | (len << 16) | (cls=-1 → 0 << 8),
     //     [N x i8] bytes (including trailing NUL) }
     // rc_inc/rc_dec both short-circuit on the sentinel.
+    //
+    // Short literals are pre-interned (runtime/intern.c): an extra leading
+    // i64 holds the FNV-1a hash, the tag carries RC_STRING_INTERNED, and the
+    // global is linkonce_odr under a content-derived name so every module
+    // shares one copy. emit_intern_ctor registers them with the runtime.
     const auto& s = node->value;
     const size_t len = s.size();
     auto* i64_ty = LType::getInt64Ty(*context_);
     auto* i8_ty = LType::getInt8Ty(*context_);
     auto* bytes_ty = ArrayType::get(i8_ty, len + 1);
+    constexpr int64_t RC_ARENA_SENTINEL = INT64_MAX;
+    constexpr int64_t RC_TYPE_STRING = 6;
+    constexpr int64_t RC_STRING_INTERNED = int64_t(1) << 15;
+    constexpr size_t INTERN_LITERAL_MAX = 64;
+    const bool interned = len <= INTERN_LITERAL_MAX;
+
+    std::string interned_name;
+    if (interned) {
+        static const char hex[] = "0123456789abcdef";
+        interned_name = "yona.istr.";
+        for (unsigned char c : s) {
+            interned_name += hex[c >> 4];
+            interned_name += hex[c & 15];
+        }
+        if (auto* gv = module_->getNamedGlobal(interned_name)) {
+            auto* struct_ty = gv->getValueType();
+            return {ConstantExpr::getInBoundsGetElementPtr(struct_ty, gv,
+                        ArrayRef<Constant*>{ConstantInt::get(LType::getInt32Ty(*context_), 0),
+                                            ConstantInt::get(LType::getInt32Ty(*context_), 3)}),
+                    CType::STRING};
+        }
+    }
+
     std::vector<Constant*> byte_consts;
     byte_consts.reserve(len + 1);
     for (size_t i = 0; i < len; i++)
         byte_consts.push_back(ConstantInt::get(i8_ty, (uint8_t)s[i]));
     byte_consts.push_back(ConstantInt::get(i8_ty, 0));
     auto* bytes_init = ConstantArray::get(bytes_ty, byte_consts);
-    auto* struct_ty = StructType::get(*context_, {i64_ty, i64_ty, bytes_ty});
-    constexpr int64_t RC_ARENA_SENTINEL = INT64_MAX;
-    constexpr int64_t RC_TYPE_STRING = 6;
     int64_t encoded_tag = RC_TYPE_STRING | ((int64_t)len << 16);
+
+    if (interned) {
+        // Same hash as Hash_String and yona_intern_bytes: FNV-1a over all
+        // len bytes, embedded NULs included
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : s) hash = (hash ^ c) * 1099511628211ULL;
+        auto* struct_ty = StructType::get(*context_, {i64_ty, i64_ty, i64_ty, bytes_ty});
+        auto* init = ConstantStruct::get(struct_ty, {
+            ConstantInt::get(i64_ty, (int64_t)hash),
+            ConstantInt::get(i64_ty, RC_ARENA_SENTINEL),
+            ConstantInt::get(i64_ty, encoded_tag | RC_STRING_INTERNED),
+            bytes_init,
+        });
+        // Writable: the runtime may clear RC_STRING_INTERNED on registration.
+        auto* gv = new GlobalVariable(*module_, struct_ty, /*isConstant=*/false,
+                                      GlobalValue::LinkOnceODRLinkage, init, interned_name);
+        gv->setVisibility(GlobalValue::HiddenVisibility);
+        if (!Triple(module_->getTargetTriple()).isOSBinFormatMachO())
+            gv->setComdat(module_->getOrInsertComdat(interned_name));
+        auto* i32_ty = LType::getInt32Ty(*context_);
+        auto* bytes_ptr = ConstantExpr::getInBoundsGetElementPtr(struct_ty, gv,
+            ArrayRef<Constant*>{ConstantInt::get(i32_ty, 0), ConstantInt::get(i32_ty, 3)});
+        interned_literals_.push_back(bytes_ptr);
+        return {bytes_ptr, CType::STRING};
+    }
+
+    auto* struct_ty = StructType::get(*context_, {i64_ty, i64_ty, bytes_ty});
     auto* init = ConstantStruct::get(struct_ty, {
         ConstantInt::get(i64_ty, RC_ARENA_SENTINEL),
         ConstantInt::get(i64_ty, encoded_tag),
@@ -774,11 +829,10 @@ std::unordered_set<std::string> Codegen::analyze_let_escaping(LetExpr* node) {
 }
 
 // Set up arena allocator for non-escaping bindings (if enough qualify).
+// Inside a structured task the runtime hands back the task's own arena.
 llvm::Value* Codegen::setup_let_arena(const std::unordered_set<std::string>& non_escaping) {
     if (non_escaping.size() < 2) return nullptr;
-    auto i64_ty = LType::getInt64Ty(*context_);
-    return builder_->CreateCall(rt_.arena_create_,
-        {ConstantInt::get(i64_ty, ARENA_DEFAULT_SIZE)}, "arena");
+    return builder_->CreateCall(rt_.let_arena_begin_, {}, "arena");
 }
 
 // `spawn` is tagged IO in Task.yonai so use-sites can auto-await, but the
@@ -965,7 +1019,7 @@ void Codegen::cleanup_let_scope(const std::vector<TypedValue>& scope_bindings,
         }
     }
     if (arena && destroy_arena_at_end)
-        builder_->CreateCall(rt_.arena_destroy_, {arena});
+        builder_->CreateCall(rt_.let_arena_end_, {arena});
 }
 
 TypedValue Codegen::codegen_let(LetExpr* node) {
@@ -975,16 +1029,16 @@ TypedValue Codegen::codegen_let(LetExpr* node) {
     auto non_escaping = analyze_let_escaping(node);
 
     const bool has_group = node->aliases.size() > 1;
-    // 2. Arena: task groups always get a parent-thread bump arena (freed with
-    //    the group / on raise unwind). Other multi-binding lets use escape-based
-    //    arena only when enough bindings qualify.
+    // 2. Arena: task groups always get a parent-thread bump arena (released
+    //    with the group / on raise unwind). Other multi-binding lets use
+    //    escape-based arena only when enough bindings qualify. Either way a
+    //    let running inside a structured task shares the task's arena, which
+    //    the scheduler resets when the task completes.
     auto saved_arena = current_arena_;
     llvm::Value* arena = nullptr;
     const bool group_arena_lifecycle = has_group;
     if (has_group) {
-        auto i64_ty = LType::getInt64Ty(*context_);
-        arena = builder_->CreateCall(rt_.arena_create_,
-            {ConstantInt::get(i64_ty, ARENA_DEFAULT_SIZE)}, "let_group_arena");
+        arena = builder_->CreateCall(rt_.let_arena_begin_, {}, "let_group_arena");
     } else {
         arena = setup_let_arena(non_escaping);
     }
@@ -992,7 +1046,26 @@ TypedValue Codegen::codegen_let(LetExpr* node) {
     // 3. Structured concurrency: task group + arena attach + TLS bind for raise
     auto saved_group = current_group_;
     if (has_group) {
-        current_group_ = builder_->CreateCall(rt_.group_begin_, {}, "let_group");
+        // Each alias spawns at most one direct child, so the child count is
+        // known here: small groups live in a frame in the entry block (one
+        // per let, reused across loop iterations); anything spawned past it
+        // spills to the heap inside the runtime. TCO functions keep the heap
+        // group, as they skip the Perceus frame for the same reason.
+        const size_t n_children = node->aliases.size();
+        if (n_children <= GROUP_FRAME_MAX_CHILDREN && tco_fn_name_.empty()) {
+            auto i64_ty = LType::getInt64Ty(*context_);
+            auto* fn_parent = builder_->GetInsertBlock()->getParent();
+            IRBuilder<> entry_ir(&fn_parent->getEntryBlock(), fn_parent->getEntryBlock().begin());
+            auto* frame = entry_ir.CreateAlloca(
+                ArrayType::get(LType::getInt8Ty(*context_),
+                               GROUP_FRAME_HEADER + n_children * sizeof(int64_t)),
+                nullptr, "let_group_frame");
+            frame->setAlignment(Align(16));
+            current_group_ = builder_->CreateCall(rt_.group_begin_in_,
+                {frame, ConstantInt::get(i64_ty, n_children)}, "let_group");
+        } else {
+            current_group_ = builder_->CreateCall(rt_.group_begin_, {}, "let_group");
+        }
         builder_->CreateCall(rt_.group_attach_arena_, {current_group_, arena});
         builder_->CreateCall(rt_.group_arena_bind_push_, {current_group_});
     }
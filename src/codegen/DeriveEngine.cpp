@@ -5,6 +5,8 @@
 /// write the generator function and add one register_strategy() call.
 
 #include "DeriveEngine.h"
+#include <algorithm>
+#include <cstdint>
 #include <sstream>
 
 namespace yona::compiler::codegen {
@@ -40,7 +42,7 @@ std::vector<std::string> DeriveEngine::all_derivable_traits() {
 
 // ===== Strategy: Show =====
 
-static std::string derive_show(const DeriveAdtInfo& adt) {
+static std::string derive_show(const DeriveAdtInfo& adt, const std::string&) {
     std::ostringstream os;
     os << "show x = case x of\n";
 
@@ -68,7 +70,7 @@ static auto _reg_show = DeriveEngine::register_strategy("Show", {"show"}, derive
 
 // ===== Strategy: Eq =====
 
-static std::string derive_eq(const DeriveAdtInfo& adt) {
+static std::string derive_eq(const DeriveAdtInfo& adt, const std::string&) {
     std::ostringstream os;
     os << "eq _a _b = case _a of\n";
 
@@ -104,7 +106,7 @@ static auto _reg_eq = DeriveEngine::register_strategy("Eq", {"eq"}, derive_eq);
 
 // ===== Strategy: Ord =====
 
-static std::string derive_ord(const DeriveAdtInfo& adt) {
+static std::string derive_ord(const DeriveAdtInfo& adt, const std::string&) {
     std::ostringstream os;
 
     if (adt.constructors.size() == 1) {
@@ -169,7 +171,7 @@ static auto _reg_ord = DeriveEngine::register_strategy("Ord", {"compare"}, deriv
 
 // ===== Strategy: Hash =====
 
-static std::string derive_hash(const DeriveAdtInfo& adt) {
+static std::string derive_hash(const DeriveAdtInfo& adt, const std::string&) {
     std::ostringstream os;
     os << "hash x = case x of\n";
 
@@ -197,4 +199,277 @@ static std::string derive_hash(const DeriveAdtInfo& adt) {
 
 static auto _reg_hash = DeriveEngine::register_strategy("Hash", {"hash"}, derive_hash);
 
+// ===== Strategy: Json =====
+//
+// JSON shape: a single constructor encodes as its fields, an object for
+// named fields ({"name": …, "age": …}) or an array for positional ones. A
+// multi-constructor type tags each value with its constructor: "Red" when
+// nullary, {"Circle": [1.5]} otherwise.
+//
+// toJson is one Std\Format.format call whose template is the constant JSON
+// text, so codegen_literal_format turns it into a single sized allocation.
+// Int and Bool fields are written straight into that buffer; other fields
+// go through their own toJson.
+//
+// fromJson takes a prototype value (trait methods dispatch on their first
+// argument) and the JSON text. It opens one Std\Json reader for the whole
+// document and hands it to readJson, which nested fields share. readJson
+// calls `enter` once per constructor, which walks the object and matches
+// keys through a perfect hash computed here. Each field is then decoded in
+// place: `seek` moves the reader to it and the field type's readJson reads
+// it, with the prototype's field as the fallback for missing keys.
+
+/// Must match yona_json_key_hash in src/runtime/json.c.
+static uint64_t json_key_hash(const std::string& key, uint64_t seed) {
+    uint64_t h = 14695981039346656037ULL ^ seed;
+    for (unsigned char c : key) h = (h ^ c) * 1099511628211ULL;
+    return h ^ (h >> 32);
+}
+
+/// Std\Json.enter spec: "#n" for positional fields, "seed:m:k0,k1,…" for
+/// named ones, where seed and the power-of-two table size m put every key
+/// in its own slot.
+static std::string json_fields_spec(const DeriveCtorInfo& ctor) {
+    if (ctor.field_names.empty()) return "#" + std::to_string(ctor.arity);
+    const auto& keys = ctor.field_names;
+    uint64_t m = 1;
+    while (m < keys.size()) m <<= 1;
+    for (;; m <<= 1) {
+        for (uint64_t seed = 0; seed < 4096; seed++) {
+            std::vector<bool> used(m, false);
+            bool ok = true;
+            for (auto& k : keys) {
+                uint64_t slot = json_key_hash(k, seed) & (m - 1);
+                if (used[slot]) { ok = false; break; }
+                used[slot] = true;
+            }
+            if (!ok) continue;
+            std::string spec = std::to_string(seed) + ":" + std::to_string(m) + ":";
+            for (size_t i = 0; i < keys.size(); i++) spec += (i ? "," : "") + keys[i];
+            return spec;
+        }
+    }
+}
+
+/// Escape JSON template text for a Yona string literal. Braces are escaped
+/// so they are not read as interpolation; "{}" placeholders are kept.
+static std::string json_template_literal(const std::string& tmpl) {
+    std::string out = "\"";
+    for (size_t i = 0; i < tmpl.size(); i++) {
+        char c = tmpl[i];
+        if (c == '{' && i + 1 < tmpl.size() && tmpl[i + 1] == '}') { out += "{}"; i++; }
+        else if (c == '{' || c == '}' || c == '"' || c == '\\') { out += '\\'; out += c; }
+        else out += c;
+    }
+    return out + "\"";
+}
+
+/// Zero value of a primitive field type, used as the fromJson prototype
+/// when the JSON names a different constructor than the prototype.
+static std::string json_zero_value(const DeriveAdtInfo& adt, const std::string& type_name) {
+    if (type_name == "Int") return "0";
+    if (type_name == "Float") return "0.0";
+    if (type_name == "String") return "\"\"";
+    if (type_name == "Bool") return "false";
+    if (type_name == adt.type_name) return "_d";
+    return "";
+}
+
+static std::string derive_json_encode(const DeriveAdtInfo& adt) {
+    bool tagged = adt.constructors.size() > 1;
+    std::ostringstream os;
+    os << "toJson _v = import format from Std\\Format in case _v of\n";
+    for (auto& ctor : adt.constructors) {
+        os << "    " << ctor.name;
+        for (int i = 0; i < ctor.arity; i++) os << " _f" << i;
+        os << " -> ";
+        if (ctor.arity == 0) {
+            os << json_template_literal("\"" + ctor.name + "\"") << "\n";
+            continue;
+        }
+        bool named = !ctor.field_names.empty();
+        std::string tmpl = named ? "{" : "[";
+        for (int i = 0; i < ctor.arity; i++) {
+            if (i > 0) tmpl += ",";
+            if (named) tmpl += "\"" + ctor.field_names[i] + "\":";
+            tmpl += "{}";
+        }
+        tmpl += named ? "}" : "]";
+        if (tagged) tmpl = "{\"" + ctor.name + "\":" + tmpl + "}";
+        os << "format " << json_template_literal(tmpl) << " [";
+        for (int i = 0; i < ctor.arity; i++) {
+            if (i > 0) os << ", ";
+            auto& ft = ctor.field_type_names[i];
+            if (ft == "Int" || ft == "Bool") os << "_f" << i;
+            else os << "toJson _f" << i;
+        }
+        os << "]\n";
+    }
+    os << "end\n";
+    return os.str();
+}
+
+/// `Ctor (readJson w0 (seek 0 _o _r)) …` with witnesses from `witness(i)`.
+template <typename W>
+static std::string json_build(const DeriveCtorInfo& ctor, W witness) {
+    std::string out = ctor.name;
+    for (int i = 0; i < ctor.arity; i++)
+        out += " (readJson " + witness(i) + " (seek " + std::to_string(i) + " _o _r))";
+    return out;
+}
+
+static std::string derive_json_from(const DeriveAdtInfo& adt) {
+    if (adt.constructors.size() == 1 && adt.constructors[0].arity == 0) return "fromJson _d _s = _d\n";
+    std::ostringstream os;
+    os << "fromJson _d _s = import reader, finish from Std\\Json in do\n";
+    os << "    _r = reader _s\n";
+    os << "    _v = readJson _d _r\n";
+    os << "    finish _r\n";
+    os << "    _v\n";
+    os << "end\n";
+    return os.str();
+}
+
+static std::string derive_json_read(const DeriveAdtInfo& adt) {
+    std::ostringstream os;
+    auto from_proto = [](int i) { return "_x" + std::to_string(i); };
+    auto proto_pattern = [](const DeriveCtorInfo& ctor) {
+        std::string p = ctor.name;
+        for (int i = 0; i < ctor.arity; i++) p += " _x" + std::to_string(i);
+        return p;
+    };
+
+    if (adt.constructors.size() == 1) {
+        auto& ctor = adt.constructors[0];
+        if (ctor.arity == 0) return "readJson _d _r = _d\n";
+        os << "readJson _d _r = import enter, seek from Std\\Json in case _d of\n";
+        os << "    " << proto_pattern(ctor) << " -> let _o = enter \"" << json_fields_spec(ctor)
+           << "\" _r in " << json_build(ctor, from_proto) << "\n";
+        os << "end\n";
+        return os.str();
+    }
+
+    os << "readJson _d _r = import variant, enter, seek from Std\\Json in case variant _r of\n";
+    for (auto& ctor : adt.constructors) {
+        os << "    \"" << ctor.name << "\" -> ";
+        if (ctor.arity == 0) {
+            os << ctor.name << "\n";
+            continue;
+        }
+        os << "let _o = enter \"" << json_fields_spec(ctor) << "\" _r in case _d of\n";
+        os << "        " << proto_pattern(ctor) << " -> " << json_build(ctor, from_proto) << "\n";
+        // Another constructor as prototype: primitives start from zero,
+        // fields of other types have nothing to decode against.
+        bool zero_ok = true;
+        for (auto& ft : ctor.field_type_names)
+            if (json_zero_value(adt, ft).empty()) zero_ok = false;
+        os << "        _ -> ";
+        if (zero_ok)
+            os << json_build(ctor, [&](int i) { return json_zero_value(adt, ctor.field_type_names[i]); });
+        else
+            os << "_d";
+        os << "\n    end\n";
+    }
+    os << "    _ -> _d\n";
+    os << "end\n";
+    return os.str();
+}
+
+static std::string derive_json(const DeriveAdtInfo& adt, const std::string& method) {
+    if (method == "toJson") return derive_json_encode(adt);
+    if (method == "fromJson") return derive_json_from(adt);
+    return derive_json_read(adt);
+}
+
+static auto _reg_json = DeriveEngine::register_strategy("Json", {"toJson", "fromJson", "readJson"}, derive_json);
+
+// ===== Strategy: Binary =====
+//
+// toBinary hands the whole value to Std\Binary.encodeAdt, which walks it
+// using the runtime's own heap masks. The spec string adds what the
+// declaration knows: per constructor "arity/heap/raw", the masks of fields
+// declared with a heap type and with a plain one. Fields of type parameters
+// and other ADTs keep the bit the value carries. A type with only nullary
+// constructors is a plain tag and gets an empty spec.
+//
+// fromBinary takes a prototype (for dispatch) and the bytes. It opens the
+// buffer once as a message (validated in one pass), switches on the stored
+// constructor tag and reads each field from the message with the accessor
+// for its declared type; an unknown tag returns the prototype.
+
+static bool binary_heap_field(const DeriveAdtInfo& adt, const std::string& type_name) {
+    return type_name == "String" || type_name == "Seq" || type_name == "Set" || type_name == "Dict" ||
+           type_name == "IntArray" || type_name == "FloatArray" || type_name == "ByteArray" ||
+           type_name == adt.type_name;
+}
+
+static bool binary_raw_field(const std::string& type_name) {
+    return type_name == "Int" || type_name == "Float" || type_name == "Bool" || type_name == "Symbol";
+}
+
+/// Std\Binary accessor that reads a field of the given declared type.
+static std::string binary_field_reader(const std::string& type_name) {
+    if (type_name == "Int" || type_name == "Symbol") return "fieldInt";
+    if (type_name == "Float" || type_name == "Bool" || type_name == "String" || type_name == "Seq" ||
+        type_name == "Set" || type_name == "Dict" || type_name == "IntArray" ||
+        type_name == "FloatArray" || type_name == "ByteArray")
+        return "field" + type_name;
+    return "field";
+}
+
+static std::string derive_binary_encode(const DeriveAdtInfo& adt) {
+    bool all_nullary = true;
+    for (auto& ctor : adt.constructors)
+        if (ctor.arity > 0) all_nullary = false;
+    std::string spec;
+    if (!all_nullary) {
+        for (size_t c = 0; c < adt.constructors.size(); c++) {
+            auto& ctor = adt.constructors[c];
+            uint64_t heap = 0, raw = 0;
+            for (int i = 0; i < ctor.arity && i < 64; i++) {
+                auto& ft = ctor.field_type_names[i];
+                if (binary_heap_field(adt, ft)) heap |= uint64_t(1) << i;
+                else if (binary_raw_field(ft)) raw |= uint64_t(1) << i;
+            }
+            if (c > 0) spec += ",";
+            spec += std::to_string(ctor.arity) + "/" + std::to_string(static_cast<int64_t>(heap)) + "/" +
+                    std::to_string(static_cast<int64_t>(raw));
+        }
+    }
+    return "toBinary _v = import encodeAdt from Std\\Binary in encodeAdt \"" + spec + "\" _v\n";
+}
+
+static std::string derive_binary_decode(const DeriveAdtInfo& adt) {
+    std::vector<std::string> readers = {"open", "close", "tag"};
+    for (auto& ctor : adt.constructors)
+        for (auto& ft : ctor.field_type_names) {
+            auto r = binary_field_reader(ft);
+            if (std::find(readers.begin(), readers.end(), r) == readers.end()) readers.push_back(r);
+        }
+    std::ostringstream os;
+    os << "fromBinary _d _b = import ";
+    for (size_t i = 0; i < readers.size(); i++) os << (i ? ", " : "") << readers[i];
+    os << " from Std\\Binary in do\n";
+    os << "    _m = open _b\n";
+    os << "    _v = case tag _m of\n";
+    for (auto& ctor : adt.constructors) {
+        os << "        " << ctor.tag << " -> " << ctor.name;
+        for (int i = 0; i < ctor.arity; i++)
+            os << " (" << binary_field_reader(ctor.field_type_names[i]) << " " << i << " _m)";
+        os << "\n";
+    }
+    os << "        _ -> _d\n";
+    os << "    end\n";
+    os << "    close _m\n";
+    os << "    _v\n";
+    os << "end\n";
+    return os.str();
+}
+
+static std::string derive_binary(const DeriveAdtInfo& adt, const std::string& method) {
+    return method == "toBinary" ? derive_binary_encode(adt) : derive_binary_decode(adt);
+}
+
+static auto _reg_binary = DeriveEngine::register_strategy("Binary", {"toBinary", "fromBinary"}, derive_binary);
+
 } // namespace yona::compiler::codegen
@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 #include <stdint.h>
 #include <inttypes.h>
 #include <math.h>
@@ -469,21 +470,38 @@ typedef struct yona_arena {
     char* cursor;
     char* end;
     struct yona_arena* next;  /* overflow chain */
+    int64_t blocks;           /* head only: blocks in the chain */
 } yona_arena_t;
 
+/* Recycled blocks: destroy hands default-size blocks to a per-thread cache
+ * that create draws from, so a scope's arena costs a pointer swap once the
+ * thread is warm instead of a malloc/free pair. */
+#define YONA_ARENA_CACHE_MAX 32
+static _Thread_local yona_arena_t* yona_arena_cache = NULL;
+static _Thread_local int yona_arena_cached = 0;
+
 void* yona_rt_arena_create(int64_t size) {
     yona_alloc_report_maybe_register();
     if (size <= 0) size = YONA_ARENA_DEFAULT_SIZE;
-    yona_arena_t* arena = (yona_arena_t*)malloc(sizeof(yona_arena_t) + size);
-    arena->base = (char*)(arena + 1);
+    yona_arena_t* arena;
+    if (size == YONA_ARENA_DEFAULT_SIZE && yona_arena_cache) {
+        arena = yona_arena_cache;
+        yona_arena_cache = arena->next;
+        yona_arena_cached--;
+    } else {
+        arena = (yona_arena_t*)malloc(sizeof(yona_arena_t) + size);
+        arena->base = (char*)(arena + 1);
+        arena->end = arena->base + size;
+    }
     arena->cursor = arena->base;
-    arena->end = arena->base + size;
     arena->next = NULL;
+    arena->blocks = 1;
     return arena;
 }
 
 void* yona_rt_arena_alloc(void* arena_ptr, int64_t type_tag, int64_t payload_bytes) {
-    yona_arena_t* arena = (yona_arena_t*)arena_ptr;
+    yona_arena_t* head = (yona_arena_t*)arena_ptr;
+    yona_arena_t* arena = head;
     size_t total = RC_HEADER_SIZE * sizeof(int64_t) + (size_t)payload_bytes;
     /* Align to 8 bytes */
     total = (total + 7) & ~7;
@@ -494,6 +512,7 @@ void* yona_rt_arena_alloc(void* arena_ptr, int64_t type_tag, int64_t payload_byt
             /* Allocate overflow block (at least total or default size) */
             int64_t new_size = total > YONA_ARENA_DEFAULT_SIZE ? (int64_t)total * 2 : YONA_ARENA_DEFAULT_SIZE;
             arena->next = (yona_arena_t*)yona_rt_arena_create(new_size);
+            head->blocks++;
         }
         arena = arena->next;
     }
@@ -509,11 +528,63 @@ void yona_rt_arena_destroy(void* arena_ptr) {
     yona_arena_t* arena = (yona_arena_t*)arena_ptr;
     while (arena) {
         yona_arena_t* next = arena->next;
-        free(arena);
+        if (arena->end - arena->base == YONA_ARENA_DEFAULT_SIZE &&
+            yona_arena_cached < YONA_ARENA_CACHE_MAX) {
+            arena->next = yona_arena_cache;
+            yona_arena_cache = arena;
+            yona_arena_cached++;
+        } else {
+            free(arena);
+        }
         arena = next;
     }
 }
 
+/* Task-local arenas. A structured task (a group child or a par chunk) gets
+ * one arena, created by its first let scope and released when the task
+ * completes, normally or by raise. Its let scopes bump-allocate from it and
+ * skip their own setup and teardown. Once the arena has grown past
+ * YONA_TASK_ARENA_BLOCKS, scopes get private arenas again so a long-running
+ * task does not pin everything it ever allocated. The scheduler brackets
+ * each task with task_arena_enter/task_arena_leave and parks the state with
+ * the task's fiber. */
+#define YONA_TASK_ARENA_BLOCKS 16
+
+typedef struct {
+    int on;                   /* running a structured task */
+    yona_arena_t* arena;      /* its arena, NULL until first use */
+} yona_task_arena_t;
+
+static _Thread_local yona_task_arena_t yona_task_arena = { 0, NULL };
+
+static yona_task_arena_t task_arena_enter(int structured) {
+    yona_task_arena_t outer = yona_task_arena;
+    yona_task_arena.on = structured;
+    yona_task_arena.arena = NULL;
+    return outer;
+}
+
+static void task_arena_leave(yona_task_arena_t outer) {
+    if (yona_task_arena.arena) yona_rt_arena_destroy(yona_task_arena.arena);
+    yona_task_arena = outer;
+}
+
+/* Arena for a let scope: the task arena when there is one with room,
+ * otherwise a private (recycled) one. Pair with yona_rt_let_arena_end. */
+void* yona_rt_let_arena_begin(void) {
+    if (yona_task_arena.on) {
+        if (!yona_task_arena.arena)
+            yona_task_arena.arena = (yona_arena_t*)yona_rt_arena_create(0);
+        if (yona_task_arena.arena->blocks <= YONA_TASK_ARENA_BLOCKS)
+            return yona_task_arena.arena;
+    }
+    return yona_rt_arena_create(0);
+}
+
+void yona_rt_let_arena_end(void* arena) {
+    if (arena && arena != (void*)yona_task_arena.arena) yona_rt_arena_destroy(arena);
+}
+
 #define RC_TYPE_BOX     7
 #define RC_TYPE_BYTE_ARRAY   8
 /* ===== Persistent Seq ===== */
@@ -987,10 +1058,17 @@ int64_t yona_rt_string_length_fast(const char* str) {
     if (__builtin_expect(rc > 0 && rc < 1000000, 1)) {
         size_t len = DECODE_STRING_LEN(header[1]);
         if (__builtin_expect(len > 0, 1)) return (int64_t)len;
+    } else if (rc == RC_ARENA_SENTINEL && DECODE_TAG(header[1]) == RC_TYPE_STRING) {
+        /* Compile-time string literals carry their length in the tag too */
+        size_t len = DECODE_STRING_LEN(header[1]);
+        if (len > 0) return (int64_t)len;
     }
     return (int64_t)strlen(str);
 }
 
+/* Interned strings: pointer-equality Eq, precomputed Hash */
+#include "runtime/intern.c"
+
 
 void yona_rt_print_int(int64_t value) {
     printf("%" PRId64, value);
@@ -1605,21 +1683,46 @@ double yona_Std_Math__cos(double x) { return cos(x); }
 
 /* Std\String — pure string operations, no I/O */
 
+#include "runtime/string_simd.c"
+#include "runtime/numconv.c"
+
+/* Number text written straight into an exactly sized RC string */
+static const char* int_to_rc_string(int64_t v) {
+    uint64_t u = v < 0 ? (uint64_t)0 - (uint64_t)v : (uint64_t)v;
+    size_t len = (size_t)yona_dec_digits(u) + (v < 0);
+    char* r = (char*)yona_rt_rc_alloc_string_len(len + 1, len);
+    if (v < 0) r[0] = '-';
+    yona_u64_write_back(r + len, u);
+    r[len] = '\0';
+    return r;
+}
+
+static const char* float_to_rc_string(double v, size_t (*fmt)(char*, double)) {
+    char buf[32];
+    size_t len = fmt(buf, v);
+    char* r = (char*)yona_rt_rc_alloc_string_len(len + 1, len);
+    memcpy(r, buf, len);
+    r[len] = '\0';
+    return r;
+}
+
 int64_t yona_Std_String__length(const char* s) {
     return yona_rt_string_length_fast(s);
 }
 
 const char* yona_Std_String__toUpperCase(const char* s) {
-    size_t len = strlen(s);
-    char* r = (char*)rc_alloc(RC_TYPE_STRING, len + 1);
-    for (size_t i = 0; i <= len; i++) r[i] = (char)toupper((unsigned char)s[i]);
+    size_t len = (size_t)yona_rt_string_length_fast(s);
+    char* r = (char*)yona_rt_rc_alloc_string_len(len + 1, len);
+    yona_str_case_ascii(r, s, len, 1);
+    r[len] = '\0';
     return r;
 }
 
 const char* yona_Std_String__toLowerCase(const char* s) {
-    size_t len = strlen(s);
-    char* r = (char*)rc_alloc(RC_TYPE_STRING, len + 1);
-    for (size_t i = 0; i <= len; i++) r[i] = (char)tolower((unsigned char)s[i]);
+    size_t len = (size_t)yona_rt_string_length_fast(s);
+    char* r = (char*)yona_rt_rc_alloc_string_len(len + 1, len);
+    yona_str_case_ascii(r, s, len, 0);
+    r[len] = '\0';
     return r;
 }
 
@@ -1636,24 +1739,28 @@ const char* yona_Std_String__trim(const char* s) {
 }
 
 int64_t yona_Std_String__indexOf(const char* needle, const char* haystack) {
-    const char* p = strstr(haystack, needle);
+    const char* p = yona_str_find(haystack, (size_t)yona_rt_string_length_fast(haystack),
+                                  needle, (size_t)yona_rt_string_length_fast(needle));
     return p ? (int64_t)(p - haystack) : -1;
 }
 
 int64_t yona_Std_String__contains(const char* needle, const char* haystack) {
-    return strstr(haystack, needle) != NULL;
+    return yona_str_find(haystack, (size_t)yona_rt_string_length_fast(haystack),
+                         needle, (size_t)yona_rt_string_length_fast(needle)) != NULL;
 }
 
 int64_t yona_Std_String__startsWith(const char* prefix, const char* s) {
-    size_t plen = strlen(prefix);
-    return strncmp(s, prefix, plen) == 0;
+    size_t plen = (size_t)yona_rt_string_length_fast(prefix);
+    size_t slen = (size_t)yona_rt_string_length_fast(s);
+    if (plen > slen) return 0;
+    return memcmp(s, prefix, plen) == 0;
 }
 
 int64_t yona_Std_String__endsWith(const char* suffix, const char* s) {
-    size_t slen = strlen(s);
-    size_t xlen = strlen(suffix);
+    size_t slen = (size_t)yona_rt_string_length_fast(s);
+    size_t xlen = (size_t)yona_rt_string_length_fast(suffix);
     if (xlen > slen) return 0;
-    return strcmp(s + slen - xlen, suffix) == 0;
+    return memcmp(s + slen - xlen, suffix, xlen) == 0;
 }
 
 const char* yona_Std_String__substring(const char* s, int64_t start, int64_t len) {
@@ -1668,54 +1775,56 @@ const char* yona_Std_String__substring(const char* s, int64_t start, int64_t len
 }
 
 const char* yona_Std_String__replace(const char* old, const char* new_s, const char* s) {
-    size_t olen = strlen(old);
-    size_t nlen = strlen(new_s);
-    size_t slen = strlen(s);
+    size_t olen = (size_t)yona_rt_string_length_fast(old);
+    size_t nlen = (size_t)yona_rt_string_length_fast(new_s);
+    size_t slen = (size_t)yona_rt_string_length_fast(s);
+    const char* end = s + slen;
     if (olen == 0) {
-        size_t l = strlen(s);
-        char* r = (char*)rc_alloc(RC_TYPE_STRING, l + 1);
-        memcpy(r, s, l + 1);
+        char* r = (char*)yona_rt_rc_alloc_string_len(slen + 1, slen);
+        memcpy(r, s, slen + 1);
         return r;
     }
     /* Count occurrences */
     size_t count = 0;
     const char* p = s;
-    while ((p = strstr(p, old)) != NULL) { count++; p += olen; }
-    /* Build result */
-    size_t rlen = slen + count * (nlen - olen);
-    char* r = (char*)rc_alloc(RC_TYPE_STRING, rlen + 1);
+    while ((p = yona_str_find(p, (size_t)(end - p), old, olen)) != NULL) { count++; p += olen; }
+    /* Build result: copy the gaps between matches in bulk */
+    size_t rlen = slen - count * olen + count * nlen;
+    char* r = (char*)yona_rt_rc_alloc_string_len(rlen + 1, rlen);
     char* w = r;
     p = s;
-    while (*p) {
-        if (strncmp(p, old, olen) == 0) {
-            memcpy(w, new_s, nlen);
-            w += nlen;
-            p += olen;
-        } else {
-            *w++ = *p++;
-        }
+    for (size_t k = 0; k < count; k++) {
+        const char* m = yona_str_find(p, (size_t)(end - p), old, olen);
+        memcpy(w, p, (size_t)(m - p));
+        w += m - p;
+        memcpy(w, new_s, nlen);
+        w += nlen;
+        p = m + olen;
     }
+    memcpy(w, p, (size_t)(end - p));
+    w += end - p;
     *w = '\0';
     return r;
 }
 
 /* split returns an Iterator that yields substrings on demand */
-typedef struct { const char* str; const char* pos; const char* delim; size_t dlen; int done; } split_iter_state_t;
+typedef struct { const char* str; const char* pos; const char* end; const char* delim; size_t dlen; int done; } split_iter_state_t;
 
 static int64_t split_iter_next(int64_t* env) {
     split_iter_state_t* st = (split_iter_state_t*)(intptr_t)env[5];
     if (st->done) return (int64_t)(intptr_t)make_none();
-    const char* next = st->dlen > 0 ? strstr(st->pos, st->delim) : NULL;
+    const char* next = st->dlen > 0
+        ? yona_str_find(st->pos, (size_t)(st->end - st->pos), st->delim, st->dlen) : NULL;
     size_t len;
     if (st->dlen == 0) {
-        if (*st->pos == '\0') {
+        if (st->pos >= st->end) {
             st->done = 1;
             return (int64_t)(intptr_t)make_none();
         }
         len = 1;
         next = NULL;
     } else {
-        len = next ? (size_t)(next - st->pos) : strlen(st->pos);
+        len = next ? (size_t)(next - st->pos) : (size_t)(st->end - st->pos);
     }
     extern void* yona_rt_rc_alloc_string_len(size_t bytes, size_t str_len);
     char* part = (char*)yona_rt_rc_alloc_string_len(len + 1, len);
@@ -1723,14 +1832,14 @@ static int64_t split_iter_next(int64_t* env) {
     if (next) st->pos = next + st->dlen;
     else if (st->dlen == 0) st->pos += 1;
     else st->done = 1;
-    if (st->dlen == 0 && *st->pos == '\0') st->done = 1;
+    if (st->dlen == 0 && st->pos >= st->end) st->done = 1;
     return (int64_t)(intptr_t)make_some((int64_t)(intptr_t)part, 1);
 }
 
-int64_t yona_Std_String__split(const char* delim, const char* s) {
+static int64_t split_iter_create(const char* delim, size_t dlen, const char* s) {
     split_iter_state_t* st = (split_iter_state_t*)malloc(sizeof(split_iter_state_t));
-    st->str = s; st->pos = s; st->delim = delim;
-    st->dlen = strlen(delim); st->done = 0;
+    st->str = s; st->pos = s; st->end = s + yona_rt_string_length_fast(s);
+    st->delim = delim; st->dlen = dlen; st->done = 0;
     extern void* yona_rt_closure_create(void* fn, int64_t ret, int64_t arity, int64_t caps);
     extern void yona_rt_closure_set_cap(void* cl, int64_t idx, int64_t val);
     int64_t* cl = (int64_t*)yona_rt_closure_create((void*)split_iter_next, 0, 0, 1);
@@ -1738,6 +1847,10 @@ int64_t yona_Std_String__split(const char* delim, const char* s) {
     return (int64_t)(intptr_t)make_iterator(cl);
 }
 
+int64_t yona_Std_String__split(const char* delim, const char* s) {
+    return split_iter_create(delim, (size_t)yona_rt_string_length_fast(delim), s);
+}
+
 const char* yona_Std_String__join(const char* sep, int64_t* seq) {
     int64_t n = seq[0];
     if (n == 0) { char* r = (char*)rc_alloc(RC_TYPE_STRING, 1); r[0] = '\0'; return r; }
@@ -1801,8 +1914,11 @@ const char* yona_Std_String__reverse(const char* s) {
     return r;
 }
 
-int64_t yona_Std_String__toInt(const char* s) { return (int64_t)atoll(s); }
-double yona_Std_String__toFloat(const char* s) { return atof(s); }
+int64_t yona_Std_String__toInt(const char* s) { return yona_parse_i64(s); }
+double yona_Std_String__toFloat(const char* s) { return yona_parse_f64(s); }
+
+/* Canonical immortal copy: equal interned strings share one pointer */
+const char* yona_Std_String__intern(const char* s) { return yona_rt_string_intern(s); }
 
 int64_t yona_Std_String__isEmpty(const char* s) { return s[0] == '\0'; }
 
@@ -1836,17 +1952,19 @@ const char* yona_Std_String__drop(int64_t n, const char* s) {
 }
 
 int64_t yona_Std_String__count(const char* needle, const char* haystack) {
-    if (needle[0] == '\0') return 0;
+    size_t nlen = (size_t)yona_rt_string_length_fast(needle);
+    if (nlen == 0) return 0;
     int64_t count = 0;
-    size_t nlen = strlen(needle);
     const char* p = haystack;
-    while ((p = strstr(p, needle)) != NULL) { count++; p += nlen; }
+    const char* end = haystack + yona_rt_string_length_fast(haystack);
+    while ((p = yona_str_find(p, (size_t)(end - p), needle, nlen)) != NULL) { count++; p += nlen; }
     return count;
 }
 
 int64_t yona_Std_String__lines(const char* s) {
-    /* Split by newline — returns Iterator */
-    return yona_Std_String__split("\n", s);
+    /* Split by newline — returns Iterator. The delimiter is a C literal
+     * without an RC header, so pass its length explicitly. */
+    return split_iter_create("\n", 1, s);
 }
 
 const char* yona_Std_String__unlines(int64_t* seq) {
@@ -2597,6 +2715,7 @@ void yona_Std_Time__sleep(int64_t ms) {
 		ms -= (int64_t)chunk;
 	}
 #else
+	yona_platform_io_flush();  /* queued I/O must not wait out the sleep */
 	usleep((useconds_t)(ms * 1000));
 #endif
 }
@@ -2703,19 +2822,47 @@ double yona_Std_FloatMath__pi(void)        { return 3.14159265358979323846; }
 
 /* ===== Std\Format — string formatting ===== */
 
-/* Simple placeholder format: replace {} with arguments in order.
- * Takes a format string and a sequence of string arguments. */
-const char* yona_Std_Format__format(const char* fmt, int64_t* args) {
-    int64_t argc = args[0];
+/* Placeholder format: replace {} with arguments in order. `kind` says
+ * what the Seq holds (a Seq is homogeneous): 0 String, 1 Int, 2 Float,
+ * 3 Bool. Numbers and booleans get their Show text. Codegen passes the
+ * element kind when it knows it; the exported entry assumes strings. */
+static size_t format_arg(int64_t kind, int64_t v, char* scratch, const char** out) {
+    switch (kind) {
+        case 1: *out = scratch; return yona_i64_to_dec(scratch, v);
+        case 2: {
+            double d;
+            memcpy(&d, &v, sizeof d);
+            *out = scratch;
+            return yona_f64_to_g(scratch, d);
+        }
+        case 3: *out = v ? "true" : "false"; return v ? 4 : 5;
+        default: *out = (const char*)(intptr_t)v; return strlen(*out);
+    }
+}
+
+const char* yona_rt_format_seq(const char* fmt, int64_t* args, int64_t kind) {
+    int64_t argc = yona_rt_seq_length(args);
     int64_t argi = 0;
     size_t flen = strlen(fmt);
+    char scratch[32];
+    const char* arg;
+
+    /* Flat seqs are read in place; tree-backed ones are copied out once */
+    const int64_t* elems = NULL;
+    int64_t* copy = NULL;
+    if (argc > 0 && !is_rbt(args)) {
+        elems = args + SEQ_HDR_SIZE + FLAT_OFF(args);
+    } else if (argc > 0) {
+        copy = (int64_t*)malloc((size_t)argc * sizeof(int64_t));
+        yona_rt_seq_copy_out(args, copy);
+        elems = copy;
+    }
 
     /* First pass: calculate output size */
     size_t out_size = 0;
     for (size_t i = 0; i < flen; i++) {
         if (fmt[i] == '{' && i + 1 < flen && fmt[i+1] == '}' && argi < argc) {
-            const char* arg = (const char*)(intptr_t)args[argi + 1];
-            out_size += strlen(arg);
+            out_size += format_arg(kind, elems[argi], scratch, &arg);
             argi++;
             i++; /* skip } */
         } else {
@@ -2729,8 +2876,7 @@ const char* yona_Std_Format__format(const char* fmt, int64_t* args) {
     size_t j = 0;
     for (size_t i = 0; i < flen; i++) {
         if (fmt[i] == '{' && i + 1 < flen && fmt[i+1] == '}' && argi < argc) {
-            const char* arg = (const char*)(intptr_t)args[argi + 1];
-            size_t alen = strlen(arg);
+            size_t alen = format_arg(kind, elems[argi], scratch, &arg);
             memcpy(r + j, arg, alen);
             j += alen;
             argi++;
@@ -2740,19 +2886,30 @@ const char* yona_Std_Format__format(const char* fmt, int64_t* args) {
         }
     }
     r[j] = '\0';
+    free(copy);
     return r;
 }
 
-/* ===== Std\Json — minimal JSON parser/stringifier ===== */
+const char* yona_Std_Format__format(const char* fmt, int64_t* args) {
+    return yona_rt_format_seq(fmt, args, 0);
+}
 
-/* JSON value types as tagged tuples:
- *   (:json_null)
- *   (:json_bool, 0|1)
- *   (:json_int, i64)
- *   (:json_string, ptr)
- *   (:json_array, seq_ptr)    — seq of json values
- *   (:json_object, seq_ptr)   — seq of (key, value) pairs
- */
+/* Number writers for `format` calls specialized at compile time
+ * (Codegen::codegen_literal_format). buf holds at least 32 bytes; the
+ * return value is the number of bytes written, without a NUL. The text
+ * matches Show Int / Show Float. */
+int64_t yona_rt_format_int(char* buf, int64_t v) {
+    return (int64_t)yona_i64_to_dec(buf, v);
+}
+
+int64_t yona_rt_format_float(char* buf, double v) {
+    return (int64_t)yona_f64_to_g(buf, v);
+}
+
+/* ===== Std\Json — JSON parser/stringifier ===== */
+
+/* Stage-1 SIMD indexing, Json tree and on-demand path queries */
+#include "runtime/json.c"
 
 /* Stringify a JSON-like structure to a string.
  * Takes a Yona value and produces a JSON string representation. */
@@ -2761,9 +2918,7 @@ const char* yona_Std_Json__stringify(int64_t value) {
      * Full JSON stringify requires recursive ADT traversal which needs
      * the codegen to pass type info. For Phase 5, we provide basic
      * int/string/bool/seq serialization. */
-    char* r = (char*)rc_alloc(RC_TYPE_STRING, 32);
-    snprintf(r, 32, "%" PRId64, value);
-    return r;
+    return int_to_rc_string(value);
 }
 
 const char* yona_Std_Json__stringifyString(const char* s) {
@@ -2795,10 +2950,9 @@ const char* yona_Std_Json__stringifyBool(int64_t b) {
     return r;
 }
 
+/* Shortest text that parses back to the same double; inf/nan -> null */
 const char* yona_Std_Json__stringifyFloat(double f) {
-    char* r = (char*)rc_alloc(RC_TYPE_STRING, 64);
-    snprintf(r, 64, "%g", f);
-    return r;
+    return float_to_rc_string(f, yona_f64_shortest);
 }
 
 const char* yona_Std_Json__null(void) {
@@ -2809,13 +2963,18 @@ const char* yona_Std_Json__null(void) {
 
 /* Parse a JSON number from string. Returns the integer value. */
 int64_t yona_Std_Json__parseInt(const char* s) {
-    return (int64_t)atoll(s);
+    return yona_parse_i64(s);
 }
 
 double yona_Std_Json__parseFloat(const char* s) {
-    return atof(s);
+    return yona_parse_f64(s);
 }
 
+/* ===== Std\Binary — compact binary serialization ===== */
+
+/* Aligned node format, zero-copy reads from mapped files */
+#include "runtime/binary.c"
+
 /* ===== Std\Crypto — hashing and random bytes ===== */
 
 /* SHA-256 implementation (standalone, no openssl dependency) */
@@ -3089,17 +3248,13 @@ int64_t yona_Prelude__foldr(int64_t* fn, int64_t acc, int64_t* seq) {
 }
 
 /* Std\Types — type conversions */
-int64_t yona_Std_Types__toInt(const char* s) { return (int64_t)atoll(s); }
-double yona_Std_Types__toFloat(const char* s) { return atof(s); }
+int64_t yona_Std_Types__toInt(const char* s) { return yona_parse_i64(s); }
+double yona_Std_Types__toFloat(const char* s) { return yona_parse_f64(s); }
 const char* yona_Std_Types__intToString(int64_t n) {
-    char* r = (char*)rc_alloc(RC_TYPE_STRING, 32);
-    snprintf(r, 32, "%" PRId64, n);
-    return r;
+    return int_to_rc_string(n);
 }
 const char* yona_Std_Types__floatToString(double f) {
-    char* r = (char*)rc_alloc(RC_TYPE_STRING, 32);
-    snprintf(r, 32, "%g", f);
-    return r;
+    return float_to_rc_string(f, yona_f64_to_g);
 }
 const char* yona_Std_Types__boolToString(int64_t b) {
     const char* src = b ? "true" : "false";
@@ -3109,12 +3264,10 @@ const char* yona_Std_Types__boolToString(int64_t b) {
     return r;
 }
 
-/* ===== Primitive trait instances (Show, Eq, Ord, Hash) ===== */
+/* ===== Primitive trait instances (Show, Eq, Ord, Hash, Json, Binary) ===== */
 
 const char* yona_Prelude__Show_Int__show(int64_t n) {
-    char* r = (char*)rc_alloc(RC_TYPE_STRING, 32);
-    snprintf(r, 32, "%" PRId64, n);
-    return r;
+    return int_to_rc_string(n);
 }
 
 const char* yona_Prelude__Show_String__show(const char* s) {
@@ -3137,15 +3290,22 @@ const char* yona_Prelude__Show_Bool__show(int64_t b) {
 }
 
 const char* yona_Prelude__Show_Float__show(double f) {
-    char* r = (char*)rc_alloc(RC_TYPE_STRING, 32);
-    snprintf(r, 32, "%g", f);
-    return r;
+    return float_to_rc_string(f, yona_f64_to_g);
 }
 
 int64_t yona_Prelude__Eq_Int__eq(int64_t a, int64_t b) { return a == b ? 1 : 0; }
 
 int64_t yona_Prelude__Eq_String__eq(const char* a, const char* b) {
-    return strcmp(a, b) == 0 ? 1 : 0;
+    if (a == b) return 1;
+    /* Interned strings are unique per content once queued literals are in
+     * the table; settling may demote a duplicate literal, so re-check. */
+    if (yona_str_is_interned(a) && yona_str_is_interned(b)) {
+        yona_intern_settle();
+        if (yona_str_is_interned(a) && yona_str_is_interned(b)) return 0;
+    }
+    size_t la = (size_t)yona_rt_string_length_fast(a);
+    if (la != (size_t)yona_rt_string_length_fast(b)) return 0;
+    return memcmp(a, b, la) == 0 ? 1 : 0;
 }
 
 int64_t yona_Prelude__Eq_Bool__eq(int64_t a, int64_t b) { return a == b ? 1 : 0; }
@@ -3163,11 +3323,9 @@ int64_t yona_Prelude__Hash_Int__hash(int64_t x) {
 }
 
 int64_t yona_Prelude__Hash_String__hash(const char* s) {
-    /* FNV-1a */
-    uint64_t h = 14695981039346656037ULL;
-    for (; *s; s++)
-        h = (h ^ (uint64_t)(unsigned char)*s) * 1099511628211ULL;
-    return (int64_t)h;
+    /* FNV-1a; interned strings carry it precomputed */
+    if (yona_str_is_interned(s)) return (int64_t)yona_str_interned_hash(s);
+    return (int64_t)yona_str_fnv1a(s, (size_t)yona_rt_string_length_fast(s));
 }
 
 /* Float instances */
@@ -3191,6 +3349,7 @@ int64_t yona_Prelude__Hash_Bool__hash(int64_t b) { return b ? 1 : 0; }
 
 /* String instances */
 int64_t yona_Prelude__Ord_String__compare(const char* a, const char* b) {
+    if (a == b) return 0;
     int r = strcmp(a, b);
     return (r < 0) ? -1 : (r > 0) ? 1 : 0;
 }
@@ -3204,6 +3363,57 @@ const char* yona_Prelude__Show_Symbol__show(int64_t sym_id) {
 int64_t yona_Prelude__Eq_Symbol__eq(int64_t a, int64_t b) { return a == b ? 1 : 0; }
 int64_t yona_Prelude__Hash_Symbol__hash(int64_t s) { return s; }
 
+/* Json instances: the leaves `deriving Json` encoders and decoders call.
+ * fromJson and readJson return their first argument when there is no
+ * value of the right kind, which is how missing fields keep their
+ * prototype value. readJson decodes the value at a Std\Json reader. */
+const char* yona_Prelude__Json_Int__toJson(int64_t n) { return int_to_rc_string(n); }
+const char* yona_Prelude__Json_Float__toJson(double f) { return yona_Std_Json__stringifyFloat(f); }
+const char* yona_Prelude__Json_String__toJson(const char* s) { return yona_Std_Json__stringifyString(s); }
+const char* yona_Prelude__Json_Bool__toJson(int64_t b) { return yona_Std_Json__stringifyBool(b); }
+int64_t yona_Prelude__Json_Int__fromJson(int64_t d, const char* s) { return yona_Std_Json__getInt("", d, s); }
+double yona_Prelude__Json_Float__fromJson(double d, const char* s) { return yona_Std_Json__getFloat("", d, s); }
+const char* yona_Prelude__Json_String__fromJson(const char* d, const char* s) { return yona_Std_Json__getString("", d, s); }
+int64_t yona_Prelude__Json_Bool__fromJson(int64_t d, const char* s) { return yona_Std_Json__getBool("", d, s); }
+int64_t yona_Prelude__Json_Int__readJson(int64_t d, int64_t r) { return yona_json_read_int(d, r); }
+double yona_Prelude__Json_Float__readJson(double d, int64_t r) { return yona_json_read_float(d, r); }
+const char* yona_Prelude__Json_String__readJson(const char* d, int64_t r) { return yona_json_read_string(d, r); }
+int64_t yona_Prelude__Json_Bool__readJson(int64_t d, int64_t r) { return yona_json_read_bool(d, r); }
+
+/* Binary instances. fromBinary takes a prototype only to pick the
+ * instance; a buffer holding another kind of value raises. */
+void* yona_Prelude__Binary_Int__toBinary(int64_t n) { return yona_bin_encode(n, 0, -1, -1); }
+void* yona_Prelude__Binary_Bool__toBinary(int64_t b) { return yona_bin_encode(b != 0, 0, -1, -1); }
+void* yona_Prelude__Binary_Float__toBinary(double f) {
+    int64_t w;
+    memcpy(&w, &f, sizeof w);
+    return yona_bin_encode(w, 0, -1, -1);
+}
+int64_t yona_Prelude__Binary_Int__fromBinary(int64_t d, void* b) { (void)d; return yona_bin_read(b, YONA_BIN_WORD); }
+int64_t yona_Prelude__Binary_Bool__fromBinary(int64_t d, void* b) { (void)d; return yona_bin_read(b, YONA_BIN_WORD) != 0; }
+double yona_Prelude__Binary_Float__fromBinary(double d, void* b) {
+    (void)d;
+    int64_t w = yona_bin_read(b, YONA_BIN_WORD);
+    memcpy(&d, &w, sizeof d);
+    return d;
+}
+void* yona_Prelude__Binary_String__toBinary(const char* v) { return yona_bin_encode((int64_t)(intptr_t)v, 1, -1, -1); }
+void* yona_Prelude__Binary_Seq__toBinary(int64_t* v) { return yona_bin_encode((int64_t)(intptr_t)v, 1, -1, -1); }
+void* yona_Prelude__Binary_Set__toBinary(int64_t* v) { return yona_bin_encode((int64_t)(intptr_t)v, 1, -1, -1); }
+void* yona_Prelude__Binary_Dict__toBinary(int64_t* v) { return yona_bin_encode((int64_t)(intptr_t)v, 1, -1, -1); }
+void* yona_Prelude__Binary_Tuple__toBinary(void* v) { return yona_bin_encode((int64_t)(intptr_t)v, 1, -1, -1); }
+void* yona_Prelude__Binary_IntArray__toBinary(int64_t* v) { return yona_bin_encode((int64_t)(intptr_t)v, 1, -1, -1); }
+void* yona_Prelude__Binary_FloatArray__toBinary(double* v) { return yona_bin_encode((int64_t)(intptr_t)v, 1, -1, -1); }
+void* yona_Prelude__Binary_ByteArray__toBinary(void* v) { return yona_bin_encode((int64_t)(intptr_t)v, 1, -1, -1); }
+const char* yona_Prelude__Binary_String__fromBinary(const char* d, void* b) { (void)d; return (const char*)(intptr_t)yona_bin_read(b, RC_TYPE_STRING); }
+int64_t* yona_Prelude__Binary_Seq__fromBinary(int64_t* d, void* b) { (void)d; return (int64_t*)(intptr_t)yona_bin_read(b, RC_TYPE_SEQ); }
+int64_t* yona_Prelude__Binary_Set__fromBinary(int64_t* d, void* b) { (void)d; return (int64_t*)(intptr_t)yona_bin_read(b, RC_TYPE_SET); }
+int64_t* yona_Prelude__Binary_Dict__fromBinary(int64_t* d, void* b) { (void)d; return (int64_t*)(intptr_t)yona_bin_read(b, RC_TYPE_DICT); }
+void* yona_Prelude__Binary_Tuple__fromBinary(void* d, void* b) { (void)d; return (void*)(intptr_t)yona_bin_read(b, RC_TYPE_TUPLE); }
+int64_t* yona_Prelude__Binary_IntArray__fromBinary(int64_t* d, void* b) { (void)d; return (int64_t*)(intptr_t)yona_bin_read(b, RC_TYPE_INT_ARRAY); }
+double* yona_Prelude__Binary_FloatArray__fromBinary(double* d, void* b) { (void)d; return (double*)(intptr_t)yona_bin_read(b, RC_TYPE_FLOAT_ARRAY); }
+void* yona_Prelude__Binary_ByteArray__fromBinary(void* d, void* b) { (void)d; return (void*)(intptr_t)yona_bin_read(b, RC_TYPE_BYTE_ARRAY); }
+
 /* ===== Array trait instance wrappers ===== */
 
 int64_t yona_Prelude__Array_ByteArray__length(int64_t arr) {
@@ -3243,6 +3453,211 @@ int64_t yona_Prelude__Array_String__get(int64_t arr, int64_t i) {
 
 /* seq_head and seq_tail are in runtime/seq.c */
 
+/* Worker pool sizing, shared by both async backends. The pool starts
+ * yona_pool_configured_size() workers on first use: the Std\Runtime
+ * setWorkerCount value if set, else YONA_POOL_THREADS, else the CPUs this
+ * process may use (affinity mask, cgroup quota). YONA_POOL_PIN=1 pins
+ * worker i to the i-th usable CPU, with CPUs grouped by NUMA node. */
+#define YONA_POOL_MAX_THREADS 256
+
+static int yona_pool_size_override = 0;  /* accessed via __atomic builtins */
+static int yona_pool_pin_override = -1;  /* -1: YONA_POOL_PIN decides */
+
+static int yona_pool_configured_size(void) {
+    int n = __atomic_load_n(&yona_pool_size_override, __ATOMIC_ACQUIRE);
+    if (n <= 0) {
+        const char* env = getenv("YONA_POOL_THREADS");
+        if (env && *env) n = atoi(env);
+    }
+    if (n <= 0) n = (int)yona_platform_available_cpus();
+    if (n < 1) n = 1;
+    if (n > YONA_POOL_MAX_THREADS) n = YONA_POOL_MAX_THREADS;
+    return n;
+}
+
+static int yona_pool_pin_enabled(void) {
+    int pin = __atomic_load_n(&yona_pool_pin_override, __ATOMIC_ACQUIRE);
+    if (pin >= 0) return pin;
+    const char* env = getenv("YONA_POOL_PIN");
+    return env && *env && strcmp(env, "0") != 0;
+}
+
+/* Scheduler statistics (Std\Runtime.stats, YONA_SCHED_STATS), shared by
+ * both async backends. Each worker owns one yona_sched_stats_t and is its
+ * only writer, so counting is a plain load and store; threads outside the
+ * pool share one block and add atomically. Readers sum the blocks without
+ * stopping anyone, so a snapshot taken while tasks run is approximate.
+ * Latencies are log2 histograms in nanoseconds and only recorded while
+ * task timing is on, since they cost two clock reads per task. */
+enum {
+    YONA_STAT_TASKS,        /* tasks started */
+    YONA_STAT_STEALS,       /* tasks taken from another worker's queue */
+    YONA_STAT_PARKS,        /* times a worker ran out of work and slept */
+    YONA_STAT_SUSPENDS,     /* times a running task parked its fiber */
+    YONA_STAT_CHAN_WAITS,   /* channel operations that had to sleep */
+    YONA_STAT_CHAN_RETRIES, /* lost races for a channel slot */
+    YONA_STAT_COUNTERS
+};
+
+static const char* const yona_stat_names[YONA_STAT_COUNTERS] = {
+    "tasks", "steals", "parks", "suspends", "chanWaits", "chanRetries",
+};
+
+#define YONA_STAT_BUCKETS 40 /* bucket i: [2^(i-1), 2^i) ns, the last open */
+
+typedef struct {
+    _Atomic uint64_t count[YONA_STAT_COUNTERS];
+    _Atomic int64_t depth_max;                   /* deepest local queue seen */
+    _Atomic uint64_t wait_ns[YONA_STAT_BUCKETS]; /* queued until started */
+    _Atomic uint64_t run_ns[YONA_STAT_BUCKETS];  /* started until finished */
+} yona_sched_stats_t;
+
+static _Atomic int yona_task_timing = 0;
+
+static inline void sched_stat_bump(_Atomic uint64_t* c, int owned, uint64_t n) {
+    if (owned)
+        atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n,
+                              memory_order_relaxed);
+    else
+        atomic_fetch_add_explicit(c, n, memory_order_relaxed);
+}
+
+static inline void sched_stat_latency(_Atomic uint64_t* hist, int owned, int64_t ns) {
+    int b = ns > 0 ? 64 - __builtin_clzll((uint64_t)ns) : 0;
+    sched_stat_bump(&hist[b < YONA_STAT_BUCKETS ? b : YONA_STAT_BUCKETS - 1], owned, 1);
+}
+
+/* Owner only */
+static inline void sched_stat_depth(yona_sched_stats_t* s, int64_t depth) {
+    if (depth > atomic_load_explicit(&s->depth_max, memory_order_relaxed))
+        atomic_store_explicit(&s->depth_max, depth, memory_order_relaxed);
+}
+
+/* YONA_SCHED_STATS / YONA_SCHED_STATS_MS; called by the backend at pool start */
+static void sched_stats_env_init(void);
+
+/* Parallel reductions (Std\Parallel.preduce / pfoldMap / pgroupBy), the part
+ * shared by both async backends. A backend splits [0, n) into ranges and
+ * calls par_reduce_fold on each; every range keeps one accumulator, and the
+ * backend joins neighbouring ranges left to right with par_reduce_join, so
+ * the combiner only has to be associative. Accumulators are words: Int
+ * values, double bits for FloatArray sources, HAMT pointers for pgroupBy. */
+enum { YONA_PAR_REDUCE, YONA_PAR_FOLD_MAP, YONA_PAR_GROUP_BY };
+
+typedef int64_t (*yona_par_fn1_t)(int64_t* env, int64_t x);
+typedef int64_t (*yona_par_fn2_t)(int64_t* env, int64_t a, int64_t b);
+typedef double (*yona_par_ffn1_t)(int64_t* env, double x);
+typedef double (*yona_par_ffn2_t)(int64_t* env, double a, double b);
+
+typedef struct {
+    int kind;
+    int floats;                 /* FloatArray source: closures take doubles */
+    int64_t* map;               /* pfoldMap: a -> b; pgroupBy: a -> value */
+    int64_t* key;               /* pgroupBy: a -> key */
+    int64_t* combine;           /* b -> b -> b, associative */
+    const void* elems;          /* int64_t or double elements, borrowed */
+    int64_t n;
+} yona_par_reduce_t;
+
+static int64_t par_group_add(const yona_par_reduce_t* r, int64_t* dict, int64_t k, int64_t v) {
+    if (yona_rt_dict_contains(dict, k)) {
+        yona_par_fn2_t c = (yona_par_fn2_t)(intptr_t)r->combine[0];
+        v = c(r->combine, yona_rt_dict_get(dict, k, 0), v);
+    }
+    return (int64_t)(intptr_t)yona_rt_dict_put(dict, k, v);
+}
+
+/* Fold elements [lo, hi) into *acc. Without an accumulator yet the first
+ * element (mapped) seeds it, so no identity value is needed per range. The
+ * pgroupBy dict is written back after every insert, so *acc stays valid if
+ * a closure raises part way through. */
+static void par_reduce_fold(const yona_par_reduce_t* r, int64_t lo, int64_t hi,
+                            int64_t* acc, int* has_acc) {
+    if (r->floats) {
+        const double* xs = (const double*)r->elems;
+        yona_par_ffn1_t m = r->map ? (yona_par_ffn1_t)(intptr_t)r->map[0] : NULL;
+        yona_par_ffn2_t c = (yona_par_ffn2_t)(intptr_t)r->combine[0];
+        double a;
+        if (*has_acc) memcpy(&a, acc, sizeof a);
+        else a = m ? m(r->map, xs[lo++]) : xs[lo++];
+        if (m) {
+            for (int64_t i = lo; i < hi; i++) a = c(r->combine, a, m(r->map, xs[i]));
+        } else {
+            for (int64_t i = lo; i < hi; i++) a = c(r->combine, a, xs[i]);
+        }
+        memcpy(acc, &a, sizeof a);
+        *has_acc = 1;
+        return;
+    }
+
+    const int64_t* xs = (const int64_t*)r->elems;
+    yona_par_fn1_t m = r->map ? (yona_par_fn1_t)(intptr_t)r->map[0] : NULL;
+    if (r->kind == YONA_PAR_GROUP_BY) {
+        yona_par_fn1_t k = (yona_par_fn1_t)(intptr_t)r->key[0];
+        if (!*has_acc) {
+            *acc = (int64_t)(intptr_t)yona_rt_dict_alloc(0);
+            *has_acc = 1;
+        }
+        for (int64_t i = lo; i < hi; i++)
+            *acc = par_group_add(r, (int64_t*)(intptr_t)*acc, k(r->key, xs[i]), m(r->map, xs[i]));
+        return;
+    }
+    yona_par_fn2_t c = (yona_par_fn2_t)(intptr_t)r->combine[0];
+    int64_t a = *has_acc ? *acc : (m ? m(r->map, xs[lo++]) : xs[lo++]);
+    if (m) {
+        for (int64_t i = lo; i < hi; i++) a = c(r->combine, a, m(r->map, xs[i]));
+    } else {
+        for (int64_t i = lo; i < hi; i++) a = c(r->combine, a, xs[i]);
+    }
+    *acc = a;
+    *has_acc = 1;
+}
+
+typedef struct {
+    const yona_par_reduce_t* r;
+    int64_t* into;
+    int left;                   /* the entries being added come from the left range */
+} yona_par_merge_t;
+
+static void par_group_merge_entry(int64_t k, int64_t v, void* ctx) {
+    yona_par_merge_t* mg = (yona_par_merge_t*)ctx;
+    if (mg->left && yona_rt_dict_contains(mg->into, k)) {
+        yona_par_fn2_t c = (yona_par_fn2_t)(intptr_t)mg->r->combine[0];
+        v = c(mg->r->combine, v, yona_rt_dict_get(mg->into, k, 0));
+        mg->into = yona_rt_dict_put(mg->into, k, v);
+        return;
+    }
+    mg->into = (int64_t*)(intptr_t)par_group_add(mg->r, mg->into, k, v);
+}
+
+/* Combine the accumulators of two adjacent ranges, left one first. For
+ * pgroupBy the smaller dict is folded into the larger one and released. */
+static int64_t par_reduce_join(const yona_par_reduce_t* r, int64_t a, int64_t b) {
+    if (r->kind == YONA_PAR_GROUP_BY) {
+        int64_t* da = (int64_t*)(intptr_t)a;
+        int64_t* db = (int64_t*)(intptr_t)b;
+        int a_small = yona_rt_dict_size(da) < yona_rt_dict_size(db);
+        yona_par_merge_t mg = { r, a_small ? db : da, a_small };
+        hamt_iterate_impl((hamt_node_t*)(a_small ? da : db), par_group_merge_entry, &mg);
+        yona_rt_rc_dec(a_small ? da : db);
+        return (int64_t)(intptr_t)mg.into;
+    }
+    if (r->floats) {
+        double x, y;
+        memcpy(&x, &a, sizeof x);
+        memcpy(&y, &b, sizeof y);
+        x = ((yona_par_ffn2_t)(intptr_t)r->combine[0])(r->combine, x, y);
+        memcpy(&a, &x, sizeof x);
+        return a;
+    }
+    return ((yona_par_fn2_t)(intptr_t)r->combine[0])(r->combine, a, b);
+}
+
+/* Drop an accumulator abandoned after an error. */
+static void par_reduce_discard(const yona_par_reduce_t* r, int64_t acc) {
+    if (r->kind == YONA_PAR_GROUP_BY && acc) yona_rt_rc_dec((void*)(intptr_t)acc);
+}
+
 /* Async runtime: thread pool, promises, await */
 #if defined(_WIN32)
 #include "runtime/platform/async_win32.c"
@@ -3250,6 +3665,354 @@ int64_t yona_Prelude__Array_String__get(int64_t arr, int64_t i) {
 #include "runtime/platform/async_posix.c"
 #endif
 
+/* ===== Std\Runtime — worker pool configuration ===== */
+
+int64_t yona_Std_Runtime__availableCpus(void) { return yona_platform_available_cpus(); }
+
+int64_t yona_Std_Runtime__workerCount(void) { return yona_pool_worker_count(); }
+
+/* Before the pool starts this sets its size; afterwards it can only add
+ * workers. Returns the resulting worker count. */
+int64_t yona_Std_Runtime__setWorkerCount(int64_t n) {
+    if (n < 1) n = 1;
+    if (n > YONA_POOL_MAX_THREADS) n = YONA_POOL_MAX_THREADS;
+    __atomic_store_n(&yona_pool_size_override, (int)n, __ATOMIC_RELEASE);
+    return yona_pool_grow((int)n);
+}
+
+/* Takes effect when the pool starts (first async call). */
+void yona_Std_Runtime__setPinWorkers(int64_t on) {
+    __atomic_store_n(&yona_pool_pin_override, on ? 1 : 0, __ATOMIC_RELEASE);
+}
+
+/* ===== Std\Runtime — scheduler statistics =====
+ *
+ * Totals over every worker plus the threads outside the pool; see
+ * yona_sched_stats_t. Latency quantiles are the upper bound of the log2
+ * bucket they fall in, so they read as "at most". */
+
+typedef struct {
+    int workers;
+    uint64_t compensations;
+    uint64_t count[YONA_STAT_COUNTERS];
+    int64_t depth_max;
+    uint64_t wait_ns[YONA_STAT_BUCKETS];
+    uint64_t run_ns[YONA_STAT_BUCKETS];
+} yona_sched_totals_t;
+
+static void sched_stats_add(yona_sched_totals_t* t, yona_sched_stats_t* s) {
+    for (int c = 0; c < YONA_STAT_COUNTERS; c++)
+        t->count[c] += atomic_load_explicit(&s->count[c], memory_order_relaxed);
+    int64_t depth = atomic_load_explicit(&s->depth_max, memory_order_relaxed);
+    if (depth > t->depth_max) t->depth_max = depth;
+    for (int b = 0; b < YONA_STAT_BUCKETS; b++) {
+        t->wait_ns[b] += atomic_load_explicit(&s->wait_ns[b], memory_order_relaxed);
+        t->run_ns[b] += atomic_load_explicit(&s->run_ns[b], memory_order_relaxed);
+    }
+}
+
+static void sched_stats_sum(yona_sched_totals_t* t) {
+    memset(t, 0, sizeof(*t));
+    t->workers = sched_stats_workers();
+    t->compensations = sched_stats_compensations();
+    sched_stats_add(t, sched_stats_worker(-1));
+    for (int i = 0; i < t->workers; i++) sched_stats_add(t, sched_stats_worker(i));
+}
+
+/* Nanoseconds at quantile q (1.0: the slowest), 0 with no samples */
+static int64_t sched_stats_quantile(const uint64_t* hist, double q) {
+    uint64_t total = 0;
+    for (int b = 0; b < YONA_STAT_BUCKETS; b++) total += hist[b];
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)total);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < YONA_STAT_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen >= rank) return b ? (int64_t)1 << b : 0;
+    }
+    return (int64_t)1 << (YONA_STAT_BUCKETS - 1);
+}
+
+static void sched_stats_duration(char* out, size_t size, int64_t ns) {
+    if (ns < 1000) snprintf(out, size, "%lldns", (long long)ns);
+    else if (ns < 1000000) snprintf(out, size, "%.1fus", (double)ns / 1e3);
+    else if (ns < 1000000000) snprintf(out, size, "%.1fms", (double)ns / 1e6);
+    else snprintf(out, size, "%.1fs", (double)ns / 1e9);
+}
+
+typedef struct {
+    char* buf;
+    size_t len, size;
+} yona_sched_report_t;
+
+static void sched_report_add(yona_sched_report_t* r, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(r->buf + r->len, r->size - r->len, fmt, ap);
+    va_end(ap);
+    if (n > 0) r->len += (size_t)n < r->size - r->len ? (size_t)n : r->size - r->len - 1;
+}
+
+static void sched_report_counters(yona_sched_report_t* r, const uint64_t* count, int64_t depth) {
+    for (int c = 0; c < YONA_STAT_COUNTERS; c++)
+        sched_report_add(r, " %s=%llu", yona_stat_names[c], (unsigned long long)count[c]);
+    sched_report_add(r, " maxQueueDepth=%lld\n", (long long)depth);
+}
+
+static void sched_report_latency(yona_sched_report_t* r, const char* prefix, const char* what,
+                                 const uint64_t* hist) {
+    uint64_t n = 0;
+    for (int b = 0; b < YONA_STAT_BUCKETS; b++) n += hist[b];
+    if (n == 0) {
+        sched_report_add(r, "%s%s: not timed\n", prefix, what);
+        return;
+    }
+    char p50[32], p99[32], max[32];
+    sched_stats_duration(p50, sizeof p50, sched_stats_quantile(hist, 0.5));
+    sched_stats_duration(p99, sizeof p99, sched_stats_quantile(hist, 0.99));
+    sched_stats_duration(max, sizeof max, sched_stats_quantile(hist, 1.0));
+    sched_report_add(r, "%s%s: p50<=%s p99<=%s max<=%s (%llu tasks)\n", prefix, what, p50, p99,
+                     max, (unsigned long long)n);
+}
+
+/* The report behind Std\Runtime.stats and YONA_SCHED_STATS; each line
+ * starts with prefix. Returns a malloc'd string. */
+static char* sched_stats_format(const char* prefix) {
+    yona_sched_totals_t t;
+    sched_stats_sum(&t);
+    yona_sched_report_t r = {NULL, 0, 1024 + (size_t)(t.workers + 1) * 384};
+    r.buf = (char*)malloc(r.size);
+    r.buf[0] = '\0';
+    sched_report_add(&r, "%sworkers=%d compensations=%llu", prefix, t.workers,
+                     (unsigned long long)t.compensations);
+    sched_report_counters(&r, t.count, t.depth_max);
+    sched_report_latency(&r, prefix, "queue wait", t.wait_ns);
+    sched_report_latency(&r, prefix, "run time", t.run_ns);
+    for (int i = 0; i < t.workers; i++) {
+        yona_sched_stats_t* s = sched_stats_worker(i);
+        uint64_t count[YONA_STAT_COUNTERS];
+        for (int c = 0; c < YONA_STAT_COUNTERS; c++)
+            count[c] = atomic_load_explicit(&s->count[c], memory_order_relaxed);
+        sched_report_add(&r, "%sworker %d:", prefix, i);
+        sched_report_counters(&r, count, atomic_load_explicit(&s->depth_max, memory_order_relaxed));
+    }
+    return r.buf;
+}
+
+static void sched_stats_dump(void) {
+    char* report = sched_stats_format("[sched-stats] ");
+    fputs(report, stderr);
+    fflush(stderr);
+    free(report);
+}
+
+static int sched_stats_dump_ms = 0;
+
+#if defined(_WIN32)
+static DWORD WINAPI sched_stats_dumper(void* arg) {
+#else
+static void* sched_stats_dumper(void* arg) {
+#endif
+    (void)arg;
+    for (;;) {
+        yona_Std_Time__sleep(sched_stats_dump_ms);
+        sched_stats_dump();
+    }
+    return 0;
+}
+
+/* YONA_SCHED_STATS=1 prints the report to stderr at exit and
+ * YONA_SCHED_STATS_MS=N every N ms as well; either turns on task timing. */
+static void sched_stats_env_init(void) {
+    const char* at_exit = getenv("YONA_SCHED_STATS");
+    const char* every = getenv("YONA_SCHED_STATS_MS");
+    sched_stats_dump_ms = every ? atoi(every) : 0;
+    if (!(at_exit && *at_exit && strcmp(at_exit, "0") != 0) && sched_stats_dump_ms <= 0) return;
+    atomic_store(&yona_task_timing, 1);
+    atexit(sched_stats_dump);
+    if (sched_stats_dump_ms <= 0) return;
+#if defined(_WIN32)
+    HANDLE h = CreateThread(NULL, 0, sched_stats_dumper, NULL, 0, NULL);
+    if (h) CloseHandle(h);
+#else
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, sched_stats_dumper, NULL) == 0) pthread_detach(thread);
+#endif
+}
+
+/* The report as a string, one line per fact */
+const char* yona_Std_Runtime__stats(void) {
+    char* report = sched_stats_format("");
+    size_t n = strlen(report);
+    char* r = (char*)rc_alloc(RC_TYPE_STRING, n + 1);
+    memcpy(r, report, n + 1);
+    free(report);
+    return r;
+}
+
+/* One total by name: a counter, workers, compensations, maxQueueDepth, or
+ * a latency in ns (waitP50, waitP99, waitMax, runP50, runP99, runMax). */
+int64_t yona_Std_Runtime__stat(const char* name) {
+    yona_sched_totals_t t;
+    sched_stats_sum(&t);
+    for (int c = 0; c < YONA_STAT_COUNTERS; c++)
+        if (strcmp(name, yona_stat_names[c]) == 0) return (int64_t)t.count[c];
+    if (strcmp(name, "workers") == 0) return t.workers;
+    if (strcmp(name, "compensations") == 0) return (int64_t)t.compensations;
+    if (strcmp(name, "maxQueueDepth") == 0) return t.depth_max;
+    static const struct { const char* name; int run; double q; } lat[] = {
+        {"waitP50", 0, 0.5}, {"waitP99", 0, 0.99}, {"waitMax", 0, 1.0},
+        {"runP50", 1, 0.5},  {"runP99", 1, 0.99},  {"runMax", 1, 1.0},
+    };
+    for (size_t i = 0; i < sizeof lat / sizeof lat[0]; i++)
+        if (strcmp(name, lat[i].name) == 0)
+            return sched_stats_quantile(lat[i].run ? t.run_ns : t.wait_ns, lat[i].q);
+    yona_rt_raise(0, "Std\\Runtime.stat: unknown statistic");
+    return 0;
+}
+
+/* Record queue wait and run time per task from now on (or stop) */
+void yona_Std_Runtime__setTaskTiming(int64_t on) {
+    atomic_store(&yona_task_timing, on ? 1 : 0);
+}
+
+/* ===== Std\Time — timers on the async runtime ===== */
+
+/* Like sleep, but a pool task parks instead of holding its worker */
+void yona_Std_Time__sleepAsync(int64_t ms) {
+    yona_rt_sleep(ms);
+}
+
+/* Run a thunk on the pool every ms milliseconds; returns a timer id */
+int64_t yona_Std_Time__every(int64_t ms, int64_t* fn) {
+    return yona_rt_timer_every(fn, ms);
+}
+
+/* Stop a timer from every; false if it was not running */
+int64_t yona_Std_Time__cancel(int64_t id) {
+    return yona_rt_timer_cancel(id) ? 1 : 0;
+}
+
+/* ===== Std\Parallel — chunked map / for-each with an explicit grain ===== */
+
+int64_t* yona_Std_Parallel__pmapChunked(int64_t grain, int64_t* fn, int64_t* xs) {
+    return yona_rt_par_map(fn, xs, grain);
+}
+
+int64_t* yona_Std_Parallel__raw_pmapChunked(int64_t grain, int64_t* fn, int64_t* xs) {
+    return yona_rt_par_map(fn, xs, grain);
+}
+
+int64_t yona_Std_Parallel__pforChunked(int64_t grain, int64_t* fn, int64_t* xs) {
+    return yona_rt_par_for(fn, xs, grain);
+}
+
+int64_t yona_Std_Parallel__raw_pforChunked(int64_t grain, int64_t* fn, int64_t* xs) {
+    return yona_rt_par_for(fn, xs, grain);
+}
+
+/* ===== Std\Parallel — reductions ===== */
+
+/* Run a reduction over a Seq, IntArray or FloatArray (elems / n already set
+ * for the arrays). Seq trees are flattened into a scratch copy first. */
+static int64_t par_reduce_source(yona_par_reduce_t* r, int64_t* seq) {
+    int64_t* copy = NULL;
+    if (seq) {
+        r->n = yona_rt_seq_length(seq);
+        if (!is_rbt(seq)) {
+            r->elems = seq + SEQ_HDR_SIZE + FLAT_OFF(seq);
+        } else {
+            copy = (int64_t*)malloc((size_t)r->n * sizeof(int64_t));
+            yona_rt_seq_copy_out(seq, copy);
+            r->elems = copy;
+        }
+    }
+    int64_t acc = 0, sym = 0;
+    const char* msg = NULL;
+    int failed = par_reduce(r, 0, &acc, &sym, &msg);
+    free(copy);
+    if (failed) yona_rt_raise(sym, msg);
+    return acc;
+}
+
+/* z only enters once, on the left: z for an empty source, else z <> total. */
+static int64_t par_reduce_words(int64_t* map, int64_t* combine, int64_t z,
+                                int64_t* seq, const int64_t* ints, int64_t n) {
+    yona_par_reduce_t r = { map ? YONA_PAR_FOLD_MAP : YONA_PAR_REDUCE, 0, map, NULL, combine, ints, n };
+    if ((seq ? yona_rt_seq_length(seq) : n) == 0) return z;
+    int64_t total = par_reduce_source(&r, seq);
+    return ((yona_par_fn2_t)(intptr_t)combine[0])(combine, z, total);
+}
+
+static double par_reduce_floats(int64_t* map, int64_t* combine, double z, double* xs) {
+    int64_t n = yona_rt_float_array_length(xs);
+    if (n == 0) return z;
+    yona_par_reduce_t r = { map ? YONA_PAR_FOLD_MAP : YONA_PAR_REDUCE, 1, map, NULL, combine, xs, n };
+    int64_t bits = par_reduce_source(&r, NULL);
+    double total;
+    memcpy(&total, &bits, sizeof total);
+    return ((yona_par_ffn2_t)(intptr_t)combine[0])(combine, z, total);
+}
+
+int64_t yona_Std_Parallel__preduce(int64_t* fn, int64_t z, int64_t* xs) {
+    return par_reduce_words(NULL, fn, z, xs, NULL, 0);
+}
+
+int64_t yona_Std_Parallel__raw_preduce(int64_t* fn, int64_t z, int64_t* xs) {
+    return par_reduce_words(NULL, fn, z, xs, NULL, 0);
+}
+
+int64_t yona_Std_Parallel__pfoldMap(int64_t* map, int64_t* fn, int64_t z, int64_t* xs) {
+    return par_reduce_words(map, fn, z, xs, NULL, 0);
+}
+
+int64_t yona_Std_Parallel__raw_pfoldMap(int64_t* map, int64_t* fn, int64_t z, int64_t* xs) {
+    return par_reduce_words(map, fn, z, xs, NULL, 0);
+}
+
+int64_t yona_Std_Parallel__preduceIntArray(int64_t* fn, int64_t z, int64_t* arr) {
+    return par_reduce_words(NULL, fn, z, NULL, arr + 1, arr[0]);
+}
+
+int64_t yona_Std_Parallel__raw_preduceIntArray(int64_t* fn, int64_t z, int64_t* arr) {
+    return par_reduce_words(NULL, fn, z, NULL, arr + 1, arr[0]);
+}
+
+int64_t yona_Std_Parallel__pfoldMapIntArray(int64_t* map, int64_t* fn, int64_t z, int64_t* arr) {
+    return par_reduce_words(map, fn, z, NULL, arr + 1, arr[0]);
+}
+
+int64_t yona_Std_Parallel__raw_pfoldMapIntArray(int64_t* map, int64_t* fn, int64_t z, int64_t* arr) {
+    return par_reduce_words(map, fn, z, NULL, arr + 1, arr[0]);
+}
+
+double yona_Std_Parallel__preduceFloatArray(int64_t* fn, double z, double* arr) {
+    return par_reduce_floats(NULL, fn, z, arr);
+}
+
+double yona_Std_Parallel__raw_preduceFloatArray(int64_t* fn, double z, double* arr) {
+    return par_reduce_floats(NULL, fn, z, arr);
+}
+
+double yona_Std_Parallel__pfoldMapFloatArray(int64_t* map, int64_t* fn, double z, double* arr) {
+    return par_reduce_floats(map, fn, z, arr);
+}
+
+double yona_Std_Parallel__raw_pfoldMapFloatArray(int64_t* map, int64_t* fn, double z, double* arr) {
+    return par_reduce_floats(map, fn, z, arr);
+}
+
+int64_t* yona_Std_Parallel__pgroupBy(int64_t* key, int64_t* value, int64_t* fn, int64_t* xs) {
+    if (yona_rt_seq_length(xs) == 0) return yona_rt_dict_alloc(0);
+    yona_par_reduce_t r = { YONA_PAR_GROUP_BY, 0, value, key, fn, NULL, 0 };
+    return (int64_t*)(intptr_t)par_reduce_source(&r, xs);
+}
+
+int64_t* yona_Std_Parallel__raw_pgroupBy(int64_t* key, int64_t* value, int64_t* fn, int64_t* xs) {
+    return yona_Std_Parallel__pgroupBy(key, value, fn, xs);
+}
+
 /* Channels: bounded MPMC for inter-task communication */
 #if defined(_WIN32)
 #include "runtime/platform/channel_win32.c"
@@ -0,0 +1,859 @@
+/*
+ * Compact binary serialization for Std\Binary and `deriving Binary`.
+ *
+ * #included from compiled_runtime.c (not compiled as a separate TU).
+ *
+ * Format (native little-endian, 64-bit; every node 8-byte aligned):
+ *
+ *   [magic "YBIN"][version: u16][flags: u16][root: i64][node...]
+ *
+ * The root word and every value slot inside a node hold either the value
+ * itself (Int, Float bits, Bool, enum tag) or, for a heap value, the byte
+ * offset of its node's payload (0 for null). Which slots are references
+ * comes from the metadata the runtime already keeps: a Seq's heap flag, an
+ * ADT's or tuple's heap mask, a Dict's key/value flags, and bit 0 of the
+ * header flags for the root.
+ *
+ * A node is the runtime object it encodes, header included, with the
+ * immortal refcount:
+ *
+ *   [RC_ARENA_SENTINEL][type tag | aux << 16][payload...]
+ *                                             ^-- offset stored in slots
+ *
+ *   String      aux = length    bytes, NUL, padding
+ *   ByteArray                   [length][bytes][padding]
+ *   IntArray                    [count][i64...]
+ *   FloatArray                  [count][f64...]
+ *   Seq                         [count][heap flag][slot...]
+ *   ADT                         [ctor tag][field count][heap mask][slot...]
+ *   Tuple                       [count][heap mask][slot...]
+ *   Dict / Set  aux = HAMT flags [count][key, value...] / [count][key...]
+ *
+ * So inside an immortal buffer (one from mapFile) String, ByteArray,
+ * IntArray and FloatArray nodes are valid objects in place, and decoding
+ * returns pointers into the mapping instead of copying. From any other
+ * buffer they are copied with one memcpy each. Containers are rebuilt;
+ * string keys of a Dict or Set are interned, so literal lookups still
+ * compare pointers. A value shared in the heap is written once and decoded
+ * to one shared object.
+ *
+ * Both directions walk an explicit stack, so deep recursive ADTs (long
+ * cons lists) do not recurse on the C stack. Decoding validates every
+ * offset, length and tag against the buffer and raises on malformed input.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define YONA_BIN_MAGIC 0x4E494259u /* "YBIN" */
+#define YONA_BIN_VERSION 1
+#define YONA_BIN_ROOT_HEAP 1
+#define YONA_BIN_HDR 16            /* magic, version, flags, root */
+/* Leading words of an encoder buffer that become the ByteArray's RC header
+ * and length: the buffer is handed over as the result without a copy. */
+#define YONA_BIN_PREFIX 3
+
+#define YONA_BIN_PENDING ((int64_t)-1)   /* memo: node on the stack */
+#define YONA_BIN_VALID   ((int64_t)-2)   /* memo: checked, not decoded yet */
+
+/* ===== Pointer / offset map ===== */
+
+/* Open addressing, keys are never 0 (heap pointers, node offsets). */
+typedef struct {
+    uint64_t* keys;
+    int64_t* vals;
+    size_t cap;   /* power of two, 0 until first insert */
+    size_t count;
+} yona_bin_map_t;
+
+static inline size_t yona_bin_map_slot(uint64_t key, size_t cap) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 17) & (cap - 1);
+}
+
+static int64_t yona_bin_map_get(const yona_bin_map_t* m, uint64_t key) {
+    if (!m->cap) return 0;
+    for (size_t i = yona_bin_map_slot(key, m->cap);; i = (i + 1) & (m->cap - 1)) {
+        if (m->keys[i] == key) return m->vals[i];
+        if (!m->keys[i]) return 0;
+    }
+}
+
+static void yona_bin_map_put(yona_bin_map_t* m, uint64_t key, int64_t val) {
+    if ((m->count + 1) * 2 > m->cap) {
+        size_t old_cap = m->cap;
+        uint64_t* old_keys = m->keys;
+        int64_t* old_vals = m->vals;
+        m->cap = old_cap ? old_cap * 2 : 64;
+        m->keys = (uint64_t*)calloc(m->cap, sizeof(uint64_t));
+        m->vals = (int64_t*)malloc(m->cap * sizeof(int64_t));
+        for (size_t i = 0; i < old_cap; i++) {
+            if (!old_keys[i]) continue;
+            size_t j = yona_bin_map_slot(old_keys[i], m->cap);
+            while (m->keys[j]) j = (j + 1) & (m->cap - 1);
+            m->keys[j] = old_keys[i];
+            m->vals[j] = old_vals[i];
+        }
+        free(old_keys);
+        free(old_vals);
+    }
+    size_t i = yona_bin_map_slot(key, m->cap);
+    while (m->keys[i] && m->keys[i] != key) i = (i + 1) & (m->cap - 1);
+    if (!m->keys[i]) {
+        m->keys[i] = key;
+        m->count++;
+    }
+    m->vals[i] = val;
+}
+
+static void yona_bin_map_free(yona_bin_map_t* m) {
+    free(m->keys);
+    free(m->vals);
+}
+
+/* ===== Encoder ===== */
+
+typedef struct {
+    int64_t value;
+    size_t slot;   /* data offset of the word that receives the value's offset */
+} yona_bin_work_t;
+
+typedef struct {
+    int64_t* buf;          /* YONA_BIN_PREFIX words, then the encoded data */
+    size_t len, cap;       /* bytes of data */
+    yona_bin_map_t seen;   /* heap pointer -> payload offset */
+    yona_bin_work_t* work;
+    size_t nwork, capwork;
+    const char* err;
+} yona_bin_writer_t;
+
+static inline int64_t* yona_bin_word(yona_bin_writer_t* w, size_t off) {
+    return (int64_t*)((char*)(w->buf + YONA_BIN_PREFIX) + off);
+}
+
+/* Reserve n bytes (rounded up to 8, zero-filled) and return their offset. */
+static size_t yona_bin_reserve(yona_bin_writer_t* w, size_t n) {
+    n = (n + 7) & ~(size_t)7;
+    if (w->len + n > w->cap) {
+        size_t cap = w->cap ? w->cap * 2 : 256;
+        while (cap < w->len + n) cap *= 2;
+        w->buf = (int64_t*)realloc(w->buf, YONA_BIN_PREFIX * sizeof(int64_t) + cap);
+        w->cap = cap;
+    }
+    size_t off = w->len;
+    memset((char*)(w->buf + YONA_BIN_PREFIX) + off, 0, n);
+    w->len += n;
+    return off;
+}
+
+/* Start a node and return the offset of its payload. */
+static size_t yona_bin_node(yona_bin_writer_t* w, int64_t tag_word, size_t payload) {
+    size_t off = yona_bin_reserve(w, RC_HEADER_SIZE * sizeof(int64_t) + payload);
+    int64_t* hdr = yona_bin_word(w, off);
+    hdr[0] = RC_ARENA_SENTINEL;
+    hdr[1] = tag_word;
+    return off + RC_HEADER_SIZE * sizeof(int64_t);
+}
+
+/* Queue a heap reference stored at data offset `slot`. */
+static void yona_bin_defer(yona_bin_writer_t* w, int64_t value, size_t slot) {
+    if (!value) return;
+    if (w->nwork == w->capwork) {
+        w->capwork = w->capwork ? w->capwork * 2 : 64;
+        w->work = (yona_bin_work_t*)realloc(w->work, w->capwork * sizeof(yona_bin_work_t));
+    }
+    w->work[w->nwork].value = value;
+    w->work[w->nwork].slot = slot;
+    w->nwork++;
+}
+
+/* Write `count` slots starting at data offset `at`, deferring the ones
+ * selected by heap(i). */
+#define YONA_BIN_SLOTS(w, at, src, count, heap)                              \
+    do {                                                                     \
+        for (int64_t _i = 0; _i < (count); _i++) {                           \
+            int64_t _v = (src)[_i];                                          \
+            if (heap) yona_bin_defer((w), _v, (at) + (size_t)_i * 8);        \
+            else *yona_bin_word((w), (at) + (size_t)_i * 8) = _v;            \
+        }                                                                    \
+    } while (0)
+
+typedef struct {
+    yona_bin_writer_t* w;
+    size_t at;
+    int64_t flags;
+    int as_set;
+} yona_bin_hamt_ctx_t;
+
+static void yona_bin_hamt_entry(int64_t key, int64_t val, void* ctx) {
+    yona_bin_hamt_ctx_t* hc = (yona_bin_hamt_ctx_t*)ctx;
+    if (hc->flags & HAMT_FLAG_KEY_HEAP) yona_bin_defer(hc->w, key, hc->at);
+    else *yona_bin_word(hc->w, hc->at) = key;
+    hc->at += 8;
+    if (hc->as_set) return;
+    if (hc->flags & HAMT_FLAG_VAL_HEAP) yona_bin_defer(hc->w, val, hc->at);
+    else *yona_bin_word(hc->w, hc->at) = val;
+    hc->at += 8;
+}
+
+/* Emit the node for heap value v, queueing its heap children. `mask` and
+ * `arity` override an ADT's own heap mask and field count (derived
+ * encoders pass the declared ones for the root); -1 keeps them. */
+static size_t yona_bin_emit(yona_bin_writer_t* w, int64_t v, int64_t mask, int64_t arity) {
+    int64_t* p = (int64_t*)(intptr_t)v;
+    int64_t tag = DECODE_TAG(p[-1]);
+    size_t at;
+    switch ((int)tag) {
+        case RC_TYPE_STRING: {
+            size_t len = (size_t)yona_rt_string_length_fast((const char*)p);
+            at = yona_bin_node(w, RC_TYPE_STRING | ((int64_t)len << 16), len + 1);
+            memcpy(yona_bin_word(w, at), p, len);
+            return at;
+        }
+        case RC_TYPE_BYTE_ARRAY: {
+            int64_t n = p[0];
+            at = yona_bin_node(w, RC_TYPE_BYTE_ARRAY, sizeof(int64_t) + (size_t)n);
+            memcpy(yona_bin_word(w, at), p, sizeof(int64_t) + (size_t)n);
+            return at;
+        }
+        case RC_TYPE_INT_ARRAY:
+        case RC_TYPE_FLOAT_ARRAY: {
+            int64_t n = p[0];
+            at = yona_bin_node(w, tag, (1 + (size_t)n) * sizeof(int64_t));
+            memcpy(yona_bin_word(w, at), p, (1 + (size_t)n) * sizeof(int64_t));
+            return at;
+        }
+        case RC_TYPE_SEQ:
+        case RC_TYPE_RBT: {
+            int64_t n = yona_rt_seq_length(p);
+            int64_t hf = yona_rt_seq_heap_flag(p) ? 1 : 0;
+            at = yona_bin_node(w, RC_TYPE_SEQ, (2 + (size_t)n) * sizeof(int64_t));
+            int64_t* out = yona_bin_word(w, at);
+            out[0] = n;
+            out[1] = hf;
+            if (!hf) {
+                yona_rt_seq_copy_out(p, out + 2);
+            } else {
+                int64_t* elems = (int64_t*)malloc((size_t)(n ? n : 1) * sizeof(int64_t));
+                yona_rt_seq_copy_out(p, elems);
+                YONA_BIN_SLOTS(w, at + 16, elems, n, 1);
+                free(elems);
+            }
+            return at;
+        }
+        case RC_TYPE_ADT: {
+            int64_t nf = arity >= 0 && arity < p[1] ? arity : p[1];
+            int64_t hm = mask >= 0 ? mask : p[2];
+            at = yona_bin_node(w, RC_TYPE_ADT, (ADT_HDR_SIZE + (size_t)nf) * sizeof(int64_t));
+            int64_t* out = yona_bin_word(w, at);
+            out[0] = p[0];
+            out[1] = nf;
+            out[2] = hm;
+            YONA_BIN_SLOTS(w, at + ADT_HDR_SIZE * 8, p + ADT_HDR_SIZE, nf,
+                           _i < 64 && (hm & ((int64_t)1 << _i)));
+            return at;
+        }
+        case RC_TYPE_TUPLE: {
+            int64_t n = p[0], hm = p[1];
+            at = yona_bin_node(w, RC_TYPE_TUPLE, (2 + (size_t)n) * sizeof(int64_t));
+            int64_t* out = yona_bin_word(w, at);
+            out[0] = n;
+            out[1] = hm;
+            YONA_BIN_SLOTS(w, at + 16, p + 2, n, _i < 64 && (hm & ((int64_t)1 << _i)));
+            return at;
+        }
+        case RC_TYPE_DICT: {
+            int64_t flags = hamt_aux_flags((hamt_node_t*)p) &
+                            (HAMT_FLAG_KEY_HEAP | HAMT_FLAG_VAL_HEAP | HAMT_FLAG_IS_SET);
+            int as_set = (flags & HAMT_FLAG_IS_SET) != 0;
+            int64_t n = yona_rt_hamt_size((hamt_node_t*)p);
+            at = yona_bin_node(w, RC_TYPE_DICT | flags,
+                               (1 + (size_t)n * (as_set ? 1 : 2)) * sizeof(int64_t));
+            *yona_bin_word(w, at) = n;
+            yona_bin_hamt_ctx_t hc = {w, at + 8, flags, as_set};
+            hamt_iterate_impl((hamt_node_t*)p, yona_bin_hamt_entry, &hc);
+            return at;
+        }
+        case RC_TYPE_SET: {
+            /* Flat set from a literal: written as the HAMT set it becomes */
+            int64_t n = p[0];
+            int64_t flags = HAMT_FLAG_IS_SET | (p[1] ? HAMT_FLAG_KEY_HEAP : 0);
+            at = yona_bin_node(w, RC_TYPE_DICT | flags, (1 + (size_t)n) * sizeof(int64_t));
+            *yona_bin_word(w, at) = n;
+            YONA_BIN_SLOTS(w, at + 8, p + 2, n, p[1]);
+            return at;
+        }
+        case RC_TYPE_CLOSURE:
+            w->err = "Std\\Binary: cannot encode a function";
+            return 0;
+        default:
+            w->err = "Std\\Binary: cannot encode this value";
+            return 0;
+    }
+}
+
+/* Encode v (a heap pointer when heap is set, a plain word otherwise) into
+ * a fresh ByteArray. Raises if the value holds a function or a handle. */
+static void* yona_bin_encode(int64_t v, int heap, int64_t root_mask, int64_t root_arity) {
+    yona_bin_writer_t w = {0};
+    size_t hdr = yona_bin_reserve(&w, YONA_BIN_HDR);
+    uint32_t* magic = (uint32_t*)yona_bin_word(&w, hdr);
+    magic[0] = YONA_BIN_MAGIC;
+    magic[1] = YONA_BIN_VERSION | ((uint32_t)(heap ? YONA_BIN_ROOT_HEAP : 0) << 16);
+    if (!heap || !v) {
+        *yona_bin_word(&w, 8) = v;
+    } else {
+        *yona_bin_word(&w, 8) = (int64_t)yona_bin_emit(&w, v, root_mask, root_arity);
+        yona_bin_map_put(&w.seen, (uint64_t)v, *yona_bin_word(&w, 8));
+    }
+    while (!w.err && w.nwork) {
+        yona_bin_work_t item = w.work[--w.nwork];
+        int64_t off = yona_bin_map_get(&w.seen, (uint64_t)item.value);
+        if (!off) {
+            off = (int64_t)yona_bin_emit(&w, item.value, -1, -1);
+            yona_bin_map_put(&w.seen, (uint64_t)item.value, off);
+        }
+        *yona_bin_word(&w, item.slot) = off;
+    }
+    yona_bin_map_free(&w.seen);
+    free(w.work);
+    if (w.err) {
+        free(w.buf);
+        yona_rt_raise(0, w.err);
+        return NULL;
+    }
+    /* The buffer becomes the ByteArray: malloc'd, so no pool class */
+    if (w.cap > 2 * w.len)
+        w.buf = (int64_t*)realloc(w.buf, YONA_BIN_PREFIX * sizeof(int64_t) + w.len);
+    w.buf[0] = 1;
+    w.buf[1] = RC_TYPE_BYTE_ARRAY;
+    w.buf[2] = (int64_t)w.len;
+    YONA_ALLOC_INC_TAG(RC_TYPE_BYTE_ARRAY);
+    return w.buf + RC_HEADER_SIZE;
+}
+
+/* ===== Decoder ===== */
+
+/* A validated node: its payload and where its value slots are. */
+typedef struct {
+    int64_t kind;          /* RC_TYPE_* */
+    int64_t aux;           /* tag word >> 16: string length or HAMT flags */
+    const int64_t* p;
+    int64_t nslots;
+    int first;             /* payload index of slot 0 */
+} yona_bin_shape_t;
+
+typedef struct {
+    yona_bin_shape_t s;
+    size_t off;
+    int64_t next;          /* next slot to visit */
+} yona_bin_frame_t;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    int zero_copy;         /* buffer is immortal: leaf nodes are used in place */
+    yona_bin_map_t done;   /* payload offset -> PENDING, VALID or decoded value */
+    yona_bin_frame_t* stack;
+    size_t sp, cap;
+    const char* err;
+} yona_bin_reader_t;
+
+static int yona_bin_fail(yona_bin_reader_t* r, const char* msg) {
+    if (!r->err) r->err = msg;
+    return 0;
+}
+
+/* Point r at a buffer. The memo and stack allocations are kept, so a
+ * reused reader does not allocate. */
+static int yona_bin_open(yona_bin_reader_t* r, void* bytes) {
+    const int64_t* b = (const int64_t*)bytes;
+    yona_bin_map_t done = r->done;
+    yona_bin_frame_t* stack = r->stack;
+    size_t cap = r->cap;
+    if (done.count) memset(done.keys, 0, done.cap * sizeof(uint64_t));
+    done.count = 0;
+    memset(r, 0, sizeof(*r));
+    r->done = done;
+    r->stack = stack;
+    r->cap = cap;
+    r->data = (const uint8_t*)(b + 1);
+    r->size = (size_t)b[0];
+    r->zero_copy = b[-RC_HEADER_SIZE] == RC_ARENA_SENTINEL;
+    if (r->size < YONA_BIN_HDR || ((const uint32_t*)r->data)[0] != YONA_BIN_MAGIC)
+        return yona_bin_fail(r, "Std\\Binary: not a Std\\Binary buffer");
+    if ((((const uint32_t*)r->data)[1] & 0xFFFF) != YONA_BIN_VERSION)
+        return yona_bin_fail(r, "Std\\Binary: unsupported format version");
+    return 1;
+}
+
+static inline int yona_bin_root_is_heap(const yona_bin_reader_t* r) {
+    return (((const uint32_t*)r->data)[1] >> 16) & YONA_BIN_ROOT_HEAP;
+}
+
+static inline int64_t yona_bin_root(const yona_bin_reader_t* r) {
+    return ((const int64_t*)r->data)[1];
+}
+
+/* Validate the node whose payload starts at `off` and describe it. */
+static int yona_bin_shape(yona_bin_reader_t* r, uint64_t off, yona_bin_shape_t* s) {
+    if (off < YONA_BIN_HDR + 16 || off > r->size || (off & 7))
+        return yona_bin_fail(r, "Std\\Binary: offset out of range");
+    const int64_t* hdr = (const int64_t*)(r->data + off) - RC_HEADER_SIZE;
+    int64_t tw = hdr[1];
+    size_t room = (r->size - off) / 8;   /* whole words after the header */
+    if (hdr[0] != RC_ARENA_SENTINEL || (tw & 0xFF00))
+        return yona_bin_fail(r, "Std\\Binary: corrupt node header");
+    s->kind = tw & 0xFF;
+    s->aux = (int64_t)((uint64_t)tw >> 16);
+    s->p = (const int64_t*)(r->data + off);
+    s->nslots = 0;
+    s->first = 0;
+    if (s->kind != RC_TYPE_STRING && s->kind != RC_TYPE_DICT && s->aux)
+        return yona_bin_fail(r, "Std\\Binary: corrupt node header");
+    int64_t n = room ? s->p[0] : -1;
+    switch ((int)s->kind) {
+        case RC_TYPE_STRING:
+            if ((uint64_t)s->aux >= r->size - off || r->data[off + (size_t)s->aux])
+                return yona_bin_fail(r, "Std\\Binary: truncated string");
+            return 1;
+        case RC_TYPE_BYTE_ARRAY:
+            if (n < 0 || (uint64_t)n > r->size - off - 8)
+                return yona_bin_fail(r, "Std\\Binary: truncated byte array");
+            return 1;
+        case RC_TYPE_INT_ARRAY:
+        case RC_TYPE_FLOAT_ARRAY:
+            if (n < 0 || (uint64_t)n > room - 1)
+                return yona_bin_fail(r, "Std\\Binary: truncated array");
+            return 1;
+        case RC_TYPE_SEQ:
+            if (room < 2 || n < 0 || (uint64_t)n > room - 2 || (uint64_t)s->p[1] > 1)
+                return yona_bin_fail(r, "Std\\Binary: corrupt sequence");
+            s->nslots = n;
+            s->first = 2;
+            return 1;
+        case RC_TYPE_ADT:
+            if (room < ADT_HDR_SIZE || s->p[1] < 0 || (uint64_t)s->p[1] > room - ADT_HDR_SIZE)
+                return yona_bin_fail(r, "Std\\Binary: corrupt ADT");
+            s->nslots = s->p[1];
+            s->first = ADT_HDR_SIZE;
+            return 1;
+        case RC_TYPE_TUPLE:
+            if (room < 2 || n < 0 || (uint64_t)n > room - 2)
+                return yona_bin_fail(r, "Std\\Binary: corrupt tuple");
+            s->nslots = n;
+            s->first = 2;
+            return 1;
+        case RC_TYPE_DICT: {
+            int64_t width = (s->aux << 16) & HAMT_FLAG_IS_SET ? 1 : 2;
+            if ((s->aux << 16) & ~(HAMT_FLAG_KEY_HEAP | HAMT_FLAG_VAL_HEAP | HAMT_FLAG_IS_SET))
+                return yona_bin_fail(r, "Std\\Binary: corrupt dictionary");
+            if (n < 0 || (uint64_t)n > (room - 1) / (uint64_t)width)
+                return yona_bin_fail(r, "Std\\Binary: corrupt dictionary");
+            s->nslots = n * width;
+            s->first = 1;
+            return 1;
+        }
+        default:
+            return yona_bin_fail(r, "Std\\Binary: unknown node type");
+    }
+}
+
+static int yona_bin_slot_is_heap(const yona_bin_shape_t* s, int64_t i) {
+    switch ((int)s->kind) {
+        case RC_TYPE_SEQ: return s->p[1] != 0;
+        case RC_TYPE_ADT: return i < 64 && (s->p[2] & ((int64_t)1 << i));
+        case RC_TYPE_TUPLE: return i < 64 && (s->p[1] & ((int64_t)1 << i));
+        case RC_TYPE_DICT: {
+            int64_t flags = s->aux << 16;
+            if ((flags & HAMT_FLAG_IS_SET) || !(i & 1)) return (flags & HAMT_FLAG_KEY_HEAP) != 0;
+            return (flags & HAMT_FLAG_VAL_HEAP) != 0;
+        }
+        default: return 0;
+    }
+}
+
+/* Slot i as a runtime value: heap slots resolve to their decoded child
+ * with a new reference. */
+static int64_t yona_bin_slot(yona_bin_reader_t* r, const yona_bin_shape_t* s, int64_t i) {
+    int64_t v = s->p[s->first + i];
+    if (!yona_bin_slot_is_heap(s, i) || !v) return v;
+    int64_t d = yona_bin_map_get(&r->done, (uint64_t)v);
+    yona_rt_rc_inc((void*)(intptr_t)d);
+    return d;
+}
+
+/* Dict and Set keys that are strings are interned (HAMT compares keys by
+ * pointer). Consumes k. */
+static int64_t yona_bin_key(int64_t k, int heap) {
+    if (!heap || !k) return k;
+    const char* s = (const char*)(intptr_t)k;
+    if (DECODE_TAG(((const int64_t*)s)[-1]) != RC_TYPE_STRING) return k;
+    const char* canon = yona_intern_bytes(s, (size_t)yona_rt_string_length_fast(s));
+    yona_rt_rc_dec((void*)s);
+    return (int64_t)(intptr_t)canon;
+}
+
+/* Build the runtime value for a node whose heap children are decoded. */
+static int64_t yona_bin_build(yona_bin_reader_t* r, const yona_bin_shape_t* s) {
+    const int64_t* p = s->p;
+    switch ((int)s->kind) {
+        case RC_TYPE_STRING: {
+            if (r->zero_copy) return (int64_t)(intptr_t)p;
+            size_t len = (size_t)s->aux;
+            char* out = (char*)yona_rt_rc_alloc_string_len(len + 1, len);
+            memcpy(out, p, len + 1);
+            return (int64_t)(intptr_t)out;
+        }
+        case RC_TYPE_BYTE_ARRAY: {
+            if (r->zero_copy) return (int64_t)(intptr_t)p;
+            int64_t* out = (int64_t*)yona_rt_byte_array_alloc(p[0]);
+            memcpy(out + 1, p + 1, (size_t)p[0]);
+            return (int64_t)(intptr_t)out;
+        }
+        case RC_TYPE_INT_ARRAY:
+        case RC_TYPE_FLOAT_ARRAY: {
+            if (r->zero_copy) return (int64_t)(intptr_t)p;
+            int64_t* out = s->kind == RC_TYPE_INT_ARRAY ? yona_rt_int_array_alloc(p[0])
+                                                        : (int64_t*)yona_rt_float_array_alloc(p[0]);
+            memcpy(out + 1, p + 1, (size_t)p[0] * sizeof(int64_t));
+            return (int64_t)(intptr_t)out;
+        }
+        case RC_TYPE_SEQ: {
+            int64_t* out = yona_rt_seq_alloc(s->nslots);
+            yona_rt_seq_set_heap(out, p[1]);
+            for (int64_t i = 0; i < s->nslots; i++)
+                out[SEQ_HDR_SIZE + i] = yona_bin_slot(r, s, i);
+            return (int64_t)(intptr_t)out;
+        }
+        case RC_TYPE_ADT: {
+            int64_t* out = (int64_t*)yona_rt_adt_alloc(p[0], s->nslots);
+            out[2] = p[2];
+            for (int64_t i = 0; i < s->nslots; i++)
+                out[ADT_HDR_SIZE + i] = yona_bin_slot(r, s, i);
+            return (int64_t)(intptr_t)out;
+        }
+        case RC_TYPE_TUPLE: {
+            int64_t* out = (int64_t*)yona_rt_tuple_alloc(s->nslots);
+            out[1] = p[1];
+            for (int64_t i = 0; i < s->nslots; i++)
+                out[2 + i] = yona_bin_slot(r, s, i);
+            return (int64_t)(intptr_t)out;
+        }
+        case RC_TYPE_DICT: {
+            int64_t flags = s->aux << 16;
+            int as_set = (flags & HAMT_FLAG_IS_SET) != 0;
+            int key_heap = (flags & HAMT_FLAG_KEY_HEAP) != 0;
+            hamt_node_t* h = yona_rt_hamt_empty();
+            hamt_or_aux_flags(h, flags);
+            for (int64_t i = 0; i < s->nslots; i += as_set ? 1 : 2) {
+                int64_t k = yona_bin_key(yona_bin_slot(r, s, i), key_heap);
+                int64_t v = as_set ? 1 : yona_bin_slot(r, s, i + 1);
+                hamt_node_t* next = yona_rt_hamt_put(h, k, v);
+                if (next != h) yona_rt_rc_dec(h);
+                h = next;
+            }
+            return (int64_t)(intptr_t)h;
+        }
+    }
+    return 0;
+}
+
+/* Push the node at `off`, already shaped into *s, on the reader's stack. */
+static void yona_bin_push(yona_bin_reader_t* r, uint64_t off, const yona_bin_shape_t* s) {
+    if (r->sp == r->cap) {
+        r->cap = r->cap ? r->cap * 2 : 64;
+        r->stack = (yona_bin_frame_t*)realloc(r->stack, r->cap * sizeof(yona_bin_frame_t));
+    }
+    r->stack[r->sp].s = *s;
+    r->stack[r->sp].off = off;
+    r->stack[r->sp].next = 0;
+    r->sp++;
+}
+
+/* Check the node at `off` and everything it references: offsets, lengths,
+ * tags and cycles. Each node is checked once and marked VALID. */
+static int yona_bin_validate(yona_bin_reader_t* r, uint64_t off) {
+    yona_bin_shape_t s;
+    if (yona_bin_map_get(&r->done, off)) return 1;
+    if (!yona_bin_shape(r, off, &s)) return 0;
+    yona_bin_map_put(&r->done, off, YONA_BIN_PENDING);
+    r->sp = 0;
+    yona_bin_push(r, off, &s);
+    while (r->sp) {
+        yona_bin_frame_t* f = &r->stack[r->sp - 1];
+        int pushed = 0;
+        for (int64_t i = f->next; i < f->s.nslots; i++) {
+            if (!yona_bin_slot_is_heap(&f->s, i)) continue;
+            uint64_t c = (uint64_t)f->s.p[f->s.first + i];
+            if (!c) continue;
+            int64_t state = yona_bin_map_get(&r->done, c);
+            if (state == YONA_BIN_PENDING) return yona_bin_fail(r, "Std\\Binary: cyclic reference");
+            if (state) continue;
+            if (!yona_bin_shape(r, c, &s)) return 0;
+            yona_bin_map_put(&r->done, c, YONA_BIN_PENDING);
+            f->next = i + 1;
+            yona_bin_push(r, c, &s);
+            pushed = 1;
+            break;
+        }
+        if (!pushed) yona_bin_map_put(&r->done, r->stack[--r->sp].off, YONA_BIN_VALID);
+    }
+    return 1;
+}
+
+/* Decode the validated heap value at `off` and whatever it references that
+ * is not decoded yet, children first. Returns a new reference. */
+static int64_t yona_bin_decode_ref(yona_bin_reader_t* r, uint64_t off) {
+    int64_t have = yona_bin_map_get(&r->done, off);
+    if (have == YONA_BIN_VALID) {
+        yona_bin_shape_t s;
+        yona_bin_shape(r, off, &s);
+        r->sp = 0;
+        yona_bin_push(r, off, &s);
+        while (r->sp) {
+            yona_bin_frame_t* f = &r->stack[r->sp - 1];
+            int pushed = 0;
+            for (int64_t i = f->next; i < f->s.nslots; i++) {
+                if (!yona_bin_slot_is_heap(&f->s, i)) continue;
+                uint64_t c = (uint64_t)f->s.p[f->s.first + i];
+                if (!c || yona_bin_map_get(&r->done, c) != YONA_BIN_VALID) continue;
+                yona_bin_shape(r, c, &s);
+                f->next = i + 1;
+                yona_bin_push(r, c, &s);
+                pushed = 1;
+                break;
+            }
+            if (pushed) continue;
+            f = &r->stack[--r->sp];
+            yona_bin_map_put(&r->done, f->off, yona_bin_build(r, &f->s));
+        }
+        have = yona_bin_map_get(&r->done, off);
+    }
+    yona_rt_rc_inc((void*)(intptr_t)have);
+    return have;
+}
+
+/* Does a decoded value have the kind a typed reader asked for? */
+static int yona_bin_kind_ok(int64_t v, int64_t kind) {
+    if (!v) return 0;
+    int64_t tw = ((const int64_t*)(intptr_t)v)[-1];
+    int64_t t = DECODE_TAG(tw);
+    if (kind == RC_TYPE_SET || kind == RC_TYPE_DICT) {
+        if (t != RC_TYPE_DICT) return 0;
+        return ((tw & HAMT_FLAG_IS_SET) != 0) == (kind == RC_TYPE_SET);
+    }
+    return t == kind;
+}
+
+#define YONA_BIN_ANY   (-2)   /* raw word or any heap value, as stored */
+#define YONA_BIN_WORD  (-1)   /* raw word only */
+
+/* ===== Messages ===== */
+
+/*
+ * A message is a buffer opened once for a whole decode (Std\Binary.open).
+ * Opening validates every node reachable from the root; field reads then
+ * only decode, and share one memo, so a node referenced from several
+ * fields is decoded once and handed out as one shared object. Leaf nodes
+ * of an immortal buffer are returned in place. Each thread keeps one
+ * spare message, so steady-state decoding does not allocate one.
+ */
+
+#define YONA_BIN_SPARE_MEMO (1 << 16)   /* larger memos are not kept */
+
+typedef struct {
+    yona_bin_reader_t r;
+    void* bytes;               /* held until close */
+    int64_t root;
+    int root_heap;
+    yona_bin_shape_t top;      /* root constructor; kind 0 if the root is no ADT */
+} yona_bin_message_t;
+
+static _Thread_local yona_bin_message_t* yona_bin_spare_message;
+
+/* Drop the message's references and keep it as the spare or free it. */
+static void yona_bin_release(yona_bin_message_t* m) {
+    yona_bin_map_t* done = &m->r.done;
+    for (size_t i = 0; i < done->cap; i++) {
+        int64_t v = done->vals[i];
+        if (done->keys[i] && v != YONA_BIN_PENDING && v != YONA_BIN_VALID)
+            yona_rt_rc_dec((void*)(intptr_t)v);
+    }
+    yona_rt_rc_dec(m->bytes);
+    if (!yona_bin_spare_message && done->cap <= YONA_BIN_SPARE_MEMO) {
+        yona_bin_spare_message = m;
+        return;
+    }
+    yona_bin_map_free(done);
+    free(m->r.stack);
+    free(m);
+}
+
+/* Release the message and raise its error. */
+static void yona_bin_raise(yona_bin_message_t* m) {
+    const char* err = m->r.err;
+    yona_bin_release(m);
+    yona_rt_raise(0, err);
+}
+
+static yona_bin_message_t* yona_bin_message(void* bytes) {
+    yona_bin_message_t* m = yona_bin_spare_message;
+    if (m) yona_bin_spare_message = NULL;
+    else m = (yona_bin_message_t*)calloc(1, sizeof(*m));
+    yona_rt_rc_inc(bytes);
+    m->bytes = bytes;
+    m->top.kind = 0;
+    if (yona_bin_open(&m->r, bytes)) {
+        m->root_heap = yona_bin_root_is_heap(&m->r);
+        m->root = yona_bin_root(&m->r);
+        if (m->root_heap && m->root && yona_bin_validate(&m->r, (uint64_t)m->root))
+            yona_bin_shape(&m->r, (uint64_t)m->root, &m->top);
+    }
+    if (m->r.err) yona_bin_raise(m);
+    return m;
+}
+
+/* Decode a stored value: the root (index < 0) or field `index` of a root
+ * ADT, checked against `kind` (an RC_TYPE_*, WORD or ANY). */
+static int64_t yona_bin_get(yona_bin_message_t* m, int64_t index, int64_t kind) {
+    int heap = m->root_heap;
+    int64_t word = m->root;
+    if (index >= 0) {
+        if (m->top.kind != RC_TYPE_ADT) {
+            yona_bin_fail(&m->r, "Std\\Binary: buffer does not hold a constructor");
+            yona_bin_raise(m);
+        }
+        if (index >= m->top.nslots) {
+            yona_bin_fail(&m->r, "Std\\Binary: field index out of range");
+            yona_bin_raise(m);
+        }
+        heap = yona_bin_slot_is_heap(&m->top, index);
+        word = m->top.p[m->top.first + index];
+    }
+    if (!heap || !word) {
+        if (heap ? kind == YONA_BIN_WORD : kind != YONA_BIN_WORD && kind != YONA_BIN_ANY) {
+            yona_bin_fail(&m->r, "Std\\Binary: value has a different type");
+            yona_bin_raise(m);
+        }
+        return word;
+    }
+    int64_t out = 0;
+    if (kind != YONA_BIN_WORD) out = yona_bin_decode_ref(&m->r, (uint64_t)word);
+    if (kind != YONA_BIN_ANY && !yona_bin_kind_ok(out, kind)) {
+        if (out) yona_rt_rc_dec((void*)(intptr_t)out);
+        yona_bin_fail(&m->r, "Std\\Binary: value has a different type");
+        yona_bin_raise(m);
+    }
+    return out;
+}
+
+/* Decode the root of a buffer, for the Prelude instances. */
+static int64_t yona_bin_read(void* bytes, int64_t kind) {
+    yona_bin_message_t* m = yona_bin_message(bytes);
+    int64_t out = yona_bin_get(m, -1, kind);
+    yona_bin_release(m);
+    return out;
+}
+
+/* Derived-encoder spec: "arity/heap/raw" per constructor, comma-separated
+ * and indexed by tag. heap and raw are the masks of fields whose declared
+ * type is, or is not, a heap type; fields of other types (type parameters,
+ * other ADTs) keep the bit the value carries. */
+static void yona_bin_spec(const char* spec, int64_t tag, int64_t* arity, int64_t* heap, int64_t* raw) {
+    *arity = *heap = -1;
+    *raw = 0;
+    for (int64_t t = 0; t < tag && spec; t++) {
+        spec = strchr(spec, ',');
+        if (spec) spec++;
+    }
+    if (!spec || !*spec) return;
+    char* end;
+    *arity = strtoll(spec, &end, 10);
+    if (*end == '/') *heap = strtoll(end + 1, &end, 10);
+    if (*end == '/') *raw = strtoll(end + 1, &end, 10);
+}
+
+/* ===== Std\Binary ===== */
+
+/* Encoder generated by `deriving Binary`. An empty spec means the type has
+ * only nullary constructors, whose values are plain tags. */
+void* yona_Std_Binary__encodeAdt(const char* spec, int64_t v) {
+    if (!spec[0]) return yona_bin_encode(v, 0, -1, -1);
+    const int64_t* p = (const int64_t*)(intptr_t)v;
+    int64_t arity, heap, raw;
+    yona_bin_spec(spec, p[0], &arity, &heap, &raw);
+    int64_t mask = heap < 0 ? -1 : (p[2] & ~raw) | heap;
+    return yona_bin_encode(v, 1, mask, arity);
+}
+
+/* open : ByteArray -> Int — validate a buffer once for a derived decoder */
+int64_t yona_Std_Binary__open(void* bytes) { return (int64_t)(intptr_t)yona_bin_message(bytes); }
+
+int64_t yona_Std_Binary__close(int64_t m) {
+    yona_bin_release((yona_bin_message_t*)(intptr_t)m);
+    return 0;
+}
+
+/* Constructor tag of the stored value: a plain word (nullary-only types)
+ * or the tag of the root ADT node. */
+int64_t yona_Std_Binary__tag(int64_t mh) {
+    yona_bin_message_t* m = (yona_bin_message_t*)(intptr_t)mh;
+    if (!m->root_heap) return m->root;
+    if (m->top.kind != RC_TYPE_ADT) {
+        yona_bin_fail(&m->r, "Std\\Binary: buffer does not hold a constructor");
+        yona_bin_raise(m);
+    }
+    return m->top.p[0];
+}
+
+#define YONA_BIN_FIELD(i, m, kind) yona_bin_get((yona_bin_message_t*)(intptr_t)(m), i, kind)
+
+/* Typed field readers used by derived decoders */
+int64_t yona_Std_Binary__fieldInt(int64_t i, int64_t m) { return YONA_BIN_FIELD(i, m, YONA_BIN_WORD); }
+int64_t yona_Std_Binary__fieldBool(int64_t i, int64_t m) { return YONA_BIN_FIELD(i, m, YONA_BIN_WORD) != 0; }
+double yona_Std_Binary__fieldFloat(int64_t i, int64_t m) {
+    int64_t w = YONA_BIN_FIELD(i, m, YONA_BIN_WORD);
+    double d;
+    memcpy(&d, &w, sizeof d);
+    return d;
+}
+const char* yona_Std_Binary__fieldString(int64_t i, int64_t m) {
+    return (const char*)(intptr_t)YONA_BIN_FIELD(i, m, RC_TYPE_STRING);
+}
+int64_t* yona_Std_Binary__fieldSeq(int64_t i, int64_t m) {
+    return (int64_t*)(intptr_t)YONA_BIN_FIELD(i, m, RC_TYPE_SEQ);
+}
+int64_t* yona_Std_Binary__fieldSet(int64_t i, int64_t m) {
+    return (int64_t*)(intptr_t)YONA_BIN_FIELD(i, m, RC_TYPE_SET);
+}
+int64_t* yona_Std_Binary__fieldDict(int64_t i, int64_t m) {
+    return (int64_t*)(intptr_t)YONA_BIN_FIELD(i, m, RC_TYPE_DICT);
+}
+int64_t* yona_Std_Binary__fieldIntArray(int64_t i, int64_t m) {
+    return (int64_t*)(intptr_t)YONA_BIN_FIELD(i, m, RC_TYPE_INT_ARRAY);
+}
+double* yona_Std_Binary__fieldFloatArray(int64_t i, int64_t m) {
+    return (double*)(intptr_t)YONA_BIN_FIELD(i, m, RC_TYPE_FLOAT_ARRAY);
+}
+void* yona_Std_Binary__fieldByteArray(int64_t i, int64_t m) {
+    return (void*)(intptr_t)YONA_BIN_FIELD(i, m, RC_TYPE_BYTE_ARRAY);
+}
+/* Any other field (ADTs, type parameters) exactly as stored */
+int64_t yona_Std_Binary__field(int64_t i, int64_t m) { return YONA_BIN_FIELD(i, m, YONA_BIN_ANY); }
+
+/* True if b starts with a Std\Binary header of a supported version. */
+int64_t yona_Std_Binary__isBinary(void* b) {
+    const int64_t* p = (const int64_t*)b;
+    if (p[0] < YONA_BIN_HDR) return 0;
+    const uint32_t* h = (const uint32_t*)(p + 1);
+    return h[0] == YONA_BIN_MAGIC && (h[1] & 0xFFFF) == YONA_BIN_VERSION;
+}
+
+/* Map a file as an immortal ByteArray. Decoding it returns strings and
+ * arrays that point into the mapping, which stays for the process. */
+void* yona_Std_Binary__mapFile(const char* path) {
+    void* bytes = yona_platform_map_file_bytes(path);
+    if (!bytes) yona_rt_raise(0, "Std\\Binary: cannot map file");
+    return bytes;
+}
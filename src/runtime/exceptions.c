@@ -228,6 +228,62 @@ void yona_rt_raise(int64_t symbol, const char* message) {
 #endif
 }
 
+/* Green threads (async_posix.c) park a task with its try blocks, frame
+ * chain and arena bindings still live, and the worker goes on running other
+ * tasks on the same thread-locals. Parking moves the task's slice into a
+ * buffer on its own fiber stack and leaves the thread with an empty state;
+ * unparking puts it back. The jmp buffers hold fiber-stack addresses, which
+ * stay valid because a fiber resumes on the stack it parked on. */
+typedef struct {
+    int depth;
+    int arena_sp;
+    yona_exception_t current;
+    yona_frame_t* frame;
+} yona_exc_park_hdr_t;
+
+static size_t yona_exc_park_size(void) {
+    return sizeof(yona_exc_park_hdr_t) +
+           (size_t)yona_exc.depth * (sizeof(yona_sjlj_buf_t) + sizeof(yona_frame_t*)) +
+           (size_t)yona_group_arena_sp * sizeof(yona_group_arena_bind_t);
+}
+
+static void yona_exc_park(void* save) {
+    yona_exc_park_hdr_t* h = (yona_exc_park_hdr_t*)save;
+    h->depth = yona_exc.depth;
+    h->arena_sp = yona_group_arena_sp;
+    h->current = yona_exc.current;
+    h->frame = yona_current_frame;
+    char* p = (char*)(h + 1);
+    size_t n = (size_t)h->depth * sizeof(yona_sjlj_buf_t);
+    memcpy(p, yona_exc.buf, n);
+    p += n;
+    n = (size_t)h->depth * sizeof(yona_frame_t*);
+    memcpy(p, yona_exc.saved_frame, n);
+    p += n;
+    memcpy(p, yona_group_arena_stack, (size_t)h->arena_sp * sizeof(yona_group_arena_bind_t));
+    yona_exc.depth = 0;
+    yona_try_depth = 0;
+    yona_group_arena_sp = 0;
+    yona_current_frame = NULL;
+}
+
+static void yona_exc_unpark(const void* save) {
+    const yona_exc_park_hdr_t* h = (const yona_exc_park_hdr_t*)save;
+    const char* p = (const char*)(h + 1);
+    size_t n = (size_t)h->depth * sizeof(yona_sjlj_buf_t);
+    memcpy(yona_exc.buf, p, n);
+    p += n;
+    n = (size_t)h->depth * sizeof(yona_frame_t*);
+    memcpy(yona_exc.saved_frame, p, n);
+    p += n;
+    memcpy(yona_group_arena_stack, p, (size_t)h->arena_sp * sizeof(yona_group_arena_bind_t));
+    yona_exc.depth = h->depth;
+    yona_try_depth = h->depth;
+    yona_group_arena_sp = h->arena_sp;
+    yona_exc.current = h->current;
+    yona_current_frame = h->frame;
+}
+
 int64_t yona_rt_get_exception_symbol(void) {
     return yona_exc.current.symbol;
 }
@@ -0,0 +1,225 @@
+/*
+ * Interned strings for Std\String.intern and compiled string literals.
+ *
+ * #included from compiled_runtime.c (not compiled as a separate TU).
+ *
+ * An interned string is immortal and unique per content, so two interned
+ * strings are equal iff their pointers are equal. Layout adds one word in
+ * front of the usual RC header:
+ *
+ *   [hash: int64_t][refcount = RC_ARENA_SENTINEL][tag | RC_STRING_INTERNED | len << 16][bytes]
+ *                                                                                        ^-- returned pointer
+ *
+ * hash is FNV-1a over all len bytes (embedded NULs included), identical to
+ * Hash_String, so interned and plain strings with the same content hash the
+ * same in a Dict or Set.
+ * Bit 15 of the tag word is free: pool classes only use bits 8-10, and the
+ * pool class of an immortal string is never consulted.
+ *
+ * Short literals are emitted by codegen in this layout under a linkonce
+ * symbol named after their content, so the linker keeps one copy per
+ * program. Each module registers its literals from a global constructor;
+ * registration only queues the array, and the queue is folded into the
+ * table on the first yona_rt_string_intern call, or the first Eq between
+ * two strings flagged as interned. Programs that never intern at runtime
+ * pay one list push per module.
+ *
+ * The table is split into shards by hash, each an open-addressing array
+ * guarded by its own spinlock. Entries are never removed.
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RC_STRING_INTERNED (1LL << 15)
+
+#define YONA_INTERN_SHARDS 64
+#define YONA_INTERN_INIT_CAP 64
+
+typedef struct {
+    atomic_flag lock;
+    size_t count;
+    size_t cap;          /* power of two, 0 until first insert */
+    const char** slots;
+} yona_intern_shard_t;
+
+static yona_intern_shard_t yona_intern_shards[YONA_INTERN_SHARDS] = {
+#define YONA_INTERN_SHARD_INIT {ATOMIC_FLAG_INIT, 0, 0, NULL}
+#define YONA_INTERN_SHARD_INIT8 YONA_INTERN_SHARD_INIT, YONA_INTERN_SHARD_INIT, \
+    YONA_INTERN_SHARD_INIT, YONA_INTERN_SHARD_INIT, YONA_INTERN_SHARD_INIT, \
+    YONA_INTERN_SHARD_INIT, YONA_INTERN_SHARD_INIT, YONA_INTERN_SHARD_INIT
+    YONA_INTERN_SHARD_INIT8, YONA_INTERN_SHARD_INIT8, YONA_INTERN_SHARD_INIT8, YONA_INTERN_SHARD_INIT8,
+    YONA_INTERN_SHARD_INIT8, YONA_INTERN_SHARD_INIT8, YONA_INTERN_SHARD_INIT8, YONA_INTERN_SHARD_INIT8,
+#undef YONA_INTERN_SHARD_INIT8
+#undef YONA_INTERN_SHARD_INIT
+};
+
+/* Literal arrays registered by module constructors, not yet in the table */
+typedef struct yona_intern_pending {
+    struct yona_intern_pending* next;
+    const char** lits;
+    int64_t count;
+} yona_intern_pending_t;
+
+static _Atomic(yona_intern_pending_t*) yona_intern_pending = NULL;
+/* Held while a pending list is folded in; `draining` lets a concurrent
+ * yona_rt_string_intern see a drain in progress after the list is taken. */
+static atomic_flag yona_intern_drain_lock = ATOMIC_FLAG_INIT;
+static _Atomic int yona_intern_draining = 0;
+
+static inline uint64_t yona_str_fnv1a(const char* s, size_t len) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ (uint64_t)(unsigned char)s[i]) * 1099511628211ULL;
+    return h;
+}
+
+/* True for strings created by yona_rt_string_intern or emitted as
+ * interned literals. Only immortal string headers are inspected. */
+static inline int yona_str_is_interned(const char* s) {
+    const int64_t* header = ((const int64_t*)s) - RC_HEADER_SIZE;
+    return header[0] == RC_ARENA_SENTINEL &&
+           (header[1] & (0xFF | RC_STRING_INTERNED)) == (RC_TYPE_STRING | RC_STRING_INTERNED);
+}
+
+static inline uint64_t yona_str_interned_hash(const char* s) {
+    return (uint64_t)(((const int64_t*)s)[-RC_HEADER_SIZE - 1]);
+}
+
+static void yona_intern_lock(yona_intern_shard_t* sh) {
+    while (atomic_flag_test_and_set_explicit(&sh->lock, memory_order_acquire)) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+}
+
+static void yona_intern_unlock(yona_intern_shard_t* sh) {
+    atomic_flag_clear_explicit(&sh->lock, memory_order_release);
+}
+
+/* Find `s` (len bytes, hash h) in a locked shard. Returns the slot index
+ * holding it, or the empty slot where it would go. */
+static size_t yona_intern_probe(const yona_intern_shard_t* sh, const char* s,
+                                size_t len, uint64_t h) {
+    size_t mask = sh->cap - 1;
+    /* Low bits picked the shard; probe with the rest */
+    size_t i = (size_t)(h >> 6) & mask;
+    for (;;) {
+        const char* e = sh->slots[i];
+        if (!e) return i;
+        if (yona_str_interned_hash(e) == h &&
+            DECODE_STRING_LEN(((const int64_t*)e)[-1]) == len &&
+            memcmp(e, s, len) == 0)
+            return i;
+        i = (i + 1) & mask;
+    }
+}
+
+static void yona_intern_grow(yona_intern_shard_t* sh) {
+    size_t old_cap = sh->cap;
+    const char** old = sh->slots;
+    sh->cap = old_cap ? old_cap * 2 : YONA_INTERN_INIT_CAP;
+    sh->slots = (const char**)calloc(sh->cap, sizeof(const char*));
+    for (size_t i = 0; i < old_cap; i++) {
+        const char* e = old[i];
+        if (!e) continue;
+        size_t j = (size_t)(yona_str_interned_hash(e) >> 6) & (sh->cap - 1);
+        while (sh->slots[j]) j = (j + 1) & (sh->cap - 1);
+        sh->slots[j] = e;
+    }
+    free(old);
+}
+
+/* Look up s in the table and insert it if absent: a literal (already in
+ * interned layout) goes in as is, anything else is copied first. */
+static const char* yona_intern_insert(const char* s, size_t len, uint64_t h, int is_literal) {
+    yona_intern_shard_t* sh = &yona_intern_shards[h & (YONA_INTERN_SHARDS - 1)];
+    yona_intern_lock(sh);
+    if ((sh->count + 1) * 2 > sh->cap) yona_intern_grow(sh);
+    size_t i = yona_intern_probe(sh, s, len, h);
+    const char* e = sh->slots[i];
+    if (!e) {
+        if (is_literal) {
+            e = s;
+        } else {
+            int64_t* raw = (int64_t*)malloc((RC_HEADER_SIZE + 1) * sizeof(int64_t) + len + 1);
+            raw[0] = (int64_t)h;
+            raw[1] = RC_ARENA_SENTINEL;
+            raw[2] = RC_TYPE_STRING | RC_STRING_INTERNED | ((int64_t)len << 16);
+            char* copy = (char*)(raw + RC_HEADER_SIZE + 1);
+            memcpy(copy, s, len);
+            copy[len] = '\0';
+            e = copy;
+        }
+        sh->slots[i] = e;
+        sh->count++;
+    }
+    yona_intern_unlock(sh);
+    return e;
+}
+
+static void yona_intern_drain_pending(void) {
+    while (atomic_flag_test_and_set_explicit(&yona_intern_drain_lock, memory_order_acquire)) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    atomic_store(&yona_intern_draining, 1);
+    yona_intern_pending_t* p = atomic_exchange(&yona_intern_pending, NULL);
+    while (p) {
+        for (int64_t k = 0; k < p->count; k++) {
+            const char* lit = p->lits[k];
+            size_t len = DECODE_STRING_LEN(((const int64_t*)lit)[-1]);
+            const char* canon = yona_intern_insert(lit, len, yona_str_interned_hash(lit), 1);
+            /* Only possible if a module was loaded after runtime interning
+             * already made a copy: demote the literal to a plain string so
+             * the pointer-equality shortcut stays sound. */
+            if (canon != lit) ((int64_t*)lit)[-1] &= ~RC_STRING_INTERNED;
+        }
+        yona_intern_pending_t* next = p->next;
+        free(p);
+        p = next;
+    }
+    atomic_store(&yona_intern_draining, 0);
+    atomic_flag_clear_explicit(&yona_intern_drain_lock, memory_order_release);
+}
+
+/* Fold any queued literals into the table. Until this has run, a queued
+ * literal can carry RC_STRING_INTERNED while the table holds a different
+ * copy of the same content, so pointer inequality proves nothing. */
+static inline void yona_intern_settle(void) {
+    if (__builtin_expect(atomic_load(&yona_intern_pending) != NULL ||
+                         atomic_load(&yona_intern_draining), 0))
+        yona_intern_drain_pending();
+}
+
+/* Public: called from each compiled module's global constructor with the
+ * module's interned literals. */
+void yona_rt_intern_register(const char** lits, int64_t count) {
+    if (count <= 0) return;
+    yona_intern_pending_t* p = (yona_intern_pending_t*)malloc(sizeof(yona_intern_pending_t));
+    p->lits = lits;
+    p->count = count;
+    p->next = atomic_load_explicit(&yona_intern_pending, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&yona_intern_pending, &p->next, p,
+                                                  memory_order_release, memory_order_relaxed))
+        ;
+}
+
+/* Canonical interned copy of the len bytes at s, which need not be a
+ * Yona string or NUL-terminated (used by the JSON parser for keys). */
+static const char* yona_intern_bytes(const char* s, size_t len) {
+    yona_intern_settle();
+    return yona_intern_insert(s, len, yona_str_fnv1a(s, len), 0);
+}
+
+/* Public: return the canonical interned copy of s. The result is immortal;
+ * rc_inc/rc_dec on it are no-ops. */
+const char* yona_rt_string_intern(const char* s) {
+    yona_intern_settle();
+    if (yona_str_is_interned(s)) return s;
+    return yona_intern_bytes(s, (size_t)yona_rt_string_length_fast(s));
+}
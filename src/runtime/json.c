@@ -0,0 +1,1228 @@
+/*
+ * JSON parser for Std\Json.
+ *
+ * #included from compiled_runtime.c (not compiled as a separate TU).
+ *
+ * Two stages, after simdjson (Langdale & Lemire, "Parsing Gigabytes of
+ * JSON per Second"):
+ *
+ *   Stage 1 classifies 64-byte blocks with SIMD compares (SSE2, AVX2 picked
+ *   at runtime; scalar table elsewhere) into quote / backslash / operator /
+ *   whitespace bitmasks, removes escaped quotes, derives the in-string mask
+ *   with a prefix XOR, and emits the offsets of structural characters:
+ *   { } [ ] : , plus the first byte of every string and scalar.
+ *
+ *   Stage 2 walks those offsets. Stage 1 runs lazily, a batch of blocks at
+ *   a time, so a cursor that finds its answer early never indexes the rest
+ *   of the document and memory stays constant. A cursor holds one batch
+ *   of offsets (4 KiB) and lives on the caller's stack. Only the reader
+ *   behind derived decoders keeps a growing index.
+ *
+ * Tree mode (yona_Std_Json__parse) builds Json ADT nodes:
+ *
+ *   JNull | JBool Bool | JInt Int | JFloat Float | JString String
+ *   | JArray [Json] | JObject [String] [Json]
+ *
+ * using the recursive ADT layout [tag, num_fields, heap_mask, fields...].
+ * Integers that fit in 18 digits without a fraction or exponent become
+ * JInt; every other number is JFloat. Keys are plain strings: interning
+ * text from the document would grow the immortal intern table with
+ * whatever keys an untrusted input contains.
+ *
+ * On-demand mode (getString, getInt, getFloat, getBool, getRaw, has) follows
+ * a dotted path ("user.tags.0") over the structural offsets, skipping
+ * unwanted values by bracket depth without decoding them. The reader
+ * functions (reader, enter, seek, variant, finish) serve decoders
+ * generated by `deriving Json`.
+ *
+ * Malformed input raises with the byte offset of the problem.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JSON_TAG_NULL   0
+#define JSON_TAG_BOOL   1
+#define JSON_TAG_INT    2
+#define JSON_TAG_FLOAT  3
+#define JSON_TAG_STRING 4
+#define JSON_TAG_ARRAY  5
+#define JSON_TAG_OBJECT 6
+
+#define YONA_JSON_BATCH_BLOCKS 8
+#define YONA_JSON_MAX_DEPTH 1024
+
+/* ===== Stage 1: block classification ===== */
+
+typedef struct {
+    uint64_t quote, backslash, op, ws;
+} yona_json_block_t;
+
+/* 1 = operator, 2 = whitespace */
+static const uint8_t yona_json_class[256] = {
+    [' '] = 2, ['\t'] = 2, ['\n'] = 2, ['\r'] = 2,
+    ['{'] = 1, ['}'] = 1, ['['] = 1, [']'] = 1, [':'] = 1, [','] = 1,
+};
+
+#ifndef YONA_STR_SIMD_X86
+
+static void yona_json_classify_scalar(const uint8_t* p, yona_json_block_t* b) {
+    uint64_t q = 0, bs = 0, op = 0, ws = 0;
+    for (int i = 0; i < 64; i++) {
+        uint64_t bit = 1ULL << i;
+        uint8_t c = p[i], k = yona_json_class[c];
+        if (c == '"') q |= bit;
+        else if (c == '\\') bs |= bit;
+        else if (k == 1) op |= bit;
+        else if (k == 2) ws |= bit;
+    }
+    b->quote = q; b->backslash = bs; b->op = op; b->ws = ws;
+}
+
+#else
+
+static void yona_json_classify_sse2(const uint8_t* p, yona_json_block_t* b) {
+    const __m128i quote = _mm_set1_epi8('"'), bslash = _mm_set1_epi8('\\');
+    /* '{'|0x20 == '{' and '['|0x20 == '{'; likewise '}' and ']' */
+    const __m128i lower = _mm_set1_epi8(0x20);
+    const __m128i lbrace = _mm_set1_epi8('{'), rbrace = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':'), comma = _mm_set1_epi8(',');
+    const __m128i sp = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+    const __m128i nl = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+    uint64_t q = 0, bs = 0, op = 0, ws = 0;
+    for (int k = 0; k < 4; k++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + 16 * k));
+        __m128i vl = _mm_or_si128(v, lower);
+        __m128i o = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(vl, lbrace), _mm_cmpeq_epi8(vl, rbrace)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+        __m128i w = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, cr)));
+        int sh = 16 * k;
+        q  |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << sh;
+        bs |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, bslash)) << sh;
+        op |= (uint64_t)(uint16_t)_mm_movemask_epi8(o) << sh;
+        ws |= (uint64_t)(uint16_t)_mm_movemask_epi8(w) << sh;
+    }
+    b->quote = q; b->backslash = bs; b->op = op; b->ws = ws;
+}
+
+__attribute__((target("avx2")))
+static void yona_json_classify_avx2(const uint8_t* p, yona_json_block_t* b) {
+    const __m256i quote = _mm256_set1_epi8('"'), bslash = _mm256_set1_epi8('\\');
+    const __m256i lower = _mm256_set1_epi8(0x20);
+    const __m256i lbrace = _mm256_set1_epi8('{'), rbrace = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':'), comma = _mm256_set1_epi8(',');
+    const __m256i sp = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+    const __m256i nl = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+    uint64_t q = 0, bs = 0, op = 0, ws = 0;
+    for (int k = 0; k < 2; k++) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(p + 32 * k));
+        __m256i vl = _mm256_or_si256(v, lower);
+        __m256i o = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(vl, lbrace), _mm256_cmpeq_epi8(vl, rbrace)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma)));
+        __m256i w = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, sp), _mm256_cmpeq_epi8(v, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, nl), _mm256_cmpeq_epi8(v, cr)));
+        int sh = 32 * k;
+        q  |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)) << sh;
+        bs |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, bslash)) << sh;
+        op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(o) << sh;
+        ws |= (uint64_t)(uint32_t)_mm256_movemask_epi8(w) << sh;
+    }
+    b->quote = q; b->backslash = bs; b->op = op; b->ws = ws;
+}
+
+#endif /* YONA_STR_SIMD_X86 */
+
+static inline void yona_json_classify(const uint8_t* p, yona_json_block_t* b) {
+#ifdef YONA_STR_SIMD_X86
+    if (yona_str_simd() == 2) { yona_json_classify_avx2(p, b); return; }
+    yona_json_classify_sse2(p, b);
+#else
+    yona_json_classify_scalar(p, b);
+#endif
+}
+
+/* Bit i set iff an odd number of quote bits are at or below i */
+static inline uint64_t yona_json_prefix_xor(uint64_t x) {
+    x ^= x << 1; x ^= x << 2; x ^= x << 4;
+    x ^= x << 8; x ^= x << 16; x ^= x << 32;
+    return x;
+}
+
+/* Characters preceded by an odd-length run of backslashes (simdjson's
+ * find_escaped). *prev carries a run that crosses the block boundary. */
+static inline uint64_t yona_json_escaped(uint64_t bs, uint64_t* prev) {
+    const uint64_t even = 0x5555555555555555ULL;
+    bs &= ~*prev;
+    uint64_t follows = (bs << 1) | *prev;
+    uint64_t odd_starts = bs & ~even & ~follows;
+    uint64_t seq_even;
+    *prev = __builtin_add_overflow(odd_starts, bs, &seq_even) ? 1 : 0;
+    uint64_t invert = seq_even << 1;
+    return (even ^ invert) & follows;
+}
+
+/* ===== Stage 1 cursor ===== */
+
+typedef struct {
+    const char* buf;
+    size_t len;
+    size_t off;             /* next block to index */
+    uint64_t prev_escaped;  /* 1 if the last block ended mid backslash run */
+    uint64_t prev_in_str;   /* all ones if the last block ended inside a string */
+    uint64_t prev_scalar;   /* 1 if the last block ended inside a scalar */
+    size_t n, pos;          /* idx[pos..n) not consumed yet */
+    size_t* idx;            /* batch below, or a reader's growing index */
+    size_t cap;             /* capacity of a growing index, 0 for a batch */
+    /* error state for stage 2 */
+    const char* err;
+    size_t err_at;
+    size_t batch[YONA_JSON_BATCH_BLOCKS * 64];
+} yona_json_cursor_t;
+
+static void yona_json_index_block(yona_json_cursor_t* c, const uint8_t* p, size_t base) {
+    yona_json_block_t b;
+    yona_json_classify(p, &b);
+    uint64_t escaped = yona_json_escaped(b.backslash, &c->prev_escaped);
+    uint64_t quote = b.quote & ~escaped;
+    uint64_t in_str = yona_json_prefix_xor(quote) ^ c->prev_in_str;
+    c->prev_in_str = (uint64_t)((int64_t)in_str >> 63);
+    /* Inside a string plus its closing quote; the opening quote stays */
+    uint64_t str_tail = in_str ^ quote;
+    uint64_t scalar = ~(b.op | b.ws);
+    uint64_t nonquote_scalar = scalar & ~quote;
+    uint64_t follows_scalar = (nonquote_scalar << 1) | c->prev_scalar;
+    c->prev_scalar = nonquote_scalar >> 63;
+    uint64_t structural = (b.op | (scalar & ~follows_scalar)) & ~str_tail;
+    while (structural) {
+        c->idx[c->n++] = base + (size_t)__builtin_ctzll(structural);
+        structural &= structural - 1;
+    }
+}
+
+/* Index the next batch of blocks. A batch cursor overwrites the previous
+ * batch; a growing one (derived decoders, which seek back) appends. */
+static void yona_json_refill(yona_json_cursor_t* c) {
+    if (!c->cap) c->n = c->pos = 0;
+    while (c->n == c->pos && c->off < c->len) {
+        if (c->cap && c->cap - c->n < YONA_JSON_BATCH_BLOCKS * 64) {
+            c->cap *= 2;
+            c->idx = (size_t*)realloc(c->idx, c->cap * sizeof(size_t));
+        }
+        for (int blk = 0; blk < YONA_JSON_BATCH_BLOCKS && c->off < c->len; blk++) {
+            size_t base = c->off;
+            if (c->len - base >= 64) {
+                yona_json_index_block(c, (const uint8_t*)c->buf + base, base);
+            } else {
+                uint8_t tail[64];
+                memset(tail, ' ', sizeof(tail));
+                memcpy(tail, c->buf + base, c->len - base);
+                yona_json_index_block(c, tail, base);
+            }
+            c->off = base + 64 < c->len ? base + 64 : c->len;
+        }
+    }
+}
+
+static void yona_json_cursor_init(yona_json_cursor_t* c, const char* s) {
+    memset(c, 0, offsetof(yona_json_cursor_t, batch));
+    c->idx = c->batch;
+    c->buf = s;
+    c->len = (size_t)yona_rt_string_length_fast(s);
+    c->err = NULL;
+}
+
+/* Offset of the next structural character, or len at end of input */
+static inline size_t yona_json_peek(yona_json_cursor_t* c) {
+    if (c->pos == c->n) {
+        yona_json_refill(c);
+        if (c->pos == c->n) return c->len;
+    }
+    return c->idx[c->pos];
+}
+
+static inline size_t yona_json_next(yona_json_cursor_t* c) {
+    size_t at = yona_json_peek(c);
+    if (at < c->len) c->pos++;
+    return at;
+}
+
+static inline int yona_json_at(const yona_json_cursor_t* c, size_t at) {
+    return at < c->len ? (unsigned char)c->buf[at] : -1;
+}
+
+static void* yona_json_fail(yona_json_cursor_t* c, const char* what, size_t at) {
+    if (!c->err) { c->err = what; c->err_at = at; }
+    return NULL;
+}
+
+/* Raises a parse error. yona_rt_raise keeps the message pointer, hence
+ * the thread-local buffer. */
+static void yona_json_raise_at(const char* what, size_t at) {
+    static _Thread_local char msg[96];
+    snprintf(msg, sizeof(msg), "invalid JSON: %s at byte %zu", what, at);
+    yona_rt_raise(0, msg);
+}
+
+static void yona_json_raise(yona_json_cursor_t* c) { yona_json_raise_at(c->err, c->err_at); }
+
+/* ===== Scalars ===== */
+
+static inline int yona_json_is_delim(int ch) {
+    return ch < 0 || yona_json_class[(unsigned char)ch] != 0;
+}
+
+/* Validate the JSON number grammar at `at`. Returns its end offset, or 0
+ * on error; *is_int says whether it has no fraction or exponent. */
+static size_t yona_json_number_end(const yona_json_cursor_t* c, size_t at, int* is_int) {
+    const char* s = c->buf;
+    size_t i = at, n = c->len;
+    *is_int = 1;
+    if (i < n && s[i] == '-') i++;
+    if (i >= n || (unsigned)(s[i] - '0') > 9) return 0;
+    if (s[i] == '0') i++;
+    else while (i < n && (unsigned)(s[i] - '0') <= 9) i++;
+    if (i < n && s[i] == '.') {
+        *is_int = 0;
+        i++;
+        if (i >= n || (unsigned)(s[i] - '0') > 9) return 0;
+        while (i < n && (unsigned)(s[i] - '0') <= 9) i++;
+    }
+    if (i < n && (s[i] == 'e' || s[i] == 'E')) {
+        *is_int = 0;
+        i++;
+        if (i < n && (s[i] == '+' || s[i] == '-')) i++;
+        if (i >= n || (unsigned)(s[i] - '0') > 9) return 0;
+        while (i < n && (unsigned)(s[i] - '0') <= 9) i++;
+    }
+    if (!yona_json_is_delim(yona_json_at(c, i))) return 0;
+    return i;
+}
+
+/* Truncate a float to an Int. Returns 0, leaving *out alone, for NaN and
+ * values outside the Int range, where the cast is undefined. */
+static int yona_json_f64_to_i64(double d, int64_t* out) {
+    if (!(d >= -9223372036854775808.0 && d < 9223372036854775808.0)) return 0;
+    *out = (int64_t)d;
+    return 1;
+}
+
+/* 1 if buf[at..] is exactly `word` followed by a delimiter */
+static int yona_json_word(const yona_json_cursor_t* c, size_t at, const char* word, size_t wlen) {
+    return c->len - at >= wlen && memcmp(c->buf + at, word, wlen) == 0 &&
+           yona_json_is_delim(yona_json_at(c, at + wlen));
+}
+
+/* ===== Strings ===== */
+
+static int yona_json_hex4(const char* p, uint32_t* out) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        char h = p[i];
+        v <<= 4;
+        if (h >= '0' && h <= '9') v |= (uint32_t)(h - '0');
+        else if (h >= 'a' && h <= 'f') v |= (uint32_t)(h - 'a' + 10);
+        else if (h >= 'A' && h <= 'F') v |= (uint32_t)(h - 'A' + 10);
+        else return 0;
+    }
+    *out = v;
+    return 1;
+}
+
+static size_t yona_json_utf8(char* w, uint32_t cp) {
+    if (cp < 0x80) { w[0] = (char)cp; return 1; }
+    if (cp < 0x800) {
+        w[0] = (char)(0xC0 | (cp >> 6)); w[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        w[0] = (char)(0xE0 | (cp >> 12)); w[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        w[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    w[0] = (char)(0xF0 | (cp >> 18)); w[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    w[2] = (char)(0x80 | ((cp >> 6) & 0x3F)); w[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/* Offset of the first byte below 0x20 in p[0..n), or n. Eight bytes at a
+ * time: (x - 0x20..) & ~x & 0x80.. is nonzero iff some byte is < 0x20. */
+static size_t yona_json_find_ctrl(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x;
+        memcpy(&x, p + i, 8);
+        if ((x - 0x2020202020202020ULL) & ~x & 0x8080808080808080ULL) break;
+    }
+    for (; i < n; i++)
+        if ((unsigned char)p[i] < 0x20) return i;
+    return n;
+}
+
+/* Find the closing quote of the string whose opening quote is at `at`.
+ * Returns its offset (or 0 on error); *has_escape is set if any backslash
+ * occurs inside. Raw control characters are an error (RFC 8259 requires
+ * them escaped), matching the strictness on lone surrogates. */
+static size_t yona_json_string_end(yona_json_cursor_t* c, size_t at, int* has_escape) {
+    const char* s = c->buf;
+    const char* end = s + c->len;
+    const char* p = s + at + 1;
+    *has_escape = 0;
+    for (;;) {
+        const char* q = (const char*)memchr(p, '"', (size_t)(end - p));
+        if (!q) { yona_json_fail(c, "unterminated string", at); return 0; }
+        const char* b = (const char*)memchr(p, '\\', (size_t)(q - p));
+        const char* stop = b ? b : q;
+        size_t ctl = yona_json_find_ctrl(p, (size_t)(stop - p));
+        if (p + ctl < stop) {
+            yona_json_fail(c, "control character in string", (size_t)(p + ctl - s));
+            return 0;
+        }
+        if (!b) return (size_t)(q - s);
+        *has_escape = 1;
+        /* Skip the escape pair and keep looking */
+        p = b + 2;
+        if (p >= end) { yona_json_fail(c, "unterminated string", at); return 0; }
+    }
+}
+
+/* Decode the string body [at+1, close) into an RC string. */
+static char* yona_json_decode_string(yona_json_cursor_t* c, size_t at, size_t close, int has_escape) {
+    const char* src = c->buf + at + 1;
+    size_t n = close - at - 1;
+    if (!has_escape) {
+        char* r = (char*)yona_rt_rc_alloc_string_len(n + 1, n);
+        memcpy(r, src, n);
+        r[n] = '\0';
+        return r;
+    }
+    /* Decoded text is never longer than the escaped source */
+    char* r = (char*)yona_rt_rc_alloc_string_len(n + 1, n);
+    char* w = r;
+    const char* p = src;
+    const char* e = src + n;
+    while (p < e) {
+        const char* b = (const char*)memchr(p, '\\', (size_t)(e - p));
+        if (!b) { memcpy(w, p, (size_t)(e - p)); w += e - p; break; }
+        memcpy(w, p, (size_t)(b - p));
+        w += b - p;
+        p = b + 1;
+        switch (*p++) {
+            case '"':  *w++ = '"';  break;
+            case '\\': *w++ = '\\'; break;
+            case '/':  *w++ = '/';  break;
+            case 'b':  *w++ = '\b'; break;
+            case 'f':  *w++ = '\f'; break;
+            case 'n':  *w++ = '\n'; break;
+            case 'r':  *w++ = '\r'; break;
+            case 't':  *w++ = '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (e - p < 4 || !yona_json_hex4(p, &cp)) goto bad;
+                p += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    uint32_t lo;
+                    if (e - p < 6 || p[0] != '\\' || p[1] != 'u' || !yona_json_hex4(p + 2, &lo) ||
+                        lo < 0xDC00 || lo > 0xDFFF)
+                        goto bad;
+                    p += 6;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    goto bad;
+                }
+                w += yona_json_utf8(w, cp);
+                break;
+            }
+            default:
+                goto bad;
+        }
+    }
+    *w = '\0';
+    /* Fix the stored length now that escapes have been folded */
+    {
+        int64_t* header = ((int64_t*)r) - RC_HEADER_SIZE;
+        size_t len = (size_t)(w - r);
+        header[1] = (header[1] & 0xFFFF) | ((int64_t)len << 16);
+    }
+    return r;
+bad:
+    yona_rt_rc_dec(r);
+    return yona_json_fail(c, "invalid escape", (size_t)(p - c->buf) - 1);
+}
+
+/* ===== Tree mode ===== */
+
+/* JNull is a shared immortal node */
+static int64_t yona_json_null_node[RC_HEADER_SIZE + ADT_HDR_SIZE] = {
+    RC_ARENA_SENTINEL, RC_TYPE_ADT, JSON_TAG_NULL, 0, 0,
+};
+#define YONA_JSON_NULL ((int64_t*)(yona_json_null_node + RC_HEADER_SIZE))
+
+static int64_t* yona_json_node(int64_t tag, int64_t num_fields, int64_t heap_mask) {
+    int64_t* node = (int64_t*)yona_rt_adt_alloc(tag, num_fields);
+    node[2] = heap_mask;
+    return node;
+}
+
+/* Growable scratch vector of i64 used while a container is open */
+typedef struct { int64_t* v; size_t n, cap; } yona_json_vec_t;
+
+static void yona_json_vec_push(yona_json_vec_t* a, int64_t x) {
+    if (a->n == a->cap) {
+        a->cap = a->cap ? a->cap * 2 : 8;
+        a->v = (int64_t*)realloc(a->v, a->cap * sizeof(int64_t));
+    }
+    a->v[a->n++] = x;
+}
+
+static void yona_json_vec_drop(yona_json_vec_t* a) {
+    for (size_t i = 0; i < a->n; i++) yona_rt_rc_dec((void*)(intptr_t)a->v[i]);
+    free(a->v);
+}
+
+/* Move the scratch vector into a heap-element Seq */
+static int64_t* yona_json_vec_to_seq(yona_json_vec_t* a) {
+    int64_t* seq = yona_rt_seq_alloc((int64_t)a->n);
+    if (a->n) memcpy(seq + SEQ_HDR_SIZE, a->v, a->n * sizeof(int64_t));
+    yona_rt_seq_set_heap(seq, 1);
+    free(a->v);
+    return seq;
+}
+
+static int64_t* yona_json_value(yona_json_cursor_t* c, size_t at, int depth);
+
+static int64_t* yona_json_array(yona_json_cursor_t* c, size_t open, int depth) {
+    yona_json_vec_t items = {0};
+    size_t at = yona_json_next(c);
+    if (yona_json_at(c, at) != ']') {
+        for (;;) {
+            int64_t* v = yona_json_value(c, at, depth + 1);
+            if (!v) goto fail;
+            yona_json_vec_push(&items, (int64_t)(intptr_t)v);
+            at = yona_json_next(c);
+            int ch = yona_json_at(c, at);
+            if (ch == ']') break;
+            if (ch != ',') { yona_json_fail(c, "expected ',' or ']'", at); goto fail; }
+            at = yona_json_next(c);
+        }
+    }
+    {
+        int64_t* node = yona_json_node(JSON_TAG_ARRAY, 1, 1);
+        node[ADT_HDR_SIZE] = (int64_t)(intptr_t)yona_json_vec_to_seq(&items);
+        return node;
+    }
+fail:
+    (void)open;
+    yona_json_vec_drop(&items);
+    return NULL;
+}
+
+static char* yona_json_key(yona_json_cursor_t* c, size_t at) {
+    int esc;
+    size_t close = yona_json_string_end(c, at, &esc);
+    if (!close) return NULL;
+    return yona_json_decode_string(c, at, close, esc);
+}
+
+static int64_t* yona_json_object(yona_json_cursor_t* c, size_t open, int depth) {
+    yona_json_vec_t keys = {0}, vals = {0};
+    size_t at = yona_json_next(c);
+    if (yona_json_at(c, at) != '}') {
+        for (;;) {
+            if (yona_json_at(c, at) != '"') { yona_json_fail(c, "expected string key", at); goto fail; }
+            char* k = yona_json_key(c, at);
+            if (!k) goto fail;
+            yona_json_vec_push(&keys, (int64_t)(intptr_t)k);
+            at = yona_json_next(c);
+            if (yona_json_at(c, at) != ':') { yona_json_fail(c, "expected ':'", at); goto fail; }
+            int64_t* v = yona_json_value(c, yona_json_next(c), depth + 1);
+            if (!v) goto fail;
+            yona_json_vec_push(&vals, (int64_t)(intptr_t)v);
+            at = yona_json_next(c);
+            int ch = yona_json_at(c, at);
+            if (ch == '}') break;
+            if (ch != ',') { yona_json_fail(c, "expected ',' or '}'", at); goto fail; }
+            at = yona_json_next(c);
+        }
+    }
+    {
+        int64_t* node = yona_json_node(JSON_TAG_OBJECT, 2, 3);
+        node[ADT_HDR_SIZE] = (int64_t)(intptr_t)yona_json_vec_to_seq(&keys);
+        node[ADT_HDR_SIZE + 1] = (int64_t)(intptr_t)yona_json_vec_to_seq(&vals);
+        return node;
+    }
+fail:
+    (void)open;
+    yona_json_vec_drop(&keys);
+    yona_json_vec_drop(&vals);
+    return NULL;
+}
+
+static int64_t* yona_json_value(yona_json_cursor_t* c, size_t at, int depth) {
+    if (depth > YONA_JSON_MAX_DEPTH) return yona_json_fail(c, "nesting too deep", at);
+    int ch = yona_json_at(c, at);
+    switch (ch) {
+        case '{': return yona_json_object(c, at, depth);
+        case '[': return yona_json_array(c, at, depth);
+        case '"': {
+            int esc;
+            size_t close = yona_json_string_end(c, at, &esc);
+            if (!close) return NULL;
+            char* s = yona_json_decode_string(c, at, close, esc);
+            if (!s) return NULL;
+            int64_t* node = yona_json_node(JSON_TAG_STRING, 1, 1);
+            node[ADT_HDR_SIZE] = (int64_t)(intptr_t)s;
+            return node;
+        }
+        case 't': case 'f': {
+            int v = ch == 't';
+            if (!yona_json_word(c, at, v ? "true" : "false", v ? 4 : 5))
+                return yona_json_fail(c, "invalid literal", at);
+            int64_t* node = yona_json_node(JSON_TAG_BOOL, 1, 0);
+            node[ADT_HDR_SIZE] = v;
+            return node;
+        }
+        case 'n':
+            if (!yona_json_word(c, at, "null", 4)) return yona_json_fail(c, "invalid literal", at);
+            return YONA_JSON_NULL;
+        case -1:
+            return yona_json_fail(c, "unexpected end of input", at);
+        default: {
+            int is_int;
+            size_t end = yona_json_number_end(c, at, &is_int);
+            if (!end) return yona_json_fail(c, "invalid value", at);
+            size_t digits = end - at - (c->buf[at] == '-');
+            if (is_int && digits <= 18) {
+                int64_t* node = yona_json_node(JSON_TAG_INT, 1, 0);
+                node[ADT_HDR_SIZE] = yona_parse_i64(c->buf + at);
+                return node;
+            }
+            int64_t* node = yona_json_node(JSON_TAG_FLOAT, 1, 0);
+            double d = yona_parse_f64(c->buf + at);
+            memcpy(&node[ADT_HDR_SIZE], &d, sizeof(d));
+            return node;
+        }
+    }
+}
+
+/* parse : String -> Json. Raises on malformed input. */
+int64_t* yona_Std_Json__parse(const char* s) {
+    yona_json_cursor_t cur, *c = &cur;
+    yona_json_cursor_init(c, s);
+    int64_t* root = yona_json_value(c, yona_json_next(c), 0);
+    if (root) {
+        size_t extra = yona_json_next(c);
+        if (extra < c->len) {
+            yona_rt_rc_dec(root);
+            root = yona_json_fail(c, "trailing characters", extra);
+        }
+    }
+    if (!root) {
+        yona_json_raise(c);
+        return YONA_JSON_NULL;
+    }
+    return root;
+}
+
+/* ===== Tree accessors ===== */
+
+static inline int64_t yona_json_tag(const int64_t* j) { return j ? j[0] : JSON_TAG_NULL; }
+
+static inline void* yona_json_share(int64_t v) {
+    yona_rt_rc_inc((void*)(intptr_t)v);
+    return (void*)(intptr_t)v;
+}
+
+static _Atomic(const char*) yona_json_kind_names[7];
+
+/* kind : Json -> String — "null", "bool", "number", "string", "array" or
+ * "object". The result is interned, so comparing it with a literal is a
+ * pointer check. */
+const char* yona_Std_Json__kind(int64_t* j) {
+    static const char* const names[7] = {
+        "null", "bool", "number", "number", "string", "array", "object",
+    };
+    int64_t tag = yona_json_tag(j);
+    if (tag < 0 || tag > JSON_TAG_OBJECT) tag = JSON_TAG_NULL;
+    const char* k = atomic_load_explicit(&yona_json_kind_names[tag], memory_order_acquire);
+    if (!k) {
+        size_t len = strlen(names[tag]);
+        char* tmp = (char*)yona_rt_rc_alloc_string_len(len + 1, len);
+        memcpy(tmp, names[tag], len + 1);
+        k = yona_rt_string_intern(tmp);
+        yona_rt_rc_dec(tmp);
+        atomic_store_explicit(&yona_json_kind_names[tag], k, memory_order_release);
+    }
+    return k;
+}
+
+int64_t yona_Std_Json__isNull(int64_t* j) { return yona_json_tag(j) == JSON_TAG_NULL; }
+
+int64_t yona_Prelude__Eq_String__eq(const char* a, const char* b);
+
+/* field : String -> Json -> Json — JNull when missing or not an object */
+int64_t* yona_Std_Json__field(const char* key, int64_t* j) {
+    if (yona_json_tag(j) != JSON_TAG_OBJECT) return YONA_JSON_NULL;
+    int64_t* keys = (int64_t*)(intptr_t)j[ADT_HDR_SIZE];
+    int64_t* vals = (int64_t*)(intptr_t)j[ADT_HDR_SIZE + 1];
+    int64_t n = keys[0];
+    for (int64_t i = 0; i < n; i++)
+        if (yona_Prelude__Eq_String__eq((const char*)(intptr_t)yona_rt_seq_get(keys, i), key))
+            return (int64_t*)yona_json_share(yona_rt_seq_get(vals, i));
+    return YONA_JSON_NULL;
+}
+
+/* at : Int -> Json -> Json — JNull when out of range or not an array */
+int64_t* yona_Std_Json__at(int64_t i, int64_t* j) {
+    if (yona_json_tag(j) != JSON_TAG_ARRAY) return YONA_JSON_NULL;
+    int64_t* items = (int64_t*)(intptr_t)j[ADT_HDR_SIZE];
+    if (i < 0 || i >= items[0]) return YONA_JSON_NULL;
+    return (int64_t*)yona_json_share(yona_rt_seq_get(items, i));
+}
+
+/* items : Json -> [Json] — array elements, object values, else [] */
+int64_t* yona_Std_Json__items(int64_t* j) {
+    int64_t tag = yona_json_tag(j);
+    if (tag == JSON_TAG_ARRAY) return (int64_t*)yona_json_share(j[ADT_HDR_SIZE]);
+    if (tag == JSON_TAG_OBJECT) return (int64_t*)yona_json_share(j[ADT_HDR_SIZE + 1]);
+    return yona_rt_seq_alloc(0);
+}
+
+/* keys : Json -> [String] — object keys in document order, else [] */
+int64_t* yona_Std_Json__keys(int64_t* j) {
+    if (yona_json_tag(j) == JSON_TAG_OBJECT) return (int64_t*)yona_json_share(j[ADT_HDR_SIZE]);
+    return yona_rt_seq_alloc(0);
+}
+
+/* size : Json -> Int — element or key count, else 0 */
+int64_t yona_Std_Json__size(int64_t* j) {
+    int64_t tag = yona_json_tag(j);
+    if (tag == JSON_TAG_ARRAY || tag == JSON_TAG_OBJECT)
+        return ((int64_t*)(intptr_t)j[ADT_HDR_SIZE])[0];
+    return 0;
+}
+
+const char* yona_Std_Json__asString(int64_t* j) {
+    if (yona_json_tag(j) == JSON_TAG_STRING) return (const char*)yona_json_share(j[ADT_HDR_SIZE]);
+    char* r = (char*)yona_rt_rc_alloc_string_len(1, 0);
+    r[0] = '\0';
+    return r;
+}
+
+int64_t yona_Std_Json__asInt(int64_t* j) {
+    switch (yona_json_tag(j)) {
+        case JSON_TAG_INT:
+        case JSON_TAG_BOOL: return j[ADT_HDR_SIZE];
+        case JSON_TAG_FLOAT: {
+            double d;
+            int64_t v = 0;
+            memcpy(&d, &j[ADT_HDR_SIZE], sizeof(d));
+            yona_json_f64_to_i64(d, &v);
+            return v;
+        }
+        default: return 0;
+    }
+}
+
+double yona_Std_Json__asFloat(int64_t* j) {
+    switch (yona_json_tag(j)) {
+        case JSON_TAG_INT: return (double)j[ADT_HDR_SIZE];
+        case JSON_TAG_FLOAT: { double d; memcpy(&d, &j[ADT_HDR_SIZE], sizeof(d)); return d; }
+        default: return 0.0;
+    }
+}
+
+int64_t yona_Std_Json__asBool(int64_t* j) {
+    return yona_json_tag(j) == JSON_TAG_BOOL && j[ADT_HDR_SIZE] != 0;
+}
+
+/* ===== On-demand mode ===== */
+
+/* Skip the value starting at structural `at`. Returns 0 on error. */
+static int yona_json_skip(yona_json_cursor_t* c, size_t at) {
+    int ch = yona_json_at(c, at);
+    if (ch != '{' && ch != '[') {
+        if (ch < 0 || ch == '}' || ch == ']' || ch == ',' || ch == ':') {
+            yona_json_fail(c, "expected value", at);
+            return 0;
+        }
+        return 1;
+    }
+    size_t depth = 1;
+    while (depth) {
+        size_t p = yona_json_next(c);
+        int k = yona_json_at(c, p);
+        if (k == '{' || k == '[') depth++;
+        else if (k == '}' || k == ']') depth--;
+        else if (k < 0) { yona_json_fail(c, "unexpected end of input", p); return 0; }
+    }
+    return 1;
+}
+
+/* Compare the raw key at `at` with seg[0..slen) without allocating */
+static int yona_json_key_eq(yona_json_cursor_t* c, size_t at, const char* seg, size_t slen) {
+    int esc;
+    size_t close = yona_json_string_end(c, at, &esc);
+    if (!close) return -1;
+    if (!esc) return close - at - 1 == slen && memcmp(c->buf + at + 1, seg, slen) == 0;
+    char* k = yona_json_decode_string(c, at, close, esc);
+    if (!k) return -1;
+    int eq = (size_t)yona_rt_string_length_fast(k) == slen && memcmp(k, seg, slen) == 0;
+    yona_rt_rc_dec(k);
+    return eq;
+}
+
+/* Move the cursor to the value at `path` ("a.b.0"). Returns the structural
+ * offset of that value, or len if the path does not exist. */
+static size_t yona_json_seek(yona_json_cursor_t* c, const char* path) {
+    size_t at = yona_json_next(c);
+    const char* seg = path;
+    while (*seg) {
+        const char* dot = strchr(seg, '.');
+        size_t slen = dot ? (size_t)(dot - seg) : strlen(seg);
+        int ch = yona_json_at(c, at);
+        if (ch == '{') {
+            at = yona_json_next(c);
+            if (yona_json_at(c, at) == '}') return c->len;
+            for (;;) {
+                if (yona_json_at(c, at) != '"') { yona_json_fail(c, "expected string key", at); return c->len; }
+                int eq = yona_json_key_eq(c, at, seg, slen);
+                if (eq < 0) return c->len;
+                at = yona_json_next(c);
+                if (yona_json_at(c, at) != ':') { yona_json_fail(c, "expected ':'", at); return c->len; }
+                at = yona_json_next(c);
+                if (eq) break;
+                if (!yona_json_skip(c, at)) return c->len;
+                at = yona_json_next(c);
+                if (yona_json_at(c, at) != ',') return c->len;
+                at = yona_json_next(c);
+            }
+        } else if (ch == '[') {
+            char* endp;
+            long long want = strtoll(seg, &endp, 10);
+            if (endp != seg + slen || slen == 0 || want < 0) return c->len;
+            at = yona_json_next(c);
+            if (yona_json_at(c, at) == ']') return c->len;
+            for (long long i = 0; i < want; i++) {
+                if (!yona_json_skip(c, at)) return c->len;
+                at = yona_json_next(c);
+                if (yona_json_at(c, at) != ',') return c->len;
+                at = yona_json_next(c);
+            }
+        } else {
+            return c->len;
+        }
+        seg += slen;
+        if (*seg == '.') seg++;
+    }
+    return at;
+}
+
+/* Run a path query on the caller's cursor. Returns the value's offset or
+ * len; raises if the document is malformed on the way there. */
+static size_t yona_json_query(const char* path, const char* json, yona_json_cursor_t* c) {
+    yona_json_cursor_init(c, json);
+    size_t at = yona_json_seek(c, path);
+    if (c->err) yona_json_raise(c);
+    return at;
+}
+
+/* has : String -> String -> Bool */
+int64_t yona_Std_Json__has(const char* path, const char* json) {
+    yona_json_cursor_t cur, *c = &cur;
+    size_t at = yona_json_query(path, json, c);
+    int64_t found = at < c->len;
+    return found;
+}
+
+/* getString : String -> String -> String -> String (path, default, json) */
+const char* yona_Std_Json__getString(const char* path, const char* dflt, const char* json) {
+    yona_json_cursor_t cur, *c = &cur;
+    size_t at = yona_json_query(path, json, c);
+    if (yona_json_at(c, at) == '"') {
+        int esc;
+        size_t close = yona_json_string_end(c, at, &esc);
+        char* s = close ? yona_json_decode_string(c, at, close, esc) : NULL;
+        if (s) return s;
+        yona_json_raise(c);
+    }
+    size_t n = (size_t)yona_rt_string_length_fast(dflt);
+    char* r = (char*)yona_rt_rc_alloc_string_len(n + 1, n);
+    memcpy(r, dflt, n + 1);
+    return r;
+}
+
+/* getInt : String -> Int -> String -> Int */
+int64_t yona_Std_Json__getInt(const char* path, int64_t dflt, const char* json) {
+    yona_json_cursor_t cur, *c = &cur;
+    size_t at = yona_json_query(path, json, c);
+    int is_int;
+    int64_t r = dflt;
+    if (at < c->len && yona_json_number_end(c, at, &is_int)) {
+        if (is_int) r = yona_parse_i64(json + at);
+        else yona_json_f64_to_i64(yona_parse_f64(json + at), &r);
+    }
+    return r;
+}
+
+/* getFloat : String -> Float -> String -> Float */
+double yona_Std_Json__getFloat(const char* path, double dflt, const char* json) {
+    yona_json_cursor_t cur, *c = &cur;
+    size_t at = yona_json_query(path, json, c);
+    int is_int;
+    double r = dflt;
+    if (at < c->len && yona_json_number_end(c, at, &is_int))
+        r = yona_parse_f64(json + at);
+    return r;
+}
+
+/* getBool : String -> Bool -> String -> Bool */
+int64_t yona_Std_Json__getBool(const char* path, int64_t dflt, const char* json) {
+    yona_json_cursor_t cur, *c = &cur;
+    size_t at = yona_json_query(path, json, c);
+    int64_t r = dflt;
+    if (at < c->len) {
+        if (yona_json_word(c, at, "true", 4)) r = 1;
+        else if (yona_json_word(c, at, "false", 5)) r = 0;
+    }
+    return r;
+}
+
+/* End offset (exclusive) of the value starting at structural `at`, moving
+ * the cursor past it. Returns `at` on error. */
+static size_t yona_json_value_end(yona_json_cursor_t* c, size_t at) {
+    int ch = yona_json_at(c, at);
+    size_t end = at;
+    if (ch == '"') {
+        int esc;
+        size_t close = yona_json_string_end(c, at, &esc);
+        end = close ? close + 1 : at;
+    } else if (ch == '{' || ch == '[') {
+        end = yona_json_skip(c, at) ? c->idx[c->pos - 1] + 1 : at;
+    } else {
+        /* Scalar: runs to the next delimiter */
+        while (end < c->len && !yona_json_is_delim((unsigned char)c->buf[end])) end++;
+    }
+    return c->err ? at : end;
+}
+
+static char* yona_json_slice(const char* s, size_t n) {
+    char* r = (char*)yona_rt_rc_alloc_string_len(n + 1, n);
+    memcpy(r, s, n);
+    r[n] = '\0';
+    return r;
+}
+
+/* getRaw : String -> String -> String — the value's JSON text, "" if
+ * missing. Feed it to parse to materialize just that subtree. */
+const char* yona_Std_Json__getRaw(const char* path, const char* json) {
+    yona_json_cursor_t cur, *c = &cur;
+    size_t at = yona_json_query(path, json, c);
+    size_t end = at < c->len ? yona_json_value_end(c, at) : at;
+    if (c->err) yona_json_raise(c);
+    return yona_json_slice(json + at, end - at);
+}
+
+/* ===== Derived decoders =====
+ *
+ * `deriving Json` (src/codegen/DeriveEngine.cpp) decodes through a reader:
+ * a cursor over the whole document that keeps every structural offset it
+ * has indexed, so a decoder can move back to a value it has already
+ * passed. Stage 1 still runs once over the text.
+ *
+ * For each constructor, `enter` walks the object or array at the reader
+ * once, matching keys and remembering where each field's value starts.
+ * The generated code then calls `seek` and the field type's readJson for
+ * each field in declaration order. Values are decoded in place: nothing is
+ * sliced, copied or classified twice. Skipping a nested value on the way
+ * costs one pass over its structural offsets.
+ *
+ * The field spec is generated at compile time:
+ *
+ *   "#n"              array with n positional fields
+ *   "seed:m:k0,k1,…"  object with named fields; hashing each key with
+ *                     yona_json_key_hash(seed) & (m - 1) puts k0..kn in
+ *                     distinct slots (a perfect hash found by the compiler)
+ *
+ * so matching a key is one hash, one table load and one memcmp.
+ *
+ * A reader is a handle (Int) from `reader` to `finish`. Each thread keeps
+ * one spare, so steady-state decoding does not allocate one.
+ */
+
+#define YONA_JSON_FIELDS_INLINE 32
+#define YONA_JSON_READER_INDEX 1024       /* initial offsets in a reader */
+#define YONA_JSON_SPARE_INDEX (1 << 16)   /* larger indexes are not kept */
+
+typedef struct {
+    yona_json_cursor_t c;
+    size_t at;          /* value the next readJson decodes; c.len if none */
+    int64_t* frames;    /* per `enter`: [n, pos0, …, pos(n-1)], -1 = missing */
+    size_t nframes, capframes;
+} yona_json_reader_t;
+
+static _Thread_local yona_json_reader_t* yona_json_spare_reader;
+
+static inline uint64_t yona_json_key_hash(const char* s, size_t n, uint64_t seed) {
+    uint64_t h = 14695981039346656037ULL ^ seed;
+    for (size_t i = 0; i < n; i++)
+        h = (h ^ (uint64_t)(unsigned char)s[i]) * 1099511628211ULL;
+    return h ^ (h >> 32);
+}
+
+static void yona_json_reader_free(yona_json_reader_t* r) {
+    yona_rt_rc_dec((void*)r->c.buf);
+    if (!yona_json_spare_reader && r->c.cap <= YONA_JSON_SPARE_INDEX) {
+        yona_json_spare_reader = r;
+        return;
+    }
+    free(r->c.idx);
+    free(r->frames);
+    free(r);
+}
+
+/* Raise the reader's error; the handle is gone once the raise unwinds */
+static void yona_json_reader_raise(yona_json_reader_t* r) {
+    const char* what = r->c.err;
+    size_t at = r->c.err_at;
+    yona_json_reader_free(r);
+    yona_json_raise_at(what, at);
+}
+
+/* reader : String -> Int — a reader positioned at the document's value */
+int64_t yona_Std_Json__reader(const char* json) {
+    yona_json_reader_t* r = yona_json_spare_reader;
+    size_t* idx;
+    size_t cap;
+    if (r) {
+        yona_json_spare_reader = NULL;
+        idx = r->c.idx;
+        cap = r->c.cap;
+    } else {
+        r = (yona_json_reader_t*)malloc(sizeof(*r));
+        r->frames = NULL;
+        r->capframes = 0;
+        cap = YONA_JSON_READER_INDEX;
+        idx = (size_t*)malloc(cap * sizeof(size_t));
+    }
+    yona_rt_rc_inc((void*)json);
+    yona_json_cursor_init(&r->c, json);
+    r->c.idx = idx;
+    r->c.cap = cap;
+    r->nframes = 0;
+    r->at = yona_json_next(&r->c);
+    return (int64_t)(intptr_t)r;
+}
+
+/* finish : Int -> () — release a reader */
+int64_t yona_Std_Json__finish(int64_t rh) {
+    yona_json_reader_free((yona_json_reader_t*)(intptr_t)rh);
+    return 0;
+}
+
+/* enter : String -> Int -> Int — walk the object or array at the reader
+ * and record where each field of `spec` starts. Returns a frame for
+ * `seek`. Any other value, or a missing one, leaves every field missing. */
+int64_t yona_Std_Json__enter(const char* spec, int64_t rh) {
+    yona_json_reader_t* r = (yona_json_reader_t*)(intptr_t)rh;
+    yona_json_cursor_t* c = &r->c;
+    const char* key_ptr[YONA_JSON_FIELDS_INLINE];
+    size_t key_len[YONA_JSON_FIELDS_INLINE];
+    int16_t slot_buf[4 * YONA_JSON_FIELDS_INLINE];
+    const char** kp = key_ptr;
+    size_t* kl = key_len;
+    int16_t* slots = slot_buf;
+    int positional = spec[0] == '#';
+    uint64_t seed = 0;
+    size_t m = 0, n = 0;
+    const char* keys = NULL;
+
+    if (positional) {
+        n = (size_t)strtoull(spec + 1, NULL, 10);
+    } else {
+        char* e;
+        seed = strtoull(spec, &e, 10);
+        m = (size_t)strtoull(e + 1, &e, 10);
+        keys = e + 1;
+        for (const char* k = keys; *k; k++) n += *k == ',';
+        n += *keys != '\0';
+    }
+
+    size_t f = r->nframes;
+    if (r->capframes - f < n + 1) {
+        while (r->capframes - f < n + 1) r->capframes = r->capframes ? r->capframes * 2 : 64;
+        r->frames = (int64_t*)realloc(r->frames, r->capframes * sizeof(int64_t));
+    }
+    int64_t* pos = r->frames + f + 1;
+    r->frames[f] = (int64_t)n;
+    r->nframes = f + 1 + n;
+    for (size_t i = 0; i < n; i++) pos[i] = -1;
+
+    int ch = yona_json_at(c, r->at);
+    if (positional && ch == '[') {
+        size_t at = yona_json_next(c);
+        if (yona_json_at(c, at) != ']') {
+            for (size_t i = 0;; i++) {
+                size_t p = c->pos - 1;
+                if (!yona_json_skip(c, at)) break;
+                if (i < n) pos[i] = (int64_t)p;
+                at = yona_json_next(c);
+                int k = yona_json_at(c, at);
+                if (k == ']') break;
+                if (k != ',') { yona_json_fail(c, "expected ',' or ']'", at); break; }
+                at = yona_json_next(c);
+            }
+        }
+    } else if (!positional && ch == '{') {
+        if (n > YONA_JSON_FIELDS_INLINE) {
+            kp = (const char**)malloc(n * sizeof(*kp));
+            kl = (size_t*)malloc(n * sizeof(*kl));
+        }
+        if (m > 4 * YONA_JSON_FIELDS_INLINE) slots = (int16_t*)malloc(m * sizeof(*slots));
+        for (size_t i = 0; i < m; i++) slots[i] = -1;
+        const char* k = keys;
+        for (size_t i = 0; i < n; i++) {
+            const char* comma = strchr(k, ',');
+            kp[i] = k;
+            kl[i] = comma ? (size_t)(comma - k) : strlen(k);
+            slots[yona_json_key_hash(k, kl[i], seed) & (m - 1)] = (int16_t)i;
+            k += kl[i] + 1;
+        }
+
+        size_t at = yona_json_next(c);
+        if (yona_json_at(c, at) != '}') {
+            for (;;) {
+                if (yona_json_at(c, at) != '"') { yona_json_fail(c, "expected string key", at); break; }
+                int esc;
+                size_t close = yona_json_string_end(c, at, &esc);
+                if (!close) break;
+                long idx = -1;
+                if (esc) {
+                    /* Escaped key: compare its decoded form */
+                    char* dk = yona_json_decode_string(c, at, close, esc);
+                    if (!dk) break;
+                    size_t kn = (size_t)yona_rt_string_length_fast(dk);
+                    int16_t sl = slots[yona_json_key_hash(dk, kn, seed) & (m - 1)];
+                    if (sl >= 0 && kl[sl] == kn && memcmp(kp[sl], dk, kn) == 0) idx = sl;
+                    yona_rt_rc_dec(dk);
+                } else {
+                    const char* rk = c->buf + at + 1;
+                    size_t kn = close - at - 1;
+                    int16_t sl = slots[yona_json_key_hash(rk, kn, seed) & (m - 1)];
+                    if (sl >= 0 && kl[sl] == kn && memcmp(kp[sl], rk, kn) == 0) idx = sl;
+                }
+                at = yona_json_next(c);
+                if (yona_json_at(c, at) != ':') { yona_json_fail(c, "expected ':'", at); break; }
+                at = yona_json_next(c);
+                size_t p = c->pos - 1;
+                if (!yona_json_skip(c, at)) break;
+                if (idx >= 0) pos[idx] = (int64_t)p;
+                at = yona_json_next(c);
+                int nk = yona_json_at(c, at);
+                if (nk == '}') break;
+                if (nk != ',') { yona_json_fail(c, "expected ',' or '}'", at); break; }
+                at = yona_json_next(c);
+            }
+        }
+        if (kp != key_ptr) { free(kp); free(kl); }
+        if (slots != slot_buf) free(slots);
+    }
+    if (c->err) yona_json_reader_raise(r);
+    return (int64_t)f;
+}
+
+/* seek : Int -> Int -> Int -> Int — move the reader to field i of an
+ * `enter` frame and return it, for that field's readJson */
+int64_t yona_Std_Json__seek(int64_t i, int64_t frame, int64_t rh) {
+    yona_json_reader_t* r = (yona_json_reader_t*)(intptr_t)rh;
+    int64_t* fr = r->frames + frame;
+    int64_t p = i < fr[0] ? fr[1 + i] : -1;
+    if (p < 0) {
+        r->at = r->c.len;
+    } else {
+        r->c.pos = (size_t)p + 1;
+        r->at = r->c.idx[p];
+    }
+    return rh;
+}
+
+/* variant : Int -> String — constructor name of the externally tagged
+ * value at the reader: the string itself for "Red", the only key for
+ * {"Circle": …}, "" for anything else. The reader moves to the payload. */
+const char* yona_Std_Json__variant(int64_t rh) {
+    yona_json_reader_t* r = (yona_json_reader_t*)(intptr_t)rh;
+    yona_json_cursor_t* c = &r->c;
+    char* name = NULL;
+    int ch = yona_json_at(c, r->at);
+    if (ch == '"') {
+        name = yona_json_key(c, r->at);
+        r->at = c->len;
+    } else if (ch == '{') {
+        size_t at = yona_json_next(c);
+        r->at = c->len;
+        if (yona_json_at(c, at) == '"') {
+            name = yona_json_key(c, at);
+            at = yona_json_next(c);
+            if (name && yona_json_at(c, at) != ':') yona_json_fail(c, "expected ':'", at);
+            r->at = yona_json_next(c);
+        }
+    }
+    if (c->err) {
+        if (name) yona_rt_rc_dec(name);
+        yona_json_reader_raise(r);
+    }
+    if (name) return name;
+    char* e = (char*)yona_rt_rc_alloc_string_len(1, 0);
+    e[0] = '\0';
+    return e;
+}
+
+/* Scalars at the reader, for the Prelude's readJson instances. A value of
+ * another kind, or a missing one, keeps the default, as does a float read
+ * as an Int that does not fit. */
+
+static int64_t yona_json_read_int(int64_t d, int64_t rh) {
+    yona_json_reader_t* r = (yona_json_reader_t*)(intptr_t)rh;
+    int is_int;
+    if (r->at < r->c.len && yona_json_number_end(&r->c, r->at, &is_int)) {
+        if (is_int) return yona_parse_i64(r->c.buf + r->at);
+        yona_json_f64_to_i64(yona_parse_f64(r->c.buf + r->at), &d);
+    }
+    return d;
+}
+
+static double yona_json_read_float(double d, int64_t rh) {
+    yona_json_reader_t* r = (yona_json_reader_t*)(intptr_t)rh;
+    int is_int;
+    if (r->at < r->c.len && yona_json_number_end(&r->c, r->at, &is_int))
+        return yona_parse_f64(r->c.buf + r->at);
+    return d;
+}
+
+static int64_t yona_json_read_bool(int64_t d, int64_t rh) {
+    yona_json_reader_t* r = (yona_json_reader_t*)(intptr_t)rh;
+    if (r->at < r->c.len) {
+        if (yona_json_word(&r->c, r->at, "true", 4)) return 1;
+        if (yona_json_word(&r->c, r->at, "false", 5)) return 0;
+    }
+    return d;
+}
+
+static const char* yona_json_read_string(const char* d, int64_t rh) {
+    yona_json_reader_t* r = (yona_json_reader_t*)(intptr_t)rh;
+    if (yona_json_at(&r->c, r->at) == '"') {
+        char* s = yona_json_key(&r->c, r->at);
+        if (!s) yona_json_reader_raise(r);
+        return s;
+    }
+    yona_rt_rc_inc((void*)d);
+    return d;
+}
@@ -0,0 +1,420 @@
+/*
+ * Number <-> text conversion kernels.
+ *
+ * #included from compiled_runtime.c (not compiled as a separate TU).
+ *
+ *   yona_u64_to_dec / yona_i64_to_dec  — itoa, two digits per division
+ *   yona_f64_shortest                  — shortest round-trip text (JSON)
+ *   yona_f64_to_g                      — printf("%g") text, no snprintf
+ *   yona_parse_i64                     — atoll semantics
+ *   yona_parse_f64                     — atof/strtod semantics
+ *
+ * Shortest printing is Schubfach (R. Giulietti, "The Schubfach way to
+ * render doubles", 2020): the decimal candidates are the two multiples of
+ * 10^k around v and the one-digit-shorter pair around them; the rounding
+ * interval is tested with a 126-bit approximation of 10^-k. The result is
+ * the shortest decimal that round-trips, closest to v on ties.
+ *
+ * Parsing tries Clinger's exact fast path (<= 2^53 mantissa, |e10| <= 22),
+ * then Eisel-Lemire (D. Lemire, "Number Parsing at a Gigabyte per Second",
+ * 2021) with one or two 64x64 multiplies. Anything it cannot decide
+ * (more than 19 significant digits, halfway cases, hex/inf/nan, range
+ * edges) falls back to strtod, so results always match libc.
+ *
+ * Both float paths share include/runtime/pow10_table.inl.
+ */
+
+#include <float.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "runtime/pow10_table.inl"
+
+/* ===== 64x64 -> 128 multiply ===== */
+
+static inline uint64_t yona_mul_hi64(uint64_t a, uint64_t b, uint64_t* lo) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 p = (unsigned __int128)a * b;
+    *lo = (uint64_t)p;
+    return (uint64_t)(p >> 64);
+#else
+    uint64_t a0 = (uint32_t)a, a1 = a >> 32, b0 = (uint32_t)b, b1 = b >> 32;
+    uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    uint64_t mid = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+    *lo = (mid << 32) | (uint32_t)p00;
+    return p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+#endif
+}
+
+/* ===== Integers ===== */
+
+static const char yona_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static inline int yona_dec_digits(uint64_t v) {
+    int n = 1;
+    for (;;) {
+        if (v < 10) return n;
+        if (v < 100) return n + 1;
+        if (v < 1000) return n + 2;
+        if (v < 10000) return n + 3;
+        v /= 10000;
+        n += 4;
+    }
+}
+
+/* Write v's digits so that the last one lands at end[-1]. */
+static inline void yona_u64_write_back(char* end, uint64_t v) {
+    while (v >= 100) {
+        unsigned i = (unsigned)(v % 100) * 2;
+        v /= 100;
+        *--end = yona_digit_pairs[i + 1];
+        *--end = yona_digit_pairs[i];
+    }
+    if (v >= 10) {
+        unsigned i = (unsigned)v * 2;
+        *--end = yona_digit_pairs[i + 1];
+        *--end = yona_digit_pairs[i];
+    } else {
+        *--end = (char)('0' + v);
+    }
+}
+
+/* Decimal text of v at out (no NUL). Returns the length, at most 20. */
+static size_t yona_u64_to_dec(char* out, uint64_t v) {
+    int n = yona_dec_digits(v);
+    yona_u64_write_back(out + n, v);
+    return (size_t)n;
+}
+
+/* Same for signed values; at most 20 bytes including the sign. */
+static size_t yona_i64_to_dec(char* out, int64_t v) {
+    if (v < 0) {
+        *out = '-';
+        return 1 + yona_u64_to_dec(out + 1, (uint64_t)0 - (uint64_t)v);
+    }
+    return yona_u64_to_dec(out, (uint64_t)v);
+}
+
+/* ===== Shortest decimal (Schubfach) ===== */
+
+#define YONA_SF_Q_MIN (-1074)
+#define YONA_SF_C_MIN ((uint64_t)1 << 52)
+#define YONA_SF_MASK63 ((uint64_t)0x7FFFFFFFFFFFFFFF)
+
+/* floor(q log10 2), floor(q log10 (3/4 2^q)), floor(e log2 10) */
+static inline int yona_flog10pow2(int q) { return (int)(((int64_t)q * 661971961083LL) >> 41); }
+static inline int yona_flog10threequarterspow2(int q) {
+    return (int)(((int64_t)q * 661971961083LL - 274743187321LL) >> 41);
+}
+static inline int yona_flog2pow10(int e) { return (int)(((int64_t)e * 913124641741LL) >> 38); }
+
+/* (g * cp) >> 127 with g = g1 2^63 + g0, plus a sticky bit for the rest */
+static inline uint64_t yona_sf_rop(uint64_t g1, uint64_t g0, uint64_t cp) {
+    uint64_t lo;
+    uint64_t x1 = yona_mul_hi64(g0, cp, &lo);
+    uint64_t y0;
+    uint64_t y1 = yona_mul_hi64(g1, cp, &y0);
+    uint64_t z = (y0 >> 1) + x1;
+    uint64_t vbp = y1 + (z >> 63);
+    return vbp | (((z & YONA_SF_MASK63) + YONA_SF_MASK63) >> 63);
+}
+
+/* v = c 2^q; result is f 10^e */
+static void yona_sf_to_decimal(int q, uint64_t c, uint64_t* f, int* e) {
+    uint64_t out = c & 1;
+    uint64_t cb = c << 2;
+    uint64_t cbr = cb + 2;
+    uint64_t cbl;
+    int k;
+    if (c != YONA_SF_C_MIN || q == YONA_SF_Q_MIN) {
+        cbl = cb - 2;
+        k = yona_flog10pow2(q);
+    } else {
+        cbl = cb - 1;
+        k = yona_flog10threequarterspow2(q);
+    }
+    int h = q + yona_flog2pow10(-k) + 2;
+
+    /* g = floor(10^-k 2^-r) + 1 in [2^125, 2^126], from the 128-bit table */
+    const uint64_t* m = yona_pow10_table[-k - YONA_POW10_MIN_E10];
+    uint64_t gh = m[0] >> 2;
+    uint64_t gl = (m[0] << 62) | (m[1] >> 2);
+    if (++gl == 0) gh++;
+    uint64_t g1 = (gh << 1) | (gl >> 63);
+    uint64_t g0 = gl & YONA_SF_MASK63;
+
+    uint64_t vb = yona_sf_rop(g1, g0, cb << h);
+    uint64_t vbl = yona_sf_rop(g1, g0, cbl << h);
+    uint64_t vbr = yona_sf_rop(g1, g0, cbr << h);
+
+    uint64_t s = vb >> 2;
+    /* The one-digit-shorter pair; the paper uses s >= 100 to keep at least
+     * two digits, we want the plain shortest (5e-324, not 4.9e-324). */
+    if (s >= 10) {
+        uint64_t sp10 = 10 * (s / 10);
+        uint64_t tp10 = sp10 + 10;
+        int upin = vbl + out <= sp10 << 2;
+        int wpin = (tp10 << 2) + out <= vbr;
+        if (upin != wpin) {
+            *f = upin ? sp10 : tp10;
+            *e = k;
+            return;
+        }
+    }
+    uint64_t t = s + 1;
+    int uin = vbl + out <= s << 2;
+    int win = (t << 2) + out <= vbr;
+    if (uin != win) {
+        *f = uin ? s : t;
+        *e = k;
+        return;
+    }
+    int64_t cmp = (int64_t)(vb - ((s + t) << 1));
+    *f = (cmp < 0 || (cmp == 0 && (s & 1) == 0)) ? s : t;
+    *e = k;
+}
+
+/* Shortest f 10^e for a finite, nonzero |v|, with trailing zeros removed. */
+static void yona_f64_decimal(double v, uint64_t* f, int* e) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof bits);
+    uint64_t t = bits & (YONA_SF_C_MIN - 1);
+    int bq = (int)((bits >> 52) & 0x7FF);
+    if (bq != 0) {
+        int mq = -YONA_SF_Q_MIN + 1 - bq;
+        uint64_t c = YONA_SF_C_MIN | t;
+        if (mq > 0 && mq < 53 && ((c >> mq) << mq) == c) {
+            /* Integer below 2^53: its own digits are the shortest */
+            *f = c >> mq;
+            *e = 0;
+        } else {
+            yona_sf_to_decimal(-mq, c, f, e);
+        }
+    } else {
+        yona_sf_to_decimal(YONA_SF_Q_MIN, t, f, e);
+    }
+    while (*f % 10 == 0) { *f /= 10; (*e)++; }
+}
+
+/* Shortest round-trip text of v at out (no NUL), ECMAScript Number
+ * layout with %g-style exponents (signed, at least two digits): 0.001,
+ * 123.5, 1e+21, 1.5e-07. Non-finite values render as `null` (JSON has no
+ * inf/nan). Returns the length, at most 25. */
+static size_t yona_f64_shortest(char* out, double v) {
+    if (v != v || v - v != 0) { memcpy(out, "null", 4); return 4; }
+    char* p = out;
+    if (signbit(v)) { *p++ = '-'; v = -v; }
+    if (v == 0) { *p++ = '0'; return (size_t)(p - out); }
+
+    uint64_t f;
+    int e;
+    yona_f64_decimal(v, &f, &e);
+    char digits[20];
+    int n = (int)yona_u64_to_dec(digits, f);
+    int point = n + e; /* value = 0.digits * 10^point */
+
+    if (n <= point && point <= 21) {
+        memcpy(p, digits, (size_t)n); p += n;
+        memset(p, '0', (size_t)(point - n)); p += point - n;
+    } else if (0 < point && point <= 21) {
+        memcpy(p, digits, (size_t)point); p += point;
+        *p++ = '.';
+        memcpy(p, digits + point, (size_t)(n - point)); p += n - point;
+    } else if (-6 < point && point <= 0) {
+        *p++ = '0'; *p++ = '.';
+        memset(p, '0', (size_t)-point); p += -point;
+        memcpy(p, digits, (size_t)n); p += n;
+    } else {
+        *p++ = digits[0];
+        if (n > 1) { *p++ = '.'; memcpy(p, digits + 1, (size_t)(n - 1)); p += n - 1; }
+        int x = point - 1;
+        *p++ = 'e';
+        *p++ = x < 0 ? '-' : '+';
+        unsigned ax = (unsigned)(x < 0 ? -x : x);
+        if (ax < 10) *p++ = '0';
+        p += yona_u64_to_dec(p, ax);
+    }
+    return (size_t)(p - out);
+}
+
+/* printf("%g", v) text at out (no NUL); out holds at least 32 bytes.
+ * Six significant digits are taken from the shortest decimal: when it is
+ * longer than six digits it is rounded, which equals rounding v itself
+ * unless the dropped part is exactly one half — that case, inf/nan and
+ * subnormals go through snprintf. */
+static size_t yona_f64_to_g(char* out, double v) {
+    /* Subnormals carry too few bits for the digit argument above */
+    if (v != v || v - v != 0 || (v != 0 && fabs(v) < DBL_MIN))
+        return (size_t)snprintf(out, 32, "%g", v);
+    const double orig = v;
+    char* p = out;
+    if (signbit(v)) { *p++ = '-'; v = -v; }
+    if (v == 0) { *p++ = '0'; return (size_t)(p - out); }
+
+    uint64_t f;
+    int e;
+    yona_f64_decimal(v, &f, &e);
+    int n = yona_dec_digits(f);
+    if (n > 6) {
+        uint64_t div = 1;
+        for (int i = 6; i < n; i++) div *= 10;
+        uint64_t rem = f % div, half = div / 2;
+        if (rem == half) return (size_t)snprintf(out, 32, "%g", orig);
+        f /= div;
+        e += n - 6;
+        if (rem > half && ++f == 1000000) { f = 100000; e++; }
+        while (f % 10 == 0) { f /= 10; e++; }
+        n = yona_dec_digits(f);
+    }
+    char digits[8];
+    yona_u64_to_dec(digits, f);
+    int x = n + e - 1; /* exponent of the leading digit */
+
+    if (x < -4 || x >= 6) {
+        *p++ = digits[0];
+        if (n > 1) { *p++ = '.'; memcpy(p, digits + 1, (size_t)(n - 1)); p += n - 1; }
+        *p++ = 'e';
+        *p++ = x < 0 ? '-' : '+';
+        unsigned ax = (unsigned)(x < 0 ? -x : x);
+        if (ax < 10) *p++ = '0';
+        p += yona_u64_to_dec(p, ax);
+    } else if (x >= 0) {
+        if (n <= x + 1) {
+            memcpy(p, digits, (size_t)n); p += n;
+            memset(p, '0', (size_t)(x + 1 - n)); p += x + 1 - n;
+        } else {
+            memcpy(p, digits, (size_t)(x + 1)); p += x + 1;
+            *p++ = '.';
+            memcpy(p, digits + x + 1, (size_t)(n - x - 1)); p += n - x - 1;
+        }
+    } else {
+        *p++ = '0'; *p++ = '.';
+        memset(p, '0', (size_t)(-x - 1)); p += -x - 1;
+        memcpy(p, digits, (size_t)n); p += n;
+    }
+    return (size_t)(p - out);
+}
+
+/* ===== Parsing ===== */
+
+static inline int yona_is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/* atoll(s): optional whitespace and sign, then decimal digits. */
+static int64_t yona_parse_i64(const char* s) {
+    const char* p = s;
+    while (yona_is_space(*p)) p++;
+    int neg = 0;
+    if (*p == '+' || *p == '-') { neg = *p == '-'; p++; }
+    uint64_t v = 0;
+    int n = 0;
+    while ((unsigned)(*p - '0') < 10) {
+        if (++n > 18) return (int64_t)strtoll(s, NULL, 10); /* may saturate */
+        v = v * 10 + (uint64_t)(*p++ - '0');
+    }
+    return neg ? -(int64_t)v : (int64_t)v;
+}
+
+/* man 10^exp10 -> double, or 0 when the fast algorithm can't decide. */
+static int yona_eisel_lemire(uint64_t man, int64_t exp10, int neg, double* out) {
+    if (exp10 < YONA_POW10_MIN_E10 || exp10 > YONA_POW10_MAX_E10) return 0;
+    const uint64_t* pw = yona_pow10_table[exp10 - YONA_POW10_MIN_E10];
+    int clz = __builtin_clzll(man);
+    man <<= clz;
+    uint64_t ret_exp2 = (uint64_t)((((int64_t)217706 * exp10) >> 16) + 64 + 1023) - (uint64_t)clz;
+
+    uint64_t x_lo;
+    uint64_t x_hi = yona_mul_hi64(man, pw[0], &x_lo);
+    if ((x_hi & 0x1FF) == 0x1FF && x_lo + man < man) {
+        uint64_t y_lo;
+        uint64_t y_hi = yona_mul_hi64(man, pw[1], &y_lo);
+        uint64_t merged_hi = x_hi, merged_lo = x_lo + y_hi;
+        if (merged_lo < x_lo) merged_hi++;
+        if ((merged_hi & 0x1FF) == 0x1FF && merged_lo + 1 == 0 && y_lo + man < man) return 0;
+        x_hi = merged_hi;
+        x_lo = merged_lo;
+    }
+
+    uint64_t msb = x_hi >> 63;
+    uint64_t ret_man = x_hi >> (msb + 9);
+    ret_exp2 -= 1 ^ msb;
+    if (x_lo == 0 && (x_hi & 0x1FF) == 0 && (ret_man & 3) == 1) return 0;
+
+    ret_man += ret_man & 1;
+    ret_man >>= 1;
+    if (ret_man >> 53) { ret_man >>= 1; ret_exp2++; }
+    if (ret_exp2 - 1 >= 0x7FF - 1) return 0;
+
+    uint64_t bits = ret_exp2 << 52 | (ret_man & 0x000FFFFFFFFFFFFFULL);
+    if (neg) bits |= 0x8000000000000000ULL;
+    memcpy(out, &bits, sizeof bits);
+    return 1;
+}
+
+/* atof(s) / strtod(s, NULL). */
+static double yona_parse_f64(const char* s) {
+    const char* p = s;
+    while (yona_is_space(*p)) p++;
+    int neg = 0;
+    if (*p == '+' || *p == '-') { neg = *p == '-'; p++; }
+
+    uint64_t man = 0;
+    int nd = 0, any = 0;
+    int64_t exp10 = 0;
+    while (*p == '0') { p++; any = 1; }
+    if (*p == 'x' || *p == 'X') return strtod(s, NULL);
+    for (; (unsigned)(*p - '0') < 10; p++, any = 1) {
+        if (++nd > 19) return strtod(s, NULL);
+        man = man * 10 + (uint64_t)(*p - '0');
+    }
+    if (*p == '.') {
+        p++;
+        if (nd == 0)
+            for (; *p == '0'; p++, any = 1) exp10--;
+        for (; (unsigned)(*p - '0') < 10; p++, any = 1) {
+            if (++nd > 19) return strtod(s, NULL);
+            man = man * 10 + (uint64_t)(*p - '0');
+            exp10--;
+        }
+    }
+    if (!any) return strtod(s, NULL); /* inf, nan, or no number at all */
+    if (*p == 'e' || *p == 'E') {
+        const char* q = p + 1;
+        int eneg = 0;
+        if (*q == '+' || *q == '-') { eneg = *q == '-'; q++; }
+        if ((unsigned)(*q - '0') < 10) {
+            int64_t x = 0;
+            for (; (unsigned)(*q - '0') < 10; q++)
+                if (x < 100000) x = x * 10 + (*q - '0');
+            exp10 += eneg ? -x : x;
+        }
+    }
+    if (man == 0) return neg ? -0.0 : 0.0;
+
+#if FLT_EVAL_METHOD == 0
+    static const double exact_pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    if (man <= ((uint64_t)1 << 53) && exp10 >= -22 && exp10 <= 22) {
+        double d = (double)man;
+        d = exp10 < 0 ? d / exact_pow10[-exp10] : d * exact_pow10[exp10];
+        return neg ? -d : d;
+    }
+#endif
+    double d;
+    if (yona_eisel_lemire(man, exp10, neg, &d)) return d;
+    return strtod(s, NULL);
+}
@@ -1,23 +1,35 @@
 /* ===== Async Runtime =====
  *
- * Fixed-size thread pool with work queue. Async functions submit tasks
- * to the pool and return a promise handle immediately (non-blocking).
+ * Work-stealing thread pool. Async functions submit tasks to the pool and
+ * return a promise handle immediately (non-blocking).
  * Promises are awaited lazily at use sites via yona_rt_async_await.
  *
+ * Tasks run on fibers (green threads), so a task that waits on a promise,
+ * a channel or an io_uring completion parks instead of blocking its worker.
+ *
  * Structured concurrency: task groups track child promises. If one child
  * fails, siblings are cancelled (thread pool: skip execution; io_uring:
  * IORING_OP_ASYNC_CANCEL). Error propagated to parent via group_await_all.
  */
 
 #include "yona/runtime/sjlj.h"
+#include "yona/runtime/fiber.h"
 #include <pthread.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
-void yona_rt_arena_destroy(void* arena_ptr);
+void yona_rt_let_arena_end(void* arena);
 
-#define YONA_POOL_SIZE 8
-#define YONA_POOL_MAX_THREADS 32
 #define YONA_GROUP_INITIAL_CAP 8
+/* Ended groups kept per thread for reuse, and the largest children array a
+ * kept group holds on to (a bigger one goes back to the initial size). */
+#define YONA_GROUP_CACHE_MAX 64
+#define YONA_GROUP_CACHE_KEEP_CAP 256
+/* Bytes ahead of the inline child slots in a caller-provided group frame
+ * (mirrored by GROUP_FRAME_HEADER in CodegenExpr.cpp). */
+#define YONA_GROUP_FRAME_HEADER 256
 
 /* Forward declarations for exception handling (exceptions.c) */
 void* yona_rt_try_push(void);
@@ -26,13 +38,7 @@ void yona_rt_raise(int64_t symbol, const char* message);
 int64_t yona_rt_get_exception_symbol(void);
 const char* yona_rt_get_exception_message(void);
 
-struct yona_promise {
-    int64_t result;
-    int completed;             /* accessed via __atomic builtins */
-    int error;                 /* 1 if completed with error */
-    pthread_mutex_t mutex;
-    pthread_cond_t cond;
-};
+struct yona_promise;  /* defined with yona_task_t below */
 typedef struct yona_promise yona_promise_t;
 
 typedef int64_t (*yona_async_fn_t)(int64_t);
@@ -42,11 +48,10 @@ typedef int64_t (*yona_thunk_fn_t)(void);
 
 typedef struct yona_task_group {
     int cancelled;       /* accessed via __atomic builtins */
-    int pending_count;   /* accessed via __atomic builtins */
     /* Thread pool children */
     yona_promise_t** children;
     int child_count, child_cap;
-    /* io_uring children */
+    /* io_uring children (allocated on first use) */
     uint64_t* io_children;
     int io_child_count, io_child_cap;
     /* Error from first failing child */
@@ -57,29 +62,82 @@ typedef struct yona_task_group {
     void* arena;
     /* Synchronization */
     pthread_mutex_t mutex;
-    pthread_cond_t done_cond;
+    /* Lifecycle: a framed group lives in caller memory (yona_rt_group_begin_in)
+     * with its first children in inline slots; the rest come from and go
+     * back to the per-thread cache. */
+    int framed;
+    yona_promise_t** inline_children;
+    struct yona_task_group* next_free;
 } yona_task_group_t;
 
+_Static_assert(sizeof(yona_task_group_t) <= YONA_GROUP_FRAME_HEADER,
+               "YONA_GROUP_FRAME_HEADER too small for yona_task_group_t");
+
+static _Thread_local yona_task_group_t* yona_group_cache = NULL;
+static _Thread_local int yona_group_cached = 0;
+
+static void group_reset(yona_task_group_t* g) {
+    g->cancelled = 0;
+    g->child_count = 0;
+    g->io_child_count = 0;
+    g->first_error_symbol = 0;
+    g->first_error_msg = NULL;
+    g->has_error = 0;
+    g->arena = NULL;
+}
+
+/* Begin a group. Ended groups are recycled per thread, children array and
+ * all, so grouped lets and comprehensions in a loop stop hitting malloc. */
 yona_task_group_t* yona_rt_group_begin(void) {
-    yona_task_group_t* g = (yona_task_group_t*)calloc(1, sizeof(yona_task_group_t));
-    g->child_cap = YONA_GROUP_INITIAL_CAP;
-    g->children = (yona_promise_t**)malloc(g->child_cap * sizeof(yona_promise_t*));
-    g->io_child_cap = YONA_GROUP_INITIAL_CAP;
-    g->io_children = (uint64_t*)malloc(g->io_child_cap * sizeof(uint64_t));
+    yona_task_group_t* g = yona_group_cache;
+    if (g) {
+        yona_group_cache = g->next_free;
+        yona_group_cached--;
+    } else {
+        g = (yona_task_group_t*)calloc(1, sizeof(yona_task_group_t));
+        g->child_cap = YONA_GROUP_INITIAL_CAP;
+        g->children = (yona_promise_t**)malloc(g->child_cap * sizeof(yona_promise_t*));
+        pthread_mutex_init(&g->mutex, NULL);
+    }
+    group_reset(g);
+    return g;
+}
+
+/* Begin a group in caller memory of YONA_GROUP_FRAME_HEADER + cap pointer
+ * bytes, for groups whose child count is known at compile time. Children
+ * past cap spill to the heap; yona_rt_group_end frees only the spill. */
+yona_task_group_t* yona_rt_group_begin_in(void* frame, int64_t cap) {
+    yona_task_group_t* g = (yona_task_group_t*)frame;
+    g->framed = 1;
+    g->inline_children = cap > 0
+        ? (yona_promise_t**)((char*)frame + YONA_GROUP_FRAME_HEADER) : NULL;
+    g->children = g->inline_children;
+    g->child_cap = cap > 0 ? (int)cap : 0;
+    g->io_children = NULL;
+    g->io_child_cap = 0;
+    g->next_free = NULL;
     pthread_mutex_init(&g->mutex, NULL);
-    pthread_cond_init(&g->done_cond, NULL);
+    group_reset(g);
     return g;
 }
 
+static void group_grow_children(yona_task_group_t* g) {
+    int cap = g->child_cap ? g->child_cap * 2 : YONA_GROUP_INITIAL_CAP;
+    if (g->children == g->inline_children) {
+        yona_promise_t** heap = (yona_promise_t**)malloc(cap * sizeof(yona_promise_t*));
+        if (g->child_count) memcpy(heap, g->children, g->child_count * sizeof(yona_promise_t*));
+        g->children = heap;
+    } else {
+        g->children = (yona_promise_t**)realloc(g->children, cap * sizeof(yona_promise_t*));
+    }
+    g->child_cap = cap;
+}
+
 void yona_rt_group_register(yona_task_group_t* g, yona_promise_t* p) {
     if (!g) return;
     pthread_mutex_lock(&g->mutex);
-    if (g->child_count >= g->child_cap) {
-        g->child_cap *= 2;
-        g->children = (yona_promise_t**)realloc(g->children, g->child_cap * sizeof(yona_promise_t*));
-    }
+    if (g->child_count >= g->child_cap) group_grow_children(g);
     g->children[g->child_count++] = p;
-    __atomic_fetch_add(&g->pending_count, 1, __ATOMIC_SEQ_CST);
     pthread_mutex_unlock(&g->mutex);
 }
 
@@ -87,11 +145,10 @@ void yona_rt_group_register_io(yona_task_group_t* g, uint64_t io_id) {
     if (!g) return;
     pthread_mutex_lock(&g->mutex);
     if (g->io_child_count >= g->io_child_cap) {
-        g->io_child_cap *= 2;
+        g->io_child_cap = g->io_child_cap ? g->io_child_cap * 2 : YONA_GROUP_INITIAL_CAP;
         g->io_children = (uint64_t*)realloc(g->io_children, g->io_child_cap * sizeof(uint64_t));
     }
     g->io_children[g->io_child_count++] = io_id;
-    __atomic_fetch_add(&g->pending_count, 1, __ATOMIC_SEQ_CST);
     pthread_mutex_unlock(&g->mutex);
 }
 
@@ -114,35 +171,74 @@ void yona_rt_group_attach_arena(yona_task_group_t* g, void* arena) {
 void yona_rt_group_detach_arena(void* g_ptr) {
     yona_task_group_t* g = (yona_task_group_t*)g_ptr;
     if (!g || !g->arena) return;
-    yona_rt_arena_destroy(g->arena);
+    yona_rt_let_arena_end(g->arena);
     g->arena = NULL;
 }
 
-static void yona_rt_promise_destroy(yona_promise_t* p) {
-    if (!p) return;
-    pthread_mutex_lock(&p->mutex);
-    while (!p->completed)
-        pthread_cond_wait(&p->cond, &p->mutex);
-    pthread_mutex_unlock(&p->mutex);
-    pthread_mutex_destroy(&p->mutex);
-    pthread_cond_destroy(&p->cond);
-    free(p);
-}
+static void yona_rt_promise_destroy(yona_promise_t* p);  /* waits, then releases */
 
 void yona_rt_group_end(void* g_ptr) {
     yona_task_group_t* g = (yona_task_group_t*)g_ptr;
     if (!g) return;
-    yona_rt_group_detach_arena(g);
+    /* Children first: on raise unwind they may still be reading values
+     * the scope put in its arena. */
     for (int i = 0; i < g->child_count; i++)
         yona_rt_promise_destroy(g->children[i]);
-    pthread_mutex_destroy(&g->mutex);
-    pthread_cond_destroy(&g->done_cond);
-    free(g->children);
-    free(g->io_children);
-    free(g);
+    yona_rt_group_detach_arena(g);
+    if (g->framed) {
+        if (g->children != g->inline_children) free(g->children);
+        free(g->io_children);
+        pthread_mutex_destroy(&g->mutex);
+        return;
+    }
+    if (yona_group_cached >= YONA_GROUP_CACHE_MAX) {
+        pthread_mutex_destroy(&g->mutex);
+        free(g->children);
+        free(g->io_children);
+        free(g);
+        return;
+    }
+    if (g->child_cap > YONA_GROUP_CACHE_KEEP_CAP) {
+        g->child_cap = YONA_GROUP_INITIAL_CAP;
+        g->children = (yona_promise_t**)realloc(g->children, g->child_cap * sizeof(yona_promise_t*));
+    }
+    if (g->io_child_cap > YONA_GROUP_CACHE_KEEP_CAP) {
+        free(g->io_children);
+        g->io_children = NULL;
+        g->io_child_cap = 0;
+    }
+    g->next_free = yona_group_cache;
+    yona_group_cache = g;
+    yona_group_cached++;
 }
 
-/* ===== Task Queue ===== */
+/* ===== Work-Stealing Scheduler =====
+ *
+ * Each worker owns a Chase-Lev deque. The owner pushes and pops at the
+ * bottom (LIFO, so a task's children run while their data is still in
+ * cache); idle workers steal from the top (FIFO, oldest and usually
+ * largest work first). Threads outside the pool push onto a lock-free
+ * injection stack, which a worker takes in one exchange and moves into its
+ * own deque for the others to steal from.
+ *
+ * A worker that finds nothing parks on its own futex word after announcing
+ * itself in yona_parked and checking the queues once more. Submitters wake
+ * one parked worker, and only when someone is parked, so a busy pool takes
+ * no syscalls and no locks on the submit path. A woken fiber wakes exactly
+ * the worker it belongs to.
+ *
+ * Priorities (Std\Task.spawnWith): the deques hold normal tasks. Batch
+ * tasks get a second deque per worker, looked at only once urgent and
+ * normal work has run out, and every YONA_BATCH_EVERY picks so a saturated
+ * pool still gets through them. Urgent tasks go on one shared
+ * earliest-deadline-first heap that workers check before anything else; an
+ * urgent task without a deadline is due when submitted. Tasks spawned by a
+ * batch task are batch; those spawned by an urgent task are normal, so its
+ * own fan-out keeps the deque's locality.
+ */
+
+struct yona_fiber;
+typedef struct yona_fiber yona_fiber_t;
 
 typedef struct yona_task {
     yona_async_fn_t fn;     /* single-arg function (legacy) */
@@ -150,89 +246,766 @@ typedef struct yona_task {
     int64_t arg;
     yona_promise_t* promise;
     yona_task_group_t* group; /* owning group (NULL if ungrouped) */
-    struct yona_task* next;
+    struct yona_task* next;   /* injection stack link */
+    int64_t queued_ns;        /* when queued, if task timing is on; else 0 */
+    int prio;                 /* YONA_PRIO_* */
+    int structured;           /* group child or par chunk: gets a task arena */
+    int64_t due_ns;           /* urgent heap key */
+    _Atomic int started;      /* taken by whoever runs it (see task_claim) */
 } yona_task_t;
 
-/* Thread pool state */
-static pthread_t yona_pool_threads[YONA_POOL_SIZE];
-static yona_task_t* yona_task_head = NULL;
-static yona_task_t* yona_task_tail = NULL;
-static pthread_mutex_t yona_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t yona_pool_cond = PTHREAD_COND_INITIALIZER;
+/* Task classes, in Std\Task.TaskPriority constructor order */
+#define YONA_PRIO_URGENT 0
+#define YONA_PRIO_NORMAL 1
+#define YONA_PRIO_BATCH  2
+#define YONA_BATCH_EVERY 64
+
+/* Promise state word: PENDING, DONE, or the list of waiters parked on it.
+ * A waiter pushes itself with one CAS and completion is one exchange to
+ * DONE followed by a walk of the list, so nothing is locked and nobody is
+ * woken who is not actually waiting. Waiter nodes live on the waiter's
+ * stack (a fiber stack stays put while the fiber is parked). */
+#define YONA_PROMISE_PENDING ((uintptr_t)0)
+#define YONA_PROMISE_DONE    ((uintptr_t)1)
+
+typedef struct yona_waiter {
+    struct yona_waiter* next;
+    yona_fiber_t* fiber;       /* parked fiber, or NULL for a blocked thread */
+    _Atomic uint32_t woken;    /* a blocked thread sleeps on this */
+    int timed;                 /* heads a yona_timed_waiter_t */
+} yona_waiter_t;
+
+/* A pool promise and the task that fulfills it share one block, recycled
+ * through a per-thread free list. refs counts the awaiter plus the pending
+ * task; whoever drops the last one recycles it. The awaiter is usually the
+ * submitter, so blocks mostly return to the thread that took them. */
+struct yona_promise {
+    int64_t result;
+    _Atomic uintptr_t state;
+    int error;                 /* 1 if completed with error */
+    _Atomic int claimed;       /* first yona_rt_promise_complete wins */
+    _Atomic int refs;
+    struct yona_promise* next_free;
+    yona_task_t task;
+};
+
+#define YONA_DEQUE_INITIAL_CAP 256
+
+typedef struct yona_deque_buf {
+    int64_t mask;
+    /* Replaced buffers stay allocated: a stealer may still be reading one */
+    struct yona_deque_buf* retired;
+    _Atomic(yona_task_t*) slots[];
+} yona_deque_buf_t;
+
+typedef struct {
+    _Atomic int64_t top;          /* stealers */
+    char pad0[56];
+    _Atomic int64_t bottom;       /* owner */
+    _Atomic(yona_deque_buf_t*) buf;
+    char pad1[48];
+} yona_deque_t;
+
+typedef struct {
+    yona_deque_t deque;           /* normal tasks */
+    yona_deque_t batch;           /* batch tasks */
+    uint64_t rng;                 /* victim selection, owner only */
+    uint32_t picks;               /* batch fairness, owner only */
+    int cpu;                      /* pinned CPU, -1 if not pinned */
+    int node;                     /* NUMA node of cpu */
+    /* Fibers (see "Fibers" below); all owner only except ready/sleeping */
+    void* sched_sp;               /* scheduler loop while a fiber runs */
+    yona_fiber_t* runq;           /* woken fibers in wake order */
+    yona_fiber_t* cache;          /* finished fibers, stacks kept */
+    int cached;
+    struct yona_waitq_node* chan_parked; /* fibers parked on channels */
+    char pad1[64];
+    _Atomic(yona_fiber_t*) ready; /* woken fibers, pushed by any thread */
+    _Atomic int sleeping;         /* parked, or about to; cleared by its waker */
+    _Atomic uint32_t park;        /* futex word, bumped to wake */
+    char pad2[64];
+    yona_sched_stats_t stats;     /* written by the owner only */
+} __attribute__((aligned(64))) yona_worker_t;
+
+static yona_worker_t yona_workers[YONA_POOL_MAX_THREADS];
+static _Atomic int yona_worker_threads = 0;   /* slots handed out */
+static _Atomic(yona_task_t*) yona_inject_head = NULL;
+static _Atomic int yona_parked = 0;
 static _Atomic int yona_pool_initialized = 0;
+static _Thread_local yona_worker_t* yona_current_worker = NULL;
+static _Thread_local yona_fiber_t* yona_current_fiber = NULL;
+/* Class for tasks the running task spawns */
+static _Thread_local int yona_current_prio = YONA_PRIO_NORMAL;
+
+/* Std\Runtime.stats: threads outside the pool count here */
+static yona_sched_stats_t yona_stats_external;
+static _Atomic uint64_t yona_stats_compensations = 0;
+
+static void sched_count(int counter, uint64_t n) {
+    yona_worker_t* w = yona_current_worker;
+    sched_stat_bump(&(w ? &w->stats : &yona_stats_external)->count[counter], w != NULL, n);
+}
+
+/* For the shared report in compiled_runtime.c */
+static int sched_stats_workers(void) {
+    return atomic_load_explicit(&yona_worker_threads, memory_order_acquire);
+}
+
+static yona_sched_stats_t* sched_stats_worker(int i) {
+    return i < 0 ? &yona_stats_external : &yona_workers[i].stats;
+}
+
+static uint64_t sched_stats_compensations(void) {
+    return atomic_load_explicit(&yona_stats_compensations, memory_order_relaxed);
+}
+
+/* Pinning plan, fixed at pool start: worker i gets yona_pool_cpus[i % n] */
+static int yona_pool_cpus[YONA_POOL_MAX_THREADS];
+static int yona_pool_nodes[YONA_POOL_MAX_THREADS];
+static int yona_pool_ncpus = 0;
+static int yona_pool_numa = 0;  /* pinned workers span more than one node */
+
+static yona_deque_buf_t* deque_buf_new(int64_t cap) {
+    yona_deque_buf_t* a = (yona_deque_buf_t*)calloc(1, sizeof(yona_deque_buf_t) +
+                                                    (size_t)cap * sizeof(yona_task_t*));
+    a->mask = cap - 1;
+    return a;
+}
+
+static yona_deque_buf_t* deque_grow(yona_deque_t* d, yona_deque_buf_t* a, int64_t t, int64_t b) {
+    yona_deque_buf_t* n = deque_buf_new((a->mask + 1) * 2);
+    for (int64_t i = t; i < b; i++)
+        atomic_store_explicit(&n->slots[i & n->mask],
+                              atomic_load_explicit(&a->slots[i & a->mask], memory_order_relaxed),
+                              memory_order_relaxed);
+    n->retired = a;
+    atomic_store_explicit(&d->buf, n, memory_order_release);
+    return n;
+}
+
+/* Owner only */
+static void deque_push(yona_worker_t* w, yona_deque_t* d, yona_task_t* task) {
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    yona_deque_buf_t* a = atomic_load_explicit(&d->buf, memory_order_relaxed);
+    if (b - t > a->mask) a = deque_grow(d, a, t, b);
+    /* Release on the slot (not just the fence below) so thieves that read it
+     * see the task's fields; it costs nothing on x86 and keeps TSan quiet. */
+    atomic_store_explicit(&a->slots[b & a->mask], task, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    sched_stat_depth(&w->stats, b + 1 - t);
+}
+
+/* Owner only */
+static yona_task_t* deque_pop(yona_deque_t* d) {
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    yona_deque_buf_t* a = atomic_load_explicit(&d->buf, memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&d->top, memory_order_relaxed);
+    if (t > b) {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+    yona_task_t* task = atomic_load_explicit(&a->slots[b & a->mask], memory_order_relaxed);
+    if (t == b) {
+        /* Last task: race the stealers for it */
+        if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed))
+            task = NULL;
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+/* Any thread */
+static yona_task_t* deque_steal(yona_deque_t* d) {
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b) return NULL;
+    yona_deque_buf_t* a = atomic_load_explicit(&d->buf, memory_order_acquire);
+    yona_task_t* task = atomic_load_explicit(&a->slots[t & a->mask], memory_order_acquire);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+        return NULL;
+    return task;
+}
+
+static int deque_nonempty(yona_deque_t* d) {
+    return atomic_load_explicit(&d->bottom, memory_order_acquire) >
+           atomic_load_explicit(&d->top, memory_order_acquire);
+}
+
+static yona_deque_t* worker_deque(yona_worker_t* w, int prio) {
+    return prio == YONA_PRIO_BATCH ? &w->batch : &w->deque;
+}
+
+/* Urgent tasks: a binary min-heap on (due_ns, submission order). */
+typedef struct {
+    int64_t due_ns;
+    uint64_t seq;
+    yona_task_t* task;
+} yona_urgent_entry_t;
+
+static struct {
+    pthread_mutex_t mutex;
+    yona_urgent_entry_t* heap;
+    int count, cap;
+    uint64_t seq;
+} yona_urgent = {PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0};
+static _Atomic int yona_urgent_count = 0;  /* lets workers skip the lock */
+
+static int urgent_before(const yona_urgent_entry_t* a, const yona_urgent_entry_t* b) {
+    return a->due_ns != b->due_ns ? a->due_ns < b->due_ns : a->seq < b->seq;
+}
+
+static void urgent_push(yona_task_t* task) {
+    pthread_mutex_lock(&yona_urgent.mutex);
+    if (yona_urgent.count == yona_urgent.cap) {
+        yona_urgent.cap = yona_urgent.cap ? yona_urgent.cap * 2 : 64;
+        yona_urgent.heap = (yona_urgent_entry_t*)realloc(
+            yona_urgent.heap, (size_t)yona_urgent.cap * sizeof(yona_urgent_entry_t));
+    }
+    yona_urgent_entry_t e = {task->due_ns, yona_urgent.seq++, task};
+    int i = yona_urgent.count++;
+    while (i > 0 && urgent_before(&e, &yona_urgent.heap[(i - 1) / 2])) {
+        yona_urgent.heap[i] = yona_urgent.heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    yona_urgent.heap[i] = e;
+    atomic_fetch_add_explicit(&yona_urgent_count, 1, memory_order_release);
+    pthread_mutex_unlock(&yona_urgent.mutex);
+}
+
+static yona_task_t* urgent_take(void) {
+    if (!atomic_load_explicit(&yona_urgent_count, memory_order_acquire)) return NULL;
+    pthread_mutex_lock(&yona_urgent.mutex);
+    yona_task_t* task = NULL;
+    if (yona_urgent.count > 0) {
+        task = yona_urgent.heap[0].task;
+        yona_urgent_entry_t last = yona_urgent.heap[--yona_urgent.count];
+        int i = 0, n = yona_urgent.count;
+        for (;;) {
+            int c = 2 * i + 1;
+            if (c >= n) break;
+            if (c + 1 < n && urgent_before(&yona_urgent.heap[c + 1], &yona_urgent.heap[c])) c++;
+            if (!urgent_before(&yona_urgent.heap[c], &last)) break;
+            yona_urgent.heap[i] = yona_urgent.heap[c];
+            i = c;
+        }
+        if (n > 0) yona_urgent.heap[i] = last;
+        atomic_fetch_sub_explicit(&yona_urgent_count, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&yona_urgent.mutex);
+    return task;
+}
+
+static void inject_push(yona_task_t* task) {
+    task->next = atomic_load_explicit(&yona_inject_head, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&yona_inject_head, &task->next, task,
+                                                  memory_order_release, memory_order_relaxed))
+        ;
+}
+
+/* Take every injected task: run the oldest normal one, queue the rest on
+ * our deques in submission order so stealers see the oldest first. */
+static yona_task_t* inject_take(yona_worker_t* self) {
+    if (!atomic_load_explicit(&yona_inject_head, memory_order_relaxed)) return NULL;
+    yona_task_t* list = atomic_exchange_explicit(&yona_inject_head, NULL, memory_order_acquire);
+    yona_task_t* fifo = NULL;
+    while (list) {
+        yona_task_t* next = list->next;
+        list->next = fifo;
+        fifo = list;
+        list = next;
+    }
+    yona_task_t* first = NULL;
+    /* Read the link before pushing: once queued, a thief may run and free it. */
+    for (yona_task_t* t = fifo, *next; t; t = next) {
+        next = t->next;
+        if (!first && t->prio != YONA_PRIO_BATCH)
+            first = t;
+        else
+            deque_push(self, worker_deque(self, t->prio), t);
+    }
+    return first;
+}
+
+static yona_task_t* steal_any(yona_worker_t* self, int prio) {
+    int n = atomic_load_explicit(&yona_worker_threads, memory_order_acquire);
+    if (n <= 1) return NULL;
+    self->rng ^= self->rng << 13;
+    self->rng ^= self->rng >> 7;
+    self->rng ^= self->rng << 17;
+    int start = (int)(self->rng % (uint64_t)n);
+    /* With NUMA pinning, try workers on our node before remote ones */
+    for (int pass = yona_pool_numa ? 0 : 1; pass < 2; pass++) {
+        for (int i = 0; i < n; i++) {
+            yona_worker_t* v = &yona_workers[(start + i) % n];
+            yona_deque_t* d = worker_deque(v, prio);
+            if (v == self || !atomic_load_explicit(&d->buf, memory_order_acquire)) continue;
+            if (pass == 0 && v->node != self->node) continue;
+            yona_task_t* task = deque_steal(d);
+            if (task) {
+                sched_stat_bump(&self->stats.count[YONA_STAT_STEALS], 1, 1);
+                return task;
+            }
+        }
+    }
+    return NULL;
+}
+
+static yona_task_t* sched_find(yona_worker_t* self) {
+    yona_task_t* task = urgent_take();
+    if (task) return task;
+    if (++self->picks % YONA_BATCH_EVERY == 0 && (task = deque_pop(&self->batch)))
+        return task;
+    task = deque_pop(&self->deque);
+    if (!task) task = inject_take(self);
+    if (!task) task = steal_any(self, YONA_PRIO_NORMAL);
+    if (!task) task = deque_pop(&self->batch);
+    if (!task) task = steal_any(self, YONA_PRIO_BATCH);
+    return task;
+}
+
+/* True if any task or woken fiber is waiting to run anywhere. */
+static int sched_has_queued(void) {
+    if (atomic_load_explicit(&yona_inject_head, memory_order_acquire)) return 1;
+    if (atomic_load_explicit(&yona_urgent_count, memory_order_acquire)) return 1;
+    int n = atomic_load_explicit(&yona_worker_threads, memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        yona_worker_t* w = &yona_workers[i];
+        if (atomic_load_explicit(&w->ready, memory_order_acquire)) return 1;
+        if (!atomic_load_explicit(&w->batch.buf, memory_order_acquire)) continue;
+        if (deque_nonempty(&w->deque) || deque_nonempty(&w->batch)) return 1;
+    }
+    return 0;
+}
+
+/* Block while *addr == expected / wake threads blocked on addr. Used for
+ * worker parking and promise waits. Spurious returns are allowed. */
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+static void yona_futex_wait(_Atomic uint32_t* addr, uint32_t expected) {
+    yona_platform_io_flush();  /* queued I/O must not wait for our wakeup */
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static void yona_futex_wake(_Atomic uint32_t* addr, int n) {
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+/* As yona_futex_wait, giving up after ms milliseconds. Returns 1 on timeout. */
+static int yona_futex_wait_ms(_Atomic uint32_t* addr, uint32_t expected, int ms) {
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    yona_platform_io_flush();
+    return syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAIT_PRIVATE, expected, &ts, NULL, 0) < 0 &&
+           errno == ETIMEDOUT;
+}
+#else
+/* No futex: condition variables striped by address. Stripes are shared,
+ * so wakes broadcast and waiters recheck their word. */
+#define YONA_FUTEX_STRIPES 64
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} yona_futex_stripes[YONA_FUTEX_STRIPES];
+static pthread_once_t yona_futex_once = PTHREAD_ONCE_INIT;
+
+static void yona_futex_init(void) {
+    for (int i = 0; i < YONA_FUTEX_STRIPES; i++) {
+        pthread_mutex_init(&yona_futex_stripes[i].mutex, NULL);
+        pthread_cond_init(&yona_futex_stripes[i].cond, NULL);
+    }
+}
+
+static int yona_futex_stripe(_Atomic uint32_t* addr) {
+    pthread_once(&yona_futex_once, yona_futex_init);
+    return (int)(((uintptr_t)addr >> 4) % YONA_FUTEX_STRIPES);
+}
+
+static void yona_futex_wait(_Atomic uint32_t* addr, uint32_t expected) {
+    int i = yona_futex_stripe(addr);
+    pthread_mutex_lock(&yona_futex_stripes[i].mutex);
+    if (atomic_load(addr) == expected)
+        pthread_cond_wait(&yona_futex_stripes[i].cond, &yona_futex_stripes[i].mutex);
+    pthread_mutex_unlock(&yona_futex_stripes[i].mutex);
+}
+
+static void yona_futex_wake(_Atomic uint32_t* addr, int n) {
+    (void)n;
+    int i = yona_futex_stripe(addr);
+    pthread_mutex_lock(&yona_futex_stripes[i].mutex);
+    pthread_cond_broadcast(&yona_futex_stripes[i].cond);
+    pthread_mutex_unlock(&yona_futex_stripes[i].mutex);
+}
+
+static int yona_futex_wait_ms(_Atomic uint32_t* addr, uint32_t expected, int ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) { ts.tv_sec++; ts.tv_nsec -= 1000000000L; }
+    int i = yona_futex_stripe(addr), rc = 0;
+    pthread_mutex_lock(&yona_futex_stripes[i].mutex);
+    if (atomic_load(addr) == expected)
+        rc = pthread_cond_timedwait(&yona_futex_stripes[i].cond, &yona_futex_stripes[i].mutex, &ts);
+    pthread_mutex_unlock(&yona_futex_stripes[i].mutex);
+    return rc == ETIMEDOUT;
+}
+#endif
+
+/* Wake w if it is parked. Claiming sleeping first means two wakers never
+ * spend themselves on the same worker. Returns 1 if w was claimed. */
+static int worker_wake(yona_worker_t* w) {
+    int expected = 1;
+    if (!atomic_load_explicit(&w->sleeping, memory_order_relaxed) ||
+        !atomic_compare_exchange_strong(&w->sleeping, &expected, 0))
+        return 0;
+    atomic_fetch_add_explicit(&w->park, 1, memory_order_release);
+    yona_futex_wake(&w->park, 1);
+    return 1;
+}
+
+/* Wake one parked worker, if any. Called after a task is published. */
+static void sched_notify(void) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&yona_parked, memory_order_relaxed) > 0) {
+        int n = atomic_load_explicit(&yona_worker_threads, memory_order_acquire);
+        for (int i = 0; i < n; i++)
+            if (worker_wake(&yona_workers[i])) return;
+    }
+}
+
+/* ===== Timers =====
+ *
+ * A hierarchical timing wheel with 1 ms ticks: YONA_TIMER_LEVELS levels of
+ * 64 slots, where level L holds timers due within 64^(L+1) ticks. Arming
+ * and cancelling are a list insert or unlink however many timers are
+ * pending; a timer on an upper level drops a level each time its slot
+ * comes round, so it moves at most YONA_TIMER_LEVELS times.
+ *
+ * One clock thread, started on first need, sleeps until the next tick
+ * anything can fire on and then fires everything due. That is one kernel
+ * timer in total, not one per pending timeout. Callbacks run on the clock
+ * thread under the wheel lock, so a timer_cancel that returns has either
+ * beaten its callback or waited it out; they must only wake or queue work.
+ */
+
+#define YONA_TIMER_BITS 6
+#define YONA_TIMER_SLOTS (1 << YONA_TIMER_BITS)
+#define YONA_TIMER_LEVELS 6           /* 2^36 ms, a little over two years */
+#define YONA_TIMER_NEVER UINT64_MAX
+
+typedef struct yona_timer {
+    struct yona_timer *next, *prev;
+    uint64_t expires;                 /* tick */
+    int64_t period;                   /* ms between firings, 0 for one-shot */
+    void (*fire)(struct yona_timer*);
+    void* arg;
+    int level, slot;                  /* level -1 while not armed */
+} yona_timer_t;
+
+static struct {
+    pthread_mutex_t lock;
+    uint64_t now;                     /* last tick processed */
+    uint64_t wake_at;                 /* tick the clock thread sleeps until */
+    uint64_t occupied[YONA_TIMER_LEVELS];
+    yona_timer_t* slots[YONA_TIMER_LEVELS][YONA_TIMER_SLOTS];
+    int64_t epoch;                    /* monotonic ns at tick 0 */
+    int clock;                        /* 0 not started, 1 running, -1 failed */
+    _Atomic uint32_t wake;            /* futex word the clock thread sleeps on */
+} yona_wheel = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+/* Armed timers; while there are any, blocked tasks are not deadlocked. */
+static _Atomic int yona_timers_armed = 0;
+
+static int64_t yona_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint64_t timer_tick_now(void) {
+    return (uint64_t)((yona_monotonic_ns() - yona_wheel.epoch) / 1000000LL);
+}
+
+static void timer_init(yona_timer_t* t, void (*fire)(yona_timer_t*), void* arg) {
+    t->fire = fire;
+    t->arg = arg;
+    t->period = 0;
+    t->level = -1;
+}
+
+/* File t by its distance from the wheel's position. Lock held; t->expires
+ * is past yona_wheel.now. */
+static void timer_insert(yona_timer_t* t) {
+    const uint64_t span = 1ULL << (YONA_TIMER_BITS * YONA_TIMER_LEVELS);
+    if (t->expires - yona_wheel.now >= span) t->expires = yona_wheel.now + span - 1;
+    uint64_t delta = t->expires - yona_wheel.now;
+    int level = 0;
+    while (delta >= 1ULL << (YONA_TIMER_BITS * (level + 1))) level++;
+    int slot = (int)((t->expires >> (YONA_TIMER_BITS * level)) & (YONA_TIMER_SLOTS - 1));
+    yona_timer_t** head = &yona_wheel.slots[level][slot];
+    t->prev = NULL;
+    t->next = *head;
+    if (*head) (*head)->prev = t;
+    *head = t;
+    t->level = level;
+    t->slot = slot;
+    yona_wheel.occupied[level] |= 1ULL << slot;
+}
+
+static void timer_unlink(yona_timer_t* t) {
+    if (t->prev) t->prev->next = t->next;
+    else yona_wheel.slots[t->level][t->slot] = t->next;
+    if (t->next) t->next->prev = t->prev;
+    if (!yona_wheel.slots[t->level][t->slot])
+        yona_wheel.occupied[t->level] &= ~(1ULL << t->slot);
+    t->level = -1;
+}
+
+/* The first tick after now on which something can happen: a level-0 timer
+ * falling due, or an occupied upper level's next slot coming round. */
+static uint64_t wheel_next(void) {
+    uint64_t now = yona_wheel.now, next = YONA_TIMER_NEVER;
+    uint64_t occ = yona_wheel.occupied[0];
+    if (occ) {
+        unsigned s = (unsigned)((now + 1) & (YONA_TIMER_SLOTS - 1));
+        uint64_t rot = s ? (occ >> s) | (occ << (64 - s)) : occ;
+        next = now + 1 + (uint64_t)__builtin_ctzll(rot);
+    }
+    for (int level = 1; level < YONA_TIMER_LEVELS; level++) {
+        if (!yona_wheel.occupied[level]) continue;
+        unsigned shift = YONA_TIMER_BITS * (unsigned)level;
+        uint64_t boundary = ((now >> shift) + 1) << shift;
+        if (boundary < next) next = boundary;
+    }
+    return next;
+}
+
+/* Process tick t: pull the slots that come round on it down a level, then
+ * fire level 0's. Periodic timers are re-filed before their callback. */
+static void wheel_tick(uint64_t t) {
+    yona_wheel.now = t;
+    for (int level = 1; level < YONA_TIMER_LEVELS; level++) {
+        unsigned shift = YONA_TIMER_BITS * (unsigned)level;
+        if (t & ((1ULL << shift) - 1)) break;
+        int slot = (int)((t >> shift) & (YONA_TIMER_SLOTS - 1));
+        yona_timer_t* list = yona_wheel.slots[level][slot];
+        yona_wheel.slots[level][slot] = NULL;
+        yona_wheel.occupied[level] &= ~(1ULL << slot);
+        for (yona_timer_t* next; list; list = next) {
+            next = list->next;
+            timer_insert(list);
+        }
+    }
+    int slot = (int)(t & (YONA_TIMER_SLOTS - 1));
+    while (yona_wheel.slots[0][slot]) {
+        yona_timer_t* due = yona_wheel.slots[0][slot];
+        timer_unlink(due);
+        if (due->period > 0) {
+            due->expires = t + (uint64_t)due->period;
+            timer_insert(due);
+        } else {
+            atomic_fetch_sub_explicit(&yona_timers_armed, 1, memory_order_relaxed);
+        }
+        /* A one-shot timer may be gone once its callback has run */
+        due->fire(due);
+    }
+}
+
+/* Lock held. Skips straight over ticks on which nothing can happen. */
+static void wheel_advance(uint64_t target) {
+    while (yona_wheel.now < target) {
+        uint64_t next = wheel_next();
+        if (next > target) {
+            yona_wheel.now = target;
+            return;
+        }
+        wheel_tick(next);
+    }
+}
+
+static void* timer_clock(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&yona_wheel.lock);
+    for (;;) {
+        wheel_advance(timer_tick_now());
+        uint64_t next = wheel_next();
+        yona_wheel.wake_at = next;
+        uint32_t seq = atomic_load_explicit(&yona_wheel.wake, memory_order_relaxed);
+        pthread_mutex_unlock(&yona_wheel.lock);
+        if (next == YONA_TIMER_NEVER) {
+            yona_futex_wait(&yona_wheel.wake, seq);
+        } else {
+            int64_t ns = yona_wheel.epoch + (int64_t)next * 1000000LL - yona_monotonic_ns();
+            if (ns > 0) {
+                int64_t ms = (ns + 999999) / 1000000;
+                yona_futex_wait_ms(&yona_wheel.wake, seq, ms > INT32_MAX ? INT32_MAX : (int)ms);
+            }
+        }
+        pthread_mutex_lock(&yona_wheel.lock);
+    }
+    return NULL;
+}
+
+/* Start the clock thread if need be. Returns 0 if there is none to be had;
+ * callers then wait on the thread instead of arming a timer. */
+static int timer_clock_start(void) {
+    pthread_mutex_lock(&yona_wheel.lock);
+    if (yona_wheel.clock == 0) {
+        yona_wheel.epoch = yona_monotonic_ns();
+        yona_wheel.wake_at = YONA_TIMER_NEVER;
+        pthread_t thread;
+        yona_wheel.clock = pthread_create(&thread, NULL, timer_clock, NULL) == 0 ? 1 : -1;
+        if (yona_wheel.clock == 1) pthread_detach(thread);
+    }
+    int ok = yona_wheel.clock == 1;
+    pthread_mutex_unlock(&yona_wheel.lock);
+    return ok;
+}
+
+/* Fire t after ms milliseconds (at least one tick), then every t->period
+ * ms if that is set. Requires timer_clock_start(). */
+static void timer_arm(yona_timer_t* t, int64_t ms) {
+    pthread_mutex_lock(&yona_wheel.lock);
+    t->expires = timer_tick_now() + (uint64_t)(ms > 0 ? ms : 1);
+    timer_insert(t);
+    atomic_fetch_add_explicit(&yona_timers_armed, 1, memory_order_relaxed);
+    if (t->expires < yona_wheel.wake_at) {
+        yona_wheel.wake_at = t->expires;
+        atomic_fetch_add_explicit(&yona_wheel.wake, 1, memory_order_relaxed);
+        yona_futex_wake(&yona_wheel.wake, 1);
+    }
+    pthread_mutex_unlock(&yona_wheel.lock);
+}
+
+/* Disarm t. Returns 1 if it was still pending. Once this returns its
+ * callback is not running and will not run. */
+static int timer_cancel(yona_timer_t* t) {
+    pthread_mutex_lock(&yona_wheel.lock);
+    int pending = t->level >= 0;
+    if (pending) {
+        timer_unlink(t);
+        atomic_fetch_sub_explicit(&yona_timers_armed, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&yona_wheel.lock);
+    return pending;
+}
 
 /* Channel liveness tracking.
  *
- * The fixed worker pool uses managed blocking: when a worker blocks on a
- * channel while queued work exists, the runtime may add a compensation worker.
+ * The worker pool uses managed blocking: when a worker blocks on a channel
+ * while queued work exists, the runtime may add a compensation worker.
  * Deadlock is reported only when every known worker task is blocked and no
  * queued task can make progress. This replaces the old timeout heuristic, so
  * slow producers are allowed to be slow without being misreported as deadlocks.
+ *
+ * The counters live in one atomic word so they change together and the
+ * deadlock check reads them as a single snapshot. A worker counts as
+ * running from the moment it starts looking for work until it parks, so a
+ * task is always either in a queue or held by a running worker. Every
+ * update bumps a generation in the top bits; the check reads the word
+ * before and after scanning the queues and only trusts an unchanged one.
+ *
+ * A fiber parked on a channel counts as blocked but leaves its worker
+ * running, so BLOCKED is wide enough for a very large number of them.
  */
-static pthread_mutex_t yona_liveness_mutex = PTHREAD_MUTEX_INITIALIZER;
-static int64_t yona_next_task_id = 1;
-static int yona_worker_threads = 0;
-static int yona_queued_tasks = 0;
-static int yona_running_workers = 0;
-static int yona_blocked_workers = 0;
-static int yona_active_external_tasks = 0;
-static int yona_external_waiters = 0;
+#define LV_RUNNING    0   /* workers searching for or running tasks */
+#define LV_BLOCKED    1   /* workers and fibers blocked on a channel */
+#define LV_EXT_ACTIVE 2   /* non-worker threads that submitted work */
+#define LV_EXT_WAIT   3   /* of those, blocked on a channel */
+#define LV_GEN_SHIFT  50
+
+/* Field f occupies bits lv_shift[f] .. lv_shift[f + 1] - 1 */
+static const int lv_shift[5] = {0, 10, 30, 40, LV_GEN_SHIFT};
+
+static _Atomic uint64_t yona_liveness = 0;
+static _Atomic int64_t yona_next_task_id = 1;
 static _Thread_local int64_t yona_current_task_id = 0;
 static _Thread_local int yona_current_task_is_worker = 0;
 static _Thread_local int yona_external_task_registered = 0;
-static _Thread_local int yona_channel_wait_kind = 0; /* 1 worker, 2 external */
+static _Thread_local int yona_channel_wait_kind = 0; /* 1 worker, 2 external, 3 fiber */
 static _Thread_local int yona_deadlock_candidate_seen = 0;
 
-static void* yona_pool_worker(void* unused);
-
-static void start_pool_worker_unlocked(void) {
-    pthread_t thread;
-    if (pthread_create(&thread, NULL, yona_pool_worker, NULL) == 0) {
-        pthread_detach(thread);
-        yona_worker_threads++;
-    }
+static inline uint64_t lv_mask(int field) {
+    return (1ULL << (lv_shift[field + 1] - lv_shift[field])) - 1;
 }
 
-static void maybe_spawn_compensation_worker_unlocked(void) {
-    if (yona_queued_tasks <= 0) return;
-    if (yona_worker_threads >= YONA_POOL_MAX_THREADS) return;
-    if (yona_running_workers > 0) return;
-    start_pool_worker_unlocked();
+static inline int lv_get(uint64_t s, int field) {
+    return (int)((s >> lv_shift[field]) & lv_mask(field));
 }
 
-static void liveness_task_queued(void) {
-    pthread_mutex_lock(&yona_liveness_mutex);
-    yona_queued_tasks++;
-    pthread_mutex_unlock(&yona_liveness_mutex);
+/* Apply per-field deltas in one step. Decrements stop at zero. */
+static uint64_t liveness_update(int d_running, int d_blocked, int d_ext_active, int d_ext_wait) {
+    int deltas[4] = {d_running, d_blocked, d_ext_active, d_ext_wait};
+    uint64_t old = atomic_load_explicit(&yona_liveness, memory_order_relaxed), next;
+    do {
+        next = ((old >> LV_GEN_SHIFT) + 1) << LV_GEN_SHIFT;
+        for (int f = 0; f < 4; f++) {
+            int v = lv_get(old, f) + deltas[f];
+            if (v < 0) v = 0;
+            next |= ((uint64_t)v & lv_mask(f)) << lv_shift[f];
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&yona_liveness, &old, next,
+                                                    memory_order_seq_cst, memory_order_relaxed));
+    return next;
 }
 
-static void liveness_register_external_task_unlocked(void) {
+static void liveness_register_external_task(void) {
     if (yona_current_task_is_worker || yona_external_task_registered) return;
     yona_external_task_registered = 1;
-    yona_current_task_id = yona_next_task_id++;
-    yona_active_external_tasks++;
+    yona_current_task_id = atomic_fetch_add(&yona_next_task_id, 1);
+    liveness_update(0, 0, 1, 0);
+}
+
+static void* yona_pool_worker(void* arg);
+
+/* Hand out a worker slot and start its thread. Returns 0 if the pool is full. */
+static int start_pool_worker(void) {
+    int i = atomic_load(&yona_worker_threads);
+    do {
+        if (i >= YONA_POOL_MAX_THREADS) return 0;
+    } while (!atomic_compare_exchange_weak(&yona_worker_threads, &i, i + 1));
+    yona_worker_t* w = &yona_workers[i];
+    w->rng = 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1);
+    w->cpu = yona_pool_ncpus ? yona_pool_cpus[i % yona_pool_ncpus] : -1;
+    w->node = yona_pool_ncpus ? yona_pool_nodes[i % yona_pool_ncpus] : 0;
+    atomic_store_explicit(&w->deque.buf, deque_buf_new(YONA_DEQUE_INITIAL_CAP), memory_order_release);
+    atomic_store_explicit(&w->batch.buf, deque_buf_new(YONA_DEQUE_INITIAL_CAP), memory_order_release);
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, yona_pool_worker, w) == 0)
+        pthread_detach(thread);
+    return 1;
+}
+
+/* Queued work and nobody running it: wake a parked worker, or add one if
+ * all of them are blocked. */
+static void maybe_spawn_compensation_worker(void) {
+    if (lv_get(atomic_load(&yona_liveness), LV_RUNNING) > 0) return;
+    if (!sched_has_queued()) return;
+    if (atomic_load(&yona_parked) > 0) sched_notify();
+    else if (start_pool_worker())
+        atomic_fetch_add_explicit(&yona_stats_compensations, 1, memory_order_relaxed);
 }
 
 static void liveness_worker_begin(void) {
-    pthread_mutex_lock(&yona_liveness_mutex);
-    if (yona_queued_tasks > 0) yona_queued_tasks--;
-    yona_running_workers++;
-    yona_current_task_id = yona_next_task_id++;
-    yona_current_task_is_worker = 1;
-    pthread_mutex_unlock(&yona_liveness_mutex);
+    yona_current_task_id = atomic_fetch_add(&yona_next_task_id, 1);
 }
 
 static void liveness_worker_end(void) {
-    pthread_mutex_lock(&yona_liveness_mutex);
-    if (yona_channel_wait_kind == 1) {
-        if (yona_blocked_workers > 0) yona_blocked_workers--;
-        yona_channel_wait_kind = 0;
-    } else if (yona_current_task_is_worker && yona_running_workers > 0) {
-        yona_running_workers--;
-    }
+    /* The task left while waiting on a channel (raised out of the wait) */
+    if (yona_channel_wait_kind == 1)
+        liveness_update(1, -1, 0, 0);
+    else if (yona_channel_wait_kind == 3)
+        liveness_update(0, -1, 0, 0);
+    yona_channel_wait_kind = 0;
     yona_current_task_id = 0;
-    yona_current_task_is_worker = 0;
-    pthread_mutex_unlock(&yona_liveness_mutex);
 }
 
 int yona_rt_channel_wait_begin(void* channel, int op, int64_t count, int64_t cap,
@@ -242,192 +1015,937 @@ int yona_rt_channel_wait_begin(void* channel, int op, int64_t count, int64_t cap
     (void)count;
     (void)cap;
     (void)closed;
-    pthread_mutex_lock(&yona_liveness_mutex);
-    if (yona_current_task_is_worker) {
-        if (yona_running_workers > 0) yona_running_workers--;
-        yona_blocked_workers++;
+    if (yona_current_fiber) {
+        /* Only the task waits; its worker keeps running others */
+        liveness_update(0, 1, 0, 0);
+        yona_channel_wait_kind = 3;
+    } else if (yona_current_task_is_worker) {
+        liveness_update(-1, 1, 0, 0);
         yona_channel_wait_kind = 1;
-        maybe_spawn_compensation_worker_unlocked();
     } else {
-        liveness_register_external_task_unlocked();
-        if (yona_active_external_tasks > 0) yona_active_external_tasks--;
-        yona_external_waiters++;
+        liveness_register_external_task();
+        liveness_update(0, 0, -1, 1);
         yona_channel_wait_kind = 2;
-        maybe_spawn_compensation_worker_unlocked();
     }
+    maybe_spawn_compensation_worker();
+    uint64_t s1 = atomic_load(&yona_liveness);
+    int queued = sched_has_queued();
+    uint64_t s2 = atomic_load(&yona_liveness);
     /* Blocked workers on *other* channels can still make progress (e.g. a
      * producer/consumer pair on a work channel while main waits on done).
      * opposite_waiters is only for this channel, so treat other blocked
-     * tasks as live progress. */
-    int other_blocked = yona_current_task_is_worker ? (yona_blocked_workers > 1)
-                                                    : (yona_blocked_workers > 0);
-    int deadlock_candidate = (yona_running_workers == 0 &&
-                              yona_active_external_tasks == 0 &&
-                              yona_queued_tasks == 0 &&
+     * tasks as live progress. So is a pending timer: a sleeping task or a
+     * timed wait will come back on its own. */
+    int blocked = lv_get(s1, LV_BLOCKED);
+    int other_blocked = yona_current_task_is_worker ? (blocked > 1) : (blocked > 0);
+    /* A fiber's own worker is running it */
+    int running = lv_get(s1, LV_RUNNING) - (yona_channel_wait_kind == 3);
+    int deadlock_candidate = (s1 == s2 &&
+                              running == 0 &&
+                              lv_get(s1, LV_EXT_ACTIVE) == 0 &&
+                              !queued &&
                               opposite_waiters <= 0 &&
-                              !other_blocked);
+                              !other_blocked &&
+                              atomic_load(&yona_timers_armed) == 0);
     /* A condition-variable signal can make a waiter runnable before it has
      * returned from timedwait and restored its liveness state. Confirm the
      * quiescent state across one wait cycle before raising :Deadlock. */
     int deadlocked = deadlock_candidate && yona_deadlock_candidate_seen;
     yona_deadlock_candidate_seen = deadlock_candidate ? 1 : 0;
-    pthread_mutex_unlock(&yona_liveness_mutex);
     return deadlocked;
 }
 
 void yona_rt_channel_wait_end(void) {
-    pthread_mutex_lock(&yona_liveness_mutex);
-    if (yona_channel_wait_kind == 1) {
-        if (yona_blocked_workers > 0) yona_blocked_workers--;
-        yona_running_workers++;
-    } else if (yona_channel_wait_kind == 2) {
-        if (yona_external_waiters > 0) yona_external_waiters--;
-        yona_active_external_tasks++;
+    if (yona_channel_wait_kind == 1)
+        liveness_update(1, -1, 0, 0);
+    else if (yona_channel_wait_kind == 2)
+        liveness_update(0, 0, 1, -1);
+    else if (yona_channel_wait_kind == 3)
+        liveness_update(0, -1, 0, 0);
+    yona_channel_wait_kind = 0;
+}
+
+/* ===== Fibers =====
+ *
+ * Every pool task runs on a fiber: its own small stack that the worker
+ * switches to. A task that has to wait (a pending promise or parallel job,
+ * a channel, an io_uring completion) parks its fiber and the worker goes
+ * back to its scheduler loop, so blocked tasks cost a stack each rather
+ * than a thread each. Whoever completes the wait makes the fiber ready
+ * again, and it resumes on the worker that started it: compiled code may
+ * keep the address of a thread-local across a call, so a running task never
+ * changes thread. Tasks that have not started still move between deques.
+ *
+ * Stacks are reserved with MAP_NORESERVE (YONA_FIBER_STACK_KB, default
+ * the size of a new thread's stack) and cost only the pages a task
+ * touches, so a task recurses as deep as it would on a thread. Every stack
+ * has a PROT_NONE guard page below it. Finished fibers are kept per worker
+ * for reuse. On targets without a context switch below, or when a stack
+ * or its guard cannot be mapped (vm.max_map_count), a task runs on the
+ * worker's own stack and its waits block the thread.
+ *
+ * The switch saves only what the C ABI makes callee-saved, plus the FP
+ * control words; everything else is already spilled by the call.
+ */
+
+#if defined(__x86_64__) || defined(__aarch64__)
+#define YONA_FIBERS 1
+#else
+#define YONA_FIBERS 0
+#endif
+
+#if defined(__SANITIZE_THREAD__)
+#define YONA_FIBER_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define YONA_FIBER_TSAN 1
+#endif
+#endif
+#ifndef YONA_FIBER_TSAN
+#define YONA_FIBER_TSAN 0
+#endif
+
+#if YONA_FIBER_TSAN
+void* __tsan_get_current_fiber(void);
+void* __tsan_create_fiber(unsigned flags);
+void __tsan_destroy_fiber(void* fiber);
+void __tsan_switch_to_fiber(void* fiber, unsigned flags);
+#endif
+
+#define YONA_FIBER_STACK_KB_MIN 256
+#define YONA_FIBER_CACHE_MAX 64
+#define YONA_FIBER_POLL_MS 100   /* channel deadlock re-check while idle */
+
+#define YONA_HELP_MAX_DEPTH 64
+static _Thread_local int yona_help_depth = 0;
+
+struct yona_fiber {
+    void* sp;                  /* saved stack pointer while switched out */
+    yona_worker_t* owner;
+    yona_task_t* task;         /* task to run; NULL once it has returned */
+    yona_fiber_t* next;        /* ready stack, run queue or cache link */
+    char* map;                 /* the stack mapping, guard page first */
+    size_t map_size;
+#if YONA_FIBER_TSAN
+    void* tsan;
+    void* owner_tsan;          /* the scheduler loop's TSan context */
+#endif
+};
+
+#if YONA_FIBERS
+/* Save callee-saved state on the current stack, store the stack pointer in
+ * *from, then load to and restore what was saved there. A new fiber starts
+ * in yona_fiber_trampoline with its argument and entry point in
+ * callee-saved registers. */
+void yona_fiber_switch(void** from, void* to);
+void yona_fiber_trampoline(void);
+
+#if defined(__APPLE__)
+#define YONA_FIBER_SYM(name) "_" #name
+#define YONA_FIBER_FUNC(name) ".globl " YONA_FIBER_SYM(name) "\n" YONA_FIBER_SYM(name) ":\n"
+#else
+#define YONA_FIBER_SYM(name) #name
+#define YONA_FIBER_FUNC(name) \
+    ".globl " #name "\n.hidden " #name "\n.type " #name ", @function\n" #name ":\n"
+#endif
+
+#if defined(__x86_64__)
+__asm__(".text\n.p2align 4\n"
+        YONA_FIBER_FUNC(yona_fiber_switch)
+        "pushq %rbp\n pushq %rbx\n pushq %r12\n pushq %r13\n pushq %r14\n pushq %r15\n"
+        "subq $8, %rsp\n stmxcsr (%rsp)\n fnstcw 4(%rsp)\n"
+        "movq %rsp, (%rdi)\n movq %rsi, %rsp\n"
+        "ldmxcsr (%rsp)\n fldcw 4(%rsp)\n addq $8, %rsp\n"
+        "popq %r15\n popq %r14\n popq %r13\n popq %r12\n popq %rbx\n popq %rbp\n"
+        "ret\n"
+        ".p2align 4\n"
+        YONA_FIBER_FUNC(yona_fiber_trampoline)
+        "movq %r12, %rdi\n callq *%r13\n ud2\n");
+
+/* Initial frame, popped by the second half of yona_fiber_switch: control
+ * words, r15..r12, rbx, rbp, then the return into the trampoline. */
+static void* fiber_initial_sp(char* top, void (*entry)(yona_fiber_t*), yona_fiber_t* arg) {
+    uint64_t* sp = (uint64_t*)top - 10;
+    memset(sp, 0, 10 * sizeof(uint64_t));
+    sp[0] = 0x1F80 | (0x037FULL << 32);  /* default MXCSR and x87 control word */
+    sp[3] = (uint64_t)(uintptr_t)entry;  /* r13 */
+    sp[4] = (uint64_t)(uintptr_t)arg;    /* r12 */
+    sp[7] = (uint64_t)(uintptr_t)yona_fiber_trampoline;
+    return sp;
+}
+#else /* __aarch64__ */
+__asm__(".text\n.p2align 4\n"
+        YONA_FIBER_FUNC(yona_fiber_switch)
+        "sub sp, sp, #176\n"
+        "stp x19, x20, [sp, #0]\n stp x21, x22, [sp, #16]\n stp x23, x24, [sp, #32]\n"
+        "stp x25, x26, [sp, #48]\n stp x27, x28, [sp, #64]\n stp x29, x30, [sp, #80]\n"
+        "stp d8, d9, [sp, #96]\n stp d10, d11, [sp, #112]\n"
+        "stp d12, d13, [sp, #128]\n stp d14, d15, [sp, #144]\n"
+        "mrs x9, fpcr\n str x9, [sp, #160]\n"
+        "mov x9, sp\n str x9, [x0]\n mov sp, x1\n"
+        "ldr x9, [sp, #160]\n msr fpcr, x9\n"
+        "ldp x19, x20, [sp, #0]\n ldp x21, x22, [sp, #16]\n ldp x23, x24, [sp, #32]\n"
+        "ldp x25, x26, [sp, #48]\n ldp x27, x28, [sp, #64]\n ldp x29, x30, [sp, #80]\n"
+        "ldp d8, d9, [sp, #96]\n ldp d10, d11, [sp, #112]\n"
+        "ldp d12, d13, [sp, #128]\n ldp d14, d15, [sp, #144]\n"
+        "add sp, sp, #176\n"
+        "ret\n"
+        ".p2align 4\n"
+        YONA_FIBER_FUNC(yona_fiber_trampoline)
+        "mov x0, x19\n blr x20\n brk #0\n");
+
+/* Initial frame: x19 = argument, x20 = entry, x29 = 0 (ends backtraces),
+ * x30 = trampoline, FPCR = 0 (round to nearest, no traps). */
+static void* fiber_initial_sp(char* top, void (*entry)(yona_fiber_t*), yona_fiber_t* arg) {
+    uint64_t* sp = (uint64_t*)top - 22;
+    memset(sp, 0, 22 * sizeof(uint64_t));
+    sp[0] = (uint64_t)(uintptr_t)arg;
+    sp[1] = (uint64_t)(uintptr_t)entry;
+    sp[11] = (uint64_t)(uintptr_t)yona_fiber_trampoline;
+    return sp;
+}
+#endif
+
+static _Atomic size_t yona_fiber_stack_bytes = 0;  /* set by yona_pool_init */
+static _Atomic int yona_fiber_live = 0;
+static _Atomic int yona_fiber_unavailable = 0;
+
+static void fiber_main(yona_fiber_t* f);
+
+/* Default: whatever a new thread would get, so moving a task from a
+ * thread to a fiber does not lower its recursion limit. */
+static size_t fiber_configured_stack_bytes(void) {
+    const char* env = getenv("YONA_FIBER_STACK_KB");
+    if (env && *env) {
+        long kb = atol(env);
+        return (size_t)(kb < 16 ? 16 : kb) * 1024;
+    }
+    size_t bytes = 0;
+    pthread_attr_t attr;
+    if (pthread_attr_init(&attr) == 0) {
+        pthread_attr_getstacksize(&attr, &bytes);
+        pthread_attr_destroy(&attr);
+    }
+    if (bytes < (size_t)YONA_FIBER_STACK_KB_MIN * 1024) bytes = (size_t)YONA_FIBER_STACK_KB_MIN * 1024;
+    return bytes;
+}
+
+/* NULL when no guarded stack can be mapped. With no fiber alive that is
+ * permanent (the platform refuses); otherwise the map count or address
+ * space ran out and a later fiber may fit once some are freed. */
+static yona_fiber_t* fiber_new(yona_worker_t* owner) {
+    if (atomic_load_explicit(&yona_fiber_unavailable, memory_order_relaxed)) return NULL;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t bytes = atomic_load_explicit(&yona_fiber_stack_bytes, memory_order_relaxed);
+    size_t size = (bytes + page - 1) / page * page + page;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+#ifdef MAP_STACK
+    flags |= MAP_STACK;
+#endif
+    char* map = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (map != MAP_FAILED && mprotect(map, page, PROT_NONE) != 0) {
+        munmap(map, size);
+        map = MAP_FAILED;
+    }
+    if (map == MAP_FAILED) {
+        if (atomic_load_explicit(&yona_fiber_live, memory_order_relaxed) == 0)
+            atomic_store_explicit(&yona_fiber_unavailable, 1, memory_order_relaxed);
+        return NULL;
+    }
+    atomic_fetch_add_explicit(&yona_fiber_live, 1, memory_order_relaxed);
+    /* The fiber record sits at the top of its own stack */
+    uintptr_t top = ((uintptr_t)(map + size) - sizeof(yona_fiber_t)) & ~(uintptr_t)63;
+    yona_fiber_t* f = (yona_fiber_t*)top;
+    f->owner = owner;
+    f->task = NULL;
+    f->next = NULL;
+    f->map = map;
+    f->map_size = size;
+#if YONA_FIBER_TSAN
+    f->tsan = __tsan_create_fiber(0);
+    f->owner_tsan = __tsan_get_current_fiber();
+#endif
+    f->sp = fiber_initial_sp((char*)top, fiber_main, f);
+    return f;
+}
+
+static void fiber_free(yona_fiber_t* f) {
+#if YONA_FIBER_TSAN
+    __tsan_destroy_fiber(f->tsan);
+#endif
+    munmap(f->map, f->map_size);
+    atomic_fetch_sub_explicit(&yona_fiber_live, 1, memory_order_relaxed);
+}
+
+static yona_fiber_t* fiber_get(yona_worker_t* self) {
+    yona_fiber_t* f = self->cache;
+    if (f) {
+        self->cache = f->next;
+        self->cached--;
+        return f;
+    }
+    return fiber_new(self);
+}
+
+static void fiber_recycle(yona_worker_t* self, yona_fiber_t* f) {
+    if (self->cached >= YONA_FIBER_CACHE_MAX) {
+        fiber_free(f);
+        return;
+    }
+    f->next = self->cache;
+    self->cache = f;
+    self->cached++;
+}
+
+/* Scheduler side: run f until it parks or its task returns. */
+static void fiber_enter(yona_worker_t* self, yona_fiber_t* f) {
+    yona_current_fiber = f;
+#if YONA_FIBER_TSAN
+    __tsan_switch_to_fiber(f->tsan, 0);
+#endif
+    yona_fiber_switch(&self->sched_sp, f->sp);
+    yona_current_fiber = NULL;
+    if (!f->task) fiber_recycle(self, f);
+}
+
+/* Fiber side: back to the scheduler loop. */
+static void fiber_leave(yona_fiber_t* f) {
+#if YONA_FIBER_TSAN
+    __tsan_switch_to_fiber(f->owner_tsan, 0);
+#endif
+    yona_fiber_switch(&f->sp, f->owner->sched_sp);
+}
+
+static void run_task(yona_task_t* task);
+
+static void fiber_main(yona_fiber_t* f) {
+    for (;;) {
+        run_task(f->task);
+        f->task = NULL;
+        fiber_leave(f);
     }
+}
+
+/* Park the current fiber until fiber_ready. The task's exception state and
+ * per-task thread-locals go with it; the worker resumes with a clean slate. */
+static void fiber_suspend(void) {
+    yona_fiber_t* f = yona_current_fiber;
+    int64_t task_id = yona_current_task_id;
+    int help_depth = yona_help_depth;
+    int wait_kind = yona_channel_wait_kind;
+    int candidate_seen = yona_deadlock_candidate_seen;
+    int prio = yona_current_prio;
+    yona_task_arena_t arena = task_arena_enter(0);
+    yona_platform_io_flush();
+    void* exc = __builtin_alloca(yona_exc_park_size());
+    yona_exc_park(exc);
+    sched_count(YONA_STAT_SUSPENDS, 1);
+    yona_current_task_id = 0;
+    yona_help_depth = 0;
     yona_channel_wait_kind = 0;
-    pthread_mutex_unlock(&yona_liveness_mutex);
+    yona_deadlock_candidate_seen = 0;
+    yona_current_prio = YONA_PRIO_NORMAL;
+    fiber_leave(f);
+    yona_exc_unpark(exc);
+    yona_current_task_id = task_id;
+    yona_help_depth = help_depth;
+    yona_channel_wait_kind = wait_kind;
+    yona_deadlock_candidate_seen = candidate_seen;
+    yona_current_prio = prio;
+    yona_task_arena = arena;
+}
+#else
+static yona_fiber_t* fiber_get(yona_worker_t* self) {
+    (void)self;
+    return NULL;
+}
+static void fiber_enter(yona_worker_t* self, yona_fiber_t* f) {
+    (void)self;
+    (void)f;
+}
+static void fiber_suspend(void) {}
+#endif
+
+/* Any thread. Queues f on its owner and wakes the owner if it sleeps. A
+ * fiber may be made ready before it has finished suspending: its owner is
+ * the thread running it, so it cannot be resumed until it has switched out. */
+static void fiber_ready(yona_fiber_t* f) {
+    yona_worker_t* w = f->owner;
+    f->next = atomic_load_explicit(&w->ready, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&w->ready, &f->next, f,
+                                                  memory_order_release, memory_order_relaxed))
+        ;
+    if (w == yona_current_worker) return;
+    atomic_thread_fence(memory_order_seq_cst);
+    worker_wake(w);
+}
+
+/* Next woken fiber, oldest first. Owner only. */
+static yona_fiber_t* fiber_next_ready(yona_worker_t* self) {
+    if (!self->runq && atomic_load_explicit(&self->ready, memory_order_relaxed)) {
+        yona_fiber_t* list = atomic_exchange_explicit(&self->ready, NULL, memory_order_acquire);
+        while (list) {
+            yona_fiber_t* next = list->next;
+            list->next = self->runq;
+            self->runq = list;
+            list = next;
+        }
+    }
+    yona_fiber_t* f = self->runq;
+    if (f) self->runq = f->next;
+    return f;
+}
+
+/* Worker: run a dequeued task on a fiber, or inline if none can be had. */
+static void run_task_on_fiber(yona_worker_t* self, yona_task_t* task) {
+    yona_fiber_t* f = fiber_get(self);
+    if (!f) {
+        run_task(task);
+        return;
+    }
+    f->task = task;
+    fiber_enter(self, f);
+}
+
+void* yona_rt_fiber_current(void) { return yona_current_fiber; }
+
+void yona_rt_fiber_suspend(void) { fiber_suspend(); }
+
+void yona_rt_fiber_ready(void* fiber) { fiber_ready((yona_fiber_t*)fiber); }
+
+/* Fiber wait queues (channels).
+ *
+ * A node lives on the waiting task's stack. It is queued on the waited-for
+ * object under that object's mutex; a parked fiber's node is also listed
+ * on the owning worker, which pokes its fibers awake for a deadlock
+ * re-check when the pool has gone quiet (a parked fiber does not poll the
+ * way a timed condition wait does). Timeouts are timers (see above).
+ *
+ * Each node points at a waiter. A select queues one node per channel, all
+ * sharing its waiter: whoever takes the waiter first wakes it, and a wake
+ * that finds it already taken moves on to the next node, so an event wakes
+ * exactly one task. Threads wait on the waiter's futex word. */
+typedef struct {
+    _Atomic uint32_t taken;                  /* 1 once woken or poked */
+    yona_fiber_t* fiber;                     /* NULL: a thread on the futex */
+} yona_wq_waiter_t;
+
+typedef struct yona_waitq_node {
+    struct yona_waitq_node *next, *prev;     /* the object's queue */
+    struct yona_waitq_node *wnext, *wprev;   /* the worker's chan_parked list */
+    yona_wq_waiter_t* waiter;
+    int queued;                              /* still on the object's queue */
+    int woken;                               /* the waiter was taken through this node */
+} yona_waitq_node_t;
+
+typedef struct {
+    yona_waitq_node_t *head, *tail;
+} yona_waitq_t;
+
+static void wq_waiter_init(yona_wq_waiter_t* w) {
+    atomic_init(&w->taken, 0);
+    w->fiber = yona_current_fiber;
+}
+
+/* Take w and wake it. Returns 0 if someone else took it first. */
+static int wq_waiter_wake(yona_wq_waiter_t* w) {
+    yona_fiber_t* f = w->fiber;
+    if (atomic_exchange_explicit(&w->taken, 1, memory_order_acq_rel)) return 0;
+    if (f) fiber_ready(f);
+    else yona_futex_wake(&w->taken, 1);
+    return 1;
+}
+
+/* Queue n on q for n->waiter. Caller holds q's mutex. */
+static void waitq_add(yona_waitq_t* q, yona_waitq_node_t* n, yona_wq_waiter_t* w) {
+    n->waiter = w;
+    n->next = NULL;
+    n->prev = q->tail;
+    if (q->tail) q->tail->next = n; else q->head = n;
+    q->tail = n;
+    n->queued = 1;
+    n->woken = 0;
+}
+
+static void waitq_unlink(yona_waitq_t* q, yona_waitq_node_t* n) {
+    if (n->prev) n->prev->next = n->next; else q->head = n->next;
+    if (n->next) n->next->prev = n->prev; else q->tail = n->prev;
+    n->queued = 0;
+}
+
+/* Take n off q if it is still queued. Caller holds q's mutex. Returns 1 if
+ * n's waiter was taken through n. */
+static int waitq_remove(yona_waitq_t* q, yona_waitq_node_t* n) {
+    if (n->queued) waitq_unlink(q, n);
+    return n->woken;
+}
+
+/* Suspend the current fiber until its waiter is taken, listed on its
+ * worker through n (one of the waiter's queued nodes). No locks held. */
+static void wq_waiter_suspend(yona_waitq_node_t* n) {
+    yona_worker_t* w = yona_current_fiber->owner;
+    n->wprev = NULL;
+    n->wnext = w->chan_parked;
+    if (w->chan_parked) w->chan_parked->wprev = n;
+    w->chan_parked = n;
+    fiber_suspend();
+    if (n->wprev) n->wprev->wnext = n->wnext; else w->chan_parked = n->wnext;
+    if (n->wnext) n->wnext->wprev = n->wprev;
+}
+
+/* Park the current fiber on q. mutex guards q; it is held on entry and on
+ * return, and released while parked. Returns 1 if a waitq_wake_one took the
+ * fiber off q, 0 if it was poked. */
+static int waitq_park(yona_waitq_t* q, pthread_mutex_t* mutex) {
+    yona_wq_waiter_t w;
+    yona_waitq_node_t n;
+    wq_waiter_init(&w);
+    waitq_add(q, &n, &w);
+    pthread_mutex_unlock(mutex);
+    wq_waiter_suspend(&n);
+    pthread_mutex_lock(mutex);
+    return waitq_remove(q, &n);
+}
+
+/* Wake the longest-waiting task on q, skipping waiters already taken
+ * through another queue. Caller holds q's mutex. Returns the node it was
+ * woken through, or NULL; the node stays valid while the mutex is held
+ * (its owner takes it before leaving). */
+static yona_waitq_node_t* waitq_wake_one(yona_waitq_t* q) {
+    while (q->head) {
+        yona_waitq_node_t* n = q->head;
+        waitq_unlink(q, n);
+        if (wq_waiter_wake(n->waiter)) {
+            n->woken = 1;
+            return n;
+        }
+    }
+    return NULL;
+}
+
+/* Idle worker: wake this worker's channel-parked fibers so they re-run the
+ * deadlock check. They go back to sleep if nothing has changed. */
+static void waitq_poke(yona_worker_t* self) {
+    for (yona_waitq_node_t* n = self->chan_parked; n; n = n->wnext)
+        wq_waiter_wake(n->waiter);
+}
+
+/* Only a lone blocked task with nothing else live can be deadlocked (see
+ * yona_rt_channel_wait_begin), so that is the only time worth poking. */
+static int waitq_should_poke(yona_worker_t* self) {
+    uint64_t s = atomic_load(&yona_liveness);
+    return self->chan_parked && lv_get(s, LV_BLOCKED) == 1 && lv_get(s, LV_EXT_ACTIVE) == 0;
+}
+
+/* ===== Promises ===== */
+
+#define YONA_PROMISE_CACHE_MAX 1024
+static _Thread_local yona_promise_t* yona_promise_cache = NULL;
+static _Thread_local int yona_promise_cached = 0;
+
+static yona_promise_t* promise_alloc(int refs) {
+    yona_promise_t* p = yona_promise_cache;
+    if (p) {
+        yona_promise_cache = p->next_free;
+        yona_promise_cached--;
+    } else {
+        p = (yona_promise_t*)malloc(sizeof(yona_promise_t));
+    }
+    p->result = 0;
+    p->error = 0;
+    atomic_store_explicit(&p->state, YONA_PROMISE_PENDING, memory_order_relaxed);
+    atomic_store_explicit(&p->claimed, 0, memory_order_relaxed);
+    atomic_store_explicit(&p->refs, refs, memory_order_relaxed);
+    atomic_store_explicit(&p->task.started, 0, memory_order_relaxed);
+    return p;
+}
+
+static void promise_release(yona_promise_t* p) {
+    if (atomic_fetch_sub_explicit(&p->refs, 1, memory_order_acq_rel) != 1) return;
+    if (yona_promise_cached >= YONA_PROMISE_CACHE_MAX) {
+        free(p);
+        return;
+    }
+    p->next_free = yona_promise_cache;
+    yona_promise_cache = p;
+    yona_promise_cached++;
+}
+
+/* Block until a state word reaches DONE: park the fiber, or sleep the
+ * thread when not on one. */
+static void state_wait(_Atomic uintptr_t* state) {
+    uintptr_t s = atomic_load_explicit(state, memory_order_acquire);
+    if (s == YONA_PROMISE_DONE) return;
+    yona_waiter_t w;
+    w.fiber = yona_current_fiber;
+    w.timed = 0;
+    atomic_init(&w.woken, 0);
+    do {
+        if (s == YONA_PROMISE_DONE) return;
+        w.next = (yona_waiter_t*)s;
+    } while (!atomic_compare_exchange_weak_explicit(state, &s, (uintptr_t)&w,
+                                                    memory_order_release, memory_order_acquire));
+    if (w.fiber) {
+        fiber_suspend();
+        return;
+    }
+    while (!atomic_load_explicit(&w.woken, memory_order_acquire))
+        yona_futex_wait(&w.woken, 0);
+}
+
+/* A waiter that gives up at a deadline. It cannot take its node back off
+ * the lock-free list, so the node is on the heap and whichever of the
+ * waiter and the completer lets go of it last frees it. Completion and the
+ * timer race to take wq; only the winner wakes the waiter. A waiter that
+ * times out leaves its promise reference on the node, so the block is not
+ * recycled while a completer may still write to it. */
+typedef struct {
+    yona_waiter_t base;
+    yona_wq_waiter_t wq;
+    _Atomic int refs;
+    yona_promise_t* abandoned;
+} yona_timed_waiter_t;
+
+static void timed_waiter_release(yona_timed_waiter_t* t) {
+    if (atomic_fetch_sub_explicit(&t->refs, 1, memory_order_acq_rel) != 1) return;
+    if (t->abandoned) promise_release(t->abandoned);
+    free(t);
+}
+
+static void timer_wake_waiter(yona_timer_t* t) {
+    wq_waiter_wake((yona_wq_waiter_t*)t->arg);
+}
+
+/* Move a state word to DONE and wake everyone parked on it. A node may go
+ * away as soon as its waiter is woken, so read the link first. */
+static void state_complete(_Atomic uintptr_t* state) {
+    uintptr_t s = atomic_exchange_explicit(state, YONA_PROMISE_DONE, memory_order_acq_rel);
+    if (s == YONA_PROMISE_DONE) return;
+    for (yona_waiter_t* w = (yona_waiter_t*)s, *next; w; w = next) {
+        next = w->next;
+        if (w->timed) {
+            yona_timed_waiter_t* t = (yona_timed_waiter_t*)w;
+            wq_waiter_wake(&t->wq);
+            timed_waiter_release(t);
+        } else if (w->fiber) {
+            fiber_ready(w->fiber);
+        } else {
+            atomic_store_explicit(&w->woken, 1, memory_order_release);
+            yona_futex_wake(&w->woken, 1);
+        }
+    }
+}
+
+/* As promise_wait, giving up after ms milliseconds. Returns 1 if the
+ * promise completed; otherwise the awaiter's reference now belongs to the
+ * waiter node and goes when the completer lets go of it. A fiber parks
+ * with a timer armed; a thread sleeps on the waiter's futex word. */
+static int promise_wait_timeout(yona_promise_t* p, int64_t ms) {
+    _Atomic uintptr_t* state = &p->state;
+    uintptr_t s = atomic_load_explicit(state, memory_order_acquire);
+    if (s == YONA_PROMISE_DONE) return 1;
+    yona_timed_waiter_t* t = (yona_timed_waiter_t*)malloc(sizeof(yona_timed_waiter_t));
+    t->base.fiber = NULL;
+    t->base.timed = 1;
+    wq_waiter_init(&t->wq);
+    atomic_init(&t->refs, 2);
+    t->abandoned = NULL;
+    if (t->wq.fiber && (ms <= 0 || !timer_clock_start())) t->wq.fiber = NULL;
+    do {
+        if (s == YONA_PROMISE_DONE) {
+            free(t);
+            return 1;
+        }
+        t->base.next = (yona_waiter_t*)s;
+    } while (!atomic_compare_exchange_weak_explicit(state, &s, (uintptr_t)&t->base,
+                                                    memory_order_release, memory_order_acquire));
+    if (t->wq.fiber) {
+        yona_timer_t timer;
+        timer_init(&timer, timer_wake_waiter, &t->wq);
+        timer_arm(&timer, ms);
+        fiber_suspend();
+        timer_cancel(&timer);
+    } else {
+        int64_t deadline = yona_monotonic_ns() + ms * 1000000LL;
+        while (!atomic_load_explicit(&t->wq.taken, memory_order_acquire)) {
+            int64_t left = deadline - yona_monotonic_ns();
+            if (left <= 0) break;
+            int64_t wait = (left + 999999) / 1000000;
+            yona_futex_wait_ms(&t->wq.taken, 0, wait > INT32_MAX ? INT32_MAX : (int)wait);
+        }
+        /* Timed out: completing later must not wake us */
+        atomic_exchange_explicit(&t->wq.taken, 1, memory_order_acq_rel);
+    }
+    int done = atomic_load_explicit(state, memory_order_acquire) == YONA_PROMISE_DONE;
+    if (!done) t->abandoned = p;
+    timed_waiter_release(t);
+    return done;
+}
+
+static void promise_wait(yona_promise_t* p) {
+    state_wait(&p->state);
+}
+
+static void yona_rt_promise_destroy(yona_promise_t* p) {
+    if (!p) return;
+    promise_wait(p);
+    promise_release(p);
 }
 
 void yona_rt_promise_complete(yona_promise_t* p, int64_t result, int is_error,
                               yona_task_group_t* group) {
     if (!p) return;
-    pthread_mutex_lock(&p->mutex);
-    if (p->completed) {
-        pthread_mutex_unlock(&p->mutex);
-        return;
-    }
+    if (atomic_exchange_explicit(&p->claimed, 1, memory_order_acq_rel)) return;
+    /* group_await_all waits on each child's promise; the group keeps no
+     * count. Once the promise is DONE the parent may end and reuse it. */
+    (void)group;
     p->result = result;
     p->error = is_error ? 1 : 0;
-    p->completed = 1;
-    pthread_cond_signal(&p->cond);
-    pthread_mutex_unlock(&p->mutex);
+    state_complete(&p->state);
+}
+
+static void fulfill_promise(yona_task_t* task, int64_t result, int is_error) {
+    yona_rt_promise_complete(task->promise, result, is_error, task->group);
+}
 
-    if (group) {
-        if (__atomic_fetch_sub(&group->pending_count, 1, __ATOMIC_SEQ_CST) == 1) {
-            pthread_cond_signal(&group->done_cond);
+/* A queued task runs once, on whichever of the worker that dequeues it and
+ * its awaiter (await_inline) takes it first. The queue entry owns the
+ * task's reference either way: a worker that dequeues a task someone else
+ * took only drops it, so the block is not recycled under a stale entry. */
+static int task_claim(yona_task_t* task) {
+    return !atomic_exchange_explicit(&task->started, 1, memory_order_acq_rel);
+}
+
+/* Run a claimed task without dropping the queue's reference. */
+static void run_task_claimed(yona_task_t* task) {
+    liveness_worker_begin();
+    sched_count(YONA_STAT_TASKS, 1);
+    int outer_prio = yona_current_prio;
+    yona_current_prio = task->prio == YONA_PRIO_BATCH ? YONA_PRIO_BATCH : YONA_PRIO_NORMAL;
+    yona_task_arena_t outer_arena = task_arena_enter(task->structured);
+    int64_t started = 0;
+    if (task->queued_ns) {
+        started = yona_monotonic_ns();
+        yona_worker_t* w = yona_current_worker;
+        sched_stat_latency((w ? &w->stats : &yona_stats_external)->wait_ns, w != NULL,
+                           started - task->queued_ns);
+    }
+
+    /* Check cancellation before executing */
+    if (task->group && __atomic_load_n(&task->group->cancelled, __ATOMIC_SEQ_CST)) {
+        fulfill_promise(task, 0, 1);
+        liveness_worker_end();
+        yona_current_prio = outer_prio;
+        task_arena_leave(outer_arena);
+        return;
+    }
+
+    /* Execute with error capture via yona_sjlj_setjmp (matches yona_rt_raise;
+     * see exceptions.c for the SJLJ buffer rationale). */
+    void* jmp = yona_rt_try_push();
+    if (yona_sjlj_setjmp(jmp) == 0) {
+        int64_t result = task->thunk ? task->thunk() : task->fn(task->arg);
+        yona_rt_try_end();
+        fulfill_promise(task, result, 0);
+    } else {
+        /* Task raised an exception — capture in group */
+        if (task->group) {
+            pthread_mutex_lock(&task->group->mutex);
+            if (!task->group->has_error) {
+                task->group->first_error_symbol = yona_rt_get_exception_symbol();
+                task->group->first_error_msg = yona_rt_get_exception_message();
+                task->group->has_error = 1;
+            }
+            pthread_mutex_unlock(&task->group->mutex);
+            /* Cancel siblings */
+            yona_rt_group_cancel(task->group);
         }
+        fulfill_promise(task, 0, 1);
     }
+
+    if (started) {
+        /* A fiber resumes on the worker it started on */
+        yona_worker_t* w = yona_current_worker;
+        sched_stat_latency((w ? &w->stats : &yona_stats_external)->run_ns, w != NULL,
+                           yona_monotonic_ns() - started);
+    }
+    liveness_worker_end();
+    yona_current_prio = outer_prio;
+    task_arena_leave(outer_arena);
+    /* I/O the task started and left for others to await */
+    yona_platform_io_flush();
 }
 
-static void fulfill_promise(yona_task_t* task, int64_t result, int is_error) {
-    yona_rt_promise_complete(task->promise, result, is_error, task->group);
+static void run_task(yona_task_t* task) {
+    run_task_claimed(task);
+    promise_release(task->promise);
 }
 
-static void* yona_pool_worker(void* unused) {
-    (void)unused;
+/* On a worker, run the awaited task here if nobody has started it yet: it
+ * is usually at the bottom of our own deque. Only that task, never other
+ * queued work. An unrelated task run on this stack would have to return
+ * before the await could, and one that waits for something the awaiter
+ * does after the await never would. Otherwise the caller parks. The
+ * caller must hold a reference to p. */
+static void await_inline(yona_promise_t* p) {
+    yona_worker_t* self = yona_current_worker;
+    if (!self || yona_help_depth >= YONA_HELP_MAX_DEPTH) return;
+    if (atomic_load_explicit(&p->state, memory_order_acquire) == YONA_PROMISE_DONE) return;
+    if (!task_claim(&p->task)) return;
+    yona_help_depth++;
+    int64_t task_id = yona_current_task_id;
+    run_task_claimed(&p->task);
+    yona_current_task_id = task_id;
+    yona_help_depth--;
+}
+
+static void* yona_pool_worker(void* arg) {
+    yona_worker_t* self = (yona_worker_t*)arg;
+    yona_current_worker = self;
+    yona_current_task_is_worker = 1;
+    if (self->cpu >= 0) yona_platform_pin_thread(self->cpu);
+    liveness_update(1, 0, 0, 0);
     while (1) {
-        pthread_mutex_lock(&yona_pool_mutex);
-        while (!yona_task_head) {
-            pthread_cond_wait(&yona_pool_cond, &yona_pool_mutex);
-        }
-        yona_task_t* task = yona_task_head;
-        yona_task_head = task->next;
-        if (!yona_task_head) yona_task_tail = NULL;
-        pthread_mutex_unlock(&yona_pool_mutex);
-
-        liveness_worker_begin();
-
-        /* Check cancellation before executing */
-        if (task->group && __atomic_load_n(&task->group->cancelled, __ATOMIC_SEQ_CST)) {
-            fulfill_promise(task, 0, 1);
-            liveness_worker_end();
-            free(task);
+        /* Woken fibers first: they hold older work than anything queued */
+        yona_fiber_t* f = fiber_next_ready(self);
+        if (f) {
+            fiber_enter(self, f);
             continue;
         }
-
-        /* Execute with error capture via yona_sjlj_setjmp (matches yona_rt_raise;
-         * see exceptions.c for the SJLJ buffer rationale). */
-        void* jmp = yona_rt_try_push();
-        if (yona_sjlj_setjmp(jmp) == 0) {
-            int64_t result = task->thunk ? task->thunk() : task->fn(task->arg);
-            yona_rt_try_end();
-            fulfill_promise(task, result, 0);
-        } else {
-            /* Task raised an exception — capture in group */
-            if (task->group) {
-                pthread_mutex_lock(&task->group->mutex);
-                if (!task->group->has_error) {
-                    task->group->first_error_symbol = yona_rt_get_exception_symbol();
-                    task->group->first_error_msg = yona_rt_get_exception_message();
-                    task->group->has_error = 1;
-                }
-                pthread_mutex_unlock(&task->group->mutex);
-                /* Cancel siblings */
-                yona_rt_group_cancel(task->group);
+        yona_task_t* task = sched_find(self);
+        if (!task) {
+            /* Announce, then look once more: a submitter that missed us in
+             * yona_parked published its task before reading it, and a
+             * fiber_ready that missed sleeping pushed before reading it. */
+            uint32_t epoch = atomic_load_explicit(&self->park, memory_order_acquire);
+            atomic_fetch_add(&yona_parked, 1);
+            atomic_store(&self->sleeping, 1);
+            /* sched_find's loads are relaxed; keep them after the store */
+            atomic_thread_fence(memory_order_seq_cst);
+            task = sched_find(self);
+            if (!task && !atomic_load(&self->ready)) {
+                /* With fibers parked on channels, wake now and then to see
+                 * whether one of them has become a deadlock to report. */
+                liveness_update(-1, 0, 0, 0);
+                sched_stat_bump(&self->stats.count[YONA_STAT_PARKS], 1, 1);
+                int timed_out = self->chan_parked
+                                    ? yona_futex_wait_ms(&self->park, epoch, YONA_FIBER_POLL_MS)
+                                    : (yona_futex_wait(&self->park, epoch), 0);
+                liveness_update(1, 0, 0, 0);
+                atomic_store(&self->sleeping, 0);
+                atomic_fetch_sub(&yona_parked, 1);
+                if (timed_out && waitq_should_poke(self)) waitq_poke(self);
+                continue;
             }
-            fulfill_promise(task, 0, 1);
+            atomic_store(&self->sleeping, 0);
+            atomic_fetch_sub(&yona_parked, 1);
+            if (!task) continue;
         }
-
-        liveness_worker_end();
-        free(task);
+        if (!task_claim(task)) {
+            promise_release(task->promise);
+            continue;
+        }
+        run_task_on_fiber(self, task);
     }
     return NULL;
 }
 
 static void yona_pool_init(void) {
-    if (yona_pool_initialized) return;
-    yona_pool_initialized = 1;
-    pthread_mutex_lock(&yona_liveness_mutex);
-    for (int i = 0; i < YONA_POOL_SIZE; i++) {
-        (void)yona_pool_threads[i];
-        start_pool_worker_unlocked();
+    if (atomic_load_explicit(&yona_pool_initialized, memory_order_acquire)) return;
+#if YONA_FIBERS
+    atomic_store(&yona_fiber_stack_bytes, fiber_configured_stack_bytes());
+#endif
+    if (atomic_exchange(&yona_pool_initialized, 1)) return;
+    sched_stats_env_init();
+    int size = yona_pool_configured_size();
+    if (yona_pool_pin_enabled()) {
+        yona_pool_ncpus = yona_platform_usable_cpus(yona_pool_cpus, yona_pool_nodes,
+                                                    YONA_POOL_MAX_THREADS);
+        int used = yona_pool_ncpus < size ? yona_pool_ncpus : size;
+        for (int i = 1; i < used; i++)
+            if (yona_pool_nodes[i] != yona_pool_nodes[0]) yona_pool_numa = 1;
     }
-    pthread_mutex_unlock(&yona_liveness_mutex);
+    for (int i = 0; i < size; i++) start_pool_worker();
+}
+
+/* Std\Runtime.workerCount: running pool size, or what it will start with */
+static int yona_pool_worker_count(void) {
+    if (!atomic_load_explicit(&yona_pool_initialized, memory_order_acquire))
+        return yona_pool_configured_size();
+    return atomic_load_explicit(&yona_worker_threads, memory_order_acquire);
+}
+
+/* Std\Runtime.setWorkerCount on a started pool: add workers up to n.
+ * Workers never exit, so the pool does not shrink. */
+static int yona_pool_grow(int n) {
+    if (atomic_load_explicit(&yona_pool_initialized, memory_order_acquire))
+        while (atomic_load(&yona_worker_threads) < n) {
+            int before = atomic_load(&yona_worker_threads);
+            start_pool_worker();
+            if (atomic_load(&yona_worker_threads) == before) break;
+        }
+    return yona_pool_worker_count();
 }
 
 /* Generic async: takes a thunk (zero-arg function returning i64).
  * The codegen generates thunks that capture multi-arg function calls. */
 typedef int64_t (*yona_thunk_t)(void);
 
-static yona_promise_t* make_promise(void) {
-    yona_promise_t* p = (yona_promise_t*)malloc(sizeof(yona_promise_t));
-    p->result = 0;
-    p->completed = 0;
-    p->error = 0;
-    pthread_mutex_init(&p->mutex, NULL);
-    pthread_cond_init(&p->cond, NULL);
+/* Standalone promise (GPU fences, native externs): only the awaiter holds it */
+yona_promise_t* yona_rt_promise_new(void) {
+    yona_promise_t* p = promise_alloc(1);
+    atomic_store_explicit(&p->task.started, 1, memory_order_relaxed);  /* no task to run */
     return p;
 }
 
-yona_promise_t* yona_rt_promise_new(void) {
-    return make_promise();
+/* Urgent tasks go on the shared heap, due deadline_ms from now (now if
+ * 0); workers push the rest onto their own deques and other threads
+ * inject. */
+static void enqueue_task_prio(yona_task_t* task, int prio, int64_t deadline_ms) {
+    int timing = atomic_load_explicit(&yona_task_timing, memory_order_relaxed);
+    int64_t now = timing || prio == YONA_PRIO_URGENT ? yona_monotonic_ns() : 0;
+    task->queued_ns = timing ? now : 0;
+    task->prio = prio;
+    task->due_ns = deadline_ms > 0 ? now + deadline_ms * 1000000 : now;
+    if (!yona_current_worker) liveness_register_external_task();
+    if (prio == YONA_PRIO_URGENT)
+        urgent_push(task);
+    else if (yona_current_worker)
+        deque_push(yona_current_worker, worker_deque(yona_current_worker, prio), task);
+    else
+        inject_push(task);
+    sched_notify();
 }
 
+/* Spawned tasks take the class of the task spawning them */
 static void enqueue_task(yona_task_t* task) {
-    pthread_mutex_lock(&yona_pool_mutex);
-    if (yona_task_tail) {
-        yona_task_tail->next = task;
-    } else {
-        yona_task_head = task;
-    }
-    yona_task_tail = task;
-    pthread_cond_signal(&yona_pool_cond);
-    pthread_mutex_unlock(&yona_pool_mutex);
+    enqueue_task_prio(task, yona_current_prio, 0);
 }
 
-static yona_promise_t* submit_task(yona_async_fn_t fn, yona_thunk_fn_t thunk,
-                                    int64_t arg, yona_task_group_t* group) {
+static yona_promise_t* submit_task_prio(yona_async_fn_t fn, yona_thunk_fn_t thunk, int64_t arg,
+                                        yona_task_group_t* group, int prio, int64_t deadline_ms) {
     yona_pool_init();
-    yona_promise_t* promise = make_promise();
+    yona_promise_t* promise = promise_alloc(2);
 
-    yona_task_t* task = (yona_task_t*)calloc(1, sizeof(yona_task_t));
+    yona_task_t* task = &promise->task;
     task->fn = fn;
     task->thunk = thunk;
     task->arg = arg;
     task->promise = promise;
     task->group = group;
+    task->structured = group != NULL;
+    task->next = NULL;
 
     if (group) yona_rt_group_register(group, promise);
-    if (!yona_current_task_is_worker) {
-        pthread_mutex_lock(&yona_liveness_mutex);
-        liveness_register_external_task_unlocked();
-        pthread_mutex_unlock(&yona_liveness_mutex);
-    }
-    liveness_task_queued();
-    enqueue_task(task);
+    enqueue_task_prio(task, prio, deadline_ms);
     return promise;
 }
 
+static yona_promise_t* submit_task(yona_async_fn_t fn, yona_thunk_fn_t thunk,
+                                    int64_t arg, yona_task_group_t* group) {
+    return submit_task_prio(fn, thunk, arg, group, yona_current_prio, 0);
+}
+
 yona_promise_t* yona_rt_async_call_thunk(yona_thunk_t thunk) {
     return submit_task(NULL, thunk, 0, NULL);
 }
@@ -462,29 +1980,44 @@ yona_promise_t* yona_rt_async_spawn_closure(int64_t* closure, yona_task_group_t*
                        NULL, (int64_t)(intptr_t)closure, group);
 }
 
+/* Std\Task.spawnWith: prio is a TaskPriority tag (out-of-range means
+ * normal), deadline_ms orders urgent tasks. */
+yona_promise_t* yona_rt_async_spawn_closure_prio(int64_t* closure, int64_t prio,
+                                                 int64_t deadline_ms) {
+    if (prio < YONA_PRIO_URGENT || prio > YONA_PRIO_BATCH) prio = YONA_PRIO_NORMAL;
+    return submit_task_prio((yona_async_fn_t)spawn_closure_dispatch, NULL,
+                            (int64_t)(intptr_t)closure, NULL, (int)prio, deadline_ms);
+}
+
 yona_promise_t* yona_rt_async_call_grouped(yona_async_fn_t fn, int64_t arg, yona_task_group_t* group) {
     return submit_task(fn, NULL, arg, group);
 }
 
 /* Await without freeing — grouped let/comprehension; yona_rt_group_end destroys. */
 int64_t yona_rt_async_await_keep(yona_promise_t* promise) {
-    pthread_mutex_lock(&promise->mutex);
-    while (!promise->completed)
-        pthread_cond_wait(&promise->cond, &promise->mutex);
-    int64_t result = promise->result;
-    pthread_mutex_unlock(&promise->mutex);
-    return result;
+    await_inline(promise);
+    promise_wait(promise);
+    return promise->result;
 }
 
 /* Standalone async: await, return result, and free the promise. */
 int64_t yona_rt_async_await(yona_promise_t* promise) {
     int64_t result = yona_rt_async_await_keep(promise);
-    pthread_mutex_destroy(&promise->mutex);
-    pthread_cond_destroy(&promise->cond);
-    free(promise);
+    promise_release(promise);
     return result;
 }
 
+/* Await for at most ms milliseconds. Returns 1 and stores the result if the
+ * promise completed in time, else 0; the task runs on regardless. The
+ * caller is done with the promise either way: on timeout it is released
+ * once it completes. */
+int yona_rt_async_await_timeout(yona_promise_t* promise, int64_t ms, int64_t* result) {
+    if (!promise_wait_timeout(promise, ms)) return 0;
+    *result = promise->result;
+    promise_release(promise);
+    return 1;
+}
+
 /* ===== Task Group: Cancel & Await All ===== */
 
 /* Cancel: set flag. io_uring cancellation is done externally by the codegen
@@ -505,10 +2038,8 @@ int64_t yona_rt_group_await_all(yona_task_group_t* g) {
     /* Wait for all thread-pool children to complete */
     for (int i = 0; i < g->child_count; i++) {
         yona_promise_t* p = g->children[i];
-        pthread_mutex_lock(&p->mutex);
-        while (!p->completed)
-            pthread_cond_wait(&p->cond, &p->mutex);
-        pthread_mutex_unlock(&p->mutex);
+        await_inline(p);
+        promise_wait(p);
     }
 
     /* Re-raise first error on the caller's thread */
@@ -522,6 +2053,441 @@ int64_t yona_rt_group_await_all(yona_task_group_t* g) {
     return 0;
 }
 
+/* ===== Sleeps and periodic timers (Std\Time) ===== */
+
+static void timer_ready_fiber(yona_timer_t* t) {
+    fiber_ready((yona_fiber_t*)t->arg);
+}
+
+/* Sleep for ms milliseconds. A fiber parks on a timer and its worker runs
+ * other tasks meanwhile; a plain thread just sleeps. */
+void yona_rt_sleep(int64_t ms) {
+    if (ms <= 0) return;
+    if (yona_current_fiber && timer_clock_start()) {
+        yona_timer_t timer;
+        timer_init(&timer, timer_ready_fiber, yona_current_fiber);
+        timer_arm(&timer, ms);
+        fiber_suspend();
+        return;
+    }
+    yona_platform_io_flush();
+    struct timespec ts = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        ;
+}
+
+/* A closure run on the pool every period. Each firing queues one run,
+ * skipped while the previous one is still queued or running, so a slow
+ * closure does not pile up work. Handles are ids looked up in a small hash
+ * table under the wheel lock, so a stale or repeated cancel is harmless. */
+#define YONA_TICKER_BUCKETS 64
+
+typedef struct yona_ticker {
+    yona_timer_t timer;
+    int64_t id;
+    int64_t* closure;
+    _Atomic int refs;                 /* the table, plus a run in flight */
+    _Atomic int busy;                 /* a run is queued or running */
+    struct yona_ticker* next;         /* bucket chain */
+} yona_ticker_t;
+
+static yona_ticker_t* yona_tickers[YONA_TICKER_BUCKETS];
+static int64_t yona_ticker_next_id = 1;
+
+static void ticker_release(yona_ticker_t* k) {
+    if (atomic_fetch_sub_explicit(&k->refs, 1, memory_order_acq_rel) != 1) return;
+    yona_rt_rc_dec(k->closure);
+    free(k);
+}
+
+static int64_t ticker_run(int64_t arg) {
+    yona_ticker_t* k = (yona_ticker_t*)(intptr_t)arg;
+    typedef int64_t (*thunk_fn_t)(int64_t*);
+    /* A raise ends this run only */
+    void* jmp = yona_rt_try_push();
+    if (yona_sjlj_setjmp(jmp) == 0) {
+        ((thunk_fn_t)(intptr_t)k->closure[0])(k->closure);
+        yona_rt_try_end();
+    }
+    atomic_store_explicit(&k->busy, 0, memory_order_release);
+    ticker_release(k);
+    return 0;
+}
+
+/* Clock thread, wheel lock held: queue a run. It goes on the injection
+ * stack directly; the clock thread is not a task and must not count as one. */
+static void ticker_fire(yona_timer_t* t) {
+    yona_ticker_t* k = (yona_ticker_t*)t->arg;
+    if (atomic_exchange_explicit(&k->busy, 1, memory_order_acq_rel)) return;
+    atomic_fetch_add_explicit(&k->refs, 1, memory_order_relaxed);
+    yona_promise_t* promise = promise_alloc(1);
+    yona_task_t* task = &promise->task;
+    task->fn = ticker_run;
+    task->thunk = NULL;
+    task->arg = (int64_t)(intptr_t)k;
+    task->promise = promise;
+    task->group = NULL;
+    task->structured = 0;
+    task->next = NULL;
+    task->queued_ns = atomic_load_explicit(&yona_task_timing, memory_order_relaxed)
+                          ? yona_monotonic_ns() : 0;
+    task->prio = YONA_PRIO_NORMAL;
+    inject_push(task);
+    sched_notify();
+}
+
+/* Run closure every ms milliseconds until yona_rt_timer_cancel. Returns
+ * the timer's id, or 0 if no clock thread could be started. */
+int64_t yona_rt_timer_every(int64_t* closure, int64_t ms) {
+    if (!timer_clock_start()) return 0;
+    yona_pool_init();
+    yona_ticker_t* k = (yona_ticker_t*)malloc(sizeof(yona_ticker_t));
+    timer_init(&k->timer, ticker_fire, k);
+    k->timer.period = ms > 0 ? ms : 1;
+    k->closure = closure;
+    yona_rt_rc_inc(closure);
+    atomic_init(&k->refs, 1);
+    atomic_init(&k->busy, 0);
+    pthread_mutex_lock(&yona_wheel.lock);
+    k->id = yona_ticker_next_id++;
+    yona_ticker_t** bucket = &yona_tickers[k->id % YONA_TICKER_BUCKETS];
+    k->next = *bucket;
+    *bucket = k;
+    pthread_mutex_unlock(&yona_wheel.lock);
+    timer_arm(&k->timer, k->timer.period);
+    return k->id;
+}
+
+/* Stop a timer from yona_rt_timer_every. A run already queued still
+ * happens. Returns 1 if id was running. */
+int yona_rt_timer_cancel(int64_t id) {
+    if (id <= 0) return 0;
+    pthread_mutex_lock(&yona_wheel.lock);
+    yona_ticker_t* k = NULL;
+    for (yona_ticker_t** link = &yona_tickers[id % YONA_TICKER_BUCKETS]; *link; link = &(*link)->next) {
+        if ((*link)->id != id) continue;
+        k = *link;
+        *link = k->next;
+        break;
+    }
+    pthread_mutex_unlock(&yona_wheel.lock);
+    if (!k) return 0;
+    timer_cancel(&k->timer);
+    ticker_release(k);
+    return 1;
+}
+
+/* ===== Chunked parallel loops ([| f x for x = xs ], Std\Parallel) =====
+ *
+ * One job covers the whole source. Ranges split lazily: a thread works
+ * through its range grain elements at a time and hands the upper half to
+ * the pool only when its own deque has run dry, so a busy pool turns the
+ * loop into a few large chunks instead of one task per element. Results go
+ * straight into the pre-sized output seq by index. */
+
+#define YONA_PAR_CHUNKS_PER_WORKER 8
+
+typedef int64_t (*yona_par_fn_t)(int64_t* env, int64_t elem);
+
+typedef struct {
+    int64_t* fn;                /* closure called as fn(env, elem) */
+    const int64_t* elems;       /* source elements, borrowed */
+    int64_t* result;            /* pre-sized output, or NULL (pfor) */
+    int64_t grain;
+    _Atomic int64_t pending;    /* spawned ranges still running, plus the caller */
+    _Atomic uintptr_t state;    /* as for promises */
+    _Atomic int failed;
+    int64_t error_symbol;
+    const char* error_msg;
+} yona_par_job_t;
+
+typedef struct {
+    yona_par_job_t* job;
+    int64_t lo, hi;
+} yona_par_range_t;
+
+static void par_run(yona_par_job_t* job, int64_t lo, int64_t hi);
+
+static void par_finish(yona_par_job_t* job) {
+    if (atomic_fetch_sub_explicit(&job->pending, 1, memory_order_acq_rel) == 1)
+        state_complete(&job->state);
+}
+
+static int64_t par_range_task(int64_t arg) {
+    yona_par_range_t* r = (yona_par_range_t*)(intptr_t)arg;
+    yona_par_job_t* job = r->job;
+    par_run(job, r->lo, r->hi);
+    free(r);
+    par_finish(job);
+    return 0;
+}
+
+/* Split only when nobody has our last split left to take. */
+static int par_should_split(void) {
+    yona_worker_t* self = yona_current_worker;
+    if (self) return !deque_nonempty(worker_deque(self, yona_current_prio));
+    return atomic_load_explicit(&yona_inject_head, memory_order_acquire) == NULL;
+}
+
+static void par_spawn(yona_par_job_t* job, int64_t lo, int64_t hi) {
+    yona_par_range_t* r = (yona_par_range_t*)malloc(sizeof(yona_par_range_t));
+    r->job = job;
+    r->lo = lo;
+    r->hi = hi;
+    atomic_fetch_add_explicit(&job->pending, 1, memory_order_relaxed);
+    /* Nobody awaits a range: the task holds the only reference. */
+    yona_promise_t* promise = promise_alloc(1);
+    yona_task_t* task = &promise->task;
+    task->fn = par_range_task;
+    task->thunk = NULL;
+    task->arg = (int64_t)(intptr_t)r;
+    task->promise = promise;
+    task->group = NULL;
+    task->structured = 1;
+    task->next = NULL;
+    enqueue_task(task);
+}
+
+static void par_chunk(yona_par_job_t* job, int64_t lo, int64_t hi) {
+    yona_par_fn_t f = (yona_par_fn_t)(intptr_t)job->fn[0];
+    void* jmp = yona_rt_try_push();
+    if (yona_sjlj_setjmp(jmp) == 0) {
+        for (int64_t i = lo; i < hi; i++) {
+            int64_t r = f(job->fn, job->elems[i]);
+            if (job->result) job->result[SEQ_HDR_SIZE + i] = r;
+        }
+        yona_rt_try_end();
+    } else if (!atomic_exchange_explicit(&job->failed, 1, memory_order_acq_rel)) {
+        job->error_symbol = yona_rt_get_exception_symbol();
+        job->error_msg = yona_rt_get_exception_message();
+    }
+}
+
+static void par_run(yona_par_job_t* job, int64_t lo, int64_t hi) {
+    while (lo < hi && !atomic_load_explicit(&job->failed, memory_order_relaxed)) {
+        if (hi - lo > job->grain && par_should_split()) {
+            int64_t mid = lo + (hi - lo) / 2;
+            par_spawn(job, mid, hi);
+            hi = mid;
+            continue;
+        }
+        int64_t end = hi - lo > job->grain ? lo + job->grain : hi;
+        par_chunk(job, lo, end);
+        lo = end;
+    }
+}
+
+/* Cost heuristic for grain <= 0: a handful of chunks per worker, so uneven
+ * element costs still balance without paying a task per element. */
+static int64_t par_auto_grain(int64_t n) {
+    int64_t chunks = (int64_t)yona_pool_worker_count() * YONA_PAR_CHUNKS_PER_WORKER;
+    int64_t grain = n / chunks;
+    return grain < 1 ? 1 : grain;
+}
+
+/* Apply a one-argument closure to every element of src on the pool. With a
+ * result seq the return values land at the matching index; the first error
+ * stops further chunks and is re-raised here once every range has drained. */
+static void par_loop(int64_t* fn, int64_t* src, int64_t* result, int64_t grain) {
+    int64_t n = yona_rt_seq_length(src);
+    if (n == 0) return;
+
+    yona_par_job_t job;
+    job.fn = fn;
+    job.result = result;
+    job.grain = grain > 0 ? grain : par_auto_grain(n);
+    atomic_init(&job.pending, 1);
+    atomic_init(&job.state, YONA_PROMISE_PENDING);
+    atomic_init(&job.failed, 0);
+    job.error_symbol = 0;
+    job.error_msg = NULL;
+
+    int64_t* copy = NULL;
+    if (!is_rbt(src)) {
+        job.elems = src + SEQ_HDR_SIZE + FLAT_OFF(src);
+    } else {
+        copy = (int64_t*)malloc((size_t)n * sizeof(int64_t));
+        yona_rt_seq_copy_out(src, copy);
+        job.elems = copy;
+    }
+
+    if (n > job.grain) yona_pool_init();
+    par_run(&job, 0, n);
+    par_finish(&job);
+    state_wait(&job.state);
+    free(copy);
+
+    if (atomic_load_explicit(&job.failed, memory_order_acquire)) {
+        if (result) yona_rt_rc_dec(result);
+        yona_rt_raise(job.error_symbol, job.error_msg);
+    }
+}
+
+/* Parallel map into a fresh seq; grain <= 0 picks one from the pool size. */
+int64_t* yona_rt_par_map(int64_t* fn, int64_t* src, int64_t grain) {
+    int64_t* result = yona_rt_seq_alloc(yona_rt_seq_length(src));
+    par_loop(fn, src, result, grain);
+    return result;
+}
+
+/* Parallel for-each; return values are dropped. Returns the element count. */
+int64_t yona_rt_par_for(int64_t* fn, int64_t* src, int64_t grain) {
+    par_loop(fn, src, NULL, grain);
+    return yona_rt_seq_length(src);
+}
+
+/* Reductions split the same way, but each range owns an accumulator and
+ * joins the halves it handed off once its own elements are folded. The
+ * halves are kept in position order, so the result is the left-to-right
+ * fold for any associative combiner, and the caller ends up with the root
+ * of a join tree as deep as the splitting was. */
+
+typedef struct yona_par_rjob {
+    const yona_par_reduce_t* r;
+    int64_t grain;
+    _Atomic int failed;
+    int64_t error_symbol;
+    const char* error_msg;
+} yona_par_rjob_t;
+
+typedef struct yona_par_rnode {
+    yona_par_rjob_t* job;
+    int64_t lo, hi;
+    int64_t acc;
+    int has_acc;
+    _Atomic uintptr_t state;            /* DONE once acc covers [lo, hi) */
+    yona_promise_t* promise;            /* the task folding a handed-off range */
+    struct yona_par_rnode* halves;      /* ranges handed off, in position order */
+    struct yona_par_rnode* next;
+} yona_par_rnode_t;
+
+static void par_reduce_fail(yona_par_rjob_t* job) {
+    if (!atomic_exchange_explicit(&job->failed, 1, memory_order_acq_rel)) {
+        job->error_symbol = yona_rt_get_exception_symbol();
+        job->error_msg = yona_rt_get_exception_message();
+    }
+}
+
+static void par_reduce_run(yona_par_rnode_t* node);
+
+static int64_t par_reduce_task(int64_t arg) {
+    yona_par_rnode_t* node = (yona_par_rnode_t*)(intptr_t)arg;
+    par_reduce_run(node);
+    state_complete(&node->state);
+    return 0;
+}
+
+/* The joining node keeps a reference, so it can run the half itself. */
+static void par_reduce_spawn(yona_par_rnode_t* node) {
+    yona_promise_t* promise = promise_alloc(2);
+    node->promise = promise;
+    yona_task_t* task = &promise->task;
+    task->fn = par_reduce_task;
+    task->thunk = NULL;
+    task->arg = (int64_t)(intptr_t)node;
+    task->promise = promise;
+    task->group = NULL;
+    task->structured = 1;
+    task->next = NULL;
+    enqueue_task(task);
+}
+
+static void par_reduce_run(yona_par_rnode_t* node) {
+    yona_par_rjob_t* job = node->job;
+    int64_t lo = node->lo, hi = node->hi;
+    while (lo < hi && !atomic_load_explicit(&job->failed, memory_order_relaxed)) {
+        if (hi - lo > job->grain && par_should_split()) {
+            yona_par_rnode_t* half = (yona_par_rnode_t*)malloc(sizeof(yona_par_rnode_t));
+            half->job = job;
+            half->lo = lo + (hi - lo) / 2;
+            half->hi = hi;
+            half->acc = 0;
+            half->has_acc = 0;
+            atomic_init(&half->state, YONA_PROMISE_PENDING);
+            half->halves = NULL;
+            /* Each split takes the part just below the previous one */
+            half->next = node->halves;
+            node->halves = half;
+            par_reduce_spawn(half);
+            hi = half->lo;
+            continue;
+        }
+        int64_t end = hi - lo > job->grain ? lo + job->grain : hi;
+        void* jmp = yona_rt_try_push();
+        if (yona_sjlj_setjmp(jmp) == 0) {
+            par_reduce_fold(job->r, lo, end, &node->acc, &node->has_acc);
+            yona_rt_try_end();
+        } else {
+            par_reduce_fail(job);
+        }
+        lo = end;
+    }
+
+    while (node->halves) {
+        yona_par_rnode_t* half = node->halves;
+        await_inline(half->promise);
+        state_wait(&half->state);
+        promise_release(half->promise);
+        node->halves = half->next;
+        if (half->has_acc && !atomic_load_explicit(&job->failed, memory_order_acquire)) {
+            if (!node->has_acc) {
+                node->acc = half->acc;
+                node->has_acc = 1;
+                half->has_acc = 0;
+            } else {
+                void* jmp = yona_rt_try_push();
+                if (yona_sjlj_setjmp(jmp) == 0) {
+                    node->acc = par_reduce_join(job->r, node->acc, half->acc);
+                    half->has_acc = 0;
+                    yona_rt_try_end();
+                } else {
+                    /* A half-merged dict may already be freed: drop both */
+                    node->has_acc = 0;
+                    half->has_acc = 0;
+                    par_reduce_fail(job);
+                }
+            }
+        }
+        if (half->has_acc) par_reduce_discard(job->r, half->acc);
+        free(half);
+    }
+}
+
+/* Fold r->n > 0 elements on the pool into *out. On error returns 1 with
+ * the first raised exception in *sym / *msg and nothing left allocated. */
+static int par_reduce(const yona_par_reduce_t* r, int64_t grain, int64_t* out,
+                      int64_t* sym, const char** msg) {
+    yona_par_rjob_t job;
+    job.r = r;
+    job.grain = grain > 0 ? grain : par_auto_grain(r->n);
+    atomic_init(&job.failed, 0);
+    job.error_symbol = 0;
+    job.error_msg = NULL;
+
+    yona_par_rnode_t root;
+    root.job = &job;
+    root.lo = 0;
+    root.hi = r->n;
+    root.acc = 0;
+    root.has_acc = 0;
+    atomic_init(&root.state, YONA_PROMISE_PENDING);
+    root.promise = NULL;
+    root.halves = NULL;
+    root.next = NULL;
+
+    if (r->n > job.grain) yona_pool_init();
+    par_reduce_run(&root);
+
+    if (atomic_load_explicit(&job.failed, memory_order_acquire)) {
+        if (root.has_acc) par_reduce_discard(r, root.acc);
+        *sym = job.error_symbol;
+        *msg = job.error_msg;
+        return 1;
+    }
+    *out = root.acc;
+    return 0;
+}
+
 /* Test helper: async function that sleeps for N milliseconds then returns N */
 int64_t yona_test_slow_identity(int64_t ms) {
     usleep((useconds_t)(ms * 1000));
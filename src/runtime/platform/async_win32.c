@@ -13,11 +13,12 @@
 #include <stdlib.h>
 #include <windows.h>
 
-void yona_rt_arena_destroy(void* arena_ptr);
+void yona_rt_let_arena_end(void* arena);
 
-#define YONA_POOL_SIZE 8
-#define YONA_POOL_MAX_THREADS 32
 #define YONA_GROUP_INITIAL_CAP 8
+#define YONA_GROUP_CACHE_MAX 64
+#define YONA_GROUP_CACHE_KEEP_CAP 256
+#define YONA_GROUP_FRAME_HEADER 256
 
 void* yona_rt_try_push(void);
 void yona_rt_try_end(void);
@@ -29,6 +30,7 @@ typedef struct yona_promise {
 	int64_t result;
 	int completed;
 	int error;
+	int abandoned; /* awaitTimeout gave up: the completer frees it */
 	CRITICAL_SECTION mutex;
 	CONDITION_VARIABLE cond;
 } yona_promise_t;
@@ -49,26 +51,78 @@ typedef struct yona_task_group {
 	void* arena;
 	CRITICAL_SECTION mutex;
 	CONDITION_VARIABLE done_cond;
+	/* See async_posix.c: framed groups live in caller memory, the rest are
+	 * recycled through a per-thread cache. */
+	int framed;
+	yona_promise_t** inline_children;
+	struct yona_task_group* next_free;
 } yona_task_group_t;
 
+_Static_assert(sizeof(yona_task_group_t) <= YONA_GROUP_FRAME_HEADER,
+	       "YONA_GROUP_FRAME_HEADER too small for yona_task_group_t");
+
+static __declspec(thread) yona_task_group_t* yona_group_cache = NULL;
+static __declspec(thread) int yona_group_cached = 0;
+
+static void group_reset(yona_task_group_t* g) {
+	g->cancelled = 0;
+	g->pending_count = 0;
+	g->child_count = 0;
+	g->io_child_count = 0;
+	g->first_error_symbol = 0;
+	g->first_error_msg = NULL;
+	g->has_error = 0;
+	g->arena = NULL;
+}
+
 yona_task_group_t* yona_rt_group_begin(void) {
-	yona_task_group_t* g = (yona_task_group_t*)calloc(1, sizeof(yona_task_group_t));
-	g->child_cap = YONA_GROUP_INITIAL_CAP;
-	g->children = (yona_promise_t**)malloc(g->child_cap * sizeof(yona_promise_t*));
-	g->io_child_cap = YONA_GROUP_INITIAL_CAP;
-	g->io_children = (uint64_t*)malloc(g->io_child_cap * sizeof(uint64_t));
+	yona_task_group_t* g = yona_group_cache;
+	if (g) {
+		yona_group_cache = g->next_free;
+		yona_group_cached--;
+	} else {
+		g = (yona_task_group_t*)calloc(1, sizeof(yona_task_group_t));
+		g->child_cap = YONA_GROUP_INITIAL_CAP;
+		g->children = (yona_promise_t**)malloc(g->child_cap * sizeof(yona_promise_t*));
+		InitializeCriticalSection(&g->mutex);
+		InitializeConditionVariable(&g->done_cond);
+	}
+	group_reset(g);
+	return g;
+}
+
+yona_task_group_t* yona_rt_group_begin_in(void* frame, int64_t cap) {
+	yona_task_group_t* g = (yona_task_group_t*)frame;
+	g->framed = 1;
+	g->inline_children = cap > 0
+		? (yona_promise_t**)((char*)frame + YONA_GROUP_FRAME_HEADER) : NULL;
+	g->children = g->inline_children;
+	g->child_cap = cap > 0 ? (int)cap : 0;
+	g->io_children = NULL;
+	g->io_child_cap = 0;
+	g->next_free = NULL;
 	InitializeCriticalSection(&g->mutex);
 	InitializeConditionVariable(&g->done_cond);
+	group_reset(g);
 	return g;
 }
 
+static void group_grow_children(yona_task_group_t* g) {
+	int cap = g->child_cap ? g->child_cap * 2 : YONA_GROUP_INITIAL_CAP;
+	if (g->children == g->inline_children) {
+		yona_promise_t** heap = (yona_promise_t**)malloc(cap * sizeof(yona_promise_t*));
+		if (g->child_count) memcpy(heap, g->children, g->child_count * sizeof(yona_promise_t*));
+		g->children = heap;
+	} else {
+		g->children = (yona_promise_t**)realloc(g->children, cap * sizeof(yona_promise_t*));
+	}
+	g->child_cap = cap;
+}
+
 void yona_rt_group_register(yona_task_group_t* g, yona_promise_t* p) {
 	if (!g) return;
 	EnterCriticalSection(&g->mutex);
-	if (g->child_count >= g->child_cap) {
-		g->child_cap *= 2;
-		g->children = (yona_promise_t**)realloc(g->children, g->child_cap * sizeof(yona_promise_t*));
-	}
+	if (g->child_count >= g->child_cap) group_grow_children(g);
 	g->children[g->child_count++] = p;
 	(void)__atomic_fetch_add(&g->pending_count, 1, __ATOMIC_SEQ_CST);
 	LeaveCriticalSection(&g->mutex);
@@ -78,7 +132,7 @@ void yona_rt_group_register_io(yona_task_group_t* g, uint64_t io_id) {
 	if (!g) return;
 	EnterCriticalSection(&g->mutex);
 	if (g->io_child_count >= g->io_child_cap) {
-		g->io_child_cap *= 2;
+		g->io_child_cap = g->io_child_cap ? g->io_child_cap * 2 : YONA_GROUP_INITIAL_CAP;
 		g->io_children = (uint64_t*)realloc(g->io_children, g->io_child_cap * sizeof(uint64_t));
 	}
 	g->io_children[g->io_child_count++] = io_id;
@@ -103,7 +157,7 @@ void yona_rt_group_attach_arena(yona_task_group_t* g, void* arena) {
 void yona_rt_group_detach_arena(void* g_ptr) {
 	yona_task_group_t* g = (yona_task_group_t*)g_ptr;
 	if (!g || !g->arena) return;
-	yona_rt_arena_destroy(g->arena);
+	yona_rt_let_arena_end(g->arena);
 	g->arena = NULL;
 }
 
@@ -120,13 +174,36 @@ static void yona_rt_promise_destroy(yona_promise_t* p) {
 void yona_rt_group_end(void* g_ptr) {
 	yona_task_group_t* g = (yona_task_group_t*)g_ptr;
 	if (!g) return;
-	yona_rt_group_detach_arena(g);
+	/* Children first: on raise unwind they may still be reading values
+	 * the scope put in its arena. */
 	for (int i = 0; i < g->child_count; i++)
 		yona_rt_promise_destroy(g->children[i]);
-	DeleteCriticalSection(&g->mutex);
-	free(g->children);
-	free(g->io_children);
-	free(g);
+	yona_rt_group_detach_arena(g);
+	if (g->framed) {
+		if (g->children != g->inline_children) free(g->children);
+		free(g->io_children);
+		DeleteCriticalSection(&g->mutex);
+		return;
+	}
+	if (yona_group_cached >= YONA_GROUP_CACHE_MAX) {
+		DeleteCriticalSection(&g->mutex);
+		free(g->children);
+		free(g->io_children);
+		free(g);
+		return;
+	}
+	if (g->child_cap > YONA_GROUP_CACHE_KEEP_CAP) {
+		g->child_cap = YONA_GROUP_INITIAL_CAP;
+		g->children = (yona_promise_t**)realloc(g->children, g->child_cap * sizeof(yona_promise_t*));
+	}
+	if (g->io_child_cap > YONA_GROUP_CACHE_KEEP_CAP) {
+		free(g->io_children);
+		g->io_children = NULL;
+		g->io_child_cap = 0;
+	}
+	g->next_free = yona_group_cache;
+	yona_group_cache = g;
+	yona_group_cached++;
 }
 
 typedef struct yona_task {
@@ -136,10 +213,23 @@ typedef struct yona_task {
 	yona_promise_t* promise;
 	yona_task_group_t* group;
 	struct yona_task* next;
+	int64_t queued_ns; /* when queued, if task timing is on; else 0 */
+	int prio;          /* YONA_PRIO_* */
+	int64_t due_ns;    /* urgent queue order */
 } yona_task_t;
 
-static yona_task_t* yona_task_head = NULL;
-static yona_task_t* yona_task_tail = NULL;
+/* Priorities (Std\Task.spawnWith), as in async_posix.c: one FIFO per
+ * class under yona_pool_mutex, the urgent one kept in deadline order. */
+#define YONA_PRIO_URGENT 0
+#define YONA_PRIO_NORMAL 1
+#define YONA_PRIO_BATCH  2
+#define YONA_PRIO_CLASSES 3
+#define YONA_BATCH_EVERY 64
+
+static yona_task_t* yona_task_head[YONA_PRIO_CLASSES];
+static yona_task_t* yona_task_tail[YONA_PRIO_CLASSES];
+static uint32_t yona_task_picks = 0; /* guarded by yona_pool_mutex */
+static __declspec(thread) int yona_current_prio = YONA_PRIO_NORMAL;
 static CRITICAL_SECTION yona_pool_mutex;
 static CONDITION_VARIABLE yona_pool_cond;
 static INIT_ONCE yona_pool_init_once = INIT_ONCE_STATIC_INIT;
@@ -154,13 +244,53 @@ static int yona_running_workers = 0;
 static int yona_blocked_workers = 0;
 static int yona_active_external_tasks = 0;
 static int yona_external_waiters = 0;
+static int yona_timers_armed = 0; /* periodic timers; guarded by yona_liveness_mutex */
 static __declspec(thread) int64_t yona_current_task_id = 0;
 static __declspec(thread) int yona_current_task_is_worker = 0;
 static __declspec(thread) int yona_external_task_registered = 0;
 static __declspec(thread) int yona_channel_wait_kind = 0; /* 1 worker, 2 external */
 static __declspec(thread) int yona_deadlock_candidate_seen = 0;
 
-static DWORD WINAPI yona_pool_worker_win32(void* unused);
+static DWORD WINAPI yona_pool_worker_win32(void* arg);
+
+/* Std\Runtime.stats; see compiled_runtime.c. One shared FIFO, so there are
+ * no steals, and no fibers to suspend. Its depth is recorded in the
+ * external block under yona_liveness_mutex. */
+static yona_sched_stats_t yona_worker_stats[YONA_POOL_MAX_THREADS];
+static yona_sched_stats_t yona_stats_external;
+static uint64_t yona_stats_compensations = 0; /* guarded by yona_liveness_mutex */
+static __declspec(thread) yona_sched_stats_t* yona_current_stats = NULL;
+
+static void sched_count(int counter, uint64_t n) {
+	yona_sched_stats_t* s = yona_current_stats;
+	sched_stat_bump(&(s ? s : &yona_stats_external)->count[counter], s != NULL, n);
+}
+
+static int sched_stats_workers(void) {
+	return __atomic_load_n(&yona_worker_threads, __ATOMIC_ACQUIRE);
+}
+
+static yona_sched_stats_t* sched_stats_worker(int i) {
+	return i < 0 ? &yona_stats_external : &yona_worker_stats[i];
+}
+
+static uint64_t sched_stats_compensations(void) {
+	return __atomic_load_n(&yona_stats_compensations, __ATOMIC_RELAXED);
+}
+
+static int64_t sched_now_ns(void) {
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+	if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (int64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+}
+
+/* Pinning plan, fixed at pool start: worker i gets yona_pool_cpus[i % n] */
+static int yona_pool_cpus[YONA_POOL_MAX_THREADS];
+static int yona_pool_nodes[YONA_POOL_MAX_THREADS];
+static int yona_pool_ncpus = 0;
+static int yona_pool_started = 0;
 
 static BOOL CALLBACK yona_liveness_init_once_cb(PINIT_ONCE initOnce, PVOID parameter, PVOID* context) {
 	(void)initOnce;
@@ -174,19 +304,20 @@ static void liveness_init(void) {
 	InitOnceExecuteOnce(&yona_liveness_init_once, yona_liveness_init_once_cb, NULL, NULL);
 }
 
-static void start_pool_worker_unlocked(void) {
-	HANDLE h = CreateThread(NULL, 0, yona_pool_worker_win32, NULL, 0, NULL);
-	if (h) {
-		CloseHandle(h);
-		yona_worker_threads++;
-	}
+static int start_pool_worker_unlocked(void) {
+	HANDLE h = CreateThread(NULL, 0, yona_pool_worker_win32,
+				(void*)(intptr_t)yona_worker_threads, 0, NULL);
+	if (!h) return 0;
+	CloseHandle(h);
+	__atomic_store_n(&yona_worker_threads, yona_worker_threads + 1, __ATOMIC_RELEASE);
+	return 1;
 }
 
 static void maybe_spawn_compensation_worker_unlocked(void) {
 	if (yona_queued_tasks <= 0) return;
 	if (yona_worker_threads >= YONA_POOL_MAX_THREADS) return;
 	if (yona_running_workers > 0) return;
-	start_pool_worker_unlocked();
+	if (start_pool_worker_unlocked()) yona_stats_compensations++;
 }
 
 static void liveness_register_external_task_unlocked(void) {
@@ -200,6 +331,7 @@ static void liveness_task_queued(void) {
 	liveness_init();
 	EnterCriticalSection(&yona_liveness_mutex);
 	yona_queued_tasks++;
+	sched_stat_depth(&yona_stats_external, yona_queued_tasks);
 	LeaveCriticalSection(&yona_liveness_mutex);
 }
 
@@ -255,6 +387,7 @@ int yona_rt_channel_wait_begin(void* channel, int op, int64_t count, int64_t cap
 				  yona_active_external_tasks == 0 &&
 				  yona_queued_tasks == 0 &&
 				  opposite_waiters <= 0 &&
+				  yona_timers_armed == 0 &&
 				  !other_blocked);
 	/* A condition-variable signal can make a waiter runnable before it has
 	 * returned from timedwait and restored its liveness state. Confirm the
@@ -279,36 +412,74 @@ void yona_rt_channel_wait_end(void) {
 	LeaveCriticalSection(&yona_liveness_mutex);
 }
 
+static void promise_free(yona_promise_t* p) {
+	DeleteCriticalSection(&p->mutex);
+	free(p);
+}
+
 static void fulfill_promise(yona_task_t* task, int64_t result, int is_error) {
+	/* Settle the group first: once completed is visible the parent may end
+	 * the group and reuse it. */
+	if (task->group) {
+		if (__atomic_fetch_sub(&task->group->pending_count, 1, __ATOMIC_SEQ_CST) == 1)
+			WakeConditionVariable(&task->group->done_cond);
+	}
 	EnterCriticalSection(&task->promise->mutex);
 	task->promise->result = result;
 	task->promise->error = is_error;
 	task->promise->completed = 1;
+	int abandoned = task->promise->abandoned;
 	WakeConditionVariable(&task->promise->cond);
 	LeaveCriticalSection(&task->promise->mutex);
+	if (abandoned) promise_free(task->promise);
+}
 
-	if (task->group) {
-		if (__atomic_fetch_sub(&task->group->pending_count, 1, __ATOMIC_SEQ_CST) == 1)
-			WakeConditionVariable(&task->group->done_cond);
+/* Urgent first, then normal, then batch; every YONA_BATCH_EVERY picks
+ * batch goes ahead of normal so a saturated pool still gets to it. */
+static yona_task_t* pool_take_locked(void) {
+	static const int order[2][2] = {{YONA_PRIO_NORMAL, YONA_PRIO_BATCH},
+					{YONA_PRIO_BATCH, YONA_PRIO_NORMAL}};
+	int q = YONA_PRIO_URGENT;
+	if (!yona_task_head[q]) {
+		const int* o = order[++yona_task_picks % YONA_BATCH_EVERY == 0];
+		q = yona_task_head[o[0]] ? o[0] : o[1];
+		if (!yona_task_head[q]) return NULL;
 	}
+	yona_task_t* task = yona_task_head[q];
+	yona_task_head[q] = task->next;
+	if (!yona_task_head[q]) yona_task_tail[q] = NULL;
+	return task;
 }
 
-static DWORD WINAPI yona_pool_worker_win32(void* unused) {
-	(void)unused;
+static DWORD WINAPI yona_pool_worker_win32(void* arg) {
+	int index = (int)(intptr_t)arg;
+	yona_current_stats = &yona_worker_stats[index];
+	if (yona_pool_ncpus) yona_platform_pin_thread(yona_pool_cpus[index % yona_pool_ncpus]);
 	for (;;) {
 		EnterCriticalSection(&yona_pool_mutex);
-		while (!yona_task_head)
+		yona_task_t* task = pool_take_locked();
+		if (!task) sched_count(YONA_STAT_PARKS, 1);
+		while (!task) {
 			SleepConditionVariableCS(&yona_pool_cond, &yona_pool_mutex, INFINITE);
-		yona_task_t* task = yona_task_head;
-		yona_task_head = task->next;
-		if (!yona_task_head) yona_task_tail = NULL;
+			task = pool_take_locked();
+		}
 		LeaveCriticalSection(&yona_pool_mutex);
+		yona_current_prio = task->prio == YONA_PRIO_BATCH ? YONA_PRIO_BATCH : YONA_PRIO_NORMAL;
+		/* Group children get a task arena (see compiled_runtime.c) */
+		yona_task_arena_t outer_arena = task_arena_enter(task->group != NULL);
 
 		liveness_worker_begin();
+		sched_count(YONA_STAT_TASKS, 1);
+		int64_t started = 0;
+		if (task->queued_ns) {
+			started = sched_now_ns();
+			sched_stat_latency(yona_current_stats->wait_ns, 1, started - task->queued_ns);
+		}
 
 		if (task->group && __atomic_load_n(&task->group->cancelled, __ATOMIC_SEQ_CST)) {
 			fulfill_promise(task, 0, 1);
 			liveness_worker_end();
+			task_arena_leave(outer_arena);
 			free(task);
 			continue;
 		}
@@ -334,7 +505,9 @@ static DWORD WINAPI yona_pool_worker_win32(void* unused) {
 			}
 			fulfill_promise(task, 0, 1);
 		}
+		if (started) sched_stat_latency(yona_current_stats->run_ns, 1, sched_now_ns() - started);
 		liveness_worker_end();
+		task_arena_leave(outer_arena);
 		free(task);
 	}
 }
@@ -346,10 +519,16 @@ static BOOL CALLBACK yona_pool_init_once_cb(PINIT_ONCE initOnce, PVOID parameter
 	InitializeCriticalSection(&yona_pool_mutex);
 	InitializeConditionVariable(&yona_pool_cond);
 	liveness_init();
+	sched_stats_env_init();
+	if (yona_pool_pin_enabled())
+		yona_pool_ncpus = yona_platform_usable_cpus(yona_pool_cpus, yona_pool_nodes,
+		                                            YONA_POOL_MAX_THREADS);
+	int size = yona_pool_configured_size();
 	EnterCriticalSection(&yona_liveness_mutex);
-	for (int i = 0; i < YONA_POOL_SIZE; i++) {
+	for (int i = 0; i < size; i++) {
 		start_pool_worker_unlocked();
 	}
+	__atomic_store_n(&yona_pool_started, 1, __ATOMIC_RELEASE);
 	LeaveCriticalSection(&yona_liveness_mutex);
 	return TRUE;
 }
@@ -358,6 +537,31 @@ static void yona_pool_init(void) {
 	InitOnceExecuteOnce(&yona_pool_init_once, yona_pool_init_once_cb, NULL, NULL);
 }
 
+/* Std\Runtime.workerCount: running pool size, or what it will start with */
+static int yona_pool_worker_count(void) {
+	if (!__atomic_load_n(&yona_pool_started, __ATOMIC_ACQUIRE))
+		return yona_pool_configured_size();
+	EnterCriticalSection(&yona_liveness_mutex);
+	int n = yona_worker_threads;
+	LeaveCriticalSection(&yona_liveness_mutex);
+	return n;
+}
+
+/* Std\Runtime.setWorkerCount on a started pool: add workers up to n.
+ * Workers never exit, so the pool does not shrink. */
+static int yona_pool_grow(int n) {
+	if (__atomic_load_n(&yona_pool_started, __ATOMIC_ACQUIRE)) {
+		EnterCriticalSection(&yona_liveness_mutex);
+		while (yona_worker_threads < n) {
+			int before = yona_worker_threads;
+			start_pool_worker_unlocked();
+			if (yona_worker_threads == before) break;
+		}
+		LeaveCriticalSection(&yona_liveness_mutex);
+	}
+	return yona_pool_worker_count();
+}
+
 typedef int64_t (*yona_thunk_t)(void);
 
 static yona_promise_t* make_promise(void) {
@@ -365,6 +569,7 @@ static yona_promise_t* make_promise(void) {
 	p->result = 0;
 	p->completed = 0;
 	p->error = 0;
+	p->abandoned = 0;
 	InitializeCriticalSection(&p->mutex);
 	InitializeConditionVariable(&p->cond);
 	return p;
@@ -382,32 +587,54 @@ void yona_rt_promise_complete(yona_promise_t* p, int64_t result, int is_error,
 		LeaveCriticalSection(&p->mutex);
 		return;
 	}
+	if (group) {
+		if (__atomic_fetch_sub(&group->pending_count, 1, __ATOMIC_SEQ_CST) == 1)
+			WakeConditionVariable(&group->done_cond);
+	}
 	p->result = result;
 	p->error = is_error ? 1 : 0;
 	p->completed = 1;
+	int abandoned = p->abandoned;
 	WakeConditionVariable(&p->cond);
 	LeaveCriticalSection(&p->mutex);
-
-	if (group) {
-		if (__atomic_fetch_sub(&group->pending_count, 1, __ATOMIC_SEQ_CST) == 1)
-			WakeConditionVariable(&group->done_cond);
-	}
+	if (abandoned) promise_free(p);
 }
 
-static void enqueue_task(yona_task_t* task) {
+static void enqueue_task_prio(yona_task_t* task, int prio, int64_t deadline_ms) {
 	yona_pool_init();
+	int timing = __atomic_load_n(&yona_task_timing, __ATOMIC_RELAXED);
+	int64_t now = timing || prio == YONA_PRIO_URGENT ? sched_now_ns() : 0;
+	task->queued_ns = timing ? now : 0;
+	task->prio = prio;
+	task->due_ns = deadline_ms > 0 ? now + deadline_ms * 1000000 : now;
+	task->next = NULL;
 	EnterCriticalSection(&yona_pool_mutex);
-	if (yona_task_tail)
-		yona_task_tail->next = task;
-	else
-		yona_task_head = task;
-	yona_task_tail = task;
+	if (prio == YONA_PRIO_URGENT) {
+		/* Deadline order, FIFO among equals */
+		yona_task_t** link = &yona_task_head[prio];
+		while (*link && (*link)->due_ns <= task->due_ns)
+			link = &(*link)->next;
+		task->next = *link;
+		*link = task;
+		if (!task->next) yona_task_tail[prio] = task;
+	} else {
+		if (yona_task_tail[prio])
+			yona_task_tail[prio]->next = task;
+		else
+			yona_task_head[prio] = task;
+		yona_task_tail[prio] = task;
+	}
 	WakeConditionVariable(&yona_pool_cond);
 	LeaveCriticalSection(&yona_pool_mutex);
 }
 
-static yona_promise_t* submit_task(yona_async_fn_t fn, yona_thunk_fn_t thunk, int64_t arg,
-				   yona_task_group_t* group) {
+/* Spawned tasks take the class of the task spawning them */
+static void enqueue_task(yona_task_t* task) {
+	enqueue_task_prio(task, yona_current_prio, 0);
+}
+
+static yona_promise_t* submit_task_prio(yona_async_fn_t fn, yona_thunk_fn_t thunk, int64_t arg,
+					yona_task_group_t* group, int prio, int64_t deadline_ms) {
 	yona_pool_init();
 	yona_promise_t* promise = make_promise();
 	yona_task_t* task = (yona_task_t*)calloc(1, sizeof(yona_task_t));
@@ -424,10 +651,15 @@ static yona_promise_t* submit_task(yona_async_fn_t fn, yona_thunk_fn_t thunk, in
 		LeaveCriticalSection(&yona_liveness_mutex);
 	}
 	liveness_task_queued();
-	enqueue_task(task);
+	enqueue_task_prio(task, prio, deadline_ms);
 	return promise;
 }
 
+static yona_promise_t* submit_task(yona_async_fn_t fn, yona_thunk_fn_t thunk, int64_t arg,
+				   yona_task_group_t* group) {
+	return submit_task_prio(fn, thunk, arg, group, yona_current_prio, 0);
+}
+
 yona_promise_t* yona_rt_async_call_thunk(yona_thunk_t thunk) {
 	return submit_task(NULL, thunk, 0, NULL);
 }
@@ -454,6 +686,13 @@ yona_promise_t* yona_rt_async_spawn_closure(int64_t* closure, yona_task_group_t*
 			   group);
 }
 
+yona_promise_t* yona_rt_async_spawn_closure_prio(int64_t* closure, int64_t prio,
+						 int64_t deadline_ms) {
+	if (prio < YONA_PRIO_URGENT || prio > YONA_PRIO_BATCH) prio = YONA_PRIO_NORMAL;
+	return submit_task_prio((yona_async_fn_t)spawn_closure_dispatch, NULL,
+				(int64_t)(intptr_t)closure, NULL, (int)prio, deadline_ms);
+}
+
 yona_promise_t* yona_rt_async_call_grouped(yona_async_fn_t fn, int64_t arg, yona_task_group_t* group) {
 	return submit_task(fn, NULL, arg, group);
 }
@@ -469,11 +708,30 @@ int64_t yona_rt_async_await_keep(yona_promise_t* promise) {
 
 int64_t yona_rt_async_await(yona_promise_t* promise) {
 	int64_t result = yona_rt_async_await_keep(promise);
-	DeleteCriticalSection(&promise->mutex);
-	free(promise);
+	promise_free(promise);
 	return result;
 }
 
+/* Await for at most ms milliseconds; see async_posix.c. On timeout the
+ * promise is marked abandoned and whoever completes it frees it. */
+int yona_rt_async_await_timeout(yona_promise_t* promise, int64_t ms, int64_t* result) {
+	ULONGLONG deadline = GetTickCount64() + (ULONGLONG)(ms > 0 ? ms : 0);
+	EnterCriticalSection(&promise->mutex);
+	while (!promise->completed) {
+		ULONGLONG now = GetTickCount64();
+		if (now >= deadline) break;
+		SleepConditionVariableCS(&promise->cond, &promise->mutex, (DWORD)(deadline - now));
+	}
+	int done = promise->completed;
+	if (done)
+		*result = promise->result;
+	else
+		promise->abandoned = 1;
+	LeaveCriticalSection(&promise->mutex);
+	if (done) promise_free(promise);
+	return done;
+}
+
 void yona_rt_group_cancel(yona_task_group_t* g) {
 	if (!g) return;
 	__atomic_store_n(&g->cancelled, 1, __ATOMIC_SEQ_CST);
@@ -496,6 +754,262 @@ int64_t yona_rt_group_await_all(yona_task_group_t* g) {
 	return 0;
 }
 
+/* Sleeps and periodic timers (Std\Time). Workers here are plain threads, so
+ * a sleep just blocks one; periodic timers are thread-pool timers whose
+ * callback queues a run of the closure on our pool. */
+void yona_rt_sleep(int64_t ms) {
+	while (ms > 0) {
+		DWORD step = ms > 0x7fffffff ? 0x7fffffff : (DWORD)ms;
+		Sleep(step);
+		ms -= step;
+	}
+}
+
+typedef struct yona_ticker {
+	PTP_TIMER timer;
+	int64_t id;
+	int64_t* closure;
+	LONG refs; /* the table, plus a run in flight */
+	LONG busy; /* a run is queued or running */
+	struct yona_ticker* next;
+} yona_ticker_t;
+
+static yona_ticker_t* yona_tickers = NULL; /* guarded by yona_liveness_mutex */
+static int64_t yona_ticker_next_id = 1;
+
+extern void yona_rt_rc_inc(void* p);
+extern void yona_rt_rc_dec(void* p);
+
+static void ticker_release(yona_ticker_t* k) {
+	if (InterlockedDecrement(&k->refs) != 0) return;
+	yona_rt_rc_dec(k->closure);
+	free(k);
+}
+
+static int64_t ticker_run(int64_t arg) {
+	yona_ticker_t* k = (yona_ticker_t*)(intptr_t)arg;
+	typedef int64_t (*thunk_fn_t)(int64_t*);
+	/* A raise ends this run only */
+	void* jmp = yona_rt_try_push();
+	if (__builtin_setjmp((void**)jmp) == 0) {
+		((thunk_fn_t)(intptr_t)k->closure[0])(k->closure);
+		yona_rt_try_end();
+	}
+	InterlockedExchange(&k->busy, 0);
+	ticker_release(k);
+	return 0;
+}
+
+static VOID CALLBACK ticker_fire(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer) {
+	(void)instance;
+	(void)timer;
+	yona_ticker_t* k = (yona_ticker_t*)context;
+	if (InterlockedExchange(&k->busy, 1)) return;
+	InterlockedIncrement(&k->refs);
+	/* Nobody awaits a run: the worker frees the promise when it completes */
+	yona_promise_t* promise = make_promise();
+	promise->abandoned = 1;
+	yona_task_t* task = (yona_task_t*)calloc(1, sizeof(yona_task_t));
+	task->fn = ticker_run;
+	task->arg = (int64_t)(intptr_t)k;
+	task->promise = promise;
+	liveness_task_queued();
+	enqueue_task(task);
+}
+
+int64_t yona_rt_timer_every(int64_t* closure, int64_t ms) {
+	yona_pool_init();
+	liveness_init();
+	yona_ticker_t* k = (yona_ticker_t*)malloc(sizeof(yona_ticker_t));
+	k->timer = CreateThreadpoolTimer(ticker_fire, k, NULL);
+	if (!k->timer) {
+		free(k);
+		return 0;
+	}
+	k->closure = closure;
+	yona_rt_rc_inc(closure);
+	k->refs = 1;
+	k->busy = 0;
+	EnterCriticalSection(&yona_liveness_mutex);
+	k->id = yona_ticker_next_id++;
+	k->next = yona_tickers;
+	yona_tickers = k;
+	yona_timers_armed++;
+	LeaveCriticalSection(&yona_liveness_mutex);
+	DWORD period = ms > 0 ? (ms > 0x7fffffff ? 0x7fffffff : (DWORD)ms) : 1;
+	/* Negative due time: relative, in 100 ns units */
+	LARGE_INTEGER due;
+	due.QuadPart = -(LONGLONG)period * 10000;
+	FILETIME ft;
+	ft.dwLowDateTime = due.LowPart;
+	ft.dwHighDateTime = (DWORD)due.HighPart;
+	SetThreadpoolTimer(k->timer, &ft, period, 0);
+	return k->id;
+}
+
+int yona_rt_timer_cancel(int64_t id) {
+	if (id <= 0) return 0;
+	liveness_init();
+	EnterCriticalSection(&yona_liveness_mutex);
+	yona_ticker_t* k = NULL;
+	for (yona_ticker_t** link = &yona_tickers; *link; link = &(*link)->next) {
+		if ((*link)->id != id) continue;
+		k = *link;
+		*link = k->next;
+		yona_timers_armed--;
+		break;
+	}
+	LeaveCriticalSection(&yona_liveness_mutex);
+	if (!k) return 0;
+	SetThreadpoolTimer(k->timer, NULL, 0, 0);
+	WaitForThreadpoolTimerCallbacks(k->timer, TRUE);
+	CloseThreadpoolTimer(k->timer);
+	ticker_release(k);
+	return 1;
+}
+
+/* Chunked parallel loops ([| f x for x = xs ], Std\Parallel). The Win32 pool
+ * has one shared FIFO, so ranges are cut up front at the grain size and run
+ * as a task group; an error cancels the ranges that have not started yet. */
+#define YONA_PAR_CHUNKS_PER_WORKER 8
+
+typedef struct {
+	int64_t* fn;
+	const int64_t* elems;
+	int64_t* result;
+	int64_t lo, hi;
+} yona_par_range_t;
+
+static int64_t par_range_task(int64_t arg) {
+	typedef int64_t (*par_fn_t)(int64_t*, int64_t);
+	yona_par_range_t* r = (yona_par_range_t*)(intptr_t)arg;
+	par_fn_t f = (par_fn_t)(intptr_t)r->fn[0];
+	for (int64_t i = r->lo; i < r->hi; i++) {
+		int64_t v = f(r->fn, r->elems[i]);
+		if (r->result) r->result[SEQ_HDR_SIZE + i] = v;
+	}
+	return 0;
+}
+
+static void par_loop(int64_t* fn, int64_t* src, int64_t* result, int64_t grain) {
+	int64_t n = yona_rt_seq_length(src);
+	if (n == 0) return;
+	if (grain <= 0) {
+		grain = n / ((int64_t)yona_pool_worker_count() * YONA_PAR_CHUNKS_PER_WORKER);
+		if (grain < 1) grain = 1;
+	}
+
+	int64_t* copy = NULL;
+	const int64_t* elems;
+	if (!is_rbt(src)) {
+		elems = src + SEQ_HDR_SIZE + FLAT_OFF(src);
+	} else {
+		copy = (int64_t*)malloc((size_t)n * sizeof(int64_t));
+		yona_rt_seq_copy_out(src, copy);
+		elems = copy;
+	}
+
+	int64_t nranges = (n + grain - 1) / grain;
+	yona_par_range_t* ranges = (yona_par_range_t*)malloc((size_t)nranges * sizeof(yona_par_range_t));
+	yona_task_group_t* g = yona_rt_group_begin();
+	for (int64_t k = 0; k < nranges; k++) {
+		ranges[k].fn = fn;
+		ranges[k].elems = elems;
+		ranges[k].result = result;
+		ranges[k].lo = k * grain;
+		ranges[k].hi = (k + 1) * grain < n ? (k + 1) * grain : n;
+		yona_rt_async_call_grouped(par_range_task, (int64_t)(intptr_t)&ranges[k], g);
+	}
+	for (int i = 0; i < g->child_count; i++) {
+		yona_promise_t* p = g->children[i];
+		EnterCriticalSection(&p->mutex);
+		while (!p->completed)
+			SleepConditionVariableCS(&p->cond, &p->mutex, INFINITE);
+		LeaveCriticalSection(&p->mutex);
+	}
+	int failed = g->has_error;
+	int64_t sym = g->first_error_symbol;
+	const char* msg = g->first_error_msg;
+	yona_rt_group_end(g);
+	free(ranges);
+	free(copy);
+
+	if (failed) {
+		if (result) yona_rt_rc_dec(result);
+		yona_rt_raise(sym, msg);
+	}
+}
+
+int64_t* yona_rt_par_map(int64_t* fn, int64_t* src, int64_t grain) {
+	int64_t* result = yona_rt_seq_alloc(yona_rt_seq_length(src));
+	par_loop(fn, src, result, grain);
+	return result;
+}
+
+int64_t yona_rt_par_for(int64_t* fn, int64_t* src, int64_t grain) {
+	par_loop(fn, src, NULL, grain);
+	return yona_rt_seq_length(src);
+}
+
+/* Reductions: one accumulator per range, joined in range order once the
+ * group has drained. */
+typedef struct {
+	const yona_par_reduce_t* r;
+	int64_t lo, hi;
+	int64_t acc;
+	int has_acc;
+} yona_par_rrange_t;
+
+static int64_t par_reduce_task(int64_t arg) {
+	yona_par_rrange_t* rr = (yona_par_rrange_t*)(intptr_t)arg;
+	par_reduce_fold(rr->r, rr->lo, rr->hi, &rr->acc, &rr->has_acc);
+	return 0;
+}
+
+/* Fold r->n > 0 elements on the pool into *out. On error returns 1 with
+ * the first raised exception in *sym / *msg and nothing left allocated. */
+static int par_reduce(const yona_par_reduce_t* r, int64_t grain, int64_t* out,
+                      int64_t* sym, const char** msg) {
+	int64_t n = r->n;
+	if (grain <= 0) {
+		grain = n / ((int64_t)yona_pool_worker_count() * YONA_PAR_CHUNKS_PER_WORKER);
+		if (grain < 1) grain = 1;
+	}
+
+	int64_t nranges = (n + grain - 1) / grain;
+	yona_par_rrange_t* ranges = (yona_par_rrange_t*)calloc((size_t)nranges, sizeof(yona_par_rrange_t));
+	yona_task_group_t* g = yona_rt_group_begin();
+	for (int64_t k = 0; k < nranges; k++) {
+		ranges[k].r = r;
+		ranges[k].lo = k * grain;
+		ranges[k].hi = (k + 1) * grain < n ? (k + 1) * grain : n;
+		yona_rt_async_call_grouped(par_reduce_task, (int64_t)(intptr_t)&ranges[k], g);
+	}
+	for (int i = 0; i < g->child_count; i++) {
+		yona_promise_t* p = g->children[i];
+		EnterCriticalSection(&p->mutex);
+		while (!p->completed)
+			SleepConditionVariableCS(&p->cond, &p->mutex, INFINITE);
+		LeaveCriticalSection(&p->mutex);
+	}
+	int failed = g->has_error;
+	*sym = g->first_error_symbol;
+	*msg = g->first_error_msg;
+	yona_rt_group_end(g);
+
+	if (!failed) {
+		int64_t acc = ranges[0].acc;
+		for (int64_t k = 1; k < nranges; k++)
+			acc = par_reduce_join(r, acc, ranges[k].acc);
+		*out = acc;
+	} else {
+		for (int64_t k = 0; k < nranges; k++)
+			if (ranges[k].has_acc) par_reduce_discard(r, ranges[k].acc);
+	}
+	free(ranges);
+	return failed;
+}
+
 /* Test helper: `extern native` returns an already-completed promise (x * 7). */
 yona_promise_t* yona_test_native_promise_immediate(int64_t x) {
 	yona_promise_t* p = yona_rt_promise_new();
@@ -1,12 +1,23 @@
 /* ===== Channel Runtime =====
  *
- * Bounded MPMC channel for inter-task communication.
- * Layout: [count, head, tail, cap, ring buffer of cap i64s].
+ * Bounded MPMC channel for inter-task communication: a Vyukov ring of
+ * (sequence, value) cells. Sequences step by two per lap so "filled" and
+ * "free for the next lap" stay distinct even at capacity 1. A sender
+ * claims the next position with one CAS on send_pos and publishes the cell
+ * by advancing its sequence; a receiver does the same on recv_pos.
+ * Senders and receivers touch separate cache lines and never take a lock
+ * while the ring has room or values.
  *
- * send blocks the calling worker thread when the buffer is full.
- * recv blocks when the buffer is empty.
+ * send blocks the calling task when the ring is full, recv when it is
+ * empty. A blocked task spins briefly, then announces itself on its side's
+ * waiter count and parks: a task on a fiber on the side's wait queue (its
+ * worker runs other tasks), other threads on a futex. The opposite side
+ * only wakes anyone when the count is non-zero.
  * close wakes all waiters; subsequent recv returns None when drained.
  *
+ * sendMany / recvMany claim a run of positions with a single CAS and wake
+ * waiters once per run.
+ *
  * Designed for use BETWEEN tasks. The async runtime tracks blocked channel
  * waiters and raises :Deadlock when no runnable task can make progress.
  */
@@ -14,7 +25,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdint.h>
+#include <limits.h>
 #include <time.h>
 
 #define RC_TYPE_CHANNEL 20
@@ -27,6 +40,7 @@ extern int yona_rt_channel_wait_begin(void* channel, int op, int64_t count,
                                       int64_t cap, int closed,
                                       int opposite_waiters);
 extern void yona_rt_channel_wait_end(void);
+extern int64_t yona_platform_available_cpus(void);
 
 /* Forward declaration of task group from async_posix.c */
 struct yona_task_group;
@@ -41,23 +55,53 @@ extern int yona_rt_group_is_cancelled(yona_task_group_t* g);
 #define SYM_DEADLOCK       0
 #define SYM_CHANNEL_CLOSED 0
 
+#define YONA_CHAN_SEND 1
+#define YONA_CHAN_RECV 2
+
+/* Polls of the ring before a blocked task parks (multi-CPU only) */
+#define YONA_CHAN_SPIN 64
+
+static inline void chan_pause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+typedef struct {
+    _Atomic uint64_t seq;      /* 2*pos: free for pos; 2*pos + 1: holds pos */
+    int64_t value;
+} yona_chan_cell_t;
+
+/* One direction's waiters (senders waiting for room, receivers for values).
+ * Parked fibers and selects wait on the queue, other threads on seq. A
+ * queued waiter woken off the queue is uncounted by its waker, under the
+ * lock, so later wakes skip the lock until someone else parks. */
+typedef struct {
+    _Atomic int waiters;       /* announced, all kinds */
+    _Atomic int queued;        /* of those, on the queue and not yet woken */
+    _Atomic uint32_t seq;      /* bumped on every wake; threads futex-wait on it */
+    yona_waitq_t queue;        /* under the channel's lock */
+} yona_chan_side_t;
+
 /* Channel struct.
  * Note: this struct is heap-allocated via rc_alloc, so the returned pointer
  * is offset by RC_HEADER_SIZE (2 i64s) from the actual allocation. */
 typedef struct yona_channel {
     int64_t cap;
-    int64_t count;
-    int64_t head;
-    int64_t tail;
-    int64_t* buf;
-    pthread_mutex_t mutex;
-    pthread_cond_t not_full;
-    pthread_cond_t not_empty;
-    int closed;
-    int waiters;             /* number of blocked send/recv */
-    int send_waiters;
-    int recv_waiters;
-    yona_task_group_t* group; /* owning task group, for cancellation */
+    uint64_t mask;             /* cap - 1 when cap is a power of two, else 0 */
+    yona_chan_cell_t* cells;
+    _Atomic int closed;
+    yona_task_group_t* group;  /* owning task group, for cancellation */
+    pthread_mutex_t lock;      /* guards the fiber wait queues only */
+    char pad0[64];
+    _Atomic uint64_t send_pos; /* next position to fill */
+    char pad1[56];
+    _Atomic uint64_t recv_pos; /* next position to drain */
+    char pad2[56];
+    yona_chan_side_t senders;
+    yona_chan_side_t receivers;
 } yona_channel_t;
 
 /* Allocate Option ADT for recv return.
@@ -78,135 +122,531 @@ static int64_t* chan_make_none(void) {
 yona_channel_t* yona_rt_channel_new(int64_t cap) {
     if (cap < 1) cap = 1;
     yona_channel_t* ch = (yona_channel_t*)rc_alloc(RC_TYPE_CHANNEL, sizeof(yona_channel_t));
+    memset(ch, 0, sizeof(yona_channel_t));
     ch->cap = cap;
-    ch->count = 0;
-    ch->head = 0;
-    ch->tail = 0;
-    ch->buf = (int64_t*)calloc((size_t)cap, sizeof(int64_t));
-    pthread_mutex_init(&ch->mutex, NULL);
-    pthread_cond_init(&ch->not_full, NULL);
-    pthread_cond_init(&ch->not_empty, NULL);
-    ch->closed = 0;
-    ch->waiters = 0;
+    ch->mask = (cap & (cap - 1)) == 0 ? (uint64_t)cap - 1 : 0;
+    ch->cells = (yona_chan_cell_t*)malloc((size_t)cap * sizeof(yona_chan_cell_t));
+    for (int64_t i = 0; i < cap; i++)
+        atomic_init(&ch->cells[i].seq, 2 * (uint64_t)i);
+    pthread_mutex_init(&ch->lock, NULL);
     ch->group = NULL;  /* TODO: track current task group for cancellation */
     return ch;
 }
 
-void yona_rt_channel_send(yona_channel_t* ch, int64_t value) {
-    pthread_mutex_lock(&ch->mutex);
-    while (ch->count == ch->cap && !ch->closed) {
-        if (ch->group && yona_rt_group_is_cancelled(ch->group)) {
-            pthread_mutex_unlock(&ch->mutex);
-            yona_rt_raise(SYM_CANCELLED,
-                          "task cancelled while waiting on channel send");
-            return;
+static inline yona_chan_cell_t* chan_cell(yona_channel_t* ch, uint64_t pos) {
+    return &ch->cells[ch->mask ? pos & ch->mask : pos % (uint64_t)ch->cap];
+}
+
+/* Claim up to want positions on one side with a single CAS. Returns how
+ * many were claimed (0: ring full for senders / empty for receivers) and
+ * the first one in *first. Only the first cell is known to be ready; a
+ * batch may include cells whose previous owner is still finishing. */
+static int64_t chan_claim(yona_channel_t* ch, int op, int64_t want, uint64_t* first) {
+    _Atomic uint64_t* mine = op == YONA_CHAN_SEND ? &ch->send_pos : &ch->recv_pos;
+    _Atomic uint64_t* theirs = op == YONA_CHAN_SEND ? &ch->recv_pos : &ch->send_pos;
+    uint64_t ready = op == YONA_CHAN_SEND ? 0 : 1;
+    uint64_t pos = atomic_load_explicit(mine, memory_order_relaxed);
+    /* Counted once on the way out; under contention is no time to touch
+     * a shared counter per retry */
+    for (uint64_t retries = 0;; retries++) {
+        uint64_t seq = atomic_load_explicit(&chan_cell(ch, pos)->seq, memory_order_acquire);
+        int64_t dif = (int64_t)(seq - (2 * pos + ready));
+        if (dif < 0) {
+            if (retries) sched_count(YONA_STAT_CHAN_RETRIES, retries);
+            return 0;
         }
-        if (yona_rt_channel_wait_begin(ch, 1, ch->count, ch->cap, ch->closed,
-                                       ch->recv_waiters)) {
-            yona_rt_channel_wait_end();
-            pthread_mutex_unlock(&ch->mutex);
-            yona_rt_raise(SYM_DEADLOCK,
-                          "channel deadlock: send waiting on full channel; no runnable tasks remain");
-            return;
+        if (dif > 0) {
+            pos = atomic_load_explicit(mine, memory_order_relaxed);
+            continue;
+        }
+        int64_t n = 1;
+        if (want > 1) {
+            uint64_t other = atomic_load_explicit(theirs, memory_order_acquire);
+            n = op == YONA_CHAN_SEND ? ch->cap - (int64_t)(pos - other) : (int64_t)(other - pos);
+            if (n > want) n = want;
+            if (n < 1) n = 1;
+        }
+        if (atomic_compare_exchange_weak_explicit(mine, &pos, pos + n,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            *first = pos;
+            if (retries) sched_count(YONA_STAT_CHAN_RETRIES, retries);
+            return n;
         }
-        ch->waiters++;
-        ch->send_waiters++;
-        struct timespec ts;
-        clock_gettime(CLOCK_REALTIME, &ts);
-        ts.tv_nsec += 100000000;  /* 100ms */
-        if (ts.tv_nsec >= 1000000000) { ts.tv_sec++; ts.tv_nsec -= 1000000000; }
-        pthread_cond_timedwait(&ch->not_full, &ch->mutex, &ts);
-        ch->send_waiters--;
-        ch->waiters--;
-        yona_rt_channel_wait_end();
     }
-    if (ch->closed) {
-        pthread_mutex_unlock(&ch->mutex);
-        yona_rt_raise(SYM_CHANNEL_CLOSED, "send on closed channel");
-        return;
+}
+
+/* Wait for a claimed cell's previous owner to finish with it. */
+static inline void chan_cell_wait(yona_chan_cell_t* c, uint64_t seq) {
+    for (int spins = 0; atomic_load_explicit(&c->seq, memory_order_acquire) != seq; spins++) {
+        if (spins < YONA_CHAN_SPIN) chan_pause();
+        else sched_yield();
     }
-    ch->buf[ch->tail] = value;
-    ch->tail = (ch->tail + 1) % ch->cap;
-    ch->count++;
-    pthread_cond_signal(&ch->not_empty);
-    pthread_mutex_unlock(&ch->mutex);
 }
 
-int64_t yona_rt_channel_recv(yona_channel_t* ch) {
-    pthread_mutex_lock(&ch->mutex);
-    while (ch->count == 0 && !ch->closed) {
-        if (ch->group && yona_rt_group_is_cancelled(ch->group)) {
-            pthread_mutex_unlock(&ch->mutex);
-            yona_rt_raise(SYM_CANCELLED,
-                          "task cancelled while waiting on channel recv");
-            return 0;
+static void chan_fill(yona_channel_t* ch, uint64_t first, const int64_t* values, int64_t n) {
+    for (int64_t i = 0; i < n; i++) {
+        yona_chan_cell_t* c = chan_cell(ch, first + (uint64_t)i);
+        uint64_t pos = first + (uint64_t)i;
+        chan_cell_wait(c, 2 * pos);
+        c->value = values[i];
+        atomic_store_explicit(&c->seq, 2 * pos + 1, memory_order_release);
+    }
+}
+
+static void chan_drain(yona_channel_t* ch, uint64_t first, int64_t* out, int64_t n) {
+    for (int64_t i = 0; i < n; i++) {
+        yona_chan_cell_t* c = chan_cell(ch, first + (uint64_t)i);
+        uint64_t pos = first + (uint64_t)i;
+        chan_cell_wait(c, 2 * pos + 1);
+        out[i] = c->value;
+        atomic_store_explicit(&c->seq, 2 * (pos + (uint64_t)ch->cap), memory_order_release);
+    }
+}
+
+/* True if op could make progress now: room to send, a value to take, or
+ * the channel is closed. */
+static int chan_ready(yona_channel_t* ch, int op) {
+    if (atomic_load_explicit(&ch->closed, memory_order_acquire)) return 1;
+    _Atomic uint64_t* mine = op == YONA_CHAN_SEND ? &ch->send_pos : &ch->recv_pos;
+    uint64_t pos = atomic_load_explicit(mine, memory_order_relaxed);
+    uint64_t seq = atomic_load_explicit(&chan_cell(ch, pos)->seq, memory_order_acquire);
+    return (int64_t)(seq - (2 * pos + (op == YONA_CHAN_SEND ? 0 : 1))) >= 0;
+}
+
+static int64_t chan_count(yona_channel_t* ch) {
+    uint64_t r = atomic_load_explicit(&ch->recv_pos, memory_order_acquire);
+    uint64_t s = atomic_load_explicit(&ch->send_pos, memory_order_acquire);
+    int64_t n = (int64_t)(s - r);
+    return n < 0 ? 0 : (n > ch->cap ? ch->cap : n);
+}
+
+static inline void chan_uncount(yona_chan_side_t* s) {
+    atomic_fetch_sub_explicit(&s->queued, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&s->waiters, 1, memory_order_relaxed);
+}
+
+/* A woken fiber stops counting as a waiter at once, so the next wake goes
+ * to someone still asleep; it shows up as blocked to the deadlock check
+ * until it runs. A woken thread (a select) has no such marker and stays
+ * counted until it leaves, so it still looks like a live peer. */
+static inline void chan_woken(yona_chan_side_t* s, yona_waitq_node_t* node) {
+    if (node->waiter->fiber) chan_uncount(s);
+}
+
+/* Wake up to n waiters on side s after the ring changed, queued ones
+ * first. The fence pairs with the one a waiter issues between announcing
+ * itself and re-checking the ring, so either we see its count or it sees
+ * our cells. seq moves on every wake, so a fiber that announced itself but
+ * has not parked yet will not park. */
+static void chan_wake(yona_channel_t* ch, yona_chan_side_t* s, int n) {
+    atomic_thread_fence(memory_order_seq_cst);
+    int waiters = atomic_load_explicit(&s->waiters, memory_order_relaxed);
+    if (waiters == 0) return;
+    int queued = atomic_load_explicit(&s->queued, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->seq, 1, memory_order_release);
+    int woken = 0;
+    if (queued > 0) {
+        pthread_mutex_lock(&ch->lock);
+        yona_waitq_node_t* node;
+        while (woken < n && (node = waitq_wake_one(&s->queue))) {
+            chan_woken(s, node);
+            woken++;
         }
-        if (yona_rt_channel_wait_begin(ch, 2, ch->count, ch->cap, ch->closed,
-                                       ch->send_waiters)) {
-            yona_rt_channel_wait_end();
-            pthread_mutex_unlock(&ch->mutex);
-            yona_rt_raise(SYM_DEADLOCK,
-                          "channel deadlock: recv waiting on empty open channel; no runnable tasks remain");
-            return 0;
+        pthread_mutex_unlock(&ch->lock);
+    }
+    if (woken < n && waiters > queued) yona_futex_wake(&s->seq, n - woken);
+}
+
+static void chan_wake_all(yona_channel_t* ch, yona_chan_side_t* s) {
+    atomic_fetch_add_explicit(&s->seq, 1, memory_order_release);
+    yona_futex_wake(&s->seq, INT_MAX);
+    pthread_mutex_lock(&ch->lock);
+    yona_waitq_node_t* node;
+    while ((node = waitq_wake_one(&s->queue)))
+        chan_woken(s, node);
+    pthread_mutex_unlock(&ch->lock);
+}
+
+static int chan_spin_limit(void) {
+    static _Atomic int limit = -1;
+    int l = atomic_load_explicit(&limit, memory_order_relaxed);
+    if (l < 0) {
+        l = yona_platform_available_cpus() > 1 ? YONA_CHAN_SPIN : 0;
+        atomic_store_explicit(&limit, l, memory_order_relaxed);
+    }
+    return l;
+}
+
+enum { CHAN_OK, CHAN_CANCELLED, CHAN_DEADLOCK, CHAN_CLOSED };
+
+static void chan_raise(int status, int op) {
+    if (status == CHAN_CANCELLED)
+        yona_rt_raise(SYM_CANCELLED, op == YONA_CHAN_SEND
+                      ? "task cancelled while waiting on channel send"
+                      : "task cancelled while waiting on channel recv");
+    else if (status == CHAN_DEADLOCK)
+        yona_rt_raise(SYM_DEADLOCK, op == YONA_CHAN_SEND
+                      ? "channel deadlock: send waiting on full channel; no runnable tasks remain"
+                      : "channel deadlock: recv waiting on empty open channel; no runnable tasks remain");
+    else if (status == CHAN_CLOSED)
+        yona_rt_raise(SYM_CHANNEL_CLOSED, "send on closed channel");
+}
+
+/* Block until op may be able to proceed; the caller retries. Spins first,
+ * then announces itself and sleeps: a fiber on the side's wait queue,
+ * a thread on the side's futex word (waking every 100ms to re-run the
+ * deadlock check; parked fibers are poked by their idle worker instead).
+ * Returns CHAN_CANCELLED or CHAN_DEADLOCK instead of sleeping forever. */
+static int chan_block(yona_channel_t* ch, int op) {
+    yona_chan_side_t* s = op == YONA_CHAN_SEND ? &ch->senders : &ch->receivers;
+    yona_chan_side_t* other = op == YONA_CHAN_SEND ? &ch->receivers : &ch->senders;
+    for (int i = chan_spin_limit(); i > 0; i--) {
+        if (chan_ready(ch, op)) return CHAN_OK;
+        chan_pause();
+    }
+
+    int fiber = yona_current_fiber != NULL;
+    uint32_t key = atomic_load_explicit(&s->seq, memory_order_acquire);
+    atomic_fetch_add_explicit(&s->waiters, 1, memory_order_relaxed);
+    if (fiber) atomic_fetch_add_explicit(&s->queued, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    int status = CHAN_OK, counted = 1;
+    if (chan_ready(ch, op)) {
+        /* Raced with the other side; no need to sleep */
+    } else if (ch->group && yona_rt_group_is_cancelled(ch->group)) {
+        status = CHAN_CANCELLED;
+    } else {
+        if (yona_rt_channel_wait_begin(ch, op, chan_count(ch), ch->cap, 0,
+                                       atomic_load(&other->waiters))) {
+            status = CHAN_DEADLOCK;
+        } else if (fiber) {
+            sched_count(YONA_STAT_CHAN_WAITS, 1);
+            pthread_mutex_lock(&ch->lock);
+            if (atomic_load_explicit(&s->seq, memory_order_acquire) == key)
+                counted = !waitq_park(&s->queue, &ch->lock);
+            pthread_mutex_unlock(&ch->lock);
+        } else {
+            sched_count(YONA_STAT_CHAN_WAITS, 1);
+            yona_futex_wait_ms(&s->seq, key, 100);
         }
-        ch->waiters++;
-        ch->recv_waiters++;
-        struct timespec ts;
-        clock_gettime(CLOCK_REALTIME, &ts);
-        ts.tv_nsec += 100000000;  /* 100ms */
-        if (ts.tv_nsec >= 1000000000) { ts.tv_sec++; ts.tv_nsec -= 1000000000; }
-        pthread_cond_timedwait(&ch->not_empty, &ch->mutex, &ts);
-        ch->recv_waiters--;
-        ch->waiters--;
         yona_rt_channel_wait_end();
     }
-    if (ch->count == 0 && ch->closed) {
-        /* Channel closed and drained */
-        pthread_mutex_unlock(&ch->mutex);
-        return (int64_t)(intptr_t)chan_make_none();
+
+    if (fiber && counted) {
+        chan_uncount(s);
+    } else if (!fiber) {
+        atomic_fetch_sub_explicit(&s->waiters, 1, memory_order_relaxed);
+    }
+    return status;
+}
+
+/* Send n values in order, claiming as many free cells per CAS as there are.
+ * Returns CHAN_OK, or why it stopped; values already claimed are sent. */
+static int chan_send_values(yona_channel_t* ch, const int64_t* values, int64_t n) {
+    while (n > 0) {
+        if (atomic_load_explicit(&ch->closed, memory_order_acquire)) return CHAN_CLOSED;
+        uint64_t first;
+        int64_t k = chan_claim(ch, YONA_CHAN_SEND, n, &first);
+        if (k == 0) {
+            int status = chan_block(ch, YONA_CHAN_SEND);
+            if (status != CHAN_OK) return status;
+            continue;
+        }
+        chan_fill(ch, first, values, k);
+        chan_wake(ch, &ch->receivers, (int)k);
+        values += k;
+        n -= k;
+    }
+    return CHAN_OK;
+}
+
+/* Receive between 1 and want values into out. Returns the count, 0 once
+ * the channel is closed and drained (or at once when empty if !block),
+ * or -status when blocking failed. */
+static int64_t chan_recv_values(yona_channel_t* ch, int64_t* out, int64_t want, int block) {
+    for (;;) {
+        uint64_t first;
+        int64_t k = chan_claim(ch, YONA_CHAN_RECV, want, &first);
+        if (k > 0) {
+            chan_drain(ch, first, out, k);
+            chan_wake(ch, &ch->senders, (int)k);
+            return k;
+        }
+        if (!block) return 0;
+        if (atomic_load_explicit(&ch->closed, memory_order_acquire)) {
+            /* Values sent before the close are still delivered */
+            k = chan_claim(ch, YONA_CHAN_RECV, want, &first);
+            if (k == 0) return 0;
+            chan_drain(ch, first, out, k);
+            return k;
+        }
+        int status = chan_block(ch, YONA_CHAN_RECV);
+        if (status != CHAN_OK) return -status;
+    }
+}
+
+void yona_rt_channel_send(yona_channel_t* ch, int64_t value) {
+    chan_raise(chan_send_values(ch, &value, 1), YONA_CHAN_SEND);
+}
+
+int64_t yona_rt_channel_recv(yona_channel_t* ch) {
+    int64_t value;
+    int64_t n = chan_recv_values(ch, &value, 1, 1);
+    if (n < 0) {
+        chan_raise((int)-n, YONA_CHAN_RECV);
+        return 0;
     }
-    int64_t value = ch->buf[ch->head];
-    ch->head = (ch->head + 1) % ch->cap;
-    ch->count--;
-    pthread_cond_signal(&ch->not_full);
-    pthread_mutex_unlock(&ch->mutex);
+    if (n == 0) return (int64_t)(intptr_t)chan_make_none();
     return (int64_t)(intptr_t)chan_make_some(value);
 }
 
 int64_t yona_rt_channel_try_recv(yona_channel_t* ch) {
-    pthread_mutex_lock(&ch->mutex);
-    if (ch->count == 0) {
-        pthread_mutex_unlock(&ch->mutex);
+    int64_t value;
+    if (chan_recv_values(ch, &value, 1, 0) == 0)
         return (int64_t)(intptr_t)chan_make_none();
-    }
-    int64_t value = ch->buf[ch->head];
-    ch->head = (ch->head + 1) % ch->cap;
-    ch->count--;
-    pthread_cond_signal(&ch->not_full);
-    pthread_mutex_unlock(&ch->mutex);
     return (int64_t)(intptr_t)chan_make_some(value);
 }
 
+/* Send every element of a Seq, in order. */
+void yona_rt_channel_send_many(yona_channel_t* ch, int64_t* values) {
+    int64_t n = yona_rt_seq_length(values);
+    if (!is_rbt(values)) {
+        chan_raise(chan_send_values(ch, values + SEQ_HDR_SIZE + FLAT_OFF(values), n),
+                   YONA_CHAN_SEND);
+        return;
+    }
+    int64_t* copy = (int64_t*)malloc((size_t)n * sizeof(int64_t));
+    yona_rt_seq_copy_out(values, copy);
+    int status = chan_send_values(ch, copy, n);
+    free(copy);
+    chan_raise(status, YONA_CHAN_SEND);
+}
+
+/* Receive 1..max values as a Seq, waiting for the first; [] once the
+ * channel is closed and drained. */
+int64_t* yona_rt_channel_recv_many(yona_channel_t* ch, int64_t max) {
+    if (max < 1) return yona_rt_seq_alloc(0);
+    if (max > ch->cap) max = ch->cap;
+    int64_t* seq = yona_rt_seq_alloc(max);
+    int64_t n = chan_recv_values(ch, seq + SEQ_HDR_SIZE, max, 1);
+    if (n < 0) {
+        yona_rt_rc_dec(seq);
+        chan_raise((int)-n, YONA_CHAN_RECV);
+        return NULL;
+    }
+    seq[0] = n;
+    return seq;
+}
+
+/* ===== Select =====
+ *
+ * Wait on several channels at once. A select tries each channel in turn
+ * (starting at a rotating offset, so none is starved), then queues one node
+ * per channel, all sharing one waiter, and re-checks before parking. The
+ * first event on any of them takes the waiter and wakes the select; the
+ * others see it taken and pass their wake on to the next waiter in line. */
+
+static _Thread_local uint32_t chan_select_turn;
+
+/* Claim one free cell without blocking. */
+static int chan_try_send(yona_channel_t* ch, int64_t value) {
+    uint64_t pos;
+    if (chan_claim(ch, YONA_CHAN_SEND, 1, &pos) == 0) return 0;
+    chan_fill(ch, pos, &value, 1);
+    chan_wake(ch, &ch->receivers, 1);
+    return 1;
+}
+
+/* One pass over the channels. Returns the index that completed op, -1 if
+ * some are still open, -2 if all are closed (and, for recv, drained).
+ * live[i] says whether channel i is still worth waiting on. */
+static int64_t chan_select_try(yona_channel_t** chans, int64_t n, int op, int64_t* value,
+                               char* live) {
+    int open = 0;
+    uint32_t start = chan_select_turn++;
+    for (int64_t j = 0; j < n; j++) {
+        int64_t i = (int64_t)((start + (uint64_t)j) % (uint64_t)n);
+        yona_channel_t* ch = chans[i];
+        int closed = atomic_load_explicit(&ch->closed, memory_order_acquire);
+        live[i] = 0;
+        if (op == YONA_CHAN_SEND) {
+            if (closed) continue;
+            if (chan_try_send(ch, *value)) return i;
+        } else if (chan_recv_values(ch, value, 1, 0) == 1) {
+            return i;
+        }
+        /* A recv on a channel closed before our attempt has seen every value */
+        if (!closed || op == YONA_CHAN_SEND) live[i] = open = 1;
+    }
+    return open ? -1 : -2;
+}
+
+/* Select over n channels. Returns the index that completed op, -1 when the
+ * timeout (ms, < 0: none) expired, or -2 when every channel is closed;
+ * *status reports :Cancelled/:Deadlock. */
+static int64_t chan_select(yona_channel_t** chans, int64_t n, int op, int64_t* value,
+                           int64_t timeout_ms, int* status) {
+    *status = CHAN_OK;
+    if (n == 0) return timeout_ms < 0 ? -2 : -1;
+    yona_waitq_node_t local[8];
+    char local_live[8];
+    yona_waitq_node_t* nodes = n <= 8 ? local
+        : (yona_waitq_node_t*)malloc((size_t)n * sizeof(yona_waitq_node_t));
+    char* live = n <= 8 ? local_live : (char*)malloc((size_t)n);
+    int64_t deadline = timeout_ms > 0 ? yona_monotonic_ns() + timeout_ms * 1000000LL : 0;
+    int64_t result, woken_by = -1;
+
+    for (;;) {
+        result = chan_select_try(chans, n, op, value, live);
+        if (result != -1) break;
+        int64_t left_ms = -1;
+        if (timeout_ms >= 0) {
+            int64_t left = deadline ? deadline - yona_monotonic_ns() : 0;
+            if (left <= 0) break;
+            left_ms = (left + 999999) / 1000000;
+        }
+
+        yona_wq_waiter_t w;
+        wq_waiter_init(&w);
+        /* A timed fiber parks with a timer armed, or waits as a thread
+         * would if there is no clock thread */
+        if (w.fiber && timeout_ms >= 0 && !timer_clock_start()) w.fiber = NULL;
+        int opposite = 0;
+        yona_waitq_node_t* first = NULL;
+        for (int64_t i = 0; i < n; i++) {
+            if (!live[i]) continue;
+            if (!first) first = &nodes[i];
+            yona_channel_t* ch = chans[i];
+            yona_chan_side_t* s = op == YONA_CHAN_SEND ? &ch->senders : &ch->receivers;
+            pthread_mutex_lock(&ch->lock);
+            waitq_add(&s->queue, &nodes[i], &w);
+            atomic_fetch_add_explicit(&s->waiters, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&s->queued, 1, memory_order_relaxed);
+            pthread_mutex_unlock(&ch->lock);
+            opposite += atomic_load(op == YONA_CHAN_SEND ? &ch->receivers.waiters
+                                                         : &ch->senders.waiters);
+        }
+        atomic_thread_fence(memory_order_seq_cst);
+
+        int ready = 0;
+        for (int64_t i = 0; i < n && !ready; i++) ready = live[i] && chan_ready(chans[i], op);
+        if (!ready) {
+            for (int64_t i = 0; i < n && *status == CHAN_OK; i++)
+                if (live[i] && chans[i]->group && yona_rt_group_is_cancelled(chans[i]->group))
+                    *status = CHAN_CANCELLED;
+        }
+        if (!ready && *status == CHAN_OK) sched_count(YONA_STAT_CHAN_WAITS, 1);
+        if (!ready && *status == CHAN_OK && timeout_ms < 0) {
+            /* Only an untimed wait can deadlock. A timed one ends on its
+             * own, so it stays out of the check and counts as live. */
+            yona_channel_t* ch = chans[first - nodes];
+            if (yona_rt_channel_wait_begin(ch, op, chan_count(ch), ch->cap, 0, opposite))
+                *status = CHAN_DEADLOCK;
+            else if (w.fiber)
+                wq_waiter_suspend(first);
+            else
+                yona_futex_wait_ms(&w.taken, 0, 100);
+            yona_rt_channel_wait_end();
+        } else if (!ready && *status == CHAN_OK) {
+            if (w.fiber) {
+                yona_timer_t timer;
+                timer_init(&timer, timer_wake_waiter, &w);
+                timer_arm(&timer, left_ms);
+                wq_waiter_suspend(first);
+                timer_cancel(&timer);
+            } else {
+                /* Wake now and then to notice a cancelled group */
+                yona_futex_wait_ms(&w.taken, 0, left_ms > 100 ? 100 : (int)left_ms);
+            }
+        }
+        /* Not parked but already woken: absorb the wake before moving on */
+        if (atomic_exchange(&w.taken, 1) && w.fiber && (ready || *status != CHAN_OK))
+            fiber_suspend();
+        woken_by = -1;
+        for (int64_t i = 0; i < n; i++) {
+            if (!live[i]) continue;
+            yona_channel_t* ch = chans[i];
+            yona_chan_side_t* s = op == YONA_CHAN_SEND ? &ch->senders : &ch->receivers;
+            pthread_mutex_lock(&ch->lock);
+            int woken = waitq_remove(&s->queue, &nodes[i]);
+            if (woken) woken_by = i;
+            if (!woken || !w.fiber) chan_uncount(s);
+            pthread_mutex_unlock(&ch->lock);
+        }
+        if (*status != CHAN_OK) break;
+    }
+
+    /* Woken by one channel but finished elsewhere: pass the wake on, or a
+     * task parked behind us on that channel could miss its event */
+    if (woken_by >= 0 && woken_by != result) {
+        yona_channel_t* ch = chans[woken_by];
+        chan_wake(ch, op == YONA_CHAN_SEND ? &ch->senders : &ch->receivers, 1);
+    }
+
+    if (nodes != local) {
+        free(nodes);
+        free(live);
+    }
+    return result;
+}
+
+/* chan_select over the channels in a Seq */
+static int64_t chan_select_seq(int64_t* seq, int op, int64_t* value, int64_t timeout_ms,
+                               int* status) {
+    int64_t n = yona_rt_seq_length(seq);
+    if (n == 0 || !is_rbt(seq))
+        return chan_select((yona_channel_t**)(seq + SEQ_HDR_SIZE + FLAT_OFF(seq)), n, op, value,
+                           timeout_ms, status);
+    int64_t* copy = (int64_t*)malloc((size_t)n * sizeof(int64_t));
+    yona_rt_seq_copy_out(seq, copy);
+    int64_t i = chan_select((yona_channel_t**)copy, n, op, value, timeout_ms, status);
+    free(copy);
+    return i;
+}
+
+/* Receive from whichever channel in the Seq has a value first. Returns its
+ * index and stores the value, or -1 on timeout (ms, < 0: wait forever) or
+ * once every channel is closed and drained. */
+int64_t yona_rt_channel_select_recv(int64_t* chans, int64_t timeout_ms, int64_t* value) {
+    int status;
+    int64_t i = chan_select_seq(chans, YONA_CHAN_RECV, value, timeout_ms, &status);
+    chan_raise(status, YONA_CHAN_RECV);
+    return i < 0 ? -1 : i;
+}
+
+/* Send value on whichever channel in the Seq has room first. Returns its
+ * index, or -1 on timeout; raises if every channel is closed. */
+int64_t yona_rt_channel_select_send(int64_t* chans, int64_t value, int64_t timeout_ms) {
+    int status;
+    int64_t i = chan_select_seq(chans, YONA_CHAN_SEND, &value, timeout_ms, &status);
+    if (i == -2) status = CHAN_CLOSED;
+    chan_raise(status, YONA_CHAN_SEND);
+    return i < 0 ? -1 : i;
+}
+
+/* Receive one value, waiting at most timeout_ms. Returns Some v, or None
+ * on timeout or once the channel is closed and drained. */
+int64_t yona_rt_channel_recv_timeout(yona_channel_t* ch, int64_t timeout_ms) {
+    int status;
+    int64_t value = 0;
+    int64_t i = chan_select(&ch, 1, YONA_CHAN_RECV, &value, timeout_ms, &status);
+    chan_raise(status, YONA_CHAN_RECV);
+    return (int64_t)(intptr_t)(i == 0 ? chan_make_some(value) : chan_make_none());
+}
+
 void yona_rt_channel_close(yona_channel_t* ch) {
-    pthread_mutex_lock(&ch->mutex);
-    ch->closed = 1;
-    pthread_cond_broadcast(&ch->not_full);
-    pthread_cond_broadcast(&ch->not_empty);
-    pthread_mutex_unlock(&ch->mutex);
+    atomic_store_explicit(&ch->closed, 1, memory_order_seq_cst);
+    chan_wake_all(ch, &ch->senders);
+    chan_wake_all(ch, &ch->receivers);
 }
 
 int64_t yona_rt_channel_is_closed(yona_channel_t* ch) {
-    pthread_mutex_lock(&ch->mutex);
-    int closed = ch->closed;
-    pthread_mutex_unlock(&ch->mutex);
-    return closed ? 1 : 0;
+    return atomic_load_explicit(&ch->closed, memory_order_acquire) ? 1 : 0;
 }
 
 int64_t yona_rt_channel_length(yona_channel_t* ch) {
-    pthread_mutex_lock(&ch->mutex);
-    int64_t n = ch->count;
-    pthread_mutex_unlock(&ch->mutex);
-    return n;
+    return chan_count(ch);
 }
 
 int64_t yona_rt_channel_capacity(yona_channel_t* ch) {
@@ -217,14 +657,10 @@ int64_t yona_rt_channel_capacity(yona_channel_t* ch) {
 void yona_rt_channel_destroy(void* ptr) {
     yona_channel_t* ch = (yona_channel_t*)ptr;
     /* Wake any straggler waiters before destroying */
-    pthread_mutex_lock(&ch->mutex);
-    pthread_cond_broadcast(&ch->not_full);
-    pthread_cond_broadcast(&ch->not_empty);
-    pthread_mutex_unlock(&ch->mutex);
-    pthread_mutex_destroy(&ch->mutex);
-    pthread_cond_destroy(&ch->not_full);
-    pthread_cond_destroy(&ch->not_empty);
-    free(ch->buf);
+    chan_wake_all(ch, &ch->senders);
+    chan_wake_all(ch, &ch->receivers);
+    pthread_mutex_destroy(&ch->lock);
+    free(ch->cells);
     /* The channel struct itself is freed by rc_dec via the standard pool free */
 }
 
@@ -276,6 +712,14 @@ int64_t yona_Std_Channel__raw_tryRecv(int64_t ch_i64) {
     return yona_Std_Channel__tryRecv(ch_i64);
 }
 
+int64_t yona_Std_Channel__recvTimeout(int64_t ch_i64, int64_t timeout_ms) {
+    return yona_rt_channel_recv_timeout((yona_channel_t*)(intptr_t)ch_i64, timeout_ms);
+}
+
+int64_t yona_Std_Channel__raw_recvTimeout(int64_t ch_i64, int64_t timeout_ms) {
+    return yona_Std_Channel__recvTimeout(ch_i64, timeout_ms);
+}
+
 int64_t yona_Std_Channel__close(int64_t ch_i64) {
     yona_rt_channel_close((yona_channel_t*)(intptr_t)ch_i64);
     return 0;
@@ -309,6 +753,54 @@ int64_t yona_Std_Channel__raw_capacity(int64_t ch_i64) {
     return yona_Std_Channel__capacity(ch_i64);
 }
 
+int64_t yona_Std_Channel__sendMany(int64_t ch_i64, int64_t* values) {
+    yona_rt_channel_send_many((yona_channel_t*)(intptr_t)ch_i64, values);
+    return 0;
+}
+
+int64_t yona_Std_Channel__raw_sendMany(int64_t ch_i64, int64_t* values) {
+    return yona_Std_Channel__sendMany(ch_i64, values);
+}
+
+int64_t* yona_Std_Channel__recvMany(int64_t ch_i64, int64_t max) {
+    return yona_rt_channel_recv_many((yona_channel_t*)(intptr_t)ch_i64, max);
+}
+
+int64_t* yona_Std_Channel__raw_recvMany(int64_t ch_i64, int64_t max) {
+    return yona_Std_Channel__recvMany(ch_i64, max);
+}
+
+/* (index, value) of the channel that delivered, or (-1, 0) on timeout or
+ * once every channel is closed and drained. */
+int64_t* yona_Std_Channel__raw_select(int64_t* chans, int64_t timeout_ms) {
+    int64_t value = 0;
+    int64_t i = yona_rt_channel_select_recv(chans, timeout_ms, &value);
+    int64_t* tuple = (int64_t*)yona_rt_tuple_alloc(2);
+    yona_rt_tuple_set(tuple, 0, i);
+    yona_rt_tuple_set(tuple, 1, i < 0 ? 0 : value);
+    return tuple;
+}
+
+/* Some (index, value), or None */
+int64_t yona_Std_Channel__select(int64_t* chans, int64_t timeout_ms) {
+    int64_t* tuple = yona_Std_Channel__raw_select(chans, timeout_ms);
+    if (tuple[2] < 0) {
+        yona_rt_rc_dec(tuple);
+        return (int64_t)(intptr_t)chan_make_none();
+    }
+    int64_t* some = chan_make_some((int64_t)(intptr_t)tuple);
+    some[2] = 1;  /* the field is a heap tuple */
+    return (int64_t)(intptr_t)some;
+}
+
+int64_t yona_Std_Channel__selectSend(int64_t* chans, int64_t value, int64_t timeout_ms) {
+    return yona_rt_channel_select_send(chans, value, timeout_ms);
+}
+
+int64_t yona_Std_Channel__raw_selectSend(int64_t* chans, int64_t value, int64_t timeout_ms) {
+    return yona_Std_Channel__selectSend(chans, value, timeout_ms);
+}
+
 /* ===== Std\Task — task spawning ===== */
 
 /* yona_rt_async_spawn_closure is defined in async_posix.c which is #included before
@@ -321,3 +813,22 @@ int64_t yona_Std_Channel__raw_capacity(int64_t ch_i64) {
 int64_t yona_Std_Task__spawn(int64_t* closure) {
     return (int64_t)(intptr_t)yona_rt_async_spawn_closure(closure, NULL);
 }
+
+/* spawnWith: spawn with a TaskPriority (Urgent | Normal | Batch) and a
+ * deadline in ms from now, 0 for none. Urgent tasks run ahead of all
+ * queued work, earliest deadline first; batch tasks only when nothing
+ * else is queued. */
+int64_t yona_Std_Task__spawnWith(int64_t prio_i64, int64_t deadline_ms, int64_t* closure) {
+    int64_t prio = prio_i64;
+    if (prio_i64 > 16) prio = ((int64_t*)(intptr_t)prio_i64)[0];  /* boxed ADT: tag first */
+    return (int64_t)(intptr_t)yona_rt_async_spawn_closure_prio(closure, prio, deadline_ms);
+}
+
+/* awaitTimeout: run the thunk as a task and wait at most ms for it.
+ * Some result, or None if it is still running (it is left to finish). */
+int64_t yona_Std_Task__awaitTimeout(int64_t ms, int64_t* closure) {
+    int64_t result = 0;
+    if (!yona_rt_async_await_timeout(yona_rt_async_spawn_closure(closure, NULL), ms, &result))
+        return (int64_t)(intptr_t)chan_make_none();
+    return (int64_t)(intptr_t)chan_make_some(result);
+}
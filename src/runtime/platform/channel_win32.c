@@ -42,9 +42,25 @@ typedef struct yona_channel {
 	int waiters;
 	int send_waiters;
 	int recv_waiters;
+	struct yona_chan_sel_node* selects[2]; /* selects waiting to send, to recv */
 	yona_task_group_t* group;
 } yona_channel_t;
 
+/* A select waiting on several channels: one node per channel, all sharing
+ * the select. Whoever takes it first wakes it; later events pass it by. */
+typedef struct {
+	volatile LONG taken;
+	CRITICAL_SECTION cs;
+	CONDITION_VARIABLE cv;
+} yona_chan_sel_t;
+
+typedef struct yona_chan_sel_node {
+	struct yona_chan_sel_node *next, *prev;
+	yona_chan_sel_t* sel;
+	int queued;
+	int woken;
+} yona_chan_sel_node_t;
+
 static int64_t* chan_make_some(int64_t value) {
 	int64_t* adt = (int64_t*)rc_alloc(4, 4 * sizeof(int64_t));
 	adt[0] = 0;
@@ -62,6 +78,37 @@ static int64_t* chan_make_none(void) {
 	return adt;
 }
 
+static void chan_sel_unlink(yona_channel_t* ch, int side, yona_chan_sel_node_t* n) {
+	if (n->prev) n->prev->next = n->next; else ch->selects[side] = n->next;
+	if (n->next) n->next->prev = n->prev;
+	n->queued = 0;
+}
+
+/* Wake up to n waiters for op (1 send, 2 recv): selects first, then
+ * threads on the condition variable. ch->mutex is held. */
+static void chan_notify(yona_channel_t* ch, int op, int64_t n) {
+	int side = op - 1;
+	while (n > 0 && ch->selects[side]) {
+		yona_chan_sel_node_t* node = ch->selects[side];
+		chan_sel_unlink(ch, side, node);
+		if (InterlockedExchange(&node->sel->taken, 1) == 0) {
+			node->woken = 1;
+			EnterCriticalSection(&node->sel->cs);
+			WakeConditionVariable(&node->sel->cv);
+			LeaveCriticalSection(&node->sel->cs);
+			n--;
+		}
+	}
+	CONDITION_VARIABLE* cond = op == 1 ? &ch->not_full : &ch->not_empty;
+	if (n > 1) WakeAllConditionVariable(cond);
+	else if (n == 1) WakeConditionVariable(cond);
+}
+
+static void chan_notify_all(yona_channel_t* ch) {
+	chan_notify(ch, 1, INT64_MAX);
+	chan_notify(ch, 2, INT64_MAX);
+}
+
 yona_channel_t* yona_rt_channel_new(int64_t cap) {
 	if (cap < 1) cap = 1;
 	yona_channel_t* ch = (yona_channel_t*)rc_alloc(RC_TYPE_CHANNEL, sizeof(yona_channel_t));
@@ -75,99 +122,309 @@ yona_channel_t* yona_rt_channel_new(int64_t cap) {
 	InitializeConditionVariable(&ch->not_empty);
 	ch->closed = 0;
 	ch->waiters = 0;
+	ch->selects[0] = NULL;
+	ch->selects[1] = NULL;
 	ch->group = NULL;
 	return ch;
 }
 
-void yona_rt_channel_send(yona_channel_t* ch, int64_t value) {
+/* One wait cycle for op (1 send, 2 recv). ch->mutex is held. Returns the
+ * message to raise once the mutex is released, or NULL to re-check. */
+static const char* chan_wait(yona_channel_t* ch, int op) {
+	if (ch->group && yona_rt_group_is_cancelled(ch->group))
+		return op == 1 ? "task cancelled while waiting on channel send"
+			       : "task cancelled while waiting on channel recv";
+	if (yona_rt_channel_wait_begin(ch, op, ch->count, ch->cap, ch->closed,
+				       op == 1 ? ch->recv_waiters : ch->send_waiters)) {
+		yona_rt_channel_wait_end();
+		return op == 1 ? "channel deadlock: send waiting on full channel; no runnable tasks remain"
+			       : "channel deadlock: recv waiting on empty open channel; no runnable tasks remain";
+	}
+	int* side = op == 1 ? &ch->send_waiters : &ch->recv_waiters;
+	sched_count(YONA_STAT_CHAN_WAITS, 1);
+	ch->waiters++;
+	(*side)++;
+	SleepConditionVariableCS(op == 1 ? &ch->not_full : &ch->not_empty, &ch->mutex, 100);
+	(*side)--;
+	ch->waiters--;
+	yona_rt_channel_wait_end();
+	return NULL;
+}
+
+/* Send n values in order, as many per lock hold as there is room for.
+ * Returns the message to raise, or NULL. */
+static const char* chan_send_values(yona_channel_t* ch, const int64_t* values, int64_t n) {
+	const char* error = NULL;
 	EnterCriticalSection(&ch->mutex);
-	while (ch->count == ch->cap && !ch->closed) {
-		if (ch->group && yona_rt_group_is_cancelled(ch->group)) {
-			LeaveCriticalSection(&ch->mutex);
-			yona_rt_raise(SYM_CANCELLED, "task cancelled while waiting on channel send");
-			return;
+	while (n > 0 && !error) {
+		if (ch->closed) {
+			error = "send on closed channel";
+			break;
 		}
-		if (yona_rt_channel_wait_begin(ch, 1, ch->count, ch->cap, ch->closed,
-					       ch->recv_waiters)) {
-			yona_rt_channel_wait_end();
-			LeaveCriticalSection(&ch->mutex);
-			yona_rt_raise(SYM_DEADLOCK,
-				      "channel deadlock: send waiting on full channel; no runnable tasks remain");
-			return;
+		if (ch->count == ch->cap) {
+			error = chan_wait(ch, 1);
+			continue;
 		}
-		ch->waiters++;
-		ch->send_waiters++;
-		SleepConditionVariableCS(&ch->not_full, &ch->mutex, 100);
-		ch->send_waiters--;
-		ch->waiters--;
-		yona_rt_channel_wait_end();
+		int64_t k = 0;
+		while (k < n && ch->count < ch->cap) {
+			ch->buf[ch->tail] = values[k++];
+			ch->tail = (ch->tail + 1) % ch->cap;
+			ch->count++;
+		}
+		chan_notify(ch, 2, k);
+		values += k;
+		n -= k;
 	}
-	if (ch->closed) {
-		LeaveCriticalSection(&ch->mutex);
-		yona_rt_raise(SYM_CHANNEL_CLOSED, "send on closed channel");
-		return;
+	LeaveCriticalSection(&ch->mutex);
+	return error;
+}
+
+/* Receive 1..want values into out; 0 once closed and drained, or at once
+ * when empty if !block. Sets *error instead of raising. */
+static int64_t chan_recv_values(yona_channel_t* ch, int64_t* out, int64_t want, int block,
+				const char** error) {
+	*error = NULL;
+	EnterCriticalSection(&ch->mutex);
+	while (ch->count == 0 && !ch->closed && block && !*error)
+		*error = chan_wait(ch, 2);
+	int64_t k = 0;
+	if (!*error) {
+		while (k < want && ch->count > 0) {
+			out[k++] = ch->buf[ch->head];
+			ch->head = (ch->head + 1) % ch->cap;
+			ch->count--;
+		}
+		chan_notify(ch, 1, k);
 	}
-	ch->buf[ch->tail] = value;
-	ch->tail = (ch->tail + 1) % ch->cap;
-	ch->count++;
-	WakeConditionVariable(&ch->not_empty);
 	LeaveCriticalSection(&ch->mutex);
+	return k;
+}
+
+void yona_rt_channel_send(yona_channel_t* ch, int64_t value) {
+	const char* error = chan_send_values(ch, &value, 1);
+	if (error) yona_rt_raise(SYM_CHANNEL_CLOSED, error);
 }
 
 int64_t yona_rt_channel_recv(yona_channel_t* ch) {
-	EnterCriticalSection(&ch->mutex);
-	while (ch->count == 0 && !ch->closed) {
-		if (ch->group && yona_rt_group_is_cancelled(ch->group)) {
+	int64_t value;
+	const char* error;
+	int64_t n = chan_recv_values(ch, &value, 1, 1, &error);
+	if (error) {
+		yona_rt_raise(SYM_DEADLOCK, error);
+		return 0;
+	}
+	if (n == 0) return (int64_t)(intptr_t)chan_make_none();
+	return (int64_t)(intptr_t)chan_make_some(value);
+}
+
+int64_t yona_rt_channel_try_recv(yona_channel_t* ch) {
+	int64_t value;
+	const char* error;
+	if (chan_recv_values(ch, &value, 1, 0, &error) == 0)
+		return (int64_t)(intptr_t)chan_make_none();
+	return (int64_t)(intptr_t)chan_make_some(value);
+}
+
+void yona_rt_channel_send_many(yona_channel_t* ch, int64_t* values) {
+	int64_t n = yona_rt_seq_length(values);
+	const char* error;
+	if (!is_rbt(values)) {
+		error = chan_send_values(ch, values + SEQ_HDR_SIZE + FLAT_OFF(values), n);
+	} else {
+		int64_t* copy = (int64_t*)malloc((size_t)n * sizeof(int64_t));
+		yona_rt_seq_copy_out(values, copy);
+		error = chan_send_values(ch, copy, n);
+		free(copy);
+	}
+	if (error) yona_rt_raise(SYM_CHANNEL_CLOSED, error);
+}
+
+int64_t* yona_rt_channel_recv_many(yona_channel_t* ch, int64_t max) {
+	if (max < 1) return yona_rt_seq_alloc(0);
+	if (max > ch->cap) max = ch->cap;
+	int64_t* seq = yona_rt_seq_alloc(max);
+	const char* error;
+	int64_t n = chan_recv_values(ch, seq + SEQ_HDR_SIZE, max, 1, &error);
+	if (error) {
+		yona_rt_rc_dec(seq);
+		yona_rt_raise(SYM_DEADLOCK, error);
+		return NULL;
+	}
+	seq[0] = n;
+	return seq;
+}
+
+/* ===== Select ===== */
+
+static LONG chan_select_turn;
+
+/* One pass over the channels; see channel_posix.c. live[i] says whether
+ * channel i is still worth waiting on. */
+static int64_t chan_select_try(yona_channel_t** chans, int64_t n, int op, int64_t* value,
+			       char* live) {
+	int open = 0;
+	uint32_t start = (uint32_t)InterlockedIncrement(&chan_select_turn);
+	for (int64_t j = 0; j < n; j++) {
+		int64_t i = (int64_t)((start + (uint64_t)j) % (uint64_t)n);
+		yona_channel_t* ch = chans[i];
+		EnterCriticalSection(&ch->mutex);
+		live[i] = 0;
+		if (op == 1 && !ch->closed && ch->count < ch->cap) {
+			ch->buf[ch->tail] = *value;
+			ch->tail = (ch->tail + 1) % ch->cap;
+			ch->count++;
+			chan_notify(ch, 2, 1);
 			LeaveCriticalSection(&ch->mutex);
-			yona_rt_raise(SYM_CANCELLED, "task cancelled while waiting on channel recv");
-			return 0;
+			return i;
 		}
-		if (yona_rt_channel_wait_begin(ch, 2, ch->count, ch->cap, ch->closed,
-					       ch->send_waiters)) {
-			yona_rt_channel_wait_end();
+		if (op == 2 && ch->count > 0) {
+			*value = ch->buf[ch->head];
+			ch->head = (ch->head + 1) % ch->cap;
+			ch->count--;
+			chan_notify(ch, 1, 1);
 			LeaveCriticalSection(&ch->mutex);
-			yona_rt_raise(SYM_DEADLOCK,
-				      "channel deadlock: recv waiting on empty open channel; no runnable tasks remain");
-			return 0;
+			return i;
 		}
-		ch->waiters++;
-		ch->recv_waiters++;
-		SleepConditionVariableCS(&ch->not_empty, &ch->mutex, 100);
-		ch->recv_waiters--;
-		ch->waiters--;
-		yona_rt_channel_wait_end();
-	}
-	if (ch->count == 0 && ch->closed) {
+		if (!ch->closed) live[i] = open = 1;
 		LeaveCriticalSection(&ch->mutex);
-		return (int64_t)(intptr_t)chan_make_none();
 	}
-	int64_t value = ch->buf[ch->head];
-	ch->head = (ch->head + 1) % ch->cap;
-	ch->count--;
-	WakeConditionVariable(&ch->not_full);
-	LeaveCriticalSection(&ch->mutex);
-	return (int64_t)(intptr_t)chan_make_some(value);
+	return open ? -1 : -2;
 }
 
-int64_t yona_rt_channel_try_recv(yona_channel_t* ch) {
-	EnterCriticalSection(&ch->mutex);
-	if (ch->count == 0) {
-		LeaveCriticalSection(&ch->mutex);
-		return (int64_t)(intptr_t)chan_make_none();
+static int64_t chan_select(yona_channel_t** chans, int64_t n, int op, int64_t* value,
+			   int64_t timeout_ms, const char** error) {
+	*error = NULL;
+	if (n == 0) return timeout_ms < 0 ? -2 : -1;
+	yona_chan_sel_node_t* nodes = (yona_chan_sel_node_t*)malloc((size_t)n * sizeof(yona_chan_sel_node_t));
+	char* live = (char*)malloc((size_t)n);
+	ULONGLONG deadline = timeout_ms > 0 ? GetTickCount64() + (ULONGLONG)timeout_ms : 0;
+	int side = op - 1;
+	int64_t result, woken_by = -1;
+
+	for (;;) {
+		result = chan_select_try(chans, n, op, value, live);
+		if (result != -1) break;
+		DWORD ms = 100;
+		if (timeout_ms >= 0) {
+			ULONGLONG now = GetTickCount64();
+			if (!deadline || now >= deadline) break;
+			if (deadline - now < ms) ms = (DWORD)(deadline - now);
+		}
+
+		yona_chan_sel_t sel;
+		sel.taken = 0;
+		InitializeCriticalSection(&sel.cs);
+		InitializeConditionVariable(&sel.cv);
+		int ready = 0, opposite = 0;
+		yona_channel_t* first = NULL;
+		for (int64_t i = 0; i < n; i++) {
+			if (!live[i]) continue;
+			yona_channel_t* ch = chans[i];
+			yona_chan_sel_node_t* node = &nodes[i];
+			EnterCriticalSection(&ch->mutex);
+			node->sel = &sel;
+			node->prev = NULL;
+			node->next = ch->selects[side];
+			if (node->next) node->next->prev = node;
+			ch->selects[side] = node;
+			node->queued = 1;
+			node->woken = 0;
+			if (op == 1 ? ch->closed || ch->count < ch->cap : ch->closed || ch->count > 0)
+				ready = 1;
+			opposite += op == 1 ? ch->recv_waiters : ch->send_waiters;
+			LeaveCriticalSection(&ch->mutex);
+			if (!first) first = ch;
+		}
+		if (!ready) {
+			for (int64_t i = 0; i < n && !*error; i++)
+				if (live[i] && chans[i]->group && yona_rt_group_is_cancelled(chans[i]->group))
+					*error = op == 1 ? "task cancelled while waiting on channel send"
+							 : "task cancelled while waiting on channel recv";
+		}
+		if (!ready && !*error) {
+			/* A timed wait ends by itself, so it stays counted as running */
+			int dead = 0;
+			if (timeout_ms < 0)
+				dead = yona_rt_channel_wait_begin(first, op, first->count, first->cap, 0, opposite);
+			if (dead) {
+				*error = op == 1
+					? "channel deadlock: send waiting on full channel; no runnable tasks remain"
+					: "channel deadlock: recv waiting on empty open channel; no runnable tasks remain";
+			} else {
+				sched_count(YONA_STAT_CHAN_WAITS, 1);
+				EnterCriticalSection(&sel.cs);
+				if (!sel.taken) SleepConditionVariableCS(&sel.cv, &sel.cs, ms);
+				LeaveCriticalSection(&sel.cs);
+			}
+			if (timeout_ms < 0) yona_rt_channel_wait_end();
+		}
+		InterlockedExchange(&sel.taken, 1);
+		/* Wakers hold the channel mutex, so none is still using sel after this */
+		woken_by = -1;
+		for (int64_t i = 0; i < n; i++) {
+			if (!live[i]) continue;
+			yona_channel_t* ch = chans[i];
+			EnterCriticalSection(&ch->mutex);
+			if (nodes[i].queued) chan_sel_unlink(ch, side, &nodes[i]);
+			if (nodes[i].woken) woken_by = i;
+			LeaveCriticalSection(&ch->mutex);
+		}
+		DeleteCriticalSection(&sel.cs);
+		if (*error) break;
 	}
-	int64_t value = ch->buf[ch->head];
-	ch->head = (ch->head + 1) % ch->cap;
-	ch->count--;
-	WakeConditionVariable(&ch->not_full);
-	LeaveCriticalSection(&ch->mutex);
-	return (int64_t)(intptr_t)chan_make_some(value);
+
+	/* Woken by one channel but finished elsewhere: pass the wake on */
+	if (woken_by >= 0 && woken_by != result) {
+		EnterCriticalSection(&chans[woken_by]->mutex);
+		chan_notify(chans[woken_by], op, 1);
+		LeaveCriticalSection(&chans[woken_by]->mutex);
+	}
+	free(live);
+	free(nodes);
+	return result;
+}
+
+/* chan_select over a Seq of channels, flat or not */
+static int64_t chan_select_seq(int64_t* seq, int op, int64_t* value, int64_t timeout_ms,
+			       const char** error) {
+	int64_t n = yona_rt_seq_length(seq);
+	if (!is_rbt(seq))
+		return chan_select((yona_channel_t**)(seq + SEQ_HDR_SIZE + FLAT_OFF(seq)), n, op, value,
+				   timeout_ms, error);
+	int64_t* copy = (int64_t*)malloc((size_t)(n > 0 ? n : 1) * sizeof(int64_t));
+	yona_rt_seq_copy_out(seq, copy);
+	int64_t i = chan_select((yona_channel_t**)copy, n, op, value, timeout_ms, error);
+	free(copy);
+	return i;
+}
+
+int64_t yona_rt_channel_select_recv(int64_t* chans, int64_t timeout_ms, int64_t* value) {
+	const char* error;
+	int64_t i = chan_select_seq(chans, 2, value, timeout_ms, &error);
+	if (error) yona_rt_raise(SYM_DEADLOCK, error);
+	return i < 0 ? -1 : i;
+}
+
+int64_t yona_rt_channel_select_send(int64_t* chans, int64_t value, int64_t timeout_ms) {
+	const char* error;
+	int64_t i = chan_select_seq(chans, 1, &value, timeout_ms, &error);
+	if (!error && i == -2) error = "send on closed channel";
+	if (error) yona_rt_raise(SYM_CHANNEL_CLOSED, error);
+	return i < 0 ? -1 : i;
+}
+
+int64_t yona_rt_channel_recv_timeout(yona_channel_t* ch, int64_t timeout_ms) {
+	const char* error;
+	int64_t value = 0;
+	int64_t i = chan_select(&ch, 1, 2, &value, timeout_ms, &error);
+	if (error) yona_rt_raise(SYM_DEADLOCK, error);
+	return (int64_t)(intptr_t)(i == 0 ? chan_make_some(value) : chan_make_none());
 }
 
 void yona_rt_channel_close(yona_channel_t* ch) {
 	EnterCriticalSection(&ch->mutex);
 	ch->closed = 1;
-	WakeAllConditionVariable(&ch->not_full);
-	WakeAllConditionVariable(&ch->not_empty);
+	chan_notify_all(ch);
 	LeaveCriticalSection(&ch->mutex);
 }
 
@@ -192,8 +449,7 @@ int64_t yona_rt_channel_capacity(yona_channel_t* ch) {
 void yona_rt_channel_destroy(void* ptr) {
 	yona_channel_t* ch = (yona_channel_t*)ptr;
 	EnterCriticalSection(&ch->mutex);
-	WakeAllConditionVariable(&ch->not_full);
-	WakeAllConditionVariable(&ch->not_empty);
+	chan_notify_all(ch);
 	LeaveCriticalSection(&ch->mutex);
 	DeleteCriticalSection(&ch->mutex);
 	free(ch->buf);
@@ -245,6 +501,60 @@ int64_t yona_Std_Channel__raw_tryRecv(int64_t ch_i64) {
 	return yona_Std_Channel__tryRecv(ch_i64);
 }
 
+int64_t yona_Std_Channel__recvTimeout(int64_t ch_i64, int64_t timeout_ms) {
+	return yona_rt_channel_recv_timeout((yona_channel_t*)(intptr_t)ch_i64, timeout_ms);
+}
+
+int64_t yona_Std_Channel__raw_recvTimeout(int64_t ch_i64, int64_t timeout_ms) {
+	return yona_Std_Channel__recvTimeout(ch_i64, timeout_ms);
+}
+
+int64_t yona_Std_Channel__sendMany(int64_t ch_i64, int64_t* values) {
+	yona_rt_channel_send_many((yona_channel_t*)(intptr_t)ch_i64, values);
+	return 0;
+}
+
+int64_t yona_Std_Channel__raw_sendMany(int64_t ch_i64, int64_t* values) {
+	return yona_Std_Channel__sendMany(ch_i64, values);
+}
+
+int64_t* yona_Std_Channel__recvMany(int64_t ch_i64, int64_t max) {
+	return yona_rt_channel_recv_many((yona_channel_t*)(intptr_t)ch_i64, max);
+}
+
+int64_t* yona_Std_Channel__raw_recvMany(int64_t ch_i64, int64_t max) {
+	return yona_Std_Channel__recvMany(ch_i64, max);
+}
+
+int64_t* yona_Std_Channel__raw_select(int64_t* chans, int64_t timeout_ms) {
+	int64_t value = 0;
+	int64_t i = yona_rt_channel_select_recv(chans, timeout_ms, &value);
+	int64_t* tuple = (int64_t*)yona_rt_tuple_alloc(2);
+	yona_rt_tuple_set(tuple, 0, i);
+	yona_rt_tuple_set(tuple, 1, i < 0 ? 0 : value);
+	return tuple;
+}
+
+/* Some (index, value), or None */
+int64_t yona_Std_Channel__select(int64_t* chans, int64_t timeout_ms) {
+	int64_t* tuple = yona_Std_Channel__raw_select(chans, timeout_ms);
+	if (tuple[2] < 0) {
+		yona_rt_rc_dec(tuple);
+		return (int64_t)(intptr_t)chan_make_none();
+	}
+	int64_t* some = chan_make_some((int64_t)(intptr_t)tuple);
+	some[2] = 1;  /* the field is a heap tuple */
+	return (int64_t)(intptr_t)some;
+}
+
+int64_t yona_Std_Channel__selectSend(int64_t* chans, int64_t value, int64_t timeout_ms) {
+	return yona_rt_channel_select_send(chans, value, timeout_ms);
+}
+
+int64_t yona_Std_Channel__raw_selectSend(int64_t* chans, int64_t value, int64_t timeout_ms) {
+	return yona_Std_Channel__selectSend(chans, value, timeout_ms);
+}
+
 int64_t yona_Std_Channel__close(int64_t ch_i64) {
 	yona_rt_channel_close((yona_channel_t*)(intptr_t)ch_i64);
 	return 0;
@@ -285,3 +595,23 @@ extern yona_promise_t* yona_rt_async_spawn_closure(int64_t* closure, yona_task_g
 int64_t yona_Std_Task__spawn(int64_t* closure) {
 	return (int64_t)(intptr_t)yona_rt_async_spawn_closure(closure, NULL);
 }
+
+extern yona_promise_t* yona_rt_async_spawn_closure_prio(int64_t* closure, int64_t prio,
+						       int64_t deadline_ms);
+
+/* spawnWith: see channel_posix.c */
+int64_t yona_Std_Task__spawnWith(int64_t prio_i64, int64_t deadline_ms, int64_t* closure) {
+	int64_t prio = prio_i64;
+	if (prio_i64 > 16) prio = ((int64_t*)(intptr_t)prio_i64)[0];
+	return (int64_t)(intptr_t)yona_rt_async_spawn_closure_prio(closure, prio, deadline_ms);
+}
+
+extern int yona_rt_async_await_timeout(yona_promise_t* promise, int64_t ms, int64_t* result);
+
+/* awaitTimeout: see channel_posix.c */
+int64_t yona_Std_Task__awaitTimeout(int64_t ms, int64_t* closure) {
+	int64_t result = 0;
+	if (!yona_rt_async_await_timeout(yona_rt_async_spawn_closure(closure, NULL), ms, &result))
+		return (int64_t)(intptr_t)chan_make_none();
+	return (int64_t)(intptr_t)chan_make_some(result);
+}
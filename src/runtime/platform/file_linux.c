@@ -11,16 +11,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <stdatomic.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <dirent.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 
 extern void* yona_rt_rc_alloc_string(size_t bytes);
 extern void yona_rt_rc_inc(void* ptr);
 extern void yona_rt_rc_dec(void* ptr);
 extern int64_t* yona_rt_seq_alloc(int64_t count);
+extern void* yona_rt_rc_alloc_string_len(size_t bytes, size_t str_len);
+extern void* rc_alloc(int64_t type_tag, size_t payload_bytes);
 
 /* ===== Generic io_uring completer ===== */
 
@@ -47,6 +51,51 @@ int64_t yona_io_register_direct_result(void* result) {
     return io_register_direct_result(result);
 }
 
+void yona_platform_io_flush(void) {
+    ring_flush();
+}
+
+/* Release a write's source: a ring staging buffer, or an RC value pinned
+ * at submit. */
+static void io_unpin(char* buf) {
+    if (buf && !ring_buf_put(buf)) yona_rt_rc_dec(buf);
+}
+
+/* A recv submitted with a provided buffer (ctx->buf NULL) gets a value
+ * sized to what arrived, and the ring gets its buffer back. If the pool
+ * was empty, receive again into a private buffer. Leaves ctx->buf set up
+ * as a plain recv would, for the completer below. */
+static int32_t io_recv_collect(io_context_t* ctx, uint64_t id, int32_t res, uint32_t cqe_flags) {
+    int bytes = ctx->type == IO_OP_RECV_BYTES;
+    size_t len = res == -ENOBUFS ? ctx->buf_size : (res > 0 ? (size_t)res : 0);
+    char* data;
+    if (bytes) {
+        int64_t* b = (int64_t*)rc_alloc(8 /* RC_TYPE_BYTE_ARRAY */, sizeof(int64_t) + len);
+        b[0] = 0;
+        ctx->buf = (char*)b;
+        data = (char*)(b + 1);
+    } else {
+        ctx->buf = (char*)yona_rt_rc_alloc_string_len(len + 1, len);
+        data = ctx->buf;
+    }
+    if (res == -ENOBUFS) {
+        struct io_uring_sqe sqe;
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_RECV;
+        sqe.fd = ctx->fd;
+        sqe.addr = (unsigned long)data;
+        sqe.len = (unsigned)len;
+        uint64_t again = ring_submit_sqe(&sqe);
+        return again ? ring_await(again) : res;
+    }
+    const char* src = ring_pbuf_data(id, cqe_flags);
+    if (src) {
+        if (len) memcpy(data, src, len);
+        ring_pbuf_recycle(id, cqe_flags);
+    }
+    return res;
+}
+
 int64_t yona_rt_io_await(int64_t uring_id) {
     if (uring_id <= 0) return 0;
     io_context_t* ctx = io_ctx_take((uint64_t)uring_id);
@@ -56,23 +105,31 @@ int64_t yona_rt_io_await(int64_t uring_id) {
         free(ctx);
         return result;
     }
-    if (ctx) io_ctx_put((uint64_t)uring_id, ctx); /* put it back for real await */
 
-    int32_t res = ring_await((uint64_t)uring_id);
+    uint32_t cqe_flags = 0;
+    int32_t res = ring_await_flags((uint64_t)uring_id, &cqe_flags);
 
     /* Handle cancellation: clean up context and raise */
     if (res == -125 /* ECANCELED */) {
-        ctx = io_ctx_take((uint64_t)uring_id);
         if (ctx) {
-            if (ctx->buf) free(ctx->buf);
+            /* Socket addresses and joined strings are malloc'd (or, for
+             * the latter, staging buffers); every other buffer is an RC
+             * value the completion would hand out. */
+            if (ctx->type == IO_OP_ACCEPT || ctx->type == IO_OP_CONNECT)
+                free(ctx->buf);
+            else if (ctx->type == IO_OP_WRITE_FD_STR) {
+                if (!ring_buf_put(ctx->buf)) free(ctx->buf);
+            } else
+                io_unpin(ctx->buf);
             if (ctx->close_fd && ctx->fd >= 0) close(ctx->fd);
             free(ctx);
         }
         return 0; /* Cancelled — caller checks group error */
     }
 
-    ctx = io_ctx_take((uint64_t)uring_id);
     if (!ctx) return (int64_t)res;
+    if (!ctx->buf && (ctx->type == IO_OP_RECV || ctx->type == IO_OP_RECV_BYTES))
+        res = io_recv_collect(ctx, (uint64_t)uring_id, res, cqe_flags);
 
     int64_t result;
     switch (ctx->type) {
@@ -84,22 +141,22 @@ int64_t yona_rt_io_await(int64_t uring_id) {
             break;
         case IO_OP_WRITE_FILE:
             if (ctx->close_fd) close(ctx->fd);
-            /* Unpin the content buffer (was rc_inc'd at submit) */
-            if (ctx->buf) yona_rt_rc_dec(ctx->buf);
+            io_unpin(ctx->buf);
             result = (res == (int32_t)ctx->buf_size) ? 1 : 0;
             break;
         case IO_OP_ACCEPT:
             free(ctx->buf);
             result = (res >= 0) ? (int64_t)res : -1;
+            if (res >= 0) ring_file_track(res);
             break;
         case IO_OP_CONNECT:
             free(ctx->buf);
             result = (res >= 0) ? (int64_t)ctx->fd : -1;
             if (res < 0) close(ctx->fd);
+            else ring_file_track(ctx->fd);
             break;
         case IO_OP_SEND:
-            /* Unpin the send buffer (was rc_inc'd at submit) */
-            if (ctx->buf) yona_rt_rc_dec(ctx->buf);
+            io_unpin(ctx->buf);
             result = (int64_t)res;
             break;
         case IO_OP_RECV:
@@ -129,16 +186,15 @@ int64_t yona_rt_io_await(int64_t uring_id) {
             break;
         }
         case IO_OP_WRITE_FD_BYTES: {
-            /* Unpin the write buffer */
-            if (ctx->buf) yona_rt_rc_dec(ctx->buf);
+            io_unpin(ctx->buf);
             /* Don't close fd — caller owns the handle */
             result = (res >= 0) ? (int64_t)res : -1;
             break;
         }
         case IO_OP_WRITE_FD_STR: {
-            /* Caller allocated the concatenated string via malloc. Free
-             * it now that the kernel has consumed it. */
-            if (ctx->buf) free(ctx->buf);
+            /* The joined string is a staging buffer or malloc'd. Free it
+             * now that the kernel has consumed it. */
+            if (ctx->buf && !ring_buf_put(ctx->buf)) free(ctx->buf);
             result = (res >= 0) ? (int64_t)res : -1;
             break;
         }
@@ -216,28 +272,33 @@ int64_t yona_platform_write_file_submit(const char* path, const char* content) {
     if (fd < 0) return 0;
     size_t len = strlen(content);
 
-    /* Copy content to RC-managed buffer so it survives until I/O completes.
-     * Cannot rc_inc the original — it may be a string constant without RC header. */
-    char* pinned = (char*)yona_rt_rc_alloc_string(len + 1);
-    memcpy(pinned, content, len + 1);
+    /* Copy content to a registered staging buffer, or failing that an
+     * RC-managed one, so it survives until I/O completes. Cannot rc_inc
+     * the original — it may be a string constant without RC header. */
+    unsigned buf_index;
+    char* pinned = (char*)ring_buf_get(len, &buf_index);
+    int staged = pinned != NULL;
+    if (!staged) pinned = (char*)yona_rt_rc_alloc_string(len + 1);
+    memcpy(pinned, content, len);
 
     io_context_t* ctx = (io_context_t*)malloc(sizeof(io_context_t));
     ctx->type = IO_OP_WRITE_FILE;
     ctx->fd = fd;
-    ctx->buf = pinned; /* rc_dec'd in completer */
+    ctx->buf = pinned; /* released in completer */
     ctx->buf_size = len;
     ctx->close_fd = 1;
 
     struct io_uring_sqe sqe;
     memset(&sqe, 0, sizeof(sqe));
-    sqe.opcode = IORING_OP_WRITE;
+    sqe.opcode = staged ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
     sqe.fd = fd;
-    sqe.addr = (unsigned long)pinned; /* use RC-managed copy */
+    sqe.addr = (unsigned long)pinned;
     sqe.len = (unsigned)len;
     sqe.off = 0;
+    if (staged) sqe.buf_index = (uint16_t)buf_index;
 
     uint64_t id = ring_submit_sqe(&sqe);
-    if (id == 0) { close(fd); yona_rt_rc_dec(pinned); free(ctx); return 0; }
+    if (id == 0) { close(fd); io_unpin(pinned); free(ctx); return 0; }
     io_ctx_put(id, ctx);
     return (int64_t)id;
 }
@@ -380,15 +441,44 @@ int64_t yona_platform_file_size(const char* path) {
     struct stat st; if (stat(path, &st) != 0) return -1; return (int64_t)st.st_size;
 }
 
+/* Map a file read-only as an immortal ByteArray: the RC header and length
+ * sit at the end of a private page just in front of the file mapping, so
+ * the bytes are never copied. The mapping lives for the rest of the process. */
+void* yona_platform_map_file_bytes(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return NULL; }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE), size = (size_t)st.st_size;
+    char* base = (char*)mmap(NULL, page + size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) { close(fd); return NULL; }
+    if (size > 0 && mmap(base + page, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, page + size);
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    int64_t* hdr = (int64_t*)(base + page) - 3;
+    hdr[0] = INT64_MAX;             /* RC_ARENA_SENTINEL */
+    hdr[1] = 8;                     /* RC_TYPE_BYTE_ARRAY */
+    hdr[2] = (int64_t)size;
+    mprotect(base, page, PROT_READ);
+    return hdr + 2;
+}
+
 int64_t yona_platform_open_file_handle(const char* path, int64_t mode_tag) {
     int flags = O_RDONLY;
     if (mode_tag == 1) flags = O_WRONLY | O_CREAT | O_TRUNC;       /* Write */
     else if (mode_tag == 2) flags = O_RDWR | O_CREAT;              /* ReadWrite */
     else if (mode_tag == 3) flags = O_WRONLY | O_CREAT | O_APPEND; /* Append */
-    return (int64_t)open(path, flags, 0644);
+    int fd = open(path, flags, 0644);
+    ring_file_track(fd);
+    return (int64_t)fd;
 }
 
 int64_t yona_platform_close_file_handle(int fd) {
+    ring_file_forget(fd);
     return (int64_t)close(fd);
 }
 
@@ -496,13 +586,17 @@ static int64_t line_iter_next(int64_t* closure_env) {
             st->buf_pos = 0;
         }
 
-        /* Scan for newline in current buffer */
-        while (st->buf_pos < st->buf_len) {
-            char c = st->buf[st->buf_pos++];
-            if (c == '\n') goto line_complete;
-            if (line_len < sizeof(line_buf) - 1)
-                line_buf[line_len++] = c;
-        }
+        /* Scan for newline in current buffer (memchr is vectorized by libc) */
+        const char* start = st->buf + st->buf_pos;
+        size_t avail = st->buf_len - st->buf_pos;
+        const char* nl = (const char*)memchr(start, '\n', avail);
+        size_t chunk = nl ? (size_t)(nl - start) : avail;
+        size_t room = sizeof(line_buf) - 1 - line_len;
+        size_t take = chunk < room ? chunk : room;
+        memcpy(line_buf + line_len, start, take);
+        line_len += take;
+        st->buf_pos += chunk;
+        if (nl) { st->buf_pos++; goto line_complete; }
     }
 
 line_complete:
@@ -662,10 +756,12 @@ static int64_t write_fd_strs_submit_impl(int fd, const char* s1, const char* s2)
     size_t l1 = s1 ? strlen(s1) : 0;
     size_t l2 = s2 ? strlen(s2) : 0;
     size_t total = l1 + l2;
-    char* buf = (char*)malloc(total + 1);
+    unsigned buf_index;
+    char* buf = (char*)ring_buf_get(total, &buf_index);
+    int staged = buf != NULL;
+    if (!staged) buf = (char*)malloc(total + 1);
     if (l1) memcpy(buf, s1, l1);
     if (l2) memcpy(buf + l1, s2, l2);
-    buf[total] = '\0';
 
     io_context_t* ctx = (io_context_t*)malloc(sizeof(io_context_t));
     ctx->type = IO_OP_WRITE_FD_STR;
@@ -676,17 +772,18 @@ static int64_t write_fd_strs_submit_impl(int fd, const char* s1, const char* s2)
 
     struct io_uring_sqe sqe;
     memset(&sqe, 0, sizeof(sqe));
-    sqe.opcode = IORING_OP_WRITE;
+    sqe.opcode = staged ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
     sqe.fd = fd;
     sqe.addr = (unsigned long)buf;
     sqe.len = (unsigned)total;
     sqe.off = (uint64_t)-1;  /* -1 = use fd's current position (no pwrite) */
+    if (staged) sqe.buf_index = (uint16_t)buf_index;
 
     uint64_t id = ring_submit_sqe(&sqe);
     if (id == 0) {
         /* Fallback: blocking write */
         ssize_t n = write(fd, buf, total);
-        free(buf);
+        if (!ring_buf_put(buf)) free(buf);
         free(ctx);
         return io_register_direct_result((void*)(intptr_t)(n >= 0 ? n : -1));
     }
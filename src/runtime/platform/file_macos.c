@@ -22,6 +22,7 @@
 #include <sys/stat.h>
 #include <dirent.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 
 extern void* yona_rt_rc_alloc_string(size_t bytes);
 extern void yona_rt_rc_inc(void* ptr);
@@ -53,6 +54,9 @@ int64_t yona_io_register_direct_result(void* result) {
     return io_register_direct_result(result);
 }
 
+/* kqueue submissions are not batched */
+void yona_platform_io_flush(void) {}
+
 int64_t yona_rt_io_await(int64_t uring_id) {
     if (uring_id <= 0) return 0;
     io_context_t* ctx = io_ctx_take((uint64_t)uring_id);
@@ -343,6 +347,32 @@ int64_t yona_platform_file_size(const char* path) {
     struct stat st; if (stat(path, &st) != 0) return -1; return (int64_t)st.st_size;
 }
 
+/* Map a file read-only as an immortal ByteArray: the RC header and length
+ * sit at the end of a private page just in front of the file mapping, so
+ * the bytes are never copied. The mapping lives for the rest of the process. */
+void* yona_platform_map_file_bytes(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return NULL; }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE), size = (size_t)st.st_size;
+    char* base = (char*)mmap(NULL, page + size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) { close(fd); return NULL; }
+    if (size > 0 && mmap(base + page, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, page + size);
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    int64_t* hdr = (int64_t*)(base + page) - 3;
+    hdr[0] = INT64_MAX;             /* RC_ARENA_SENTINEL */
+    hdr[1] = 8;                     /* RC_TYPE_BYTE_ARRAY */
+    hdr[2] = (int64_t)size;
+    mprotect(base, page, PROT_READ);
+    return hdr + 2;
+}
+
 int64_t yona_platform_open_file_handle(const char* path, int64_t mode_tag) {
     int flags = O_RDONLY;
     if (mode_tag == 1) flags = O_WRONLY | O_CREAT | O_TRUNC;       /* Write */
@@ -459,13 +489,17 @@ static int64_t line_iter_next(int64_t* closure_env) {
             st->buf_pos = 0;
         }
 
-        /* Scan for newline in current buffer */
-        while (st->buf_pos < st->buf_len) {
-            char c = st->buf[st->buf_pos++];
-            if (c == '\n') goto line_complete;
-            if (line_len < sizeof(line_buf) - 1)
-                line_buf[line_len++] = c;
-        }
+        /* Scan for newline in current buffer (memchr is vectorized by libc) */
+        const char* start = st->buf + st->buf_pos;
+        size_t avail = st->buf_len - st->buf_pos;
+        const char* nl = (const char*)memchr(start, '\n', avail);
+        size_t chunk = nl ? (size_t)(nl - start) : avail;
+        size_t room = sizeof(line_buf) - 1 - line_len;
+        size_t take = chunk < room ? chunk : room;
+        memcpy(line_buf + line_len, start, take);
+        line_len += take;
+        st->buf_pos += chunk;
+        if (nl) { st->buf_pos++; goto line_complete; }
     }
 
 line_complete:
@@ -135,6 +135,9 @@ int64_t yona_io_register_direct_result(void* result) {
 	return io_register_direct_result(result);
 }
 
+/* Overlapped operations are issued immediately */
+void yona_platform_io_flush(void) {}
+
 typedef struct yona_win_read_op {
 	OVERLAPPED ov;
 	HANDLE hFile;
@@ -613,6 +616,24 @@ int64_t yona_platform_file_size(const char* path) {
 	return (int64_t)st.st_size;
 }
 
+/* No file mapping here: read the file into an immortal ByteArray that is
+ * never freed, so decoding it still returns pointers into the buffer. */
+void* yona_platform_map_file_bytes(const char* path) {
+	FILE* f = fopen(path, "rb");
+	if (!f) return NULL;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (size < 0) { fclose(f); return NULL; }
+	int64_t* hdr = (int64_t*)malloc(3 * sizeof(int64_t) + (size_t)size + 1);
+	if (!hdr) { fclose(f); return NULL; }
+	hdr[0] = INT64_MAX;             /* RC_ARENA_SENTINEL */
+	hdr[1] = 8;                     /* RC_TYPE_BYTE_ARRAY */
+	hdr[2] = (int64_t)fread(hdr + 3, 1, (size_t)size, f);
+	fclose(f);
+	return hdr + 2;
+}
+
 int64_t yona_platform_open_file_handle(const char* path, int64_t mode_tag) {
 	int flags = O_RDONLY;
 	if (mode_tag == 1) flags = O_WRONLY | O_CREAT | O_TRUNC;       /* Write */
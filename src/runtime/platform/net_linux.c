@@ -25,6 +25,7 @@ extern void yona_rt_rc_dec(void* ptr);
 #include <fcntl.h>
 
 extern void* yona_rt_rc_alloc_string(size_t bytes);
+extern void* rc_alloc(int64_t type_tag, size_t payload_bytes);
 
 /* ===== TCP ===== */
 
@@ -76,6 +77,7 @@ int64_t yona_Std_Net__tcpListen(const char* host, int64_t port) {
     setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
     if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) { close(fd); return -1; }
     if (listen(fd, 128) < 0) { close(fd); return -1; }
+    ring_file_track(fd);
     return (int64_t)fd;
 }
 
@@ -108,34 +110,59 @@ int64_t yona_Std_Net__tcpAccept(int64_t listener_fd) {
 int64_t yona_Std_Net__send(int64_t fd, const char* data) {
     size_t len = strlen(data);
 
-    /* Copy to RC-managed buffer so it survives until I/O completes */
-    extern void* yona_rt_rc_alloc_string(size_t bytes);
-    char* pinned = (char*)yona_rt_rc_alloc_string(len + 1);
-    memcpy(pinned, data, len + 1);
+    /* Copy to a registered staging buffer (sent with WRITE_FIXED, which on
+     * a socket is a send without flags) or else an RC-managed one, so it
+     * survives until I/O completes */
+    unsigned buf_index;
+    char* pinned = (char*)ring_buf_get(len, &buf_index);
+    int staged = pinned != NULL;
+    if (!staged) pinned = (char*)yona_rt_rc_alloc_string(len + 1);
+    memcpy(pinned, data, len);
 
     io_context_t* ctx = (io_context_t*)malloc(sizeof(io_context_t));
     ctx->type = IO_OP_SEND;
     ctx->fd = (int)fd;
-    ctx->buf = pinned; /* rc_dec'd in completer */
+    ctx->buf = pinned; /* released in completer */
     ctx->buf_size = len;
     ctx->close_fd = 0;
 
     struct io_uring_sqe sqe;
     memset(&sqe, 0, sizeof(sqe));
-    sqe.opcode = IORING_OP_SEND;
+    sqe.opcode = staged ? IORING_OP_WRITE_FIXED : IORING_OP_SEND;
     sqe.fd = (int)fd;
     sqe.addr = (unsigned long)pinned;
     sqe.len = (unsigned)len;
+    if (staged) {
+        sqe.off = (uint64_t)-1;
+        sqe.buf_index = (uint16_t)buf_index;
+    }
 
     uint64_t id = ring_submit_sqe(&sqe);
-    if (id == 0) { yona_rt_rc_dec(pinned); free(ctx); return 0; }
+    if (id == 0) {
+        if (!ring_buf_put(pinned)) yona_rt_rc_dec(pinned);
+        free(ctx);
+        return 0;
+    }
     io_ctx_put(id, ctx);
     return (int64_t)id;
 }
 
+/* recv and recvBytes take a buffer from the ring's provided-buffer pool
+ * when max_bytes fits one, leaving ctx->buf NULL: the completer allocates
+ * the result at the size actually received. */
 int64_t yona_Std_Net__recv(int64_t fd, int64_t max_bytes) {
     if (max_bytes <= 0) max_bytes = 4096;
-    char* buf = (char*)yona_rt_rc_alloc_string((size_t)max_bytes + 1);
+
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_RECV;
+    sqe.fd = (int)fd;
+    sqe.len = (unsigned)max_bytes;
+    char* buf = NULL;
+    if (!ring_sqe_select_buffer(&sqe, (size_t)max_bytes)) {
+        buf = (char*)yona_rt_rc_alloc_string((size_t)max_bytes + 1);
+        sqe.addr = (unsigned long)buf;
+    }
 
     io_context_t* ctx = (io_context_t*)malloc(sizeof(io_context_t));
     ctx->type = IO_OP_RECV;
@@ -144,15 +171,8 @@ int64_t yona_Std_Net__recv(int64_t fd, int64_t max_bytes) {
     ctx->buf_size = (size_t)max_bytes;
     ctx->close_fd = 0;
 
-    struct io_uring_sqe sqe;
-    memset(&sqe, 0, sizeof(sqe));
-    sqe.opcode = IORING_OP_RECV;
-    sqe.fd = (int)fd;
-    sqe.addr = (unsigned long)buf;
-    sqe.len = (unsigned)max_bytes;
-
     uint64_t id = ring_submit_sqe(&sqe);
-    if (id == 0) { free(ctx); buf[0] = '\0'; return 0; }
+    if (id == 0) { free(ctx); if (buf) yona_rt_rc_dec(buf); return 0; }
     io_ctx_put(id, ctx);
     return (int64_t)id;
 }
@@ -188,10 +208,20 @@ int64_t yona_Std_Net__sendBytes(int64_t fd, void* bytes) {
 /* recvBytes: receive into Bytes buffer via io_uring */
 int64_t yona_Std_Net__recvBytes(int64_t fd, int64_t max_bytes) {
     if (max_bytes <= 0) max_bytes = 4096;
-    /* Allocate Bytes buffer: [length][data...] with RC header */
-    extern void* rc_alloc(int64_t type_tag, size_t payload_bytes);
-    int64_t* buf = (int64_t*)rc_alloc(8 /* RC_TYPE_BYTE_ARRAY */, sizeof(int64_t) + (size_t)max_bytes);
-    buf[0] = 0; /* length set by completer */
+
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_RECV;
+    sqe.fd = (int)fd;
+    sqe.len = (unsigned)max_bytes;
+    int64_t* buf = NULL;
+    if (!ring_sqe_select_buffer(&sqe, (size_t)max_bytes)) {
+        /* Allocate Bytes buffer: [length][data...] with RC header */
+        extern void* rc_alloc(int64_t type_tag, size_t payload_bytes);
+        buf = (int64_t*)rc_alloc(8 /* RC_TYPE_BYTE_ARRAY */, sizeof(int64_t) + (size_t)max_bytes);
+        buf[0] = 0; /* length set by completer */
+        sqe.addr = (unsigned long)(uint8_t*)(buf + 1); /* data starts after length */
+    }
 
     io_context_t* ctx = (io_context_t*)malloc(sizeof(io_context_t));
     ctx->type = IO_OP_RECV_BYTES;
@@ -200,20 +230,168 @@ int64_t yona_Std_Net__recvBytes(int64_t fd, int64_t max_bytes) {
     ctx->buf_size = (size_t)max_bytes;
     ctx->close_fd = 0;
 
-    struct io_uring_sqe sqe;
-    memset(&sqe, 0, sizeof(sqe));
-    sqe.opcode = IORING_OP_RECV;
-    sqe.fd = (int)fd;
-    sqe.addr = (unsigned long)(uint8_t*)(buf + 1); /* data starts after length */
-    sqe.len = (unsigned)max_bytes;
-
     uint64_t id = ring_submit_sqe(&sqe);
-    if (id == 0) { free(ctx); return 0; }
+    if (id == 0) { free(ctx); if (buf) yona_rt_rc_dec(buf); return 0; }
     io_ctx_put(id, ctx);
     return (int64_t)id;
 }
 
-int64_t yona_Std_Net__close(int64_t fd) { close((int)fd); return 0; }
+int64_t yona_Std_Net__close(int64_t fd) {
+    ring_file_forget((int)fd);
+    close((int)fd);
+    return 0;
+}
+
+/* ===== Streams: multishot accept and recv ===== */
+
+/* acceptStream / recvStream return an Iterator driven by one multishot
+ * SQE, so a server loop costs no submission per connection or read. The
+ * kernel ends a multishot early when, say, the provided-buffer pool runs
+ * dry; the iterator then re-arms it. Where multishot is unavailable it
+ * falls back to one tcpAccept / recvBytes per element. */
+
+typedef struct {
+    int fd;
+    int recv;                 /* recv stream, else accept */
+    ring_stream_t* stream;    /* armed multishot, or NULL */
+    int oneshot;              /* no multishot here: one op per element */
+    int produced;             /* an element has been yielded */
+    int done;
+} net_stream_state_t;
+
+static int64_t net_stream_none(void) {
+    int64_t* none = (int64_t*)rc_alloc(4 /* RC_TYPE_ADT */, 3 * sizeof(int64_t));
+    none[0] = 1; none[1] = 0; none[2] = 0;
+    return (int64_t)(intptr_t)none;
+}
+
+static int64_t net_stream_some(int64_t value, int heap) {
+    int64_t* some = (int64_t*)rc_alloc(4 /* RC_TYPE_ADT */, 4 * sizeof(int64_t));
+    some[0] = 0; some[1] = 1; some[2] = heap; /* tag=Some, 1 field */
+    some[3] = value;
+    return (int64_t)(intptr_t)some;
+}
+
+static ring_stream_t* net_stream_arm(net_stream_state_t* ns) {
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.fd = ns->fd;
+    if (ns->recv) {
+        sqe.opcode = IORING_OP_RECV;
+        sqe.ioprio = IORING_RECV_MULTISHOT;
+        if (!ring_sqe_select_buffer(&sqe, 0)) return NULL;
+    } else {
+        sqe.opcode = IORING_OP_ACCEPT;
+        sqe.ioprio = IORING_ACCEPT_MULTISHOT;
+    }
+    return ring_stream_open(&sqe);
+}
+
+/* One element without multishot. Returns 0 at the end of the stream. */
+static int net_stream_oneshot(net_stream_state_t* ns, int64_t* out) {
+    if (ns->recv) {
+        int64_t id = yona_Std_Net__recvBytes(ns->fd, 4096);
+        int64_t* b = id ? (int64_t*)(intptr_t)yona_rt_io_await(id) : NULL;
+        if (b && b[0] > 0) { *out = (int64_t)(intptr_t)b; return 1; }
+        if (b) yona_rt_rc_dec(b);
+        return 0;
+    }
+    int64_t id = yona_Std_Net__tcpAccept(ns->fd);
+    *out = id ? yona_rt_io_await(id) : -1;
+    return *out >= 0;
+}
+
+static int64_t net_stream_next(int64_t* env) {
+    net_stream_state_t* ns = (net_stream_state_t*)(intptr_t)env[5];
+    int64_t value;
+    while (!ns->done) {
+        if (!ns->stream && !ns->oneshot && !(ns->stream = net_stream_arm(ns)))
+            ns->oneshot = 1;
+        if (ns->oneshot) {
+            if (net_stream_oneshot(ns, &value)) return net_stream_some(value, ns->recv);
+            ns->done = 1;
+            break;
+        }
+        int32_t res;
+        uint32_t cqe_flags;
+        int got = ring_stream_next(ns->stream, &res, &cqe_flags);
+        if (got < 0) {
+            /* The socket was closed under us */
+            ns->done = 1;
+            break;
+        }
+        if (!got) {
+            /* Ended by the kernel after a result, not an error: re-arm */
+            ring_stream_close(ns->stream);
+            ns->stream = NULL;
+            continue;
+        }
+        if (ns->recv && res > 0) {
+            uint64_t id = ring_stream_id(ns->stream);
+            int64_t* b = (int64_t*)rc_alloc(8 /* RC_TYPE_BYTE_ARRAY */, sizeof(int64_t) + (size_t)res);
+            b[0] = res;
+            memcpy(b + 1, ring_pbuf_data(id, cqe_flags), (size_t)res);
+            ring_pbuf_recycle(id, cqe_flags);
+            ns->produced = 1;
+            return net_stream_some((int64_t)(intptr_t)b, 1);
+        }
+        if (!ns->recv && res >= 0) {
+            ring_file_track(res);
+            ns->produced = 1;
+            return net_stream_some(res, 0);
+        }
+        if (res == -ENOBUFS) {
+            /* Provided buffers ran out, which ends the multishot: take
+             * this element the slow way, re-arm for the next */
+            if (net_stream_oneshot(ns, &value)) return net_stream_some(value, 1);
+            ns->done = 1;
+        } else if (res == -EINVAL && !ns->produced) {
+            ring_stream_close(ns->stream);
+            ns->stream = NULL;
+            ns->oneshot = 1;
+        } else if (!ns->recv && (res == -ECONNABORTED || res == -EINTR)) {
+            continue;
+        } else {
+            /* EOF, an error, or the socket was closed */
+            ns->done = 1;
+        }
+    }
+    if (ns->stream) {
+        ring_stream_close(ns->stream);
+        ns->stream = NULL;
+    }
+    return net_stream_none();
+}
+
+static int64_t net_stream_iterator(int64_t fd, int recv) {
+    net_stream_state_t* st = (net_stream_state_t*)calloc(1, sizeof(net_stream_state_t));
+    st->fd = (int)fd;
+    st->recv = recv;
+
+    extern void* yona_rt_closure_create(void* fn_ptr, int64_t ret_tag,
+                                        int64_t arity, int64_t num_caps);
+    int64_t* closure = (int64_t*)yona_rt_closure_create(
+        (void*)net_stream_next, 0, 0, 1);
+    extern void yona_rt_closure_set_cap(void* closure, int64_t idx, int64_t val);
+    yona_rt_closure_set_cap(closure, 0, (int64_t)(intptr_t)st);
+
+    int64_t* iter_adt = (int64_t*)rc_alloc(4, 4 * sizeof(int64_t));
+    iter_adt[0] = 0;
+    iter_adt[1] = 1;
+    iter_adt[2] = 0;
+    iter_adt[3] = (int64_t)(intptr_t)closure;
+    return (int64_t)(intptr_t)iter_adt;
+}
+
+/* acceptStream: Iterator of accepted client sockets */
+int64_t yona_Std_Net__acceptStream(int64_t listener_fd) {
+    return net_stream_iterator(listener_fd, 0);
+}
+
+/* recvStream: Iterator of ByteArrays received on a socket, ending at EOF */
+int64_t yona_Std_Net__recvStream(int64_t fd) {
+    return net_stream_iterator(fd, 1);
+}
 
 /* ===== HTTP GET via io_uring ===== */
 
@@ -177,6 +177,75 @@ int64_t yona_Std_Net__recvBytes(int64_t fd, int64_t max_bytes) {
 
 int64_t yona_Std_Net__close(int64_t fd) { close((int)fd); return 0; }
 
+/* ===== Streams ===== */
+
+/* acceptStream / recvStream: Iterators issuing one accept or recv per
+ * element (kqueue has no multishot form). */
+
+typedef struct {
+    int fd;
+    int recv;
+    int done;
+} net_stream_state_t;
+
+static int64_t net_stream_next(int64_t* env) {
+    net_stream_state_t* st = (net_stream_state_t*)(intptr_t)env[5];
+    extern void* rc_alloc(int64_t type_tag, size_t payload_bytes);
+    int64_t value = -1;
+    if (!st->done) {
+        if (st->recv) {
+            int64_t id = yona_Std_Net__recvBytes(st->fd, 4096);
+            int64_t* b = id ? (int64_t*)(intptr_t)yona_rt_io_await(id) : NULL;
+            if (b && b[0] > 0) value = (int64_t)(intptr_t)b;
+            else if (b) yona_rt_rc_dec(b);
+        } else {
+            int64_t id = yona_Std_Net__tcpAccept(st->fd);
+            if (id) value = yona_rt_io_await(id);
+        }
+        if (value < 0) st->done = 1;
+    }
+    if (st->done) {
+        int64_t* none = (int64_t*)rc_alloc(4 /* RC_TYPE_ADT */, 3 * sizeof(int64_t));
+        none[0] = 1; none[1] = 0; none[2] = 0;
+        return (int64_t)(intptr_t)none;
+    }
+    int64_t* some = (int64_t*)rc_alloc(4 /* RC_TYPE_ADT */, 4 * sizeof(int64_t));
+    some[0] = 0; some[1] = 1; some[2] = st->recv; /* tag=Some, 1 field */
+    some[3] = value;
+    return (int64_t)(intptr_t)some;
+}
+
+static int64_t net_stream_iterator(int64_t fd, int recv) {
+    net_stream_state_t* st = (net_stream_state_t*)calloc(1, sizeof(net_stream_state_t));
+    st->fd = (int)fd;
+    st->recv = recv;
+
+    extern void* rc_alloc(int64_t type_tag, size_t payload_bytes);
+    extern void* yona_rt_closure_create(void* fn_ptr, int64_t ret_tag,
+                                        int64_t arity, int64_t num_caps);
+    int64_t* closure = (int64_t*)yona_rt_closure_create(
+        (void*)net_stream_next, 0, 0, 1);
+    extern void yona_rt_closure_set_cap(void* closure, int64_t idx, int64_t val);
+    yona_rt_closure_set_cap(closure, 0, (int64_t)(intptr_t)st);
+
+    int64_t* iter_adt = (int64_t*)rc_alloc(4, 4 * sizeof(int64_t));
+    iter_adt[0] = 0;
+    iter_adt[1] = 1;
+    iter_adt[2] = 0;
+    iter_adt[3] = (int64_t)(intptr_t)closure;
+    return (int64_t)(intptr_t)iter_adt;
+}
+
+/* acceptStream: Iterator of accepted client sockets */
+int64_t yona_Std_Net__acceptStream(int64_t listener_fd) {
+    return net_stream_iterator(listener_fd, 0);
+}
+
+/* recvStream: Iterator of ByteArrays received on a socket, ending at EOF */
+int64_t yona_Std_Net__recvStream(int64_t fd) {
+    return net_stream_iterator(fd, 1);
+}
+
 /* ===== HTTP GET via kqueue ===== */
 
 extern const char* yona_Std_Http__buildRequest(const char* method, const char* host,
@@ -10,6 +10,7 @@
  *   - writeStdin: write to subprocess stdin pipe
  */
 
+#define _GNU_SOURCE /* sched_getaffinity, pthread_setaffinity_np */
 #include "yona/runtime/platform.h"
 #include "yona/runtime/uring.h"
 #include <stdio.h>
@@ -44,6 +45,7 @@ typedef struct {
 
 char* yona_platform_read_line(void) {
     char buf[4096];
+    yona_platform_io_flush();
     if (!fgets(buf, sizeof(buf), stdin)) {
         char* r = (char*)yona_rt_rc_alloc_string(1);
         r[0] = '\0';
@@ -273,6 +275,7 @@ int64_t yona_Std_Process__wait(void* proc_handle) {
     if (proc->exited) return proc->exit_code;
 
     int status;
+    yona_platform_io_flush();
     pid_t ret = waitpid((pid_t)proc->pid, &status, 0);
     if (ret < 0) return -1;
 
@@ -374,6 +377,99 @@ int64_t yona_platform_cpu_count(void) {
     return v > 0 ? (int64_t)v : 1;
 }
 
+/* ===== CPU topology ===== */
+
+#include <sched.h>
+#include <pthread.h>
+#include <dirent.h>
+
+/* cgroup CPU quota in whole CPUs (rounded up), 0 when unlimited. cgroup v2
+ * has "quota period" in cpu.max; v1 splits them across two files. */
+static int64_t cgroup_cpu_limit(void) {
+    long long quota = -1, period = 0;
+    FILE* f = fopen("/sys/fs/cgroup/cpu.max", "r");
+    if (f) {
+        char q[32];
+        if (fscanf(f, "%31s %lld", q, &period) == 2 && strcmp(q, "max") != 0)
+            quota = atoll(q);
+        fclose(f);
+    } else {
+        f = fopen("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "r");
+        if (f) {
+            if (fscanf(f, "%lld", &quota) != 1) quota = -1;
+            fclose(f);
+        }
+        f = fopen("/sys/fs/cgroup/cpu/cpu.cfs_period_us", "r");
+        if (f) {
+            if (fscanf(f, "%lld", &period) != 1) period = 0;
+            fclose(f);
+        }
+    }
+    if (quota <= 0 || period <= 0) return 0;
+    return (int64_t)((quota + period - 1) / period);
+}
+
+int64_t yona_platform_available_cpus(void) {
+    int64_t n = yona_platform_cpu_count();
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        int c = CPU_COUNT(&set);
+        if (c > 0 && c < n) n = c;
+    }
+    int64_t quota = cgroup_cpu_limit();
+    if (quota > 0 && quota < n) n = quota;
+    return n;
+}
+
+/* NUMA node of a CPU: the nodeN entry in its sysfs directory, 0 if none. */
+static int cpu_numa_node(int cpu) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR* d = opendir(path);
+    if (!d) return 0;
+    int node = 0;
+    struct dirent* e;
+    while ((e = readdir(d)) != NULL) {
+        if (strncmp(e->d_name, "node", 4) == 0 && e->d_name[4] >= '0' && e->d_name[4] <= '9') {
+            node = atoi(e->d_name + 4);
+            break;
+        }
+    }
+    closedir(d);
+    return node;
+}
+
+int yona_platform_usable_cpus(int* cpus, int* nodes, int max) {
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return 0;
+    int n = 0;
+    for (int c = 0; c < CPU_SETSIZE && n < max; c++) {
+        if (!CPU_ISSET(c, &set)) continue;
+        cpus[n] = c;
+        nodes[n] = cpu_numa_node(c);
+        n++;
+    }
+    /* Stable insertion sort by node: consecutive workers share a node */
+    for (int i = 1; i < n; i++) {
+        int c = cpus[i], nd = nodes[i], j = i - 1;
+        while (j >= 0 && nodes[j] > nd) {
+            cpus[j + 1] = cpus[j];
+            nodes[j + 1] = nodes[j];
+            j--;
+        }
+        cpus[j + 1] = c;
+        nodes[j + 1] = nd;
+    }
+    return n;
+}
+
+int yona_platform_pin_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? 0 : -1;
+}
+
 /* 1 = little-endian (x86_64, aarch64-le), 0 = big-endian. */
 int64_t yona_platform_is_little_endian(void) {
     uint16_t x = 1;
@@ -372,6 +372,27 @@ int64_t yona_platform_cpu_count(void) {
     return v > 0 ? (int64_t)v : 1;
 }
 
+/* ===== CPU topology ===== */
+/* macOS has no affinity masks or cgroups: every online CPU is usable, one
+ * node, and thread pinning is only a scheduler hint we do not rely on. */
+
+int64_t yona_platform_available_cpus(void) { return yona_platform_cpu_count(); }
+
+int yona_platform_usable_cpus(int* cpus, int* nodes, int max) {
+    int n = (int)yona_platform_cpu_count();
+    if (n > max) n = max;
+    for (int i = 0; i < n; i++) {
+        cpus[i] = i;
+        nodes[i] = 0;
+    }
+    return n;
+}
+
+int yona_platform_pin_thread(int cpu) {
+    (void)cpu;
+    return -1;
+}
+
 /* 1 = little-endian (x86_64, aarch64-le), 0 = big-endian. */
 int64_t yona_platform_is_little_endian(void) {
     uint16_t x = 1;
@@ -419,6 +419,49 @@ int64_t yona_platform_cpu_count(void) {
 	return n > 0 ? (int64_t)n : 1;
 }
 
+/* ----- CPU topology (worker pool sizing and pinning) ----- */
+/* Affinity masks only cover the current processor group (64 CPUs). */
+
+int64_t yona_platform_available_cpus(void) {
+	DWORD_PTR proc_mask = 0, sys_mask = 0;
+	int64_t n = yona_platform_cpu_count();
+	if (GetProcessAffinityMask(GetCurrentProcess(), &proc_mask, &sys_mask) && proc_mask) {
+		int64_t c = (int64_t)__builtin_popcountll((unsigned long long)proc_mask);
+		if (c < n) n = c;
+	}
+	return n;
+}
+
+int yona_platform_usable_cpus(int* cpus, int* nodes, int max) {
+	DWORD_PTR proc_mask = 0, sys_mask = 0;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &proc_mask, &sys_mask)) return 0;
+	int n = 0;
+	for (int c = 0; c < (int)(sizeof(DWORD_PTR) * 8) && n < max; c++) {
+		if (!(proc_mask & ((DWORD_PTR)1 << c))) continue;
+		UCHAR node = 0;
+		if (!GetNumaProcessorNode((UCHAR)c, &node) || node == 0xFF) node = 0;
+		cpus[n] = c;
+		nodes[n] = (int)node;
+		n++;
+	}
+	for (int i = 1; i < n; i++) {
+		int c = cpus[i], nd = nodes[i], j = i - 1;
+		while (j >= 0 && nodes[j] > nd) {
+			cpus[j + 1] = cpus[j];
+			nodes[j + 1] = nodes[j];
+			j--;
+		}
+		cpus[j + 1] = c;
+		nodes[j + 1] = nd;
+	}
+	return n;
+}
+
+int yona_platform_pin_thread(int cpu) {
+	if (cpu < 0 || cpu >= (int)(sizeof(DWORD_PTR) * 8)) return -1;
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) ? 0 : -1;
+}
+
 int64_t yona_platform_is_little_endian(void) {
 	uint16_t x = 1;
 	return (*(uint8_t*)&x) == 1 ? 1 : 0;
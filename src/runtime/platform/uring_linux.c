@@ -1,13 +1,68 @@
 /*
- * Single io_uring instance + io_ctx table for all Linux platform TUs.
+ * io_uring rings + io_ctx table for all Linux platform TUs.
+ *
+ * Each thread that submits I/O gets a ring of its own, created on first
+ * use, so submitters never contend on a shared SQ. A ring's id space is
+ * tagged with its index (bits 40 and up of user_data), which is how
+ * ring_await and ring_cancel find the ring that owns an operation no
+ * matter which thread asks. Each ring has its own mutex for its SQ, CQ and
+ * waiter lists; the owning thread is normally the only one taking it.
+ *
+ * A thread that exits hands its ring back for the next new thread. Past
+ * YONA_RING_MAX rings, further threads share the existing ones.
+ *
+ * Every operation owns a slot in its ring's slot table for as long as it
+ * is in flight, and its user_data is the slot's address: ring index, slot
+ * generation, slot index. A CQE goes straight to its slot, which holds the
+ * result, the io_context_t and the waiter to wake, so completion costs the
+ * same however many operations are outstanding and none is ever dropped.
+ *
+ * IORING_SETUP_SINGLE_ISSUER / DEFER_TASKRUN are not used: completions are
+ * reaped by the reaper thread below, and cancels are submitted to the
+ * owning ring from whichever thread cancels.
+ *
+ * Submission is batched: SQEs queue in the SQ and go to the kernel in one
+ * io_uring_enter when YONA_RING_BATCH have piled up, when an operation is
+ * awaited, or when the thread is about to block or finishes a task
+ * (yona_platform_io_flush, called by the scheduler and before the
+ * runtime's sleeps and other blocking calls). With
+ * YONA_URING_SQPOLL set, rings are created with a kernel polling thread,
+ * shared by all rings, and submission takes no syscall at all while that
+ * thread is awake.
+ *
+ * Registered resources, each set up on a ring the first time it is needed
+ * and kept for the ring's lifetime:
+ *  - Fixed files. Long-lived fds (sockets, file handles; see
+ *    ring_file_track) go into the ring's sparse file table at slot == fd,
+ *    and SQEs naming them are switched to IOSQE_FIXED_FILE, sparing the
+ *    kernel an fd lookup and file refcount per operation.
+ *  - Staging buffers for writes the runtime already copies (ring_buf_get),
+ *    issued as WRITE_FIXED so their pages are not pinned per operation.
+ *  - A provided-buffer ring for recv (ring_sqe_select_buffer): a pending
+ *    recv holds no memory, and the kernel picks a buffer only once data
+ *    arrives.
+ *
+ * Multishot operations (ring_stream_open) post many CQEs under one
+ * user_data. Their slot carries a ring_stream_t that queues each result
+ * until the consumer takes it, and stays live until a CQE without
+ * IORING_CQE_F_MORE ends the stream.
  */
 
 #include "yona/runtime/uring.h"
+#include "yona/runtime/fiber.h"
 
+#include <linux/futex.h>
 #include <stdatomic.h>
+#include <stdlib.h>
 #include <pthread.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/syscall.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <string.h>
 
@@ -20,52 +75,158 @@ static inline int yona_uring_enter(int ring_fd, unsigned to_submit, unsigned min
     return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
 }
 
+static inline int yona_uring_register(int ring_fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+#define YONA_RING_MAX 64
+#define YONA_RING_ENTRIES 256
+#define YONA_RING_BATCH 32
+/* SQ poll thread idle time before it sleeps, when YONA_URING_SQPOLL=1 */
+#define YONA_RING_SQPOLL_IDLE_MS 50
+/* Completions can outnumber submissions in flight at once; a deep CQ keeps
+ * the kernel off its overflow list (see ring_drain_locked). */
+#define YONA_RING_CQ_ENTRIES 4096
+/* Fixed-file slots per ring (capped at RLIMIT_NOFILE); fds past the end
+ * are passed as plain fds */
+#define YONA_RING_FILES 4096
+/* Registered write staging buffers per ring */
+#define YONA_RING_BUFS 16
+#define YONA_RING_BUF_SIZE 16384
+/* Provided recv buffers per ring (a power of two) */
+#define YONA_RING_PBUFS 128
+#define YONA_RING_PBUF_SIZE 4096
+#define YONA_RING_PBUF_GROUP 0
+
+/* user_data layout: [ring index + 1 : 24][generation : 18][slot : 22].
+ * Cancel requests carry user_data 0 and their CQEs are dropped. */
+#define YONA_RING_ID_SHIFT 40
+#define RING_SLOT_BITS 22
+#define RING_SLOT_GEN_MASK ((1ULL << (YONA_RING_ID_SHIFT - RING_SLOT_BITS)) - 1)
+#define RING_SLOT_CHUNK 1024
+#define RING_SLOT_CHUNKS ((1u << RING_SLOT_BITS) / RING_SLOT_CHUNK)
+#define RING_SLOT_NONE UINT32_MAX
+
+/* Slot states; the state word doubles as the waiter's futex */
+#define SLOT_FREE    0
+#define SLOT_PENDING 1  /* in flight, nobody waiting */
+#define SLOT_PARKED  2  /* in flight, waiter recorded */
+#define SLOT_DONE    3  /* res is valid */
+
 typedef struct {
+    _Atomic uint32_t state;
+    int32_t res;
+    uint32_t cqe_flags;
+    uint32_t gen;
+    uint32_t next_free;
+    void* fiber;              /* parked fiber, or NULL for a plain thread */
+    io_context_t* ctx;
+    ring_stream_t* stream;    /* multishot: results queue here, not in res */
+} ring_slot_t;
+
+typedef struct {
+    pthread_mutex_t mutex;    /* SQ, CQ, slot allocation */
     int ring_fd;
+    int event_fd;             /* signalled per CQE, -1 if unavailable */
     unsigned *sq_head, *sq_tail, *sq_ring_mask, *sq_ring_entries;
-    unsigned *sq_array;
+    unsigned *sq_array, *sq_flags;
     struct io_uring_sqe *sqes;
-    void *sq_ring_ptr;
-    size_t sq_ring_sz;
     unsigned *cq_head, *cq_tail, *cq_ring_mask, *cq_ring_entries;
     struct io_uring_cqe *cqes;
-    void *cq_ring_ptr;
-    size_t cq_ring_sz;
-    atomic_uint_fast64_t next_id;
-    int initialized;
+    uint64_t id_base;         /* (index + 1) << YONA_RING_ID_SHIFT */
+    _Atomic unsigned unsubmitted; /* SQEs queued since the last enter; mutex */
+    int sqpoll;               /* kernel thread consumes the SQ */
+    int owned;                /* held by a live thread; under yona_rings_mutex */
+    /* Registered resources: 0 not yet set up, 1 ready, -1 unavailable.
+     * Set up under the mutex. */
+    int files;
+    unsigned file_slots;
+    int bufs;
+    char* buf_base;
+    uint16_t buf_free[YONA_RING_BUFS];
+    unsigned buf_nfree;       /* mutex */
+    int pbufs;
+    struct io_uring_buf_ring* pbuf_ring;
+    char* pbuf_base;
+    uint16_t pbuf_tail;       /* mutex */
+    /* Slot table: chunks are allocated as needed and never freed, so any
+     * thread can look a slot up without the mutex. */
+    _Atomic(ring_slot_t*) chunks[RING_SLOT_CHUNKS];
+    uint32_t slot_count;      /* slots handed out so far */
+    uint32_t free_head;       /* owner's free list; mutex held */
+    _Atomic uint32_t returned; /* slots freed by awaiters, any thread */
 } yona_ring_t;
 
-static yona_ring_t yona_ring = {0};
-static pthread_mutex_t yona_ring_mutex = PTHREAD_MUTEX_INITIALIZER;
+static yona_ring_t* yona_rings[YONA_RING_MAX];
+static _Atomic int yona_ring_count = 0;
+static pthread_mutex_t yona_rings_mutex = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local yona_ring_t* yona_thread_ring = NULL;
+static pthread_key_t yona_ring_key;
+static pthread_once_t yona_ring_key_once = PTHREAD_ONCE_INIT;
+static int yona_ring_epoll = -1;               /* reaper's view of every ring */
+static int yona_ring_sqpoll_fd = -1;           /* ring owning the shared SQ poll thread */
 
-static int yona_ring_init(void) {
-    if (yona_ring.initialized) return 0;
+/* Fds that may be registered as fixed files, and the rings (bit = ring
+ * index) whose file table holds each one */
+static _Atomic uint8_t ring_file_tracked[YONA_RING_FILES];
+static _Atomic uint64_t ring_file_rings[YONA_RING_FILES];
+
+/* YONA_URING_SQPOLL=ms (1 for the default) asks for SQ polling; 0 if unset. */
+static unsigned ring_sqpoll_idle_ms(void) {
+    const char* env = getenv("YONA_URING_SQPOLL");
+    if (!env || !*env) return 0;
+    long ms = strtol(env, NULL, 10);
+    if (ms <= 0) return 0;
+    return ms == 1 ? YONA_RING_SQPOLL_IDLE_MS : (unsigned)ms;
+}
 
+/* io_uring_setup with SQ polling if asked for and allowed, else plain.
+ * yona_rings_mutex held. */
+static int ring_setup(struct io_uring_params* params, int* sqpoll) {
+    unsigned idle = ring_sqpoll_idle_ms();
+    *sqpoll = 0;
+    if (idle) {
+        struct io_uring_params p = *params;
+        p.flags |= IORING_SETUP_SQPOLL;
+        p.sq_thread_idle = idle;
+        if (yona_ring_sqpoll_fd >= 0) {
+            p.flags |= IORING_SETUP_ATTACH_WQ;
+            p.wq_fd = (unsigned)yona_ring_sqpoll_fd;
+        }
+        int fd = yona_uring_setup(YONA_RING_ENTRIES, &p);
+        if (fd >= 0) {
+            if (yona_ring_sqpoll_fd < 0) yona_ring_sqpoll_fd = fd;
+            *params = p;
+            *sqpoll = 1;
+            return fd;
+        }
+    }
+    return yona_uring_setup(YONA_RING_ENTRIES, params);
+}
+
+static yona_ring_t* yona_ring_create(int index) {
     struct io_uring_params params;
     memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = YONA_RING_CQ_ENTRIES;
 
-    int fd = yona_uring_setup(256, &params);
-    if (fd < 0) return -1;
-
-    yona_ring.ring_fd = fd;
+    int sqpoll;
+    int fd = ring_setup(&params, &sqpoll);
+    if (fd < 0) {
+        memset(&params, 0, sizeof(params));
+        fd = ring_setup(&params, &sqpoll);
+    }
+    if (fd < 0) return NULL;
 
     size_t sq_ring_sz = params.sq_off.array + params.sq_entries * sizeof(unsigned);
     void *sq_ptr = mmap(0, sq_ring_sz, PROT_READ | PROT_WRITE,
                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
-    if (sq_ptr == MAP_FAILED) { close(fd); return -1; }
-
-    yona_ring.sq_ring_ptr = sq_ptr;
-    yona_ring.sq_ring_sz = sq_ring_sz;
-    yona_ring.sq_head = sq_ptr + params.sq_off.head;
-    yona_ring.sq_tail = sq_ptr + params.sq_off.tail;
-    yona_ring.sq_ring_mask = sq_ptr + params.sq_off.ring_mask;
-    yona_ring.sq_ring_entries = sq_ptr + params.sq_off.ring_entries;
-    yona_ring.sq_array = sq_ptr + params.sq_off.array;
+    if (sq_ptr == MAP_FAILED) { close(fd); return NULL; }
 
     size_t sqes_sz = params.sq_entries * sizeof(struct io_uring_sqe);
-    yona_ring.sqes = mmap(0, sqes_sz, PROT_READ | PROT_WRITE,
-                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
-    if (yona_ring.sqes == MAP_FAILED) { munmap(sq_ptr, sq_ring_sz); close(fd); return -1; }
+    struct io_uring_sqe *sqes = mmap(0, sqes_sz, PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) { munmap(sq_ptr, sq_ring_sz); close(fd); return NULL; }
 
     size_t cq_ring_sz = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
     void *cq_ptr;
@@ -74,129 +235,588 @@ static int yona_ring_init(void) {
     } else {
         cq_ptr = mmap(0, cq_ring_sz, PROT_READ | PROT_WRITE,
                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
-        if (cq_ptr == MAP_FAILED) { munmap(yona_ring.sqes, sqes_sz); munmap(sq_ptr, sq_ring_sz); close(fd); return -1; }
+        if (cq_ptr == MAP_FAILED) { munmap(sqes, sqes_sz); munmap(sq_ptr, sq_ring_sz); close(fd); return NULL; }
+    }
+
+    yona_ring_t* r = (yona_ring_t*)calloc(1, sizeof(yona_ring_t));
+    if (!r) { close(fd); return NULL; }
+    pthread_mutex_init(&r->mutex, NULL);
+    r->ring_fd = fd;
+    r->sq_head = sq_ptr + params.sq_off.head;
+    r->sq_tail = sq_ptr + params.sq_off.tail;
+    r->sq_ring_mask = sq_ptr + params.sq_off.ring_mask;
+    r->sq_ring_entries = sq_ptr + params.sq_off.ring_entries;
+    r->sq_array = sq_ptr + params.sq_off.array;
+    r->sq_flags = sq_ptr + params.sq_off.flags;
+    r->sqes = sqes;
+    r->cq_head = cq_ptr + params.cq_off.head;
+    r->cq_tail = cq_ptr + params.cq_off.tail;
+    r->cq_ring_mask = cq_ptr + params.cq_off.ring_mask;
+    r->cq_ring_entries = cq_ptr + params.cq_off.ring_entries;
+    r->cqes = cq_ptr + params.cq_off.cqes;
+    r->id_base = (uint64_t)(index + 1) << YONA_RING_ID_SHIFT;
+    r->sqpoll = sqpoll;
+    r->free_head = RING_SLOT_NONE;
+    atomic_init(&r->returned, RING_SLOT_NONE);
+    /* Before RSRC_TAGS, registering files or buffers on a busy ring waits
+     * for every request in flight to finish */
+    r->files = r->bufs = (params.features & IORING_FEAT_RSRC_TAGS) ? 0 : -1;
+
+    /* The reaper learns about completions through an eventfd, registered
+     * before anything is submitted so no CQE can slip past it. */
+    r->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (r->event_fd >= 0) {
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = r };
+        if (yona_ring_epoll < 0) yona_ring_epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (yona_ring_epoll < 0 ||
+            yona_uring_register(fd, IORING_REGISTER_EVENTFD, &r->event_fd, 1) != 0 ||
+            epoll_ctl(yona_ring_epoll, EPOLL_CTL_ADD, r->event_fd, &ev) != 0) {
+            close(r->event_fd);
+            r->event_fd = -1;
+        }
+    }
+    return r;
+}
+
+static void yona_ring_release(void* ring) {
+    pthread_mutex_lock(&yona_rings_mutex);
+    ((yona_ring_t*)ring)->owned = 0;
+    pthread_mutex_unlock(&yona_rings_mutex);
+}
+
+static void yona_ring_key_init(void) {
+    (void)pthread_key_create(&yona_ring_key, yona_ring_release);
+}
+
+/* The calling thread's ring: its own, one an exited thread left behind, a
+ * new one, or (all YONA_RING_MAX taken) a shared one. NULL when io_uring
+ * is unavailable. */
+static yona_ring_t* ring_for_thread(void) {
+    if (yona_thread_ring) return yona_thread_ring;
+    pthread_once(&yona_ring_key_once, yona_ring_key_init);
+    pthread_mutex_lock(&yona_rings_mutex);
+    int n = atomic_load_explicit(&yona_ring_count, memory_order_relaxed);
+    yona_ring_t* r = NULL;
+    for (int i = 0; i < n && !r; i++)
+        if (!yona_rings[i]->owned) r = yona_rings[i];
+    if (!r && n < YONA_RING_MAX && (r = yona_ring_create(n)) != NULL) {
+        yona_rings[n] = r;
+        atomic_store_explicit(&yona_ring_count, n + 1, memory_order_release);
+    }
+    if (r) {
+        r->owned = 1;
+        pthread_setspecific(yona_ring_key, r);
+    } else if (n > 0) {
+        r = yona_rings[(uintptr_t)pthread_self() % (unsigned)n];
+    }
+    pthread_mutex_unlock(&yona_rings_mutex);
+    yona_thread_ring = r;
+    return r;
+}
+
+/* The ring that issued id, or NULL for ids no ring handed out. */
+static yona_ring_t* ring_of(uint64_t id) {
+    uint64_t index = (id >> YONA_RING_ID_SHIFT) - 1;
+    if (index >= (uint64_t)atomic_load_explicit(&yona_ring_count, memory_order_acquire))
+        return NULL;
+    return yona_rings[index];
+}
+
+static ring_slot_t* slot_at(yona_ring_t* r, uint32_t index) {
+    ring_slot_t* chunk = atomic_load_explicit(&r->chunks[index / RING_SLOT_CHUNK],
+                                              memory_order_acquire);
+    return chunk ? &chunk[index % RING_SLOT_CHUNK] : NULL;
+}
+
+/* The live slot id names, or NULL if id is stale or not a ring id. */
+static ring_slot_t* slot_of(uint64_t id, yona_ring_t** ring) {
+    yona_ring_t* r = ring_of(id);
+    if (!r) return NULL;
+    ring_slot_t* s = slot_at(r, (uint32_t)(id & ((1u << RING_SLOT_BITS) - 1)));
+    if (!s || s->gen != ((id >> RING_SLOT_BITS) & RING_SLOT_GEN_MASK)) return NULL;
+    if (ring) *ring = r;
+    return s;
+}
+
+/* Take a free slot and return the user_data naming it, or 0 if the table
+ * is full. Ring mutex held. */
+static uint64_t slot_alloc_locked(yona_ring_t* r) {
+    if (r->free_head == RING_SLOT_NONE)
+        r->free_head = atomic_exchange_explicit(&r->returned, RING_SLOT_NONE,
+                                                memory_order_acquire);
+    uint32_t index;
+    ring_slot_t* s;
+    if (r->free_head != RING_SLOT_NONE) {
+        index = r->free_head;
+        s = slot_at(r, index);
+        r->free_head = s->next_free;
+    } else {
+        if (r->slot_count == RING_SLOT_CHUNKS * RING_SLOT_CHUNK) return 0;
+        index = r->slot_count;
+        if (index % RING_SLOT_CHUNK == 0) {
+            ring_slot_t* chunk = (ring_slot_t*)calloc(RING_SLOT_CHUNK, sizeof(ring_slot_t));
+            if (!chunk) return 0;
+            atomic_store_explicit(&r->chunks[index / RING_SLOT_CHUNK], chunk,
+                                  memory_order_release);
+        }
+        r->slot_count++;
+        s = slot_at(r, index);
     }
+    s->gen = (s->gen + 1) & RING_SLOT_GEN_MASK;
+    s->fiber = NULL;
+    s->ctx = NULL;
+    s->stream = NULL;
+    atomic_store_explicit(&s->state, SLOT_PENDING, memory_order_relaxed);
+    return r->id_base | ((uint64_t)s->gen << RING_SLOT_BITS) | index;
+}
+
+/* Give a slot back from any thread. The allocator takes the whole returned
+ * list in one exchange, so pushes see no ABA. */
+static void slot_free(yona_ring_t* r, ring_slot_t* s, uint64_t id) {
+    uint32_t index = (uint32_t)(id & ((1u << RING_SLOT_BITS) - 1));
+    atomic_store_explicit(&s->state, SLOT_FREE, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->returned, memory_order_relaxed);
+    do {
+        s->next_free = head;
+    } while (!atomic_compare_exchange_weak_explicit(&r->returned, &head, index,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+static unsigned ring_index(const yona_ring_t* r) {
+    return (unsigned)(r->id_base >> YONA_RING_ID_SHIFT) - 1;
+}
 
-    yona_ring.cq_ring_ptr = cq_ptr;
-    yona_ring.cq_ring_sz = cq_ring_sz;
-    yona_ring.cq_head = cq_ptr + params.cq_off.head;
-    yona_ring.cq_tail = cq_ptr + params.cq_off.tail;
-    yona_ring.cq_ring_mask = cq_ptr + params.cq_off.ring_mask;
-    yona_ring.cq_ring_entries = cq_ptr + params.cq_off.ring_entries;
-    yona_ring.cqes = cq_ptr + params.cq_off.cqes;
+static void ring_stream_cancel_fd(int fd);
+
+void ring_file_track(int fd) {
+    if (fd >= 0 && fd < YONA_RING_FILES)
+        atomic_store(&ring_file_tracked[fd], 1);
+}
+
+/* Drop fd from every ring's file table and cancel streams on it; call
+ * before closing it, or the tables and streams keep the file open. Every
+ * ring's mutex is taken in turn so a submitter that saw fd still tracked
+ * has finished registering it. */
+void ring_file_forget(int fd) {
+    ring_stream_cancel_fd(fd);
+    if (fd < 0 || fd >= YONA_RING_FILES) return;
+    if (!atomic_exchange(&ring_file_tracked[fd], 0)) return;
+    int n = atomic_load_explicit(&yona_ring_count, memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        yona_ring_t* r = yona_rings[i];
+        uint64_t bit = 1ULL << i;
+        pthread_mutex_lock(&r->mutex);
+        if (atomic_load_explicit(&ring_file_rings[fd], memory_order_relaxed) & bit) {
+            int none = -1;
+            struct io_uring_files_update up = { .offset = (unsigned)fd,
+                                                .fds = (uint64_t)(uintptr_t)&none };
+            yona_uring_register(r->ring_fd, IORING_REGISTER_FILES_UPDATE, &up, 1);
+            atomic_fetch_and(&ring_file_rings[fd], ~bit);
+        }
+        pthread_mutex_unlock(&r->mutex);
+    }
+}
+
+/* Make sure fd sits in r's file table, registering an empty table first
+ * if r has none. Returns 1 if the SQE may use IOSQE_FIXED_FILE. Ring
+ * mutex held. */
+static int ring_fixed_file_locked(yona_ring_t* r, int fd) {
+    if (fd < 0 || fd >= YONA_RING_FILES || r->files < 0) return 0;
+    if (!atomic_load(&ring_file_tracked[fd])) return 0;
+    uint64_t bit = 1ULL << ring_index(r);
+    if (atomic_load_explicit(&ring_file_rings[fd], memory_order_relaxed) & bit) return 1;
+    if (!r->files) {
+        r->files = -1;
+        struct rlimit lim;
+        unsigned slots = YONA_RING_FILES;
+        if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < slots)
+            slots = (unsigned)lim.rlim_cur;
+        int* fds = (int*)malloc(slots * sizeof(int));
+        if (!fds) return 0;
+        for (unsigned i = 0; i < slots; i++) fds[i] = -1;
+        if (yona_uring_register(r->ring_fd, IORING_REGISTER_FILES, fds, slots) == 0) {
+            r->files = 1;
+            r->file_slots = slots;
+        }
+        free(fds);
+        if (r->files < 0) return 0;
+    }
+    if ((unsigned)fd >= r->file_slots) return 0;
+    struct io_uring_files_update up = { .offset = (unsigned)fd,
+                                        .fds = (uint64_t)(uintptr_t)&fd };
+    if (yona_uring_register(r->ring_fd, IORING_REGISTER_FILES_UPDATE, &up, 1) != 1) return 0;
+    atomic_fetch_or(&ring_file_rings[fd], bit);
+    return 1;
+}
+
+static int ring_op_takes_fixed_file(uint8_t opcode) {
+    switch (opcode) {
+        case IORING_OP_READ: case IORING_OP_WRITE:
+        case IORING_OP_READ_FIXED: case IORING_OP_WRITE_FIXED:
+        case IORING_OP_RECV: case IORING_OP_SEND:
+        case IORING_OP_ACCEPT:
+            return 1;
+        default:
+            return 0;
+    }
+}
 
-    atomic_init(&yona_ring.next_id, 1);
-    yona_ring.initialized = 1;
+/* Register r's write staging buffers. Ring mutex held. */
+static int ring_bufs_locked(yona_ring_t* r) {
+    if (r->bufs) return r->bufs > 0;
+    r->bufs = -1;
+    size_t size = (size_t)YONA_RING_BUFS * YONA_RING_BUF_SIZE;
+    char* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return 0;
+    struct iovec iov[YONA_RING_BUFS];
+    for (unsigned i = 0; i < YONA_RING_BUFS; i++) {
+        iov[i].iov_base = base + (size_t)i * YONA_RING_BUF_SIZE;
+        iov[i].iov_len = YONA_RING_BUF_SIZE;
+    }
+    if (yona_uring_register(r->ring_fd, IORING_REGISTER_BUFFERS, iov, YONA_RING_BUFS) != 0) {
+        munmap(base, size);
+        return 0;
+    }
+    for (unsigned i = 0; i < YONA_RING_BUFS; i++)
+        r->buf_free[i] = (uint16_t)(YONA_RING_BUFS - 1 - i);
+    r->buf_nfree = YONA_RING_BUFS;
+    __atomic_store_n(&r->buf_base, base, __ATOMIC_RELEASE);
+    r->bufs = 1;
+    return 1;
+}
+
+void* ring_buf_get(size_t len, unsigned* index) {
+    if (len > YONA_RING_BUF_SIZE) return NULL;
+    yona_ring_t* r = ring_for_thread();
+    if (!r) return NULL;
+    void* data = NULL;
+    pthread_mutex_lock(&r->mutex);
+    if (ring_bufs_locked(r) && r->buf_nfree) {
+        *index = r->buf_free[--r->buf_nfree];
+        data = r->buf_base + (size_t)*index * YONA_RING_BUF_SIZE;
+    }
+    pthread_mutex_unlock(&r->mutex);
+    return data;
+}
+
+int ring_buf_put(const void* data) {
+    if (!data) return 0;
+    int n = atomic_load_explicit(&yona_ring_count, memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        yona_ring_t* r = yona_rings[i];
+        const char* base = __atomic_load_n(&r->buf_base, __ATOMIC_ACQUIRE);
+        if (!base || (const char*)data < base ||
+            (const char*)data >= base + (size_t)YONA_RING_BUFS * YONA_RING_BUF_SIZE)
+            continue;
+        pthread_mutex_lock(&r->mutex);
+        r->buf_free[r->buf_nfree++] = (uint16_t)(((const char*)data - base) / YONA_RING_BUF_SIZE);
+        pthread_mutex_unlock(&r->mutex);
+        return 1;
+    }
     return 0;
 }
 
-uint64_t ring_submit_sqe(struct io_uring_sqe *sqe_template) {
-    pthread_mutex_lock(&yona_ring_mutex);
-    if (!yona_ring.initialized && yona_ring_init() != 0) {
-        pthread_mutex_unlock(&yona_ring_mutex);
+/* Hand buffer bid (back) to the kernel. Ring mutex held. */
+static void ring_pbuf_add_locked(yona_ring_t* r, unsigned bid) {
+    struct io_uring_buf* buf = &r->pbuf_ring->bufs[r->pbuf_tail & (YONA_RING_PBUFS - 1)];
+    /* Field by field: bufs[0].resv is the ring's tail */
+    buf->addr = (uint64_t)(uintptr_t)(r->pbuf_base + (size_t)bid * YONA_RING_PBUF_SIZE);
+    buf->len = YONA_RING_PBUF_SIZE;
+    buf->bid = (uint16_t)bid;
+    r->pbuf_tail++;
+}
+
+/* Register r's provided-buffer ring for recv. Ring mutex held. */
+static int ring_pbufs_locked(yona_ring_t* r) {
+    if (r->pbufs) return r->pbufs > 0;
+    __atomic_store_n(&r->pbufs, -1, __ATOMIC_RELAXED);
+    size_t ring_size = YONA_RING_PBUFS * sizeof(struct io_uring_buf);
+    size_t data_size = (size_t)YONA_RING_PBUFS * YONA_RING_PBUF_SIZE;
+    void* ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) return 0;
+    char* data = mmap(NULL, data_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) { munmap(ring, ring_size); return 0; }
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)ring;
+    reg.ring_entries = YONA_RING_PBUFS;
+    reg.bgid = YONA_RING_PBUF_GROUP;
+    if (yona_uring_register(r->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        munmap(data, data_size);
+        munmap(ring, ring_size);
         return 0;
     }
-    unsigned tail = *yona_ring.sq_tail;
-    unsigned mask = *yona_ring.sq_ring_mask;
+    r->pbuf_ring = (struct io_uring_buf_ring*)ring;
+    r->pbuf_base = data;
+    for (unsigned i = 0; i < YONA_RING_PBUFS; i++) ring_pbuf_add_locked(r, i);
+    __atomic_store_n(&r->pbuf_ring->tail, r->pbuf_tail, __ATOMIC_RELEASE);
+    __atomic_store_n(&r->pbufs, 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+int ring_sqe_select_buffer(struct io_uring_sqe* sqe, size_t len) {
+    if (len > YONA_RING_PBUF_SIZE) return 0;
+    yona_ring_t* r = ring_for_thread();
+    if (!r) return 0;
+    int ready = __atomic_load_n(&r->pbufs, __ATOMIC_ACQUIRE);
+    if (!ready) {
+        pthread_mutex_lock(&r->mutex);
+        ready = ring_pbufs_locked(r);
+        pthread_mutex_unlock(&r->mutex);
+    }
+    if (ready <= 0) return 0;
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = YONA_RING_PBUF_GROUP;
+    sqe->addr = 0;
+    return 1;
+}
+
+const char* ring_pbuf_data(uint64_t id, uint32_t cqe_flags) {
+    yona_ring_t* r = ring_of(id);
+    if (!r || !(cqe_flags & IORING_CQE_F_BUFFER)) return NULL;
+    return r->pbuf_base + (size_t)(cqe_flags >> IORING_CQE_BUFFER_SHIFT) * YONA_RING_PBUF_SIZE;
+}
+
+void ring_pbuf_recycle(uint64_t id, uint32_t cqe_flags) {
+    yona_ring_t* r = ring_of(id);
+    if (!r || !(cqe_flags & IORING_CQE_F_BUFFER)) return;
+    pthread_mutex_lock(&r->mutex);
+    ring_pbuf_add_locked(r, cqe_flags >> IORING_CQE_BUFFER_SHIFT);
+    __atomic_store_n(&r->pbuf_ring->tail, r->pbuf_tail, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&r->mutex);
+}
+
+static void ring_drain_locked(yona_ring_t* r);
+
+/* Hand queued SQEs to the kernel. With SQ polling that only means waking
+ * the poll thread if it has gone to sleep. Ring mutex held. */
+static void ring_flush_locked(yona_ring_t* r) {
+    if (!r->unsubmitted) return;
+    if (r->sqpoll) {
+        /* The tail store must be visible before we look at the flag */
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(r->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP)
+            yona_uring_enter(r->ring_fd, 0, 0, IORING_ENTER_SQ_WAKEUP);
+        r->unsubmitted = 0;
+        return;
+    }
+    while (r->unsubmitted) {
+        int n = yona_uring_enter(r->ring_fd, r->unsubmitted, 0, 0);
+        if (n > 0) {
+            r->unsubmitted -= (unsigned)n < r->unsubmitted ? (unsigned)n : r->unsubmitted;
+        } else if (n < 0 && (errno == EBUSY || errno == EAGAIN)) {
+            /* CQ backed up: make room, then try again */
+            ring_drain_locked(r);
+            sched_yield();
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            break;
+        }
+    }
+}
+
+/* Queue one SQE with the given user_data; it reaches the kernel with the
+ * next flush. Ring mutex held. */
+static void ring_push_locked(yona_ring_t* r, const struct io_uring_sqe *sqe_template,
+                             uint64_t user_data) {
+    unsigned tail = *r->sq_tail;
+    while (tail - __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE) >= *r->sq_ring_entries) {
+        if (r->sqpoll) {
+            if (yona_uring_enter(r->ring_fd, 0, 0,
+                                 IORING_ENTER_SQ_WAKEUP | IORING_ENTER_SQ_WAIT) < 0)
+                sched_yield();
+        } else {
+            ring_flush_locked(r);
+        }
+    }
+    unsigned mask = *r->sq_ring_mask;
     unsigned idx = tail & mask;
-    uint64_t id = atomic_fetch_add(&yona_ring.next_id, 1);
-    struct io_uring_sqe *sqe = &yona_ring.sqes[idx];
+    struct io_uring_sqe *sqe = &r->sqes[idx];
     *sqe = *sqe_template;
-    sqe->user_data = id;
-    yona_ring.sq_array[idx] = idx;
-    __atomic_store_n(yona_ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
-    yona_uring_enter(yona_ring.ring_fd, 1, 0, 0);
-    pthread_mutex_unlock(&yona_ring_mutex);
+    sqe->user_data = user_data;
+    if (!(sqe->flags & IOSQE_FIXED_FILE) && ring_op_takes_fixed_file(sqe->opcode) &&
+        ring_fixed_file_locked(r, sqe->fd))
+        sqe->flags |= IOSQE_FIXED_FILE;
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    r->unsubmitted++;
+    if (r->sqpoll || r->unsubmitted >= YONA_RING_BATCH) ring_flush_locked(r);
+}
+
+uint64_t ring_submit_sqe(struct io_uring_sqe *sqe_template) {
+    yona_ring_t* r = ring_for_thread();
+    if (!r) return 0;
+    pthread_mutex_lock(&r->mutex);
+    uint64_t id = slot_alloc_locked(r);
+    if (id) ring_push_locked(r, sqe_template, id);
+    pthread_mutex_unlock(&r->mutex);
     return id;
 }
 
-/* Completions for other in-flight ids must be stashed; otherwise awaiting
- * accept while connect finished first would skip/drop the connect CQE. */
-#define RING_PENDING_MAX 256
-static struct {
-    uint64_t id;
-    int32_t res;
-    int used;
-} ring_pending[RING_PENDING_MAX];
-
-static int pending_put(uint64_t id, int32_t res) {
-    for (int i = 0; i < RING_PENDING_MAX; i++) {
-        if (!ring_pending[i].used) {
-            ring_pending[i].id = id;
-            ring_pending[i].res = res;
-            ring_pending[i].used = 1;
-            return 0;
-        }
+static void ring_flush_ring(yona_ring_t* r) {
+    if (!atomic_load_explicit(&r->unsubmitted, memory_order_relaxed)) return;
+    pthread_mutex_lock(&r->mutex);
+    ring_flush_locked(r);
+    pthread_mutex_unlock(&r->mutex);
+}
+
+void ring_flush(void) {
+    if (yona_thread_ring) ring_flush_ring(yona_thread_ring);
+}
+
+/* Blocking waits go through one reaper thread, started on first need: it
+ * alone sleeps, in epoll_wait on the rings' eventfds, and drains whichever
+ * ring signals. A waiter records itself in its operation's slot: a fiber
+ * parks and is readied by whoever posts the result, a plain thread sleeps
+ * on the slot's state word. Waiters never block in the kernel themselves,
+ * so a CQE taken by one drainer cannot leave another asleep in
+ * io_uring_enter. */
+static int ring_reaper_state = 0;   /* 0 not started, 1 running, -1 failed; yona_rings_mutex */
+
+static void ring_stream_post_locked(ring_stream_t* st, int32_t res, uint32_t cqe_flags);
+
+/* Post a result to id's slot and wake its waiter. Ring mutex held. */
+static void slot_complete(uint64_t id, int32_t res, uint32_t cqe_flags) {
+    ring_slot_t* s = slot_of(id, NULL);
+    if (!s) return;
+    if (s->stream) {
+        ring_stream_post_locked(s->stream, res, cqe_flags);
+        if (atomic_exchange_explicit(&s->state, SLOT_PENDING, memory_order_acq_rel) != SLOT_PARKED)
+            return;
+        if (s->fiber)
+            yona_rt_fiber_ready(s->fiber);
+        else
+            syscall(SYS_futex, (uint32_t*)&s->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+        return;
     }
-    return -1;
+    s->res = res;
+    s->cqe_flags = cqe_flags;
+    uint32_t prev = atomic_exchange_explicit(&s->state, SLOT_DONE, memory_order_acq_rel);
+    if (prev != SLOT_PARKED) return;
+    if (s->fiber)
+        yona_rt_fiber_ready(s->fiber);
+    else
+        syscall(SYS_futex, (uint32_t*)&s->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
 }
 
-static int pending_take(uint64_t id, int32_t *out) {
-    for (int i = 0; i < RING_PENDING_MAX; i++) {
-        if (ring_pending[i].used && ring_pending[i].id == id) {
-            *out = ring_pending[i].res;
-            ring_pending[i].used = 0;
-            return 1;
+/* Consume the CQ, posting every result to its slot. CQEs the kernel had
+ * to park on its overflow list (CQ full) are flushed back in and taken
+ * too. Ring mutex held. */
+static void ring_drain_locked(yona_ring_t* r) {
+    for (;;) {
+        unsigned head = __atomic_load_n(r->cq_head, __ATOMIC_ACQUIRE);
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        unsigned mask = *r->cq_ring_mask;
+        for (; head != tail; head++) {
+            struct io_uring_cqe *cqe = &r->cqes[head & mask];
+            if (cqe->user_data) slot_complete(cqe->user_data, cqe->res, cqe->flags);
         }
+        __atomic_store_n(r->cq_head, tail, __ATOMIC_RELEASE);
+        if (!(__atomic_load_n(r->sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW)) return;
+        yona_uring_enter(r->ring_fd, 0, 0, IORING_ENTER_GETEVENTS);
     }
-    return 0;
 }
 
-int32_t ring_await(uint64_t id) {
+static void* ring_reaper(void* arg) {
+    (void)arg;
+    struct epoll_event events[16];
     for (;;) {
-        pthread_mutex_lock(&yona_ring_mutex);
-        if (!yona_ring.initialized) {
-            pthread_mutex_unlock(&yona_ring_mutex);
-            return -1;
-        }
-        int32_t stashed = 0;
-        if (pending_take(id, &stashed)) {
-            pthread_mutex_unlock(&yona_ring_mutex);
-            return stashed;
-        }
-        unsigned head = __atomic_load_n(yona_ring.cq_head, __ATOMIC_ACQUIRE);
-        unsigned tail = __atomic_load_n(yona_ring.cq_tail, __ATOMIC_ACQUIRE);
-        unsigned consumed = 0;
-        int32_t found_res = 0;
-        int found = 0;
-        while (head != tail) {
-            unsigned mask = *yona_ring.cq_ring_mask;
-            struct io_uring_cqe *cqe = &yona_ring.cqes[head & mask];
-            if (cqe->user_data == id) {
-                found_res = cqe->res;
-                found = 1;
-            } else {
-                (void)pending_put(cqe->user_data, cqe->res);
+        int n = epoll_wait(yona_ring_epoll, events, 16, -1);
+        for (int i = 0; i < n; i++) {
+            yona_ring_t* r = (yona_ring_t*)events[i].data.ptr;
+            uint64_t count;
+            (void)!read(r->event_fd, &count, sizeof(count));
+            pthread_mutex_lock(&r->mutex);
+            ring_drain_locked(r);
+            pthread_mutex_unlock(&r->mutex);
+        }
+    }
+    return NULL;
+}
+
+/* Returns 0 if r cannot be reaped for us; callers then drive the ring
+ * themselves from io_uring_enter, as before. */
+static int ring_reaper_start(yona_ring_t* r) {
+    if (r->event_fd < 0) return 0;
+    pthread_mutex_lock(&yona_rings_mutex);
+    if (ring_reaper_state == 0) {
+        pthread_t thread;
+        ring_reaper_state = pthread_create(&thread, NULL, ring_reaper, NULL) == 0 ? 1 : -1;
+        if (ring_reaper_state == 1) pthread_detach(thread);
+    }
+    int ok = ring_reaper_state == 1;
+    pthread_mutex_unlock(&yona_rings_mutex);
+    return ok;
+}
+
+static int slot_done(ring_slot_t* s) {
+    return atomic_load_explicit(&s->state, memory_order_acquire) == SLOT_DONE;
+}
+
+int32_t ring_await_flags(uint64_t id, uint32_t* cqe_flags) {
+    yona_ring_t* r = NULL;
+    ring_slot_t* s = slot_of(id, &r);
+    if (!s) return -1;
+    /* The operation may still sit in its ring's SQ, and we are about to
+     * wait: push out ours too. */
+    ring_flush_ring(r);
+    ring_flush();
+    if (!slot_done(s)) {
+        /* Whatever is already in the CQ costs less to take than to sleep on */
+        if (pthread_mutex_trylock(&r->mutex) == 0) {
+            ring_drain_locked(r);
+            pthread_mutex_unlock(&r->mutex);
+        }
+    }
+    if (!slot_done(s)) {
+        if (!ring_reaper_start(r)) {
+            while (!slot_done(s)) {
+                yona_uring_enter(r->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+                pthread_mutex_lock(&r->mutex);
+                ring_drain_locked(r);
+                pthread_mutex_unlock(&r->mutex);
+            }
+        } else {
+            s->fiber = yona_rt_fiber_current();
+            uint32_t expected = SLOT_PENDING;
+            if (atomic_compare_exchange_strong_explicit(&s->state, &expected, SLOT_PARKED,
+                                                        memory_order_acq_rel,
+                                                        memory_order_acquire)) {
+                if (s->fiber) {
+                    yona_rt_fiber_suspend();
+                } else {
+                    while (!slot_done(s))
+                        syscall(SYS_futex, (uint32_t*)&s->state, FUTEX_WAIT_PRIVATE,
+                                SLOT_PARKED, NULL, NULL, 0);
+                }
             }
-            head++;
-            consumed++;
         }
-        if (consumed)
-            __atomic_store_n(yona_ring.cq_head,
-                __atomic_load_n(yona_ring.cq_head, __ATOMIC_RELAXED) + consumed,
-                __ATOMIC_RELEASE);
-        pthread_mutex_unlock(&yona_ring_mutex);
-        if (found)
-            return found_res;
-        yona_uring_enter(yona_ring.ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
     }
+    int32_t res = s->res;
+    if (cqe_flags) *cqe_flags = s->cqe_flags;
+    slot_free(r, s, id);
+    return res;
 }
 
+int32_t ring_await(uint64_t id) {
+    return ring_await_flags(id, NULL);
+}
+
+/* ASYNC_CANCEL only matches operations on its own ring, so it goes to the
+ * ring that issued target_id rather than the caller's. */
 void ring_cancel(uint64_t target_id) {
-    if (!yona_ring.initialized) return;
-    pthread_mutex_lock(&yona_ring_mutex);
-    unsigned tail = *yona_ring.sq_tail;
-    unsigned mask = *yona_ring.sq_ring_mask;
-    unsigned idx = tail & mask;
-    struct io_uring_sqe *sqe = &yona_ring.sqes[idx];
-    memset(sqe, 0, sizeof(*sqe));
-    sqe->opcode = IORING_OP_ASYNC_CANCEL;
-    sqe->addr = target_id;
-    sqe->user_data = atomic_fetch_add(&yona_ring.next_id, 1);
-    yona_ring.sq_array[idx] = idx;
-    __atomic_store_n(yona_ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
-    yona_uring_enter(yona_ring.ring_fd, 1, 0, 0);
-    pthread_mutex_unlock(&yona_ring_mutex);
+    yona_ring_t* r = ring_of(target_id);
+    if (!r) return;
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_ASYNC_CANCEL;
+    sqe.addr = target_id;
+    pthread_mutex_lock(&r->mutex);
+    ring_push_locked(r, &sqe, 0);
+    ring_flush_locked(r);
+    pthread_mutex_unlock(&r->mutex);
 }
 
 void ring_cancel_group_ios(uint64_t* io_ids, int count) {
@@ -204,6 +824,177 @@ void ring_cancel_group_ios(uint64_t* io_ids, int count) {
         ring_cancel(io_ids[i]);
 }
 
+struct ring_stream {
+    yona_ring_t* ring;
+    ring_slot_t* slot;
+    uint64_t id;
+    int fd;
+    uint8_t opcode;
+    /* Queued results, a circular buffer; ring mutex */
+    struct { int32_t res; uint32_t flags; }* items;
+    unsigned head, count, cap;
+    int ended;                /* final CQE posted; ring mutex */
+    int closing;              /* results are discarded, not queued; ring mutex */
+    ring_stream_t* next_open;
+};
+
+/* Open streams, for ring_stream_cancel_fd */
+static ring_stream_t* ring_streams_open = NULL;
+static pthread_mutex_t ring_streams_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Throw away a result nobody will take: give its provided buffer back,
+ * close the fd an accept produced. Ring mutex held. */
+static void ring_stream_discard_locked(ring_stream_t* st, int32_t res, uint32_t cqe_flags) {
+    if (cqe_flags & IORING_CQE_F_BUFFER) {
+        ring_pbuf_add_locked(st->ring, cqe_flags >> IORING_CQE_BUFFER_SHIFT);
+        __atomic_store_n(&st->ring->pbuf_ring->tail, st->ring->pbuf_tail, __ATOMIC_RELEASE);
+    } else if (st->opcode == IORING_OP_ACCEPT && res >= 0) {
+        close(res);
+    }
+}
+
+static void ring_stream_post_locked(ring_stream_t* st, int32_t res, uint32_t cqe_flags) {
+    if (!(cqe_flags & IORING_CQE_F_MORE)) st->ended = 1;
+    if (st->closing) {
+        ring_stream_discard_locked(st, res, cqe_flags);
+        return;
+    }
+    if (st->count == st->cap) {
+        unsigned cap = st->cap ? st->cap * 2 : 16;
+        void* items = malloc(cap * sizeof(*st->items));
+        if (!items) {
+            ring_stream_discard_locked(st, res, cqe_flags);
+            return;
+        }
+        for (unsigned i = 0; i < st->count; i++)
+            memcpy((char*)items + i * sizeof(*st->items),
+                   &st->items[(st->head + i) % st->cap], sizeof(*st->items));
+        free(st->items);
+        st->items = items;
+        st->cap = cap;
+        st->head = 0;
+    }
+    unsigned tail = (st->head + st->count++) % st->cap;
+    st->items[tail].res = res;
+    st->items[tail].flags = cqe_flags;
+}
+
+/* Stop queueing st's results and drop those already queued. Ring mutex
+ * held. */
+static void ring_stream_close_locked(ring_stream_t* st) {
+    st->closing = 1;
+    for (; st->count; st->count--, st->head = (st->head + 1) % st->cap)
+        ring_stream_discard_locked(st, st->items[st->head].res, st->items[st->head].flags);
+}
+
+ring_stream_t* ring_stream_open(const struct io_uring_sqe* sqe) {
+    yona_ring_t* r = ring_for_thread();
+    if (!r) return NULL;
+    ring_stream_t* st = (ring_stream_t*)calloc(1, sizeof(ring_stream_t));
+    if (!st) return NULL;
+    st->ring = r;
+    st->fd = sqe->fd;
+    st->opcode = sqe->opcode;
+    pthread_mutex_lock(&ring_streams_mutex);
+    pthread_mutex_lock(&r->mutex);
+    st->id = slot_alloc_locked(r);
+    if (st->id) {
+        st->slot = slot_of(st->id, NULL);
+        st->slot->stream = st;
+        /* Arm it now: a stream is long-lived, not part of a batch */
+        ring_push_locked(r, sqe, st->id);
+        ring_flush_locked(r);
+        st->next_open = ring_streams_open;
+        ring_streams_open = st;
+    }
+    pthread_mutex_unlock(&r->mutex);
+    pthread_mutex_unlock(&ring_streams_mutex);
+    if (!st->id) { free(st); return NULL; }
+    return st;
+}
+
+uint64_t ring_stream_id(const ring_stream_t* st) {
+    return st->id;
+}
+
+int ring_stream_next(ring_stream_t* st, int32_t* res, uint32_t* cqe_flags) {
+    yona_ring_t* r = st->ring;
+    ring_slot_t* s = st->slot;
+    int reaped = ring_reaper_start(r);
+    ring_flush();
+    for (;;) {
+        pthread_mutex_lock(&r->mutex);
+        if (!st->count && !st->ended) ring_drain_locked(r);
+        if (st->count) {
+            *res = st->items[st->head].res;
+            *cqe_flags = st->items[st->head].flags;
+            st->head = (st->head + 1) % st->cap;
+            st->count--;
+            pthread_mutex_unlock(&r->mutex);
+            return 1;
+        }
+        if (st->ended) {
+            int closed = st->closing;
+            pthread_mutex_unlock(&r->mutex);
+            return closed ? -1 : 0;
+        }
+        if (!reaped) {
+            pthread_mutex_unlock(&r->mutex);
+            yona_uring_enter(r->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+            continue;
+        }
+        s->fiber = yona_rt_fiber_current();
+        atomic_store_explicit(&s->state, SLOT_PARKED, memory_order_release);
+        pthread_mutex_unlock(&r->mutex);
+        if (s->fiber) {
+            yona_rt_fiber_suspend();
+        } else {
+            while (atomic_load_explicit(&s->state, memory_order_acquire) == SLOT_PARKED)
+                syscall(SYS_futex, (uint32_t*)&s->state, FUTEX_WAIT_PRIVATE,
+                        SLOT_PARKED, NULL, NULL, 0);
+        }
+    }
+}
+
+void ring_stream_close(ring_stream_t* st) {
+    yona_ring_t* r = st->ring;
+    pthread_mutex_lock(&ring_streams_mutex);
+    for (ring_stream_t** p = &ring_streams_open; *p; p = &(*p)->next_open)
+        if (*p == st) { *p = st->next_open; break; }
+    pthread_mutex_unlock(&ring_streams_mutex);
+    pthread_mutex_lock(&r->mutex);
+    ring_stream_close_locked(st);
+    int ended = st->ended;
+    pthread_mutex_unlock(&r->mutex);
+    if (!ended) {
+        /* The slot stays ours until the final CQE is in */
+        ring_cancel(st->id);
+        int32_t res;
+        uint32_t cqe_flags;
+        while (ring_stream_next(st, &res, &cqe_flags) > 0) {}
+    }
+    slot_free(r, st->slot, st->id);
+    free(st->items);
+    free(st);
+}
+
+/* A file is being closed: end the streams on it, dropping what they have
+ * queued. Their consumers see the end of the stream. */
+static void ring_stream_cancel_fd(int fd) {
+    pthread_mutex_lock(&ring_streams_mutex);
+    for (ring_stream_t* st = ring_streams_open; st; st = st->next_open) {
+        if (st->fd != fd) continue;
+        pthread_mutex_lock(&st->ring->mutex);
+        ring_stream_close_locked(st);
+        int ended = st->ended;
+        pthread_mutex_unlock(&st->ring->mutex);
+        if (!ended) ring_cancel(st->id);
+    }
+    pthread_mutex_unlock(&ring_streams_mutex);
+}
+
+/* Contexts of ring operations live in their slots. The table below is for
+ * the rest: direct results registered when io_uring is unavailable. */
 static struct {
     uint64_t id;
     io_context_t* ctx;
@@ -211,12 +1002,21 @@ static struct {
 
 static pthread_mutex_t io_ctx_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* Taken slots keep a tombstone so later entries of the same probe chain
+ * stay reachable; puts reuse them. */
+#define IO_CTX_TOMBSTONE UINT64_MAX
+
 void io_ctx_put(uint64_t id, io_context_t* ctx) {
+    ring_slot_t* s = slot_of(id, NULL);
+    if (s) {
+        s->ctx = ctx;
+        return;
+    }
     pthread_mutex_lock(&io_ctx_mutex);
     unsigned idx = (unsigned)(id % IO_CTX_TABLE_SIZE);
     for (unsigned i = 0; i < IO_CTX_TABLE_SIZE; i++) {
         unsigned slot = (idx + i) % IO_CTX_TABLE_SIZE;
-        if (io_ctx_table[slot].id == 0) {
+        if (io_ctx_table[slot].id == 0 || io_ctx_table[slot].id == IO_CTX_TOMBSTONE) {
             io_ctx_table[slot].id = id;
             io_ctx_table[slot].ctx = ctx;
             pthread_mutex_unlock(&io_ctx_mutex);
@@ -226,14 +1026,22 @@ void io_ctx_put(uint64_t id, io_context_t* ctx) {
     pthread_mutex_unlock(&io_ctx_mutex);
 }
 
+/* For a ring id, call before ring_await: the slot is recycled once the
+ * result has been collected. */
 io_context_t* io_ctx_take(uint64_t id) {
+    ring_slot_t* s = slot_of(id, NULL);
+    if (s) {
+        io_context_t* ctx = s->ctx;
+        s->ctx = NULL;
+        return ctx;
+    }
     pthread_mutex_lock(&io_ctx_mutex);
     unsigned idx = (unsigned)(id % IO_CTX_TABLE_SIZE);
     for (unsigned i = 0; i < IO_CTX_TABLE_SIZE; i++) {
         unsigned slot = (idx + i) % IO_CTX_TABLE_SIZE;
         if (io_ctx_table[slot].id == id) {
             io_context_t* ctx = io_ctx_table[slot].ctx;
-            io_ctx_table[slot].id = 0;
+            io_ctx_table[slot].id = IO_CTX_TOMBSTONE;
             io_ctx_table[slot].ctx = NULL;
             pthread_mutex_unlock(&io_ctx_mutex);
             return ctx;
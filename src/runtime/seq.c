@@ -278,6 +278,42 @@ void yona_rt_seq_set_heap(int64_t* seq, int64_t flag) {
 
 int64_t yona_rt_seq_length(int64_t* seq) { return seq[0]; }
 
+int64_t yona_rt_seq_heap_flag(int64_t* seq) {
+    if (!seq) return 0;
+    return is_rbt(seq) ? ((rbt_t*)seq)->heap_flag : FLAT_HF(seq);
+}
+
+/* Copy all elements in order into dst (seq[0] words) in O(n), walking the
+ * head buffer, head chain, trie leaves and tail once. No refcounts change. */
+void yona_rt_seq_copy_out(int64_t* seq, int64_t* dst) {
+    if (!seq || seq[0] == 0) return;
+    if (LIKELY(!is_rbt(seq))) {
+        memcpy(dst, seq + SEQ_HDR_SIZE + FLAT_OFF(seq), (size_t)seq[0] * sizeof(int64_t));
+        return;
+    }
+    rbt_t* r = (rbt_t*)seq;
+    memcpy(dst, r->head_buf + r->head_off, (size_t)r->head_cnt * sizeof(int64_t));
+    dst += r->head_cnt;
+    int64_t chain = r->head_chain_len;
+    for (rbt_chunk_t* c = r->head_next; c && chain > 0; c = c->next) {
+        int64_t n = c->count < chain ? c->count : chain;
+        memcpy(dst, c->elems + c->offset, (size_t)n * sizeof(int64_t));
+        dst += n;
+        chain -= n;
+    }
+    for (int64_t i = r->back_off; i < r->back_size;) {
+        void* node = r->back_root;
+        for (int64_t shift = r->back_shift; shift > 0; shift -= BITS)
+            node = (void*)(intptr_t)((rbt_node_t*)node)->children[(i >> shift) & MASK];
+        int64_t lo = i & MASK, n = B - lo;
+        if (n > r->back_size - i) n = r->back_size - i;
+        memcpy(dst, ((rbt_leaf_t*)node)->elems + lo, (size_t)n * sizeof(int64_t));
+        dst += n;
+        i += n;
+    }
+    memcpy(dst, r->tail_buf, (size_t)r->tail_cnt * sizeof(int64_t));
+}
+
 int64_t yona_rt_seq_is_empty(int64_t* seq) {
     if (!seq) return 1;
     return seq[0] == 0;
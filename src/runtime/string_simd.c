@@ -0,0 +1,174 @@
+/*
+ * String scan kernels for Std\String.
+ *
+ * #included from compiled_runtime.c (not compiled as a separate TU).
+ *
+ *   yona_str_find(hay, hlen, needle, nlen)  — substring search
+ *   yona_str_case_ascii(dst, src, len, up)  — ASCII upper/lower conversion
+ *
+ * Substring search uses the first/last-byte filter (W. Muła, "SIMD-friendly
+ * algorithms for substring searching"): broadcast the needle's first and
+ * last byte, compare them against two unaligned loads of the haystack
+ * offset by nlen-1, and only memcmp the candidate positions whose mask bits
+ * survive the AND. On x86-64 SSE2 is baseline; the AVX2 variant is selected
+ * once at runtime via __builtin_cpu_supports. Other targets (and MSVC) use
+ * the memchr+memcmp scalar path, which is also used for the unaligned tail.
+ *
+ * Case conversion matches toupper/tolower in the C locale: only 'a'..'z' /
+ * 'A'..'Z' change, every other byte (including UTF-8 continuation bytes)
+ * is copied through unchanged.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define YONA_STR_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/* ===== Scalar fallbacks ===== */
+
+static const char* yona_str_find_scalar(const char* hay, size_t hlen,
+                                        const char* needle, size_t nlen) {
+    if (nlen > hlen) return NULL;
+    const char* p = hay;
+    const char* last = hay + (hlen - nlen);
+    unsigned char first = (unsigned char)needle[0];
+    while (p <= last) {
+        p = (const char*)memchr(p, first, (size_t)(last - p) + 1);
+        if (!p) return NULL;
+        if (memcmp(p + 1, needle + 1, nlen - 1) == 0) return p;
+        p++;
+    }
+    return NULL;
+}
+
+static void yona_str_case_scalar(char* dst, const char* src, size_t len, int upper) {
+    unsigned char lo = upper ? 'a' : 'A';
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)src[i];
+        dst[i] = (char)((unsigned char)(c - lo) < 26 ? c ^ 0x20 : c);
+    }
+}
+
+#ifdef YONA_STR_SIMD_X86
+
+/* ===== SSE2 (x86-64 baseline) ===== */
+
+static const char* yona_str_find_sse2(const char* hay, size_t hlen,
+                                      const char* needle, size_t nlen) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[nlen - 1]);
+    size_t i = 0;
+    /* Both loads must stay inside the haystack: i + nlen - 1 + 16 <= hlen */
+    for (; i + nlen + 15 <= hlen; i += 16) {
+        __m128i bf = _mm_loadu_si128((const __m128i*)(hay + i));
+        __m128i bl = _mm_loadu_si128((const __m128i*)(hay + i + nlen - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, bf), _mm_cmpeq_epi8(last, bl)));
+        while (mask) {
+            unsigned bit = (unsigned)__builtin_ctz(mask);
+            if (memcmp(hay + i + bit + 1, needle + 1, nlen - 2) == 0)
+                return hay + i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return yona_str_find_scalar(hay + i, hlen - i, needle, nlen);
+}
+
+static void yona_str_case_sse2(char* dst, const char* src, size_t len, int upper) {
+    /* Signed compares: bytes >= 0x80 are negative and never fall in range */
+    const __m128i lo = _mm_set1_epi8((char)((upper ? 'a' : 'A') - 1));
+    const __m128i hi = _mm_set1_epi8((char)((upper ? 'z' : 'Z') + 1));
+    const __m128i flip = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i in = _mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(v, _mm_and_si128(in, flip)));
+    }
+    yona_str_case_scalar(dst + i, src + i, len - i, upper);
+}
+
+/* ===== AVX2 (runtime-selected) ===== */
+
+__attribute__((target("avx2")))
+static const char* yona_str_find_avx2(const char* hay, size_t hlen,
+                                      const char* needle, size_t nlen) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[nlen - 1]);
+    size_t i = 0;
+    for (; i + nlen + 31 <= hlen; i += 32) {
+        __m256i bf = _mm256_loadu_si256((const __m256i*)(hay + i));
+        __m256i bl = _mm256_loadu_si256((const __m256i*)(hay + i + nlen - 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, bf), _mm256_cmpeq_epi8(last, bl)));
+        while (mask) {
+            unsigned bit = (unsigned)__builtin_ctz(mask);
+            if (memcmp(hay + i + bit + 1, needle + 1, nlen - 2) == 0)
+                return hay + i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return yona_str_find_sse2(hay + i, hlen - i, needle, nlen);
+}
+
+__attribute__((target("avx2")))
+static void yona_str_case_avx2(char* dst, const char* src, size_t len, int upper) {
+    const __m256i lo = _mm256_set1_epi8((char)((upper ? 'a' : 'A') - 1));
+    const __m256i hi = _mm256_set1_epi8((char)((upper ? 'z' : 'Z') + 1));
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i in = _mm256_and_si256(_mm256_cmpgt_epi8(v, lo), _mm256_cmpgt_epi8(hi, v));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_xor_si256(v, _mm256_and_si256(in, flip)));
+    }
+    yona_str_case_sse2(dst + i, src + i, len - i, upper);
+}
+
+/* 0 = not probed yet, 1 = SSE2, 2 = AVX2. Probing is idempotent, so a race
+ * between two first callers is harmless. */
+static _Atomic int yona_str_simd_level = 0;
+
+static inline int yona_str_simd(void) {
+    int level = atomic_load_explicit(&yona_str_simd_level, memory_order_relaxed);
+    if (__builtin_expect(level == 0, 0)) {
+        __builtin_cpu_init();
+        level = __builtin_cpu_supports("avx2") ? 2 : 1;
+        atomic_store_explicit(&yona_str_simd_level, level, memory_order_relaxed);
+    }
+    return level;
+}
+
+#endif /* YONA_STR_SIMD_X86 */
+
+/* ===== Dispatch ===== */
+
+/* Find the first occurrence of needle[0..nlen) in hay[0..hlen).
+ * Returns a pointer into hay, or NULL. An empty needle matches at hay. */
+static const char* yona_str_find(const char* hay, size_t hlen,
+                                 const char* needle, size_t nlen) {
+    if (nlen == 0) return hay;
+    if (nlen > hlen) return NULL;
+    if (nlen == 1) return (const char*)memchr(hay, (unsigned char)needle[0], hlen);
+#ifdef YONA_STR_SIMD_X86
+    if (yona_str_simd() == 2) return yona_str_find_avx2(hay, hlen, needle, nlen);
+    return yona_str_find_sse2(hay, hlen, needle, nlen);
+#else
+    return yona_str_find_scalar(hay, hlen, needle, nlen);
+#endif
+}
+
+/* Copy len bytes from src to dst, converting ASCII letters to upper case
+ * (upper != 0) or lower case. dst and src may be the same buffer. */
+static void yona_str_case_ascii(char* dst, const char* src, size_t len, int upper) {
+#ifdef YONA_STR_SIMD_X86
+    if (yona_str_simd() == 2) { yona_str_case_avx2(dst, src, len, upper); return; }
+    yona_str_case_sse2(dst, src, len, upper);
+#else
+    yona_str_case_scalar(dst, src, len, upper);
+#endif
+}
@@ -0,0 +1,126 @@
+/*
+ * Std\Format runtime path tests.
+ *
+ * format calls whose template or argument list is not a literal go through
+ * yona_rt_format_seq, which takes the arguments as a Seq. A short Seq is a
+ * flat block behind a two-word header (and may start at an offset after a
+ * tail), a long one is tree-backed. These tests build each shape the way
+ * compiled code does and check every element reaches the output in order.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <string>
+
+extern "C" {
+const char* yona_rt_format_seq(const char* fmt, int64_t* args, int64_t kind);
+const char* yona_Std_Format__format(const char* fmt, int64_t* args);
+int64_t* yona_rt_seq_alloc(int64_t count);
+void yona_rt_seq_set(int64_t* seq, int64_t index, int64_t value);
+int64_t* yona_rt_seq_cons(int64_t elem, int64_t* seq);
+int64_t* yona_rt_seq_tail(int64_t* seq);
+void yona_rt_rc_dec(void* ptr);
+}
+
+namespace {
+
+/* [values[0], ..., values[n-1]] built by consing onto [], as compiled
+ * code builds a list; past 32 elements the Seq becomes tree-backed */
+int64_t* cons_seq(const int64_t* values, int64_t n) {
+    int64_t* s = yona_rt_seq_alloc(0);
+    for (int64_t i = n - 1; i >= 0; i--) {
+        int64_t* next = yona_rt_seq_cons(values[i], s);
+        if (next != s) yona_rt_rc_dec(s);
+        s = next;
+    }
+    return s;
+}
+
+std::string placeholders(int n) {
+    std::string t;
+    for (int i = 0; i < n; i++) t += i ? " {}" : "{}";
+    return t;
+}
+
+std::string take(const char* s) {
+    std::string r = s;
+    yona_rt_rc_dec((void*)s);
+    return r;
+}
+
+} // namespace
+
+TEST_SUITE("RuntimeFormat") {
+
+TEST_CASE("flat Seqs of each element kind") {
+    int64_t* ints = yona_rt_seq_alloc(3);
+    for (int i = 0; i < 3; i++) yona_rt_seq_set(ints, i, i + 1);
+    CHECK(take(yona_rt_format_seq("{} + {} = {}", ints, 1)) == "1 + 2 = 3");
+
+    const char* words[] = {"a", "bc", "def"};
+    int64_t* strs = yona_rt_seq_alloc(3);
+    for (int i = 0; i < 3; i++) yona_rt_seq_set(strs, i, (int64_t)(intptr_t)words[i]);
+    CHECK(take(yona_Std_Format__format("{}/{}/{}!", strs)) == "a/bc/def!");
+
+    double d[] = {0.5, 2.25};
+    int64_t* floats = yona_rt_seq_alloc(2);
+    for (int i = 0; i < 2; i++) {
+        int64_t bits;
+        memcpy(&bits, &d[i], sizeof bits);
+        yona_rt_seq_set(floats, i, bits);
+    }
+    CHECK(take(yona_rt_format_seq("{} {}", floats, 2)) == "0.5 2.25");
+
+    int64_t* flags = yona_rt_seq_alloc(2);
+    yona_rt_seq_set(flags, 0, 1);
+    yona_rt_seq_set(flags, 1, 0);
+    CHECK(take(yona_rt_format_seq("{}/{}", flags, 3)) == "true/false");
+
+    /* Fewer arguments than placeholders leaves the rest as text */
+    CHECK(take(yona_rt_format_seq("{} {} {} {}", ints, 1)) == "1 2 3 {}");
+    int64_t* none = yona_rt_seq_alloc(0);
+    CHECK(take(yona_rt_format_seq("x{}", none, 1)) == "x{}");
+
+    yona_rt_rc_dec(ints);
+    yona_rt_rc_dec(strs);
+    yona_rt_rc_dec(floats);
+    yona_rt_rc_dec(flags);
+    yona_rt_rc_dec(none);
+}
+
+TEST_CASE("a flat Seq read from an offset") {
+    int64_t values[] = {10, 20, 30, 40};
+    int64_t* s = cons_seq(values, 4);
+    /* A uniquely owned flat Seq drops its head in place */
+    int64_t* t = yona_rt_seq_tail(s);
+    if (t != s) yona_rt_rc_dec(s);
+    CHECK(take(yona_rt_format_seq("{},{},{}", t, 1)) == "20,30,40");
+    yona_rt_rc_dec(t);
+}
+
+TEST_CASE("tree-backed Seqs") {
+    const int n = 100;
+    int64_t values[n];
+    std::string expected;
+    for (int i = 0; i < n; i++) {
+        values[i] = i * 3;
+        expected += (i ? " " : "") + std::to_string(i * 3);
+    }
+    int64_t* ints = cons_seq(values, n);
+    CHECK(take(yona_rt_format_seq(placeholders(n).c_str(), ints, 1)) == expected);
+    yona_rt_rc_dec(ints);
+
+    static std::string names[n];
+    std::string joined;
+    for (int i = 0; i < n; i++) {
+        names[i] = "s" + std::to_string(i);
+        values[i] = (int64_t)(intptr_t)names[i].c_str();
+        joined += (i ? " " : "") + names[i];
+    }
+    int64_t* strs = cons_seq(values, n);
+    CHECK(take(yona_Std_Format__format(placeholders(n).c_str(), strs)) == joined);
+    yona_rt_rc_dec(strs);
+}
+
+} // TEST_SUITE("RuntimeFormat")
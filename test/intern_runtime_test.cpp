@@ -0,0 +1,108 @@
+/*
+ * Interned string tests.
+ *
+ * Compiled modules emit short literals in the interned layout and queue
+ * them with yona_rt_intern_register from a global constructor. These
+ * tests build literals the same way codegen does and check that they
+ * agree with strings interned at runtime: same hash for the same bytes
+ * (embedded NULs included), and Eq String never reports two equal
+ * strings as different while literals are still queued.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <doctest/doctest.h>
+
+extern "C" {
+void yona_rt_intern_register(const char** lits, int64_t count);
+const char* yona_rt_string_intern(const char* s);
+void* yona_rt_rc_alloc_string_len(size_t bytes, size_t str_len);
+int64_t yona_Prelude__Eq_String__eq(const char* a, const char* b);
+int64_t yona_Prelude__Hash_String__hash(const char* s);
+void yona_rt_rc_dec(void* ptr);
+}
+
+namespace {
+
+/* Layout of a codegen-emitted interned literal (CodegenExpr.cpp) */
+struct InternedLiteral {
+    int64_t hash;
+    int64_t refcount;
+    int64_t tag;
+    char bytes[32];
+};
+
+InternedLiteral make_literal(const char* s, size_t len) {
+    InternedLiteral lit{};
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) h = (h ^ (unsigned char)s[i]) * 1099511628211ULL;
+    lit.hash = (int64_t)h;
+    lit.refcount = INT64_MAX;
+    lit.tag = 6 | (int64_t(1) << 15) | ((int64_t)len << 16);
+    memcpy(lit.bytes, s, len);
+    return lit;
+}
+
+char* runtime_string(const char* s, size_t len) {
+    char* r = (char*)yona_rt_rc_alloc_string_len(len + 1, len);
+    memcpy(r, s, len);
+    r[len] = '\0';
+    return r;
+}
+
+} // namespace
+
+TEST_SUITE("RuntimeIntern") {
+
+TEST_CASE("literal with an embedded NUL is the canonical copy") {
+    static InternedLiteral lit = make_literal("nul\0tail", 8);
+    static const char* lits[] = {lit.bytes};
+    yona_rt_intern_register(lits, 1);
+
+    char* s = runtime_string("nul\0tail", 8);
+    CHECK(yona_rt_string_intern(s) == lit.bytes);
+    CHECK(yona_Prelude__Hash_String__hash(s) == yona_Prelude__Hash_String__hash(lit.bytes));
+    CHECK(yona_Prelude__Eq_String__eq(s, lit.bytes) == 1);
+    yona_rt_rc_dec(s);
+}
+
+TEST_CASE("Eq String sees a queued literal equal to a runtime-interned copy") {
+    char* s = runtime_string("queued-literal", 14);
+    const char* copy = yona_rt_string_intern(s);
+    yona_rt_rc_dec(s);
+
+    /* A module registered after runtime interning made its own copy */
+    static InternedLiteral lit = make_literal("queued-literal", 14);
+    static const char* lits[] = {lit.bytes};
+    yona_rt_intern_register(lits, 1);
+
+    CHECK(yona_rt_string_intern(lit.bytes) == copy);
+    CHECK(yona_Prelude__Eq_String__eq(copy, lit.bytes) == 1);
+    CHECK(yona_Prelude__Eq_String__eq(lit.bytes, copy) == 1);
+}
+
+TEST_CASE("Eq String settles queued literals before trusting the flags") {
+    char* s = runtime_string("queued-eq-first", 15);
+    const char* copy = yona_rt_string_intern(s);
+    yona_rt_rc_dec(s);
+
+    static InternedLiteral lit = make_literal("queued-eq-first", 15);
+    static const char* lits[] = {lit.bytes};
+    yona_rt_intern_register(lits, 1);
+
+    CHECK(yona_Prelude__Eq_String__eq(lit.bytes, copy) == 1);
+}
+
+TEST_CASE("distinct interned strings compare unequal") {
+    char* a = runtime_string("intern-a", 8);
+    char* b = runtime_string("intern-b", 8);
+    const char* ia = yona_rt_string_intern(a);
+    const char* ib = yona_rt_string_intern(b);
+    CHECK(ia != ib);
+    CHECK(yona_Prelude__Eq_String__eq(ia, ib) == 0);
+    CHECK(yona_Prelude__Eq_String__eq(ia, yona_rt_string_intern(a)) == 1);
+    yona_rt_rc_dec(a);
+    yona_rt_rc_dec(b);
+}
+
+} // TEST_SUITE("RuntimeIntern")
@@ -0,0 +1,190 @@
+/*
+ * Std\Json reader tests.
+ *
+ * Decoders generated by `deriving Json` share one reader per document:
+ * `enter` walks a record once, `seek` moves back to each field, and the
+ * field's readJson decodes it in place. These tests drive the runtime the
+ * way the generated code does, including a record nested in another and
+ * a document large enough to grow the reader's index. Floats read as Ints
+ * outside the Int range are checked on every path that converts them.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <string>
+#include <vector>
+
+extern "C" {
+int64_t yona_Std_Json__reader(const char* json);
+int64_t yona_Std_Json__finish(int64_t r);
+int64_t yona_Std_Json__enter(const char* spec, int64_t r);
+int64_t yona_Std_Json__seek(int64_t i, int64_t frame, int64_t r);
+const char* yona_Std_Json__variant(int64_t r);
+int64_t yona_Prelude__Json_Int__readJson(int64_t d, int64_t r);
+double yona_Prelude__Json_Float__readJson(double d, int64_t r);
+const char* yona_Prelude__Json_String__readJson(const char* d, int64_t r);
+int64_t yona_Std_Json__getInt(const char* path, int64_t dflt, const char* json);
+int64_t* yona_Std_Json__parse(const char* s);
+int64_t* yona_Std_Json__at(int64_t i, int64_t* j);
+int64_t yona_Std_Json__asInt(int64_t* j);
+void* yona_rt_rc_alloc_string_len(size_t bytes, size_t str_len);
+void yona_rt_rc_dec(void* ptr);
+}
+
+namespace {
+
+char* runtime_string(const std::string& s) {
+    char* r = (char*)yona_rt_rc_alloc_string_len(s.size() + 1, s.size());
+    memcpy(r, s.c_str(), s.size() + 1);
+    return r;
+}
+
+/* Perfect-hash spec the way DeriveEngine builds it */
+std::string named_spec(const std::vector<std::string>& keys) {
+    auto hash = [](const std::string& k, uint64_t seed) {
+        uint64_t h = 14695981039346656037ULL ^ seed;
+        for (unsigned char c : k) h = (h ^ c) * 1099511628211ULL;
+        return h ^ (h >> 32);
+    };
+    uint64_t m = 1;
+    while (m < keys.size()) m <<= 1;
+    for (;; m <<= 1)
+        for (uint64_t seed = 0; seed < 4096; seed++) {
+            std::vector<bool> used(m, false);
+            bool ok = true;
+            for (auto& k : keys) {
+                uint64_t slot = hash(k, seed) & (m - 1);
+                if (used[slot]) { ok = false; break; }
+                used[slot] = true;
+            }
+            if (!ok) continue;
+            std::string spec = std::to_string(seed) + ":" + std::to_string(m) + ":";
+            for (size_t i = 0; i < keys.size(); i++) spec += (i ? "," : "") + keys[i];
+            return spec;
+        }
+}
+
+struct Person {
+    std::string name;
+    int64_t age;
+};
+
+/* readJson for Person { name : String, age : Int } */
+Person read_person(const Person& d, int64_t r) {
+    static const std::string spec = named_spec({"name", "age"});
+    int64_t o = yona_Std_Json__enter(spec.c_str(), r);
+    char* dn = runtime_string(d.name);
+    const char* n = yona_Prelude__Json_String__readJson(dn, yona_Std_Json__seek(0, o, r));
+    Person p{n, yona_Prelude__Json_Int__readJson(d.age, yona_Std_Json__seek(1, o, r))};
+    yona_rt_rc_dec((void*)n);
+    yona_rt_rc_dec(dn);
+    return p;
+}
+
+Person decode_person(const std::string& json, const Person& d) {
+    char* s = runtime_string(json);
+    int64_t r = yona_Std_Json__reader(s);
+    Person p = read_person(d, r);
+    yona_Std_Json__finish(r);
+    yona_rt_rc_dec(s);
+    return p;
+}
+
+} // namespace
+
+TEST_SUITE("JsonReader") {
+
+TEST_CASE("fields decode in place in any order") {
+    Person p = decode_person(R"({"extra": [1, {"age": 9}], "age": 41, "name": "Al"})", {"", 0});
+    CHECK(p.name == "Al");
+    CHECK(p.age == 41);
+}
+
+TEST_CASE("missing fields and values of another kind keep the prototype") {
+    Person p = decode_person(R"({"age": "old"})", {"proto", 7});
+    CHECK(p.name == "proto");
+    CHECK(p.age == 7);
+    p = decode_person("", {"empty", 3});
+    CHECK(p.name == "empty");
+    CHECK(p.age == 3);
+}
+
+TEST_CASE("a nested record is read from the same reader") {
+    static const std::string spec = named_spec({"lead", "size"});
+    char* s = runtime_string(R"({"size": 3, "lead": {"age": 41, "name": "Al"}, "tail": true})");
+    int64_t r = yona_Std_Json__reader(s);
+    int64_t o = yona_Std_Json__enter(spec.c_str(), r);
+    Person lead = read_person({"", 0}, yona_Std_Json__seek(0, o, r));
+    int64_t size = yona_Prelude__Json_Int__readJson(0, yona_Std_Json__seek(1, o, r));
+    yona_Std_Json__finish(r);
+    yona_rt_rc_dec(s);
+    CHECK(lead.name == "Al");
+    CHECK(lead.age == 41);
+    CHECK(size == 3);
+}
+
+TEST_CASE("variant moves the reader to a tagged payload") {
+    char* s = runtime_string(R"([{"Circle": [2.5]}, "Dot", 4])");
+    int64_t r = yona_Std_Json__reader(s);
+    int64_t o = yona_Std_Json__enter("#3", r);
+
+    const char* tag = yona_Std_Json__variant(yona_Std_Json__seek(0, o, r));
+    CHECK(std::string(tag) == "Circle");
+    int64_t c = yona_Std_Json__enter("#1", r);
+    CHECK(yona_Prelude__Json_Float__readJson(0.0, yona_Std_Json__seek(0, c, r)) == 2.5);
+    yona_rt_rc_dec((void*)tag);
+
+    tag = yona_Std_Json__variant(yona_Std_Json__seek(1, o, r));
+    CHECK(std::string(tag) == "Dot");
+    yona_rt_rc_dec((void*)tag);
+
+    tag = yona_Std_Json__variant(yona_Std_Json__seek(2, o, r));
+    CHECK(std::string(tag).empty());
+    yona_rt_rc_dec((void*)tag);
+    yona_Std_Json__finish(r);
+    yona_rt_rc_dec(s);
+}
+
+TEST_CASE("floats outside the Int range are not converted") {
+    const char* doc = "[1e300, -1e300, 9.3e18, -9.3e18, 2.9, -2.9, -9.2e18]";
+    const int64_t in_range[] = {2, -2, -9200000000000000000LL};
+    char* s = runtime_string(doc);
+
+    int64_t r = yona_Std_Json__reader(s);
+    int64_t o = yona_Std_Json__enter("#7", r);
+    for (int i = 0; i < 4; i++) CHECK(yona_Prelude__Json_Int__readJson(-5, yona_Std_Json__seek(i, o, r)) == -5);
+    for (int i = 0; i < 3; i++)
+        CHECK(yona_Prelude__Json_Int__readJson(-5, yona_Std_Json__seek(4 + i, o, r)) == in_range[i]);
+    yona_Std_Json__finish(r);
+
+    for (int i = 0; i < 4; i++) CHECK(yona_Std_Json__getInt(std::to_string(i).c_str(), -5, s) == -5);
+    for (int i = 0; i < 3; i++) CHECK(yona_Std_Json__getInt(std::to_string(4 + i).c_str(), -5, s) == in_range[i]);
+
+    int64_t* tree = yona_Std_Json__parse(s);
+    for (int i = 0; i < 4; i++) {
+        int64_t* v = yona_Std_Json__at(i, tree);
+        CHECK(yona_Std_Json__asInt(v) == 0);
+        yona_rt_rc_dec(v);
+    }
+    for (int i = 0; i < 3; i++) {
+        int64_t* v = yona_Std_Json__at(4 + i, tree);
+        CHECK(yona_Std_Json__asInt(v) == in_range[i]);
+        yona_rt_rc_dec(v);
+    }
+    yona_rt_rc_dec(tree);
+    yona_rt_rc_dec(s);
+}
+
+TEST_CASE("the index grows past one batch and readers are reused") {
+    std::string big = R"({"pad": [)";
+    for (int i = 0; i < 100000; i++) big += (i ? "," : "") + std::to_string(i % 10);
+    big += R"(], "age": 77, "name": "end"})";
+    for (int round = 0; round < 3; round++) {
+        Person p = decode_person(big, {"", 0});
+        CHECK(p.name == "end");
+        CHECK(p.age == 77);
+    }
+}
+
+} // TEST_SUITE("JsonReader")
@@ -84,6 +84,14 @@ TEST_CASE("StringLiterals") {
     });
 }
 
+TEST_CASE("StringLiteralBraces") {
+    LexerTest fixture;
+    fixture.TestTokenValues(R"("{} + {}" "\{\"a\":1\}")", {
+        {TokenType::YSTRING, string("{} + {}")},
+        {TokenType::YSTRING, string("{\"a\":1}")}
+    });
+}
+
 TEST_CASE("Identifiers") {
     LexerTest fixture;
     fixture.TestTokens("foo bar_baz x' _test", {
@@ -1,6 +1,9 @@
 #include <doctest/doctest.h>
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <thread>
+#include <unistd.h>
 
 extern "C" {
 int64_t yona_rt_io_await(int64_t uring_id);
@@ -15,6 +18,10 @@ int64_t yona_Std_Net__close(int64_t fd);
 int64_t yona_Std_Net__udpBind(const char* host, int64_t port);
 int64_t yona_Std_Net__udpSendTo(int64_t fd, const char* host, int64_t port, const char* data);
 int64_t yona_Std_Net__udpRecv(int64_t fd, int64_t max_bytes);
+int64_t yona_Std_Net__acceptStream(int64_t listener_fd);
+int64_t yona_Std_Net__recvStream(int64_t fd);
+void* yona_rt_async_call(int64_t (*fn)(int64_t), int64_t arg);
+int yona_rt_async_await_timeout(void* promise, int64_t ms, int64_t* result);
 }
 
 static int64_t bind_loopback_listener_with_port(int64_t* out_port) {
@@ -39,6 +46,29 @@ static int64_t bind_udp_with_port(int64_t* out_port) {
 	return -1;
 }
 
+/* Iterator protocol: the iterator's closure returns Some v or None */
+static bool iter_next(int64_t iter, int64_t* value) {
+	int64_t* closure = (int64_t*)(intptr_t)((int64_t*)(intptr_t)iter)[3];
+	int64_t* opt = (int64_t*)(intptr_t)((int64_t (*)(int64_t*))(intptr_t)closure[0])(closure);
+	bool some = opt[0] == 0;
+	if (some) *value = opt[3];
+	return some;
+}
+
+static std::string bytes_string(int64_t bytes) {
+	int64_t* b = (int64_t*)(intptr_t)bytes;
+	std::string s((const char*)(b + 1), (size_t)b[0]);
+	yona_rt_rc_dec(b);
+	return s;
+}
+
+/* Everything a recvStream yields until it ends */
+static int64_t drain_recv_stream(int64_t fd) {
+	int64_t it = yona_Std_Net__recvStream(fd), chunk, total = 0;
+	while (iter_next(it, &chunk)) total += (int64_t)bytes_string(chunk).size();
+	return total;
+}
+
 TEST_SUITE("Runtime Net Submit/Await") {
 
 TEST_CASE("TCP connect accept send recv on loopback") {
@@ -85,4 +115,86 @@ TEST_CASE("UDP send and recv on loopback") {
 	yona_Std_Net__close(recv_sock);
 }
 
+TEST_CASE("acceptStream and recvStream yield every connection and chunk") {
+	int64_t port = 0;
+	int64_t listener = bind_loopback_listener_with_port(&port);
+	REQUIRE(listener != -1);
+	int64_t accepts = yona_Std_Net__acceptStream(listener);
+
+	for (int c = 0; c < 4; c++) {
+		int64_t client = yona_rt_io_await(yona_Std_Net__tcpConnect("127.0.0.1", port));
+		REQUIRE(client > 0);
+		int64_t server = -1;
+		REQUIRE(iter_next(accepts, &server));
+		REQUIRE(server > 0);
+		/* One chunk at a time, so each is its own completion */
+		int64_t chunks = yona_Std_Net__recvStream(server), chunk;
+		for (int i = 0; i < 10; i++) {
+			std::string msg = "c" + std::to_string(c) + "-" + std::to_string(i);
+			REQUIRE(yona_rt_io_await(yona_Std_Net__send(client, msg.c_str())) == (int64_t)msg.size());
+			REQUIRE(iter_next(chunks, &chunk));
+			CHECK(bytes_string(chunk) == msg);
+		}
+		yona_Std_Net__close(client);
+		CHECK_FALSE(iter_next(chunks, &chunk));  /* EOF ends it */
+		yona_Std_Net__close(server);
+	}
+
+	/* More data queued than the shared buffer pool holds, read afterwards */
+	int64_t client = yona_rt_io_await(yona_Std_Net__tcpConnect("127.0.0.1", port));
+	int64_t server = -1;
+	REQUIRE(iter_next(accepts, &server));
+	std::string big(1 << 20, 'z');
+	int64_t sent = 0;
+	std::thread pusher([&] {
+		while (sent < (int64_t)big.size()) {
+			int64_t n = yona_rt_io_await(yona_Std_Net__send(client, big.c_str() + sent));
+			if (n <= 0) break;
+			sent += n;
+		}
+		yona_Std_Net__close(client);
+	});
+	usleep(100000);
+	int64_t received = drain_recv_stream(server);
+	pusher.join();
+	CHECK(received == (int64_t)big.size());
+	yona_Std_Net__close(server);
+
+	yona_Std_Net__close(listener);
+	int64_t fd;
+	CHECK_FALSE(iter_next(accepts, &fd));
+}
+
+TEST_CASE("closing a socket ends a stream whose consumer is parked") {
+	int64_t port = 0;
+	int64_t listener = bind_loopback_listener_with_port(&port);
+	REQUIRE(listener != -1);
+	int64_t accept_id = yona_Std_Net__tcpAccept(listener);
+	int64_t client = yona_rt_io_await(yona_Std_Net__tcpConnect("127.0.0.1", port));
+	int64_t server = yona_rt_io_await(accept_id);
+	REQUIRE(server > 0);
+
+	/* A pool task parks its fiber in recvStream */
+	void* task = yona_rt_async_call(drain_recv_stream, server);
+	usleep(100000);
+	yona_Std_Net__close(server);
+	int64_t received = -1;
+	CHECK(yona_rt_async_await_timeout(task, 5000, &received) == 1);
+	CHECK(received == 0);
+
+	/* A plain thread sleeps in acceptStream */
+	std::atomic<int> ended{0};
+	std::thread acceptor([&] {
+		int64_t it = yona_Std_Net__acceptStream(listener), fd;
+		while (iter_next(it, &fd)) yona_Std_Net__close(fd);
+		ended = 1;
+	});
+	usleep(100000);
+	yona_Std_Net__close(listener);
+	for (int i = 0; i < 500 && !ended.load(); i++) usleep(10000);
+	CHECK(ended.load() == 1);
+	if (ended.load()) acceptor.join(); else acceptor.detach();
+	yona_Std_Net__close(client);
+}
+
 } // TEST_SUITE
@@ -0,0 +1,188 @@
+/*
+ * Pooled promise and task group tests.
+ *
+ * A promise and its task share one block. The awaiter and the task each
+ * hold a reference, and whichever lets go last recycles the block onto its
+ * own thread's free list. Timed waiters live on the heap and are freed by
+ * the last of the waiter and the completer; a waiter that times out
+ * leaves its reference on the node. These tests push both orders of
+ * release, across threads and inside tasks, and check that a recycled
+ * block or group never hands out a stale result.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+extern "C" {
+void* yona_rt_async_call(int64_t (*fn)(int64_t), int64_t arg);
+int64_t yona_rt_async_await(void* promise);
+int64_t yona_rt_async_await_keep(void* promise);
+int yona_rt_async_await_timeout(void* promise, int64_t ms, int64_t* result);
+void* yona_rt_promise_new(void);
+void yona_rt_promise_complete(void* p, int64_t result, int is_error, void* group);
+void* yona_rt_group_begin(void);
+void* yona_rt_group_begin_in(void* frame, int64_t cap);
+void* yona_rt_async_call_grouped(int64_t (*fn)(int64_t), int64_t arg, void* group);
+int64_t yona_rt_group_await_all(void* group);
+void yona_rt_group_end(void* group);
+}
+
+namespace {
+
+int64_t square(int64_t x) { return x * x; }
+
+/* Finishes after its awaiter is parked, so the task releases last */
+int64_t slow_square(int64_t x) {
+    usleep(50);
+    return x * x;
+}
+
+int64_t sleep_us(int64_t us) {
+    usleep((useconds_t)us);
+    return us;
+}
+
+/* Inside a task: a timed await parks the fiber with a timer armed */
+int64_t timed_in_task(int64_t us) {
+    int64_t r = -1;
+    int done = yona_rt_async_await_timeout(yona_rt_async_call(sleep_us, us), 1, &r);
+    return done ? r : -2;
+}
+
+int64_t grouped_sum(int64_t n) {
+    alignas(16) char frame[256 + 4 * sizeof(void*)];
+    void* g = (n & 1) ? yona_rt_group_begin_in(frame, 4) : yona_rt_group_begin();
+    std::vector<void*> ps;
+    for (int64_t i = 0; i < n % 8 + 1; i++) ps.push_back(yona_rt_async_call_grouped(square, n + i, g));
+    int64_t sum = 0;
+    for (void* p : ps) sum += yona_rt_async_await_keep(p);
+    yona_rt_group_await_all(g);
+    yona_rt_group_end(g);
+    return sum;
+}
+
+int64_t grouped_expected(int64_t n) {
+    int64_t sum = 0;
+    for (int64_t i = 0; i < n % 8 + 1; i++) sum += (n + i) * (n + i);
+    return sum;
+}
+
+} // namespace
+
+TEST_SUITE("RuntimePromise") {
+
+TEST_CASE("either side may release a pooled promise last") {
+    std::vector<std::thread> threads;
+    std::atomic<int> bad{0};
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&bad, t] {
+            for (int i = 0; i < 20000; i++) {
+                int64_t x = t * 100000 + i;
+                /* Alternate: await before the task ends, or after */
+                void* p = yona_rt_async_call(i & 1 ? slow_square : square, x);
+                if (!(i & 1) && (i & 6) == 0) usleep(20);
+                if (yona_rt_async_await(p) != x * x) bad++;
+            }
+        });
+    for (auto& th : threads) th.join();
+    CHECK(bad.load() == 0);
+}
+
+TEST_CASE("promises released on another thread are reused safely") {
+    std::vector<void*> ps;
+    for (int i = 0; i < 5000; i++) ps.push_back(yona_rt_async_call(square, i));
+    std::atomic<int> bad{0};
+    std::thread other([&] {
+        for (int i = 0; i < 5000; i++)
+            if (yona_rt_async_await(ps[i]) != (int64_t)i * i) bad++;
+    });
+    other.join();
+    /* This thread's free list is refilled by the other's releases later */
+    for (int i = 0; i < 5000; i++)
+        if (yona_rt_async_await(yona_rt_async_call(square, i)) != (int64_t)i * i) bad++;
+    CHECK(bad.load() == 0);
+}
+
+TEST_CASE("timed awaits racing completion") {
+    int completed = 0, timed_out = 0;
+    for (int i = 0; i < 2000; i++) {
+        int64_t r = -1;
+        /* Task duration straddles the deadline */
+        if (yona_rt_async_await_timeout(yona_rt_async_call(sleep_us, 500 + (i % 5) * 250), 1, &r)) {
+            CHECK(r == 500 + (i % 5) * 250);
+            completed++;
+        } else {
+            timed_out++;
+        }
+    }
+    CHECK(completed + timed_out == 2000);
+    int64_t r = 0;
+    CHECK(yona_rt_async_await_timeout(yona_rt_async_call(square, 9), 10000, &r) == 1);
+    CHECK(r == 81);
+    CHECK(yona_rt_async_await_timeout(yona_rt_async_call(sleep_us, 100000), 1, &r) == 0);
+}
+
+TEST_CASE("a standalone promise completed after its await timed out") {
+    int64_t r = 0;
+    int bad = 0;
+    for (int i = 0; i < 1000; i++) {
+        void* p = yona_rt_promise_new();
+        if (yona_rt_async_await_timeout(p, i & 1, &r) != 0) bad++;
+        /* p is still the completer's: q must not be handed its block */
+        void* q = yona_rt_promise_new();
+        yona_rt_promise_complete(p, i, 0, nullptr);
+        if (q == p || yona_rt_async_await_timeout(q, 0, &r) != 0) bad++;
+        yona_rt_promise_complete(q, -1, 0, nullptr);
+    }
+    CHECK(bad == 0);
+
+    /* A native completer on another thread racing the deadline */
+    const int n = 2000;
+    std::vector<void*> ps;
+    for (int i = 0; i < n; i++) ps.push_back(yona_rt_promise_new());
+    std::thread completer([&] {
+        for (int i = 0; i < n; i++) {
+            usleep((useconds_t)(i % 4) * 400);
+            yona_rt_promise_complete(ps[i], i, 0, nullptr);
+        }
+    });
+    int completed = 0;
+    for (int i = 0; i < n; i++) {
+        if (!yona_rt_async_await_timeout(ps[i], 1, &r)) continue;
+        if (r != i) bad++;
+        completed++;
+        /* Recycled blocks start out pending */
+        void* q = yona_rt_promise_new();
+        if (yona_rt_async_await_timeout(q, 0, &r) != 0) bad++;
+        yona_rt_promise_complete(q, -1, 0, nullptr);
+    }
+    completer.join();
+    CHECK(bad == 0);
+    CHECK(completed > 0);
+}
+
+TEST_CASE("timed awaits inside tasks") {
+    std::vector<void*> ps;
+    for (int i = 0; i < 500; i++) ps.push_back(yona_rt_async_call(timed_in_task, (i % 3) * 800));
+    int bad = 0;
+    for (int i = 0; i < 500; i++) {
+        int64_t r = yona_rt_async_await(ps[i]);
+        if (r != -2 && r != (i % 3) * 800) bad++;
+    }
+    CHECK(bad == 0);
+}
+
+TEST_CASE("recycled and framed groups keep their children apart") {
+    std::vector<void*> ps;
+    for (int i = 0; i < 4000; i++) ps.push_back(yona_rt_async_call(grouped_sum, i));
+    int bad = 0;
+    for (int i = 0; i < 4000; i++)
+        if (yona_rt_async_await(ps[i]) != grouped_expected(i)) bad++;
+    CHECK(bad == 0);
+}
+
+} // TEST_SUITE("RuntimePromise")
@@ -0,0 +1,211 @@
+/*
+ * Task scheduler tests.
+ *
+ * Workers take tasks from their own deques, steal from each other, pick
+ * up work that non-workers push on the injection stack, and run urgent
+ * tasks from a shared heap in deadline order. These tests drive each of
+ * those through the public spawn and await entry points, plus the awaits
+ * that must not deadlock while a sibling blocks, and the fiber stacks
+ * tasks run and park on.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+extern "C" {
+void* yona_rt_async_call(int64_t (*fn)(int64_t), int64_t arg);
+int64_t yona_rt_async_await(void* promise);
+void* yona_rt_async_spawn_closure_prio(int64_t* closure, int64_t prio, int64_t deadline_ms);
+void* yona_rt_channel_new(int64_t capacity);
+void yona_rt_channel_send(void* ch, int64_t value);
+int64_t yona_rt_channel_recv(void* ch);
+void yona_Std_Time__sleep(int64_t ms);
+int64_t yona_Std_Runtime__workerCount(void);
+}
+
+namespace {
+
+int64_t identity(int64_t x) { return x; }
+
+int64_t fib(int64_t n) {
+    if (n < 2) return n;
+    void* a = yona_rt_async_call(fib, n - 1);
+    void* b = yona_rt_async_call(fib, n - 2);
+    int64_t r = yona_rt_async_await(b);
+    return yona_rt_async_await(a) + r;
+}
+
+/* More children than a deque starts with, awaited oldest first */
+int64_t fan_out(int64_t n) {
+    std::vector<void*> ps(n);
+    for (int64_t i = 0; i < n; i++) ps[i] = yona_rt_async_call(identity, i);
+    int64_t sum = 0;
+    for (int64_t i = 0; i < n; i++) sum += yona_rt_async_await(ps[i]);
+    return sum;
+}
+
+/* A awaits C, then sends what B is blocked receiving */
+void* sibling_channel;
+
+int64_t sleeper(int64_t ms) {
+    yona_Std_Time__sleep(ms);
+    return ms;
+}
+
+int64_t receiver(int64_t) {
+    return ((int64_t*)(intptr_t)yona_rt_channel_recv(sibling_channel))[3];
+}
+
+int64_t awaits_before_sending(int64_t) {
+    void* c = yona_rt_async_call(sleeper, 50);
+    void* b = yona_rt_async_call(receiver, 0);
+    int64_t r = yona_rt_async_await(c);
+    yona_rt_channel_send(sibling_channel, 7);
+    return r + yona_rt_async_await(b);
+}
+
+/* Not a tail call, and enough of a frame that the depth is real */
+#if defined(__SANITIZE_ADDRESS__)
+const int64_t recursion_depth = 20000;  /* redzones more than double a frame */
+#else
+const int64_t recursion_depth = 50000;
+#endif
+
+int64_t recurse(int64_t n) {
+    volatile int64_t pad[4] = {n, n, n, n};
+    if (n == 0) return 0;
+    int64_t r = recurse(n - 1);
+    return r + pad[n & 3] - n + 1;
+}
+
+/* Parks on the channel until the test sends to it */
+#if defined(__SANITIZE_THREAD__)
+const int parked_tasks = 1000;  /* TSan keeps a large context per fiber */
+#else
+const int parked_tasks = 10000;
+#endif
+std::atomic<int> parked{0};
+void* park_channel;
+
+int64_t park_then_receive(int64_t) {
+    parked.fetch_add(1);
+    return ((int64_t*)(intptr_t)yona_rt_channel_recv(park_channel))[3];
+}
+
+/* Blocks its worker thread (not just its task) until released */
+std::atomic<int> gate_started{0};
+std::atomic<int> gate_open[256];
+
+int64_t hold_worker(int64_t i) {
+    gate_started.fetch_add(1);
+    while (!gate_open[i].load()) usleep(200);
+    return 0;
+}
+
+std::atomic<int> ran_next{0};
+int64_t ran[64];
+
+int64_t record(int64_t* closure) {
+    ran[ran_next.fetch_add(1)] = closure[5];
+    return 0;
+}
+
+} // namespace
+
+TEST_SUITE("RuntimeScheduler") {
+
+TEST_CASE("nested spawns are stolen and awaited") {
+    void* p = yona_rt_async_call(fib, 20);
+    CHECK(yona_rt_async_await(p) == 6765);
+}
+
+TEST_CASE("a worker's deque grows past its initial size") {
+    void* p = yona_rt_async_call(fan_out, 5000);
+    CHECK(yona_rt_async_await(p) == 5000 * 4999 / 2);
+}
+
+TEST_CASE("tasks injected from several threads all run") {
+    std::vector<std::thread> threads;
+    std::atomic<int64_t> total{0};
+    for (int t = 0; t < 8; t++)
+        threads.emplace_back([&total, t] {
+            std::vector<void*> ps;
+            for (int i = 0; i < 2000; i++) ps.push_back(yona_rt_async_call(identity, t * 2000 + i));
+            int64_t sum = 0;
+            for (void* p : ps) sum += yona_rt_async_await(p);
+            total += sum;
+        });
+    for (auto& th : threads) th.join();
+    CHECK(total.load() == int64_t(16000) * 15999 / 2);
+}
+
+TEST_CASE("an await does not run a blocked sibling on its own stack") {
+    for (int round = 0; round < 20; round++) {
+        sibling_channel = yona_rt_channel_new(1);
+        void* a = yona_rt_async_call(awaits_before_sending, 0);
+        REQUIRE(yona_rt_async_await(a) == 57);
+    }
+}
+
+TEST_CASE("urgent tasks run earliest deadline first, before normal ones") {
+    yona_rt_async_await(yona_rt_async_call(identity, 0));  /* pool started */
+    int workers = (int)yona_Std_Runtime__workerCount();
+    REQUIRE(workers <= 256);
+    gate_started = 0;
+    for (int i = 0; i < workers; i++) gate_open[i] = 0;
+    std::vector<void*> holders;
+    for (int i = 0; i < workers; i++) holders.push_back(yona_rt_async_call(hold_worker, i));
+    while (gate_started.load() < workers) usleep(200);
+
+    /* Every worker is held: queue in scrambled order, then free one */
+    const int64_t deadlines[] = {50, 10, 40, 20, 70, 30, 60, 0};
+    static int64_t closures[12][6];
+    std::vector<void*> ps;
+    ran_next = 0;
+    for (int i = 0; i < 4; i++) {
+        int64_t* c = closures[8 + i];
+        c[0] = (int64_t)(intptr_t)record;
+        c[3] = 1;
+        c[5] = 1000 + i;
+        ps.push_back(yona_rt_async_spawn_closure_prio(c, 1, 0));
+    }
+    for (int i = 0; i < 8; i++) {
+        int64_t* c = closures[i];
+        c[0] = (int64_t)(intptr_t)record;
+        c[3] = 1;
+        c[5] = deadlines[i];
+        ps.push_back(yona_rt_async_spawn_closure_prio(c, 0, deadlines[i]));
+    }
+    gate_open[0] = 1;
+    for (void* p : ps) yona_rt_async_await(p);
+    for (int i = 1; i < workers; i++) gate_open[i] = 1;
+    for (void* p : holders) yona_rt_async_await(p);
+
+    REQUIRE(ran_next.load() == 12);
+    for (int i = 0; i < 8; i++) CHECK(ran[i] == i * 10);
+    for (int i = 8; i < 12; i++) CHECK(ran[i] >= 1000);
+}
+
+TEST_CASE("a task recurses as deep as a thread") {
+    void* p = yona_rt_async_call(recurse, recursion_depth);
+    CHECK(yona_rt_async_await(p) == recursion_depth);
+}
+
+TEST_CASE("thousands of tasks park at once, each on its own stack") {
+    const int n = parked_tasks;
+    park_channel = yona_rt_channel_new(n);
+    parked = 0;
+    std::vector<void*> ps;
+    for (int i = 0; i < n; i++) ps.push_back(yona_rt_async_call(park_then_receive, 0));
+    while (parked.load() < n) usleep(1000);
+    for (int i = 0; i < n; i++) yona_rt_channel_send(park_channel, i);
+    int64_t sum = 0;
+    for (void* p : ps) sum += yona_rt_async_await(p);
+    CHECK(sum == int64_t(n) * (n - 1) / 2);
+}
+
+} // TEST_SUITE("RuntimeScheduler")
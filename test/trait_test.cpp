@@ -787,4 +787,159 @@ import Test\DeriveHash1 in hashTest Green
     CHECK(result == "1");
 }
 
+TEST_CASE("Derive Json encodes a record as an object") {
+    string mod_source = R"(
+module Test\DeriveJson1
+
+export type Person
+export encode
+
+type Person = Person { name : String, age : Int }
+    deriving Json
+
+encode n a = toJson (Person { name = n, age = a })
+)";
+    string expr_source = R"(
+import encode from Test\DeriveJson1 in encode "Al" 30
+)";
+    auto result = compile_and_run_derive(mod_source, expr_source, "Test/DeriveJson1");
+    CHECK(result == R"({"name":"Al","age":30})");
+}
+
+TEST_CASE("Derive Json decodes fields by name in any order") {
+    string mod_source = R"(
+module Test\DeriveJson2
+
+export type Person
+export decodeAge
+
+type Person = Person { name : String, age : Int }
+    deriving Json
+
+decodeAge s = case fromJson (Person { name = "", age = 0 }) s of
+    Person _ a -> a
+end
+)";
+    string expr_source = R"(
+import decodeAge from Test\DeriveJson2 in decodeAge "\{\"extra\": [1], \"age\": 41, \"name\": \"x\"\}"
+)";
+    auto result = compile_and_run_derive(mod_source, expr_source, "Test/DeriveJson2");
+    CHECK(result == "41");
+}
+
+TEST_CASE("Derive Json round-trips a tagged constructor") {
+    string mod_source = R"(
+module Test\DeriveJson3
+
+export type Shape
+export roundTrip
+
+type Shape = Dot | Circle Int
+    deriving Json
+
+roundTrip r = toJson (fromJson Dot (toJson (Circle r)))
+)";
+    string expr_source = R"(
+import roundTrip from Test\DeriveJson3 in roundTrip 7
+)";
+    auto result = compile_and_run_derive(mod_source, expr_source, "Test/DeriveJson3");
+    CHECK(result == R"({"Circle":[7]})");
+}
+
+TEST_CASE("Derive Json skips nested values and matches escaped keys") {
+    string mod_source = R"(
+module Test\DeriveJson4
+
+export type Person
+export describe
+
+type Person = Person { name : String, age : Int }
+    deriving Json
+
+describe s = case fromJson (Person { name = "", age = 0 }) s of
+    Person n a -> n ++ " " ++ show a
+end
+)";
+    string expr_source = R"(
+import describe from Test\DeriveJson4 in describe "\{\"skip\": \{\"age\": 1, \"name\": [\"x\"]\}, \"age\": 41, \"n\\u0061me\": \"Al\"\}"
+)";
+    auto result = compile_and_run_derive(mod_source, expr_source, "Test/DeriveJson4");
+    CHECK(result == "Al 41");
+}
+
+TEST_CASE("Derive Json reads nested records of every scalar type") {
+    string mod_source = R"(
+module Test\DeriveJson5
+
+export type Point
+export type Reading
+export describe
+
+type Point = Point { x : Float, ok : Bool }
+    deriving Json
+
+type Reading = Reading { label : String, count : Int, at : Point }
+    deriving Json
+
+describe s = import reader, finish from Std\Json in do
+    r = reader s
+    v = readJson (Reading { label = "", count = 0, at = Point { x = 0.0, ok = false } }) r
+    finish r
+    case v of
+        Reading l c p -> case p of
+            Point x ok -> l ++ " " ++ show c ++ " " ++ show x ++ " " ++ show ok
+        end
+    end
+end
+)";
+    string expr_source = R"(
+import describe from Test\DeriveJson5 in describe "\{\"count\": 3, \"at\": \{\"ok\": true, \"x\": 2.5\}, \"label\": \"t\"\}"
+)";
+    auto result = compile_and_run_derive(mod_source, expr_source, "Test/DeriveJson5");
+    CHECK(result == "t 3 2.5 true");
+}
+
+TEST_CASE("Derive Binary round-trips a record") {
+    string mod_source = R"(
+module Test\DeriveBinary1
+
+export type Person
+export roundTrip
+
+type Person = Person { name : String, age : Int, tags : Seq String }
+    deriving Binary
+
+roundTrip n a = import length from Std\List in case fromBinary (Person { name = "", age = 0, tags = [] }) (toBinary (Person { name = n, age = a, tags = [n, "x"] })) of
+    Person name age tags -> name ++ " " ++ show age ++ " " ++ show (length tags)
+end
+)";
+    string expr_source = R"(
+import roundTrip from Test\DeriveBinary1 in roundTrip "Al" 30
+)";
+    auto result = compile_and_run_derive(mod_source, expr_source, "Test/DeriveBinary1");
+    CHECK(result == "Al 30 2");
+}
+
+TEST_CASE("Derive Binary keeps the constructor of a sum type") {
+    string mod_source = R"(
+module Test\DeriveBinary2
+
+export type Shape
+export radius
+
+type Shape = Dot | Circle Float
+    deriving Binary
+
+radius r = case fromBinary Dot (toBinary (Circle r)) of
+    Circle x -> x
+    Dot -> 0.0
+end
+)";
+    string expr_source = R"(
+import radius from Test\DeriveBinary2 in radius 2.5
+)";
+    auto result = compile_and_run_derive(mod_source, expr_source, "Test/DeriveBinary2");
+    CHECK(result == "2.5");
+}
+
 } // TEST_SUITE
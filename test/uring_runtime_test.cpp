@@ -0,0 +1,427 @@
+/*
+ * io_uring ring tests (Linux).
+ *
+ * Each submitting thread gets a ring of its own up to YONA_RING_MAX, and
+ * threads past that share one. An operation's user_data names its ring, a
+ * slot in that ring, and the slot's generation, so a completion for a slot
+ * that has since been reused is dropped. SQEs are queued and reach the
+ * kernel in batches, so a thread must push out what it queued before it
+ * blocks. A ring also registers long-lived fds as fixed files, staging
+ * buffers for writes, and a pool of provided buffers for recv. These tests
+ * drive the ring layer directly and through the Net and File entry points
+ * that use those resources.
+ */
+
+#ifdef __linux__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <dirent.h>
+#include <doctest/doctest.h>
+#include <fcntl.h>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+extern "C" {
+#include "yona/runtime/uring.h"
+
+void yona_Std_Time__sleep(int64_t ms);
+void yona_rt_sleep(int64_t ms);
+int64_t yona_rt_io_await(int64_t uring_id);
+void yona_rt_rc_dec(void* ptr);
+int64_t yona_Std_Net__tcpListen(const char* host, int64_t port);
+int64_t yona_Std_Net__tcpConnect(const char* host, int64_t port);
+int64_t yona_Std_Net__tcpAccept(int64_t listener_fd);
+int64_t yona_Std_Net__send(int64_t fd, const char* data);
+int64_t yona_Std_Net__recv(int64_t fd, int64_t max_bytes);
+int64_t yona_Std_Net__close(int64_t fd);
+int64_t yona_Std_File__writeFile(const char* path, const char* content);
+int64_t yona_platform_open_file_handle(const char* path, int64_t mode_tag);
+int64_t yona_platform_close_file_handle(int fd);
+int64_t yona_platform_write_fd_str_submit(int fd, const char* s);
+}
+
+namespace {
+
+/* user_data: [ring index + 1 : 24][generation : 18][slot : 22] */
+const int slot_bits = 22;
+const uint64_t gen_mask = (1u << 18) - 1;
+
+/* The same slot one generation back */
+uint64_t previous_generation(uint64_t id) {
+    uint64_t gen = (id >> slot_bits) & gen_mask;
+    return (id & ~(gen_mask << slot_bits)) | (((gen - 1) & gen_mask) << slot_bits);
+}
+
+char scratch[512];
+
+uint64_t submit_write(int fd, const void* data, unsigned len) {
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_WRITE;
+    sqe.fd = fd;
+    sqe.addr = (uint64_t)(uintptr_t)data;
+    sqe.len = len;
+    sqe.off = (uint64_t)-1;
+    return ring_submit_sqe(&sqe);
+}
+
+uint64_t submit_read(int fd, void* buf, unsigned len) {
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = fd;
+    sqe.addr = (uint64_t)(uintptr_t)buf;
+    sqe.len = len;
+    sqe.off = (uint64_t)-1;
+    return ring_submit_sqe(&sqe);
+}
+
+/* Every io_uring instance the process has open */
+std::vector<int> ring_fds() {
+    std::vector<int> fds;
+    DIR* d = opendir("/proc/self/fd");
+    if (!d) return fds;
+    while (struct dirent* e = readdir(d)) {
+        char path[64], target[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%s", e->d_name);
+        ssize_t n = readlink(path, target, sizeof(target) - 1);
+        if (n <= 0) continue;
+        target[n] = '\0';
+        if (strcmp(target, "anon_inode:[io_uring]") == 0) fds.push_back(atoi(e->d_name));
+    }
+    closedir(d);
+    return fds;
+}
+
+/* Post a CQE with the given user_data and res on ring_fd, as if an
+ * operation had completed there. Returns the MSG_RING's own result. */
+int32_t post_completion(int ring_fd, uint64_t user_data, uint32_t res) {
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_MSG_RING;
+    sqe.fd = ring_fd;
+    sqe.addr = IORING_MSG_DATA;
+    sqe.len = res;
+    sqe.off = user_data;
+    return ring_await(ring_submit_sqe(&sqe));
+}
+
+/* Has the read end of the pipe got data within ms? */
+bool readable_within(int fd, int ms) {
+    struct pollfd p = {fd, POLLIN, 0};
+    return poll(&p, 1, ms) == 1;
+}
+
+/* Provided recv buffers and staging buffers per ring, and a staging
+ * buffer's size (YONA_RING_PBUFS, YONA_RING_BUFS, YONA_RING_BUF_SIZE) */
+const int ring_pbufs = 128;
+const int ring_bufs = 16;
+const size_t ring_buf_size = 16384;
+
+int64_t listen_loopback(int64_t* port) {
+    for (*port = 28500; *port < 28700; ++*port) {
+        int64_t fd = yona_Std_Net__tcpListen("127.0.0.1", *port);
+        if (fd != -1) return fd;
+    }
+    return -1;
+}
+
+std::string recv_string(int64_t fd) {
+    char* s = (char*)(intptr_t)yona_rt_io_await(yona_Std_Net__recv(fd, 64));
+    std::string r = s ? s : "";
+    if (s) yona_rt_rc_dec(s);
+    return r;
+}
+
+std::string slurp(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+/* Read exactly n bytes from a blocking fd */
+std::string read_exactly(int fd, size_t n) {
+    std::string r(n, '\0');
+    size_t got = 0;
+    while (got < n) {
+        ssize_t k = read(fd, &r[got], n - got);
+        if (k <= 0) break;
+        got += (size_t)k;
+    }
+    r.resize(got);
+    return r;
+}
+
+} // namespace
+
+TEST_SUITE("RuntimeRing") {
+
+TEST_CASE("more threads than rings share them") {
+    int devnull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    REQUIRE(devnull >= 0);
+    const int threads = 100;  /* past YONA_RING_MAX, all alive at once */
+    std::mutex m;
+    std::condition_variable cv;
+    int ready = 0;
+    std::atomic<int> bad{0};
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++)
+        pool.emplace_back([&, t] {
+            {
+                std::unique_lock<std::mutex> lock(m);
+                if (++ready == threads) cv.notify_all();
+                cv.wait(lock, [&] { return ready == threads; });
+            }
+            for (int round = 0; round < 20; round++) {
+                /* More than one batch queued before the first await */
+                uint64_t ids[40];
+                for (int i = 0; i < 40; i++) ids[i] = submit_write(devnull, scratch, (t * 7 + i) % 512 + 1);
+                for (int i = 0; i < 40; i++)
+                    if (!ids[i] || ring_await(ids[i]) != (t * 7 + i) % 512 + 1) bad++;
+            }
+        });
+    for (auto& th : pool) th.join();
+    CHECK(bad.load() == 0);
+
+    /* One thread's operations awaited by another */
+    std::vector<uint64_t> ids;
+    std::thread([&] {
+        for (int i = 0; i < 100; i++) ids.push_back(submit_write(devnull, scratch, i + 1));
+    }).join();
+    for (int i = 0; i < 100; i++) CHECK(ring_await(ids[i]) == i + 1);
+    close(devnull);
+}
+
+TEST_CASE("a completion for a reused slot's old generation is dropped") {
+    int p[2];
+    REQUIRE(pipe(p) == 0);
+    char buf[8];
+    uint64_t id = submit_read(p[0], buf, sizeof(buf));
+    REQUIRE(id != 0);
+
+    int posted = 0;
+    for (int fd : ring_fds())
+        if (post_completion(fd, previous_generation(id), 12345) == 0) posted++;
+    if (!posted) {
+        MESSAGE("IORING_OP_MSG_RING unavailable; skipped");
+        ring_cancel(id);
+        ring_await(id);
+    } else {
+        /* The stale CQE must not finish the read; only the data does */
+        std::thread writer([&] {
+            usleep(100000);
+            CHECK(write(p[1], "x", 1) == 1);
+        });
+        CHECK(ring_await(id) == 1);
+        writer.join();
+    }
+    close(p[0]);
+    close(p[1]);
+}
+
+TEST_CASE("queued submissions go out before a thread sleeps") {
+    int p[2];
+    REQUIRE(pipe(p) == 0);
+    for (int variant = 0; variant < 2; variant++) {
+        uint64_t id = 0;
+        std::thread sleeper([&] {
+            id = submit_write(p[1], "ping", 4);  /* one SQE: well short of a batch */
+            if (variant == 0)
+                yona_Std_Time__sleep(1500);
+            else
+                yona_rt_sleep(1500);
+        });
+        CHECK(readable_within(p[0], 1000));
+        sleeper.join();
+        CHECK(ring_await(id) == 4);
+        CHECK(read(p[0], scratch, sizeof(scratch)) == 4);
+    }
+    close(p[0]);
+    close(p[1]);
+}
+
+TEST_CASE("a closed socket's fd reused by a new one reaches the new socket") {
+    int64_t port = 0;
+    int64_t listener = listen_loopback(&port);
+    REQUIRE(listener != -1);
+    int64_t accept1 = yona_Std_Net__tcpAccept(listener);
+    int64_t c1 = yona_rt_io_await(yona_Std_Net__tcpConnect("127.0.0.1", port));
+    int64_t s1 = yona_rt_io_await(accept1);
+    REQUIRE(s1 > 0);
+    REQUIRE(c1 > 0);
+    /* A recv on s1 puts it in the ring's fixed-file table */
+    CHECK(yona_rt_io_await(yona_Std_Net__send(c1, "one")) == 3);
+    CHECK(recv_string(s1) == "one");
+
+    /* The second client is queued on the listener before s1's fd is freed,
+     * so the next accept is handed that fd */
+    int64_t c2 = yona_rt_io_await(yona_Std_Net__tcpConnect("127.0.0.1", port));
+    REQUIRE(c2 > 0);
+    yona_Std_Net__close(s1);
+    shutdown((int)c1, SHUT_RDWR);  /* a recv that reached s1 sees the end */
+    int64_t s2 = yona_rt_io_await(yona_Std_Net__tcpAccept(listener));
+    REQUIRE(s2 == s1);
+    CHECK(yona_rt_io_await(yona_Std_Net__send(c2, "two")) == 3);
+    CHECK(recv_string(s2) == "two");
+    yona_Std_Net__close(c1);
+    yona_Std_Net__close(s2);
+    yona_Std_Net__close(c2);
+    yona_Std_Net__close(listener);
+}
+
+TEST_CASE("a closed file handle's fd reused by another file writes that file") {
+    char dir[] = "/tmp/yona_ring_XXXXXX";
+    REQUIRE(mkdtemp(dir) != nullptr);
+    std::string a = std::string(dir) + "/a", b = std::string(dir) + "/b";
+    int fa = (int)yona_platform_open_file_handle(a.c_str(), 1);
+    REQUIRE(fa >= 0);
+    CHECK(yona_rt_io_await(yona_platform_write_fd_str_submit(fa, "first")) == 5);
+    yona_platform_close_file_handle(fa);
+    int fb = (int)yona_platform_open_file_handle(b.c_str(), 1);
+    REQUIRE(fb == fa);
+    CHECK(yona_rt_io_await(yona_platform_write_fd_str_submit(fb, "second")) == 6);
+    yona_platform_close_file_handle(fb);
+    CHECK(slurp(a) == "first");
+    CHECK(slurp(b) == "second");
+    unlink(a.c_str());
+    unlink(b.c_str());
+    rmdir(dir);
+}
+
+TEST_CASE("writes larger than a staging buffer, or past the last one, still go out") {
+    int sv[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    std::string big(ring_buf_size * 2 + 123, 'x');
+    for (size_t i = 0; i < big.size(); i++) big[i] = (char)('a' + i % 26);
+    std::string got;
+    std::thread reader([&] { got = read_exactly(sv[1], big.size()); });
+    CHECK(yona_rt_io_await(yona_Std_Net__send(sv[0], big.c_str())) == (int64_t)big.size());
+    reader.join();
+    CHECK(got == big);
+
+    /* More sends in flight than there are staging buffers */
+    const int sends = ring_bufs * 2 + 5;
+    std::string chunk(1000, 'y');
+    std::vector<int64_t> ids;
+    std::thread drain([&] { got = read_exactly(sv[1], chunk.size() * sends); });
+    for (int i = 0; i < sends; i++) ids.push_back(yona_Std_Net__send(sv[0], chunk.c_str()));
+    for (int64_t id : ids) CHECK(yona_rt_io_await(id) == (int64_t)chunk.size());
+    drain.join();
+    CHECK(got == std::string(chunk.size() * sends, 'y'));
+    close(sv[0]);
+    close(sv[1]);
+
+    char dir[] = "/tmp/yona_ring_XXXXXX";
+    REQUIRE(mkdtemp(dir) != nullptr);
+    std::string path = std::string(dir) + "/big";
+    CHECK(yona_rt_io_await(yona_Std_File__writeFile(path.c_str(), big.c_str())) == 1);
+    CHECK(slurp(path) == big);
+    unlink(path.c_str());
+    rmdir(dir);
+}
+
+TEST_CASE("recv buffers run out, fall back, and come back") {
+    const int pairs = ring_pbufs + 22;
+    std::vector<int> fds(pairs * 2);
+    for (int i = 0; i < pairs; i++) REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, &fds[i * 2]) == 0);
+    int extra[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, extra) == 0);
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < pairs; i++) {
+            std::string msg = "msg-" + std::to_string(round) + "-" + std::to_string(i);
+            REQUIRE(write(fds[i * 2], msg.data(), msg.size()) == (ssize_t)msg.size());
+        }
+        /* Every recv completes at once, each holding a buffer until taken */
+        std::vector<uint64_t> ids;
+        for (int i = 0; i < pairs; i++) {
+            struct io_uring_sqe sqe;
+            memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_RECV;
+            sqe.fd = fds[i * 2 + 1];
+            sqe.len = 64;
+            REQUIRE(ring_sqe_select_buffer(&sqe, 64));
+            ids.push_back(ring_submit_sqe(&sqe));
+        }
+        std::vector<uint32_t> flags(pairs);
+        std::vector<int32_t> res(pairs);
+        int buffered = 0, ran_out = 0;
+        for (int i = 0; i < pairs; i++) {
+            res[i] = ring_await_flags(ids[i], &flags[i]);
+            if (flags[i] & IORING_CQE_F_BUFFER) {
+                std::string msg = "msg-" + std::to_string(round) + "-" + std::to_string(i);
+                CHECK(std::string(ring_pbuf_data(ids[i], flags[i]), (size_t)res[i]) == msg);
+                buffered++;
+            } else if (res[i] == -ENOBUFS) {
+                /* Still queued on the socket for the next round to skip */
+                char drop[64];
+                CHECK(read(fds[i * 2 + 1], drop, sizeof(drop)) > 0);
+                ran_out++;
+            }
+        }
+        CHECK(buffered == ring_pbufs);
+        CHECK(ran_out == pairs - ring_pbufs);
+
+        /* With the pool empty, Net.recv falls back to a buffer of its own */
+        REQUIRE(write(extra[0], "extra", 5) == 5);
+        CHECK(recv_string(extra[1]) == "extra");
+
+        for (int i = 0; i < pairs; i++) ring_pbuf_recycle(ids[i], flags[i]);
+    }
+    for (int fd : fds) close(fd);
+    close(extra[0]);
+    close(extra[1]);
+}
+
+TEST_CASE("a cancelled multishot ends its stream") {
+    int64_t port = 0;
+    int64_t listener = listen_loopback(&port);
+    REQUIRE(listener != -1);
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_ACCEPT;
+    sqe.fd = (int)listener;
+    sqe.ioprio = IORING_ACCEPT_MULTISHOT;
+    ring_stream_t* st = ring_stream_open(&sqe);
+    REQUIRE(st != nullptr);
+
+    int32_t res = 0;
+    uint32_t cqe_flags;
+    for (int i = 0; i < 3 && res >= 0; i++) {
+        int64_t client = yona_rt_io_await(yona_Std_Net__tcpConnect("127.0.0.1", port));
+        REQUIRE(ring_stream_next(st, &res, &cqe_flags) == 1);
+        if (res >= 0) {
+            CHECK((cqe_flags & IORING_CQE_F_MORE) != 0);
+            close(res);
+        }
+        yona_Std_Net__close(client);
+    }
+    if (res == -EINVAL) {
+        MESSAGE("multishot accept unavailable; skipped");
+    } else {
+        REQUIRE(res >= 0);
+        /* The final CQE carries the cancel; nothing comes after it */
+        ring_cancel(ring_stream_id(st));
+        REQUIRE(ring_stream_next(st, &res, &cqe_flags) == 1);
+        CHECK(res == -ECANCELED);
+        CHECK((cqe_flags & IORING_CQE_F_MORE) == 0);
+        CHECK(ring_stream_next(st, &res, &cqe_flags) == 0);
+    }
+    ring_stream_close(st);
+    yona_Std_Net__close(listener);
+}
+
+} // TEST_SUITE("RuntimeRing")
+
+#endif /* __linux__ */